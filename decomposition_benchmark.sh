@@ -0,0 +1,57 @@
+#!/usr/bin/env bash
+
+# compares the quality and the computational time of the monolithic solver and the geographic decomposition
+# on generated instances, results are read from manifests of the runs
+
+set -e
+
+SIZES=${SIZES:-"20:60:120 40:120:240 80:240:480"}
+CLUSTERS=${CLUSTERS:-4}
+THREADS=${THREADS:-4}
+OUTPUT_DIR=${OUTPUT_DIR:-decomposition_benchmark}
+SOLVER_ARGS="--travel-model=haversine --scheduling-date=2017-02-01 --console-format=log \
+--preopt-noprogress-time-limit=00:00:30 --opt-noprogress-time-limit=00:01:00 --postopt-noprogress-time-limit=00:00:30 \
+--visit-time-window=00:30:00 --break-time-window=00:30:00 --begin-end-shift-time-extension=00:15:00"
+
+mkdir -p ${OUTPUT_DIR}
+for size in ${SIZES}; do
+    IFS=':' read -r carers service_users visits <<< "${size}"
+    instance=${OUTPUT_DIR}/c${carers}_s${service_users}_v${visits}
+
+    if [ ! -f ${instance}_problem.json ]; then
+        ./build/rows-generate --carers=${carers} --service_users=${service_users} --visits_per_day=${visits} \
+        --clusters=${CLUSTERS} --problem_output=${instance}_problem.json --history_output=
+    fi
+
+    rm -f ${instance}_monolithic.json ${instance}_decomposition.json
+    ./build/rows-main --problem=${instance}_problem.json ${SOLVER_ARGS} \
+    --output=${instance}_monolithic.gexf --manifest=${instance}_monolithic.json 2> ${instance}_monolithic.err.log
+    ./build/rows-main --problem=${instance}_problem.json ${SOLVER_ARGS} \
+    --decomposition-clusters=${CLUSTERS} --decomposition-threads=${THREADS} \
+    --output=${instance}_decomposition.gexf --manifest=${instance}_decomposition.json 2> ${instance}_decomposition.err.log
+done
+
+python3 - ${OUTPUT_DIR}/*_monolithic.json <<'PYTHON'
+import json
+import sys
+
+
+def summarize(path):
+    with open(path) as input_stream:
+        manifest = json.load(input_stream)
+    solutions = [solution for solution in manifest['solutions'] if solution['stage'] == 'Stage2']
+    wall_time_ms = sum(stage['wall_time_ms'] for stage in manifest['stages'] if stage['name'] == 'All')
+    if not solutions:
+        return None, None, wall_time_ms
+    return solutions[-1]['cost'], solutions[-1]['dropped_visits'], wall_time_ms
+
+
+print('{0:<24} {1:>14} {2:>8} {3:>10} {4:>14} {5:>8} {6:>10}'.format(
+    'instance', 'cost', 'dropped', 'time [s]', 'cost (dec)', 'dropped', 'time [s]'))
+for monolithic_path in sys.argv[1:]:
+    instance = monolithic_path[:-len('_monolithic.json')]
+    cost, dropped, wall_time_ms = summarize(monolithic_path)
+    dec_cost, dec_dropped, dec_wall_time_ms = summarize(instance + '_decomposition.json')
+    print('{0:<24} {1:>14} {2:>8} {3:>10.1f} {4:>14} {5:>8} {6:>10.1f}'.format(
+        instance.split('/')[-1], cost, dropped, wall_time_ms / 1000.0, dec_cost, dec_dropped, dec_wall_time_ms / 1000.0))
+PYTHON
@@ -0,0 +1,144 @@
+#include "async_printer.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include <glog/logging.h>
+
+namespace rows {
+
+    static std::size_t RoundUpToPowerOfTwo(std::size_t value) {
+        std::size_t result = 1;
+        while (result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    AsyncPrinter::AsyncPrinter(std::shared_ptr<Printer> printer, std::size_t capacity)
+            : printer_{std::move(printer)},
+              buffer_(RoundUpToPowerOfTwo(std::max(capacity, static_cast<std::size_t>(2)))),
+              mask_{buffer_.size() - 1},
+              head_{0},
+              head_padding_{},
+              tail_{0},
+              tail_padding_{},
+              dropped_{0},
+              stopped_{false},
+              thread_{} {
+        thread_ = std::thread([this]() -> void { Run(); });
+    }
+
+    AsyncPrinter::~AsyncPrinter() {
+        {
+            std::lock_guard<std::mutex> lock{print_mutex_};
+            stopped_ = true;
+        }
+        stop_requested_.notify_all();
+        thread_.join();
+
+        const auto dropped_steps = dropped_.load(std::memory_order_relaxed);
+        LOG_IF(WARNING, dropped_steps > 0) << "Printer dropped " << dropped_steps << " progress steps which did not fit into the buffer";
+    }
+
+    Printer &AsyncPrinter::operator<<(const ProgressStep &progress_step) {
+        const auto head = head_.load(std::memory_order_relaxed);
+        if (head - tail_.load(std::memory_order_acquire) > mask_) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return *this;
+        }
+
+        auto &slot = buffer_[head & mask_];
+        slot.Cost = progress_step.Cost;
+        slot.WallTimeUs = progress_step.WallTime.total_microseconds();
+        slot.Branches = progress_step.Branches;
+        slot.Solutions = progress_step.Solutions;
+        slot.MemoryUsage = progress_step.MemoryUsage;
+        slot.DroppedVisits = static_cast<uint32_t>(progress_step.DroppedVisits);
+        head_.store(head + 1, std::memory_order_release);
+        return *this;
+    }
+
+    Printer &AsyncPrinter::operator<<(const std::string &text) {
+        std::lock_guard<std::mutex> lock{print_mutex_};
+        PrintPending();
+        printer_->operator<<(text);
+        return *this;
+    }
+
+    Printer &AsyncPrinter::operator<<(const ProblemDefinition &problem_definition) {
+        std::lock_guard<std::mutex> lock{print_mutex_};
+        PrintPending();
+        printer_->operator<<(problem_definition);
+        return *this;
+    }
+
+    Printer &AsyncPrinter::operator<<(const TracingEvent &trace_event) {
+        std::lock_guard<std::mutex> lock{print_mutex_};
+        PrintPending();
+        printer_->operator<<(trace_event);
+        return *this;
+    }
+
+    Printer &AsyncPrinter::operator<<(const PerformanceSummary &performance_summary) {
+        std::lock_guard<std::mutex> lock{print_mutex_};
+        PrintPending();
+        printer_->operator<<(performance_summary);
+        return *this;
+    }
+
+    Printer &AsyncPrinter::operator<<(const MemorySummary &memory_summary) {
+        std::lock_guard<std::mutex> lock{print_mutex_};
+        PrintPending();
+        printer_->operator<<(memory_summary);
+        return *this;
+    }
+
+    Printer &AsyncPrinter::operator<<(const SolutionSummary &solution_summary) {
+        std::lock_guard<std::mutex> lock{print_mutex_};
+        PrintPending();
+        printer_->operator<<(solution_summary);
+        return *this;
+    }
+
+    void AsyncPrinter::Flush() {
+        std::lock_guard<std::mutex> lock{print_mutex_};
+        PrintPending();
+    }
+
+    std::size_t AsyncPrinter::capacity() const {
+        return buffer_.size();
+    }
+
+    std::size_t AsyncPrinter::dropped() const {
+        return dropped_.load(std::memory_order_relaxed);
+    }
+
+    void AsyncPrinter::PrintPending() {
+        const auto head = head_.load(std::memory_order_acquire);
+        auto tail = tail_.load(std::memory_order_relaxed);
+        while (tail != head) {
+            const auto &slot = buffer_[tail & mask_];
+            const ProgressStep progress_step{slot.Cost,
+                                             slot.DroppedVisits,
+                                             boost::posix_time::microseconds(slot.WallTimeUs),
+                                             slot.Branches,
+                                             slot.Solutions,
+                                             slot.MemoryUsage};
+            ++tail;
+            tail_.store(tail, std::memory_order_release);
+            printer_->operator<<(progress_step);
+        }
+    }
+
+    void AsyncPrinter::Run() {
+        static const std::chrono::milliseconds POLL_INTERVAL{5};
+
+        // the producer does not notify the consumer to avoid system calls on the search thread
+        std::unique_lock<std::mutex> lock{print_mutex_};
+        while (!stopped_) {
+            stop_requested_.wait_for(lock, POLL_INTERVAL);
+            PrintPending();
+        }
+    }
+}
@@ -0,0 +1,86 @@
+#ifndef ROWS_ASYNC_PRINTER_H
+#define ROWS_ASYNC_PRINTER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "printer.h"
+
+namespace rows {
+
+    // progress steps are copied into a ring buffer and formatted by a background thread, other events are rare,
+    // so they are forwarded to the decorated printer by the calling thread after the pending progress steps
+    class AsyncPrinter : public Printer {
+    public:
+        // progress steps must be sent by a single thread at a time, which is the search thread of the worker,
+        // progress steps which do not fit into the buffer are dropped
+        AsyncPrinter(std::shared_ptr<Printer> printer, std::size_t capacity);
+
+        AsyncPrinter(const AsyncPrinter &other) = delete;
+
+        AsyncPrinter &operator=(const AsyncPrinter &other) = delete;
+
+        ~AsyncPrinter() override;
+
+        Printer &operator<<(const std::string &text) override;
+
+        Printer &operator<<(const ProblemDefinition &problem_definition) override;
+
+        Printer &operator<<(const TracingEvent &trace_event) override;
+
+        Printer &operator<<(const ProgressStep &progress_step) override;
+
+        Printer &operator<<(const PerformanceSummary &performance_summary) override;
+
+        Printer &operator<<(const MemorySummary &memory_summary) override;
+
+        Printer &operator<<(const SolutionSummary &solution_summary) override;
+
+        // prints pending progress steps
+        void Flush();
+
+        std::size_t capacity() const;
+
+        std::size_t dropped() const;
+
+    private:
+        struct CompactProgressStep {
+            double Cost;
+            int64_t WallTimeUs;
+            uint64_t Branches;
+            uint64_t Solutions;
+            uint64_t MemoryUsage;
+            uint32_t DroppedVisits;
+        };
+
+        // must be called with the print mutex held, so there is a single consumer of the buffer
+        void PrintPending();
+
+        void Run();
+
+        std::shared_ptr<Printer> printer_;
+        std::vector<CompactProgressStep> buffer_;
+        std::size_t mask_;
+
+        // the producer and the consumer update positions in separate cache lines
+        std::atomic<std::size_t> head_;
+        char head_padding_[64];
+        std::atomic<std::size_t> tail_;
+        char tail_padding_[64];
+        std::atomic<std::size_t> dropped_;
+
+        std::mutex print_mutex_;
+        std::condition_variable stop_requested_;
+        bool stopped_;
+        std::thread thread_;
+    };
+}
+
+
+#endif //ROWS_ASYNC_PRINTER_H
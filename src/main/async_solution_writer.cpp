@@ -0,0 +1,109 @@
+#include "async_solution_writer.h"
+
+#include <algorithm>
+#include <exception>
+
+#include <glog/logging.h>
+
+rows::AsyncSolutionWriter::AsyncSolutionWriter(WriteFunction write, std::size_t capacity)
+        : write_{std::move(write)},
+          capacity_{std::max(capacity, static_cast<std::size_t>(1))},
+          writing_{false},
+          stopped_{false},
+          error_{},
+          submitted_{0},
+          coalesced_{0},
+          written_{0},
+          thread_{} {
+    thread_ = std::thread([this]() -> void { Run(); });
+}
+
+rows::AsyncSolutionWriter::~AsyncSolutionWriter() {
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+        stopped_ = true;
+    }
+    queue_changed_.notify_all();
+    thread_.join();
+
+    LOG_IF(ERROR, error_ != nullptr) << "Output writer was destroyed before a failed write was reported";
+}
+
+void rows::AsyncSolutionWriter::Submit(std::string file, SolutionSnapshot snapshot) {
+    std::unique_lock<std::mutex> lock{mutex_};
+    ++submitted_;
+
+    // only the latest snapshot of a file is worth writing
+    const auto pending_it = std::find_if(std::begin(queue_), std::end(queue_),
+                                         [&file](const std::pair<std::string, SolutionSnapshot> &pending) -> bool {
+                                             return pending.first == file;
+                                         });
+    if (pending_it != std::end(queue_)) {
+        pending_it->second = std::move(snapshot);
+        ++coalesced_;
+        return;
+    }
+
+    queue_changed_.wait(lock, [this]() -> bool { return queue_.size() < capacity_; });
+    queue_.emplace_back(std::move(file), std::move(snapshot));
+    lock.unlock();
+    queue_changed_.notify_all();
+}
+
+void rows::AsyncSolutionWriter::Flush() {
+    std::unique_lock<std::mutex> lock{mutex_};
+    queue_changed_.wait(lock, [this]() -> bool { return queue_.empty() && !writing_; });
+
+    if (error_ != nullptr) {
+        auto error = error_;
+        error_ = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+std::size_t rows::AsyncSolutionWriter::submitted() const {
+    std::lock_guard<std::mutex> lock{mutex_};
+    return submitted_;
+}
+
+std::size_t rows::AsyncSolutionWriter::coalesced() const {
+    std::lock_guard<std::mutex> lock{mutex_};
+    return coalesced_;
+}
+
+std::size_t rows::AsyncSolutionWriter::written() const {
+    std::lock_guard<std::mutex> lock{mutex_};
+    return written_;
+}
+
+void rows::AsyncSolutionWriter::Run() {
+    std::unique_lock<std::mutex> lock{mutex_};
+    while (true) {
+        queue_changed_.wait(lock, [this]() -> bool { return stopped_ || !queue_.empty(); });
+        if (queue_.empty()) {
+            break;
+        }
+
+        auto snapshot = std::move(queue_.front());
+        queue_.pop_front();
+        writing_ = true;
+        lock.unlock();
+        queue_changed_.notify_all();
+
+        std::exception_ptr error;
+        try {
+            write_(snapshot.first, snapshot.second);
+        } catch (const std::exception &ex) {
+            LOG(ERROR) << "Failed to write the solution to " << snapshot.first << ": " << ex.what();
+            error = std::current_exception();
+        }
+
+        lock.lock();
+        if (error != nullptr && error_ == nullptr) {
+            error_ = error;
+        }
+        writing_ = false;
+        ++written_;
+        queue_changed_.notify_all();
+    }
+}
@@ -0,0 +1,69 @@
+#ifndef ROWS_ASYNC_SOLUTION_WRITER_H
+#define ROWS_ASYNC_SOLUTION_WRITER_H
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "solution_snapshot.h"
+
+namespace rows {
+
+    // validates and saves snapshots of solutions in a background thread, so the search is not paused by the output
+    class AsyncSolutionWriter {
+    public:
+        // the function is called only by the background thread
+        using WriteFunction = std::function<void(const std::string &, const SolutionSnapshot &)>;
+
+        AsyncSolutionWriter(WriteFunction write, std::size_t capacity);
+
+        AsyncSolutionWriter(const AsyncSolutionWriter &other) = delete;
+
+        AsyncSolutionWriter &operator=(const AsyncSolutionWriter &other) = delete;
+
+        // writes pending snapshots before the background thread is stopped, a failure which was not rethrown
+        // by a flush is logged
+        ~AsyncSolutionWriter();
+
+        // replaces the pending snapshot of the same file, waits if snapshots of too many files are pending
+        void Submit(std::string file, SolutionSnapshot snapshot);
+
+        // waits until all pending snapshots are written and rethrows the first failure of a write since
+        // the last flush, the remaining snapshots are written even if a write fails
+        void Flush();
+
+        std::size_t submitted() const;
+
+        std::size_t coalesced() const;
+
+        std::size_t written() const;
+
+    private:
+        void Run();
+
+        WriteFunction write_;
+        std::size_t capacity_;
+
+        mutable std::mutex mutex_;
+        std::condition_variable queue_changed_;
+        std::deque<std::pair<std::string, SolutionSnapshot> > queue_;
+        bool writing_;
+        bool stopped_;
+        std::exception_ptr error_;
+
+        std::size_t submitted_;
+        std::size_t coalesced_;
+        std::size_t written_;
+
+        std::thread thread_;
+    };
+}
+
+
+#endif //ROWS_ASYNC_SOLUTION_WRITER_H
@@ -1,5 +1,8 @@
 #include "break_constraint.h"
 
+#include <algorithm>
+#include <utility>
+
 #include <boost/algorithm/string/join.hpp>
 #include <boost/date_time/time.hpp>
 
@@ -7,18 +10,50 @@
 
 namespace rows {
 
+    BreakConstraint::Activity::Activity()
+            : Activity(0, 0, 0, false) {}
+
+    BreakConstraint::Activity::Activity(int64 start_min, int64 start_max, int64 duration, bool optional)
+            : StartMin{start_min},
+              StartMax{start_max},
+              Duration{duration},
+              Optional{optional} {}
+
     BreakConstraint::BreakConstraint(const operations_research::RoutingDimension *dimension,
                                      const operations_research::RoutingIndexManager *index_manager,
                                      int vehicle,
                                      std::vector<operations_research::IntervalVar *> break_intervals,
-                                     RealProblemData &problem_data)
+                                     const ProblemData &problem_data)
             : Constraint(dimension->model()->solver()),
               dimension_(dimension),
               index_manager_(index_manager),
               vehicle_(vehicle),
               break_intervals_(std::move(break_intervals)),
               status_(solver()->MakeBoolVar((boost::format("status %1%") % vehicle).str())),
-              problem_data_(problem_data) {}
+              problem_data_(problem_data),
+              service_times_(),
+              activities_(),
+              activity_cumuls_(),
+              breaks_(),
+              candidate_breaks_(),
+              earliest_ready_(),
+              latest_ready_() {
+        const auto model = dimension_->model();
+        service_times_.resize(static_cast<std::size_t>(model->Size()), 0);
+        for (int64 index = 0; index < model->Size(); ++index) {
+            if (model->IsStart(index)) {
+                continue;
+            }
+
+            const auto node = index_manager_->IndexToNode(index);
+            if (node != RealProblemData::DEPOT) {
+                service_times_[index] = problem_data_.ServiceTime(node);
+            }
+        }
+
+        breaks_.reserve(break_intervals_.size());
+        candidate_breaks_.reserve(break_intervals_.size());
+    }
 
     void BreakConstraint::Post() {
         operations_research::RoutingModel *const model = dimension_->model();
@@ -29,8 +64,27 @@ namespace rows {
                                               {status_});
 
         solver()->AddConstraint(path_connected_const);
-        operations_research::Demon *const demon = solver()->MakeConstraintInitialPropagateCallback(this);
+
+        // the path is not known in advance, so the demon listens to all visits which may belong to the path,
+        // it returns immediately while the path is open
+        operations_research::Demon *const demon = solver()->MakeDelayedConstraintInitialPropagateCallback(this);
         status_->WhenBound(demon);
+        for (int64 index = 0; index < model->Size(); ++index) {
+            if (!model->IsStart(index)) {
+                dimension_->CumulVar(index)->WhenRange(demon);
+            }
+        }
+        dimension_->CumulVar(model->End(vehicle_))->WhenRange(demon);
+        for (operations_research::IntervalVar *const break_interval : break_intervals_) {
+            break_interval->WhenAnything(demon);
+        }
+
+        // order of breaks does not depend on the path, so it is posted once
+        for (std::size_t break_index = 1; break_index < break_intervals_.size(); ++break_index) {
+            solver()->AddConstraint(solver()->MakeIntervalVarRelation(break_intervals_[break_index],
+                                                                      operations_research::Solver::STARTS_AFTER_END,
+                                                                      break_intervals_[break_index - 1]));
+        }
     }
 
     void BreakConstraint::InitialPropagate() {
@@ -39,10 +93,151 @@ namespace rows {
         }
     }
 
-    void BreakConstraint::OnPathClosed() {
-        using boost::posix_time::time_duration;
-        using boost::posix_time::seconds;
+    bool BreakConstraint::Propagate(std::vector<Activity> &activities,
+                                    std::vector<Activity> &breaks,
+                                    std::vector<int64> &earliest_ready,
+                                    std::vector<int64> &latest_ready) {
+        static const auto UNREACHABLE = kint64max;
+        static const auto DEAD_END = kint64min;
+
+        // earliest_ready stores the earliest completion time of the first activity_count activities and
+        // the first break_count breaks, latest_ready stores the latest time from which the remaining activities
+        // and breaks can be completed; both are indexed by activity_count * row_size + break_count
+        const auto row_size = breaks.size() + 1;
+        const auto position = [row_size](std::size_t activity_count, std::size_t break_count) -> std::size_t {
+            return activity_count * row_size + break_count;
+        };
+        earliest_ready.assign((activities.size() + 1) * row_size, UNREACHABLE);
+        latest_ready.assign((activities.size() + 1) * row_size, DEAD_END);
+
+        const auto earliest_completion = [](int64 ready_time, const Activity &activity) -> int64 {
+            if (ready_time == UNREACHABLE) {
+                return UNREACHABLE;
+            }
+
+            const auto start_time = std::max(ready_time, activity.StartMin);
+            if (start_time > activity.StartMax) {
+                return UNREACHABLE;
+            }
+            return start_time + activity.Duration;
+        };
+
+        const auto latest_start = [](const Activity &activity, int64 next_ready_time) -> int64 {
+            if (next_ready_time == DEAD_END) {
+                return DEAD_END;
+            }
+
+            const auto start_time = next_ready_time == kint64max
+                                    ? activity.StartMax
+                                    : std::min(activity.StartMax, next_ready_time - activity.Duration);
+            if (start_time < activity.StartMin) {
+                return DEAD_END;
+            }
+            return start_time;
+        };
+
+        earliest_ready[0] = kint64min;
+        for (std::size_t activity_count = 0; activity_count <= activities.size(); ++activity_count) {
+            for (std::size_t break_count = 0; break_count <= breaks.size(); ++break_count) {
+                auto &ready_time = earliest_ready[position(activity_count, break_count)];
+
+                if (activity_count > 0) {
+                    const auto &activity = activities[activity_count - 1];
+                    const auto previous_ready_time = earliest_ready[position(activity_count - 1, break_count)];
+                    ready_time = std::min(ready_time, earliest_completion(previous_ready_time, activity));
+                    if (activity.Optional) {
+                        ready_time = std::min(ready_time, previous_ready_time);
+                    }
+                }
+
+                if (break_count > 0) {
+                    const auto &break_activity = breaks[break_count - 1];
+                    const auto previous_ready_time = earliest_ready[position(activity_count, break_count - 1)];
+                    ready_time = std::min(ready_time, earliest_completion(previous_ready_time, break_activity));
+                    if (break_activity.Optional) {
+                        ready_time = std::min(ready_time, previous_ready_time);
+                    }
+                }
+            }
+        }
+
+        if (earliest_ready.back() == UNREACHABLE) {
+            return false;
+        }
+
+        latest_ready.back() = kint64max;
+        for (auto activity_count = activities.size() + 1; activity_count-- > 0;) {
+            for (auto break_count = breaks.size() + 1; break_count-- > 0;) {
+                auto &ready_time = latest_ready[position(activity_count, break_count)];
+
+                if (activity_count < activities.size()) {
+                    const auto &activity = activities[activity_count];
+                    const auto next_ready_time = latest_ready[position(activity_count + 1, break_count)];
+                    ready_time = std::max(ready_time, latest_start(activity, next_ready_time));
+                    if (activity.Optional) {
+                        ready_time = std::max(ready_time, next_ready_time);
+                    }
+                }
 
+                if (break_count < breaks.size()) {
+                    const auto &break_activity = breaks[break_count];
+                    const auto next_ready_time = latest_ready[position(activity_count, break_count + 1)];
+                    ready_time = std::max(ready_time, latest_start(break_activity, next_ready_time));
+                    if (break_activity.Optional) {
+                        ready_time = std::max(ready_time, next_ready_time);
+                    }
+                }
+            }
+        }
+
+        // from a given state the activity can start at any time between its earliest start after the ready time
+        // and its latest start before the next ready time, the new window is the hull of these ranges over all states
+        const auto extend_window = [&latest_start](const Activity &activity,
+                                                   int64 ready_time,
+                                                   int64 next_ready_time,
+                                                   std::pair<int64, int64> &window) -> void {
+            const auto last_start = latest_start(activity, next_ready_time);
+            if (ready_time == UNREACHABLE || last_start == DEAD_END) {
+                return;
+            }
+
+            const auto first_start = std::max(ready_time, activity.StartMin);
+            if (first_start <= last_start) {
+                window.first = std::min(window.first, first_start);
+                window.second = std::max(window.second, last_start);
+            }
+        };
+
+        for (std::size_t activity_index = 0; activity_index < activities.size(); ++activity_index) {
+            auto &activity = activities[activity_index];
+            std::pair<int64, int64> window{kint64max, kint64min};
+            for (std::size_t break_count = 0; break_count <= breaks.size(); ++break_count) {
+                extend_window(activity,
+                              earliest_ready[position(activity_index, break_count)],
+                              latest_ready[position(activity_index + 1, break_count)],
+                              window);
+            }
+            activity.StartMin = window.first;
+            activity.StartMax = window.second;
+        }
+
+        for (std::size_t break_index = 0; break_index < breaks.size(); ++break_index) {
+            auto &break_activity = breaks[break_index];
+            std::pair<int64, int64> window{kint64max, kint64min};
+            for (std::size_t activity_count = 0; activity_count <= activities.size(); ++activity_count) {
+                extend_window(break_activity,
+                              earliest_ready[position(activity_count, break_index)],
+                              latest_ready[position(activity_count, break_index + 1)],
+                              window);
+            }
+            break_activity.StartMin = window.first;
+            break_activity.StartMax = window.second;
+        }
+
+        return true;
+    }
+
+    void BreakConstraint::OnPathClosed() {
         if (status_->Max() == 0) {
             for (operations_research::IntervalVar *const break_interval : break_intervals_) {
                 break_interval->SetPerformed(false);
@@ -50,13 +245,9 @@ namespace rows {
             return;
         }
 
-        const auto initial_number_of_failures = solver()->failures();
-
-        std::vector<operations_research::IntervalVar *> all_intervals;
-        operations_research::IntervalVar *last_travel_interval = nullptr;
-        operations_research::IntervalVar *last_last_visit_interval = nullptr;
-        operations_research::IntervalVar *last_visit_interval = nullptr;
-
+        // a visit is followed by a journey to the next node unless both nodes share the same location
+        activities_.clear();
+        activity_cumuls_.clear();
         operations_research::RoutingModel *const model = dimension_->model();
         int64 current_index = model->Start(vehicle_);
         while (!model->IsEnd(current_index)) {
@@ -64,96 +255,58 @@ namespace rows {
             const auto next_index = model->NextVar(current_index)->Value();
             const auto next_node = index_manager_->IndexToNode(next_index);
 
-            // create visit interval
             if (RealProblemData::DEPOT != current_node) {
-                const auto visit_duration = problem_data_.ServiceTime(current_node);
+                const auto visit_duration = service_times_[current_index];
                 DCHECK_GT(visit_duration, 0);
 
-                operations_research::IntervalVar *const visit_interval = solver()->MakeFixedDurationIntervalVar(
-                        dimension_->CumulVar(current_index),
-                        visit_duration,
-                        (boost::format("visit %1%") % current_index).str());
-                all_intervals.push_back(visit_interval);
-
-                if (last_travel_interval) {
-                    solver()->AddConstraint(solver()->MakeIntervalVarRelation(visit_interval,
-                                                                              operations_research::Solver::STARTS_AFTER_END,
-                                                                              last_travel_interval));
-                }
-
-                last_last_visit_interval = last_visit_interval;
-                last_visit_interval = visit_interval;
-            } else {
-                last_last_visit_interval = last_visit_interval;
-                last_visit_interval = nullptr;
+                operations_research::IntVar *const cumul = dimension_->CumulVar(current_index);
+                activities_.emplace_back(cumul->Min(), cumul->Max(), visit_duration, false);
+                activity_cumuls_.push_back(cumul);
             }
 
-            // create travel interval
             const auto travel_duration = problem_data_.Distance(current_node, next_node);
             if (travel_duration > 0) {
-                int64 min_travel_start = 0;
-                if (last_visit_interval != nullptr) {
-                    min_travel_start = last_visit_interval->EndMin();
-                }
-
                 const auto max_travel_start = std::min(dimension_->CumulVar(next_index)->Max() - travel_duration,
                                                        RealProblemData::SECONDS_IN_DIMENSION);
-                if (min_travel_start > max_travel_start) {
-                    solver()->Fail();
-                }
+                activities_.emplace_back(0, max_travel_start, travel_duration, false);
+                activity_cumuls_.push_back(nullptr);
+            }
 
-                operations_research::IntervalVar *const travel_interval = solver()->MakeFixedDurationIntervalVar(
-                        min_travel_start,
-                        max_travel_start,
-                        travel_duration,
-                        false,
-                        (boost::format("travel %1%-%2%") % current_index % next_index).str());
-                all_intervals.push_back(travel_interval);
-
-                if (last_visit_interval) {
-                    solver()->AddConstraint(solver()->MakeIntervalVarRelation(travel_interval,
-                                                                              operations_research::Solver::STARTS_AFTER_END,
-                                                                              last_visit_interval));
-                    solver()->AddConstraint(
-                            solver()->MakeLessOrEqual(last_visit_interval->EndExpr(), travel_interval->StartExpr()));
-                    CHECK_GE(travel_interval->StartMin(), last_visit_interval->EndMin());
-                }
+            current_index = next_index;
+        }
 
-                last_travel_interval = travel_interval;
-            } else {
-                if (last_last_visit_interval && last_visit_interval) {
-                    solver()->AddConstraint(solver()->MakeIntervalVarRelation(last_visit_interval,
-                                                                              operations_research::Solver::STARTS_AFTER_END,
-                                                                              last_last_visit_interval));
-                }
-                last_travel_interval = nullptr;
+        breaks_.clear();
+        candidate_breaks_.clear();
+        for (operations_research::IntervalVar *const break_interval : break_intervals_) {
+            if (!break_interval->MayBePerformed()) {
+                continue;
             }
 
-            current_index = next_index;
+            breaks_.emplace_back(break_interval->StartMin(),
+                                 break_interval->StartMax(),
+                                 break_interval->DurationMin(),
+                                 !break_interval->MustBePerformed());
+            candidate_breaks_.push_back(break_interval);
         }
 
-        if (break_intervals_.size() > 1) {
-            const auto break_interval_end = std::end(break_intervals_);
-            auto last_break_it = std::begin(break_intervals_);
-            auto break_interval_it = std::next(last_break_it);
-            while (break_interval_it != break_interval_end) {
-                solver()->AddConstraint(solver()->MakeIntervalVarRelation(*break_interval_it,
-                                                                          operations_research::Solver::STARTS_AFTER_END,
-                                                                          *last_break_it));
+        if (!Propagate(activities_, breaks_, earliest_ready_, latest_ready_)) {
+            solver()->Fail();
+        }
 
-                last_break_it = break_interval_it;
-                break_interval_it = std::next(break_interval_it);
+        for (std::size_t activity_index = 0; activity_index < activities_.size(); ++activity_index) {
+            if (activity_cumuls_[activity_index] != nullptr) {
+                activity_cumuls_[activity_index]->SetRange(activities_[activity_index].StartMin,
+                                                           activities_[activity_index].StartMax);
             }
         }
 
-        const auto current_number_of_failures = solver()->failures();
-        if (current_number_of_failures > initial_number_of_failures) {
-            LOG(WARNING) << "Registered a failure and have no way to jump...";
-        } else {
-            std::copy(std::begin(break_intervals_), std::end(break_intervals_), std::back_inserter(all_intervals));
-            solver()->AddConstraint(solver()->MakeDisjunctiveConstraint(all_intervals,
-                                                                        (boost::format("Vehicle breaks %1%")
-                                                                         % vehicle_).str()));
+        for (std::size_t break_index = 0; break_index < breaks_.size(); ++break_index) {
+            const auto &break_activity = breaks_[break_index];
+            if (break_activity.StartMin > break_activity.StartMax) {
+                candidate_breaks_[break_index]->SetPerformed(false);
+            } else {
+                candidate_breaks_[break_index]->SetStartRange(break_activity.StartMin, break_activity.StartMax);
+            }
         }
     }
 }
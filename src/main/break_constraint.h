@@ -11,13 +11,28 @@
 
 namespace rows {
 
+    // breaks of a vehicle must fit between visits and journeys of its path once the path is closed
+    //
+    // the constraint does not create solver objects during the search: activities of the path are collected into
+    // reusable buffers and the start times of visits and breaks are narrowed by a dynamic program over the path
     class BreakConstraint : public operations_research::Constraint {
     public:
+        struct Activity {
+            Activity();
+
+            Activity(int64 start_min, int64 start_max, int64 duration, bool optional);
+
+            int64 StartMin;
+            int64 StartMax;
+            int64 Duration;
+            bool Optional;
+        };
+
         BreakConstraint(const operations_research::RoutingDimension *dimension,
                         const operations_research::RoutingIndexManager *index_manager,
                         int vehicle,
                         std::vector<operations_research::IntervalVar *> break_intervals,
-                        RealProblemData &problem_data);
+                        const ProblemData &problem_data);
 
         ~BreakConstraint() override = default;
 
@@ -25,6 +40,16 @@ namespace rows {
 
         void InitialPropagate() override;
 
+        // activities are performed in the given order, breaks are taken in the given order in gaps between activities
+        // and every activity may wait until its earliest start; returns false if no such schedule exists, otherwise
+        // narrows the start window of each activity and each break to the start times used by feasible schedules,
+        // the window of an optional activity which is not performed in any feasible schedule becomes empty;
+        // the buffers are used as a working memory to avoid allocations
+        static bool Propagate(std::vector<Activity> &activities,
+                              std::vector<Activity> &breaks,
+                              std::vector<int64> &earliest_ready,
+                              std::vector<int64> &latest_ready);
+
     private:
         void OnPathClosed();
 
@@ -33,7 +58,18 @@ namespace rows {
         const int vehicle_;
         std::vector<operations_research::IntervalVar *> break_intervals_;
         operations_research::IntVar *const status_;
-        RealProblemData &problem_data_;
+        const ProblemData &problem_data_;
+
+        // service times by index are read once, so the search does not call the virtual interface of the problem data
+        std::vector<int64> service_times_;
+
+        // working memory reused by every propagation, cumul variables of visits are null for journeys
+        std::vector<Activity> activities_;
+        std::vector<operations_research::IntVar *> activity_cumuls_;
+        std::vector<Activity> breaks_;
+        std::vector<operations_research::IntervalVar *> candidate_breaks_;
+        std::vector<int64> earliest_ready_;
+        std::vector<int64> latest_ready_;
     };
 }
 
@@ -0,0 +1,67 @@
+#include "candidate_neighbour_filter.h"
+
+#include <algorithm>
+
+#include <glog/logging.h>
+
+rows::CandidateNeighbourFilter::CandidateNeighbourFilter(const operations_research::RoutingModel &model,
+                                                         std::vector<std::vector<int64> > candidates)
+        : IntVarLocalSearchFilter(model.Nexts()),
+          model_{model},
+          candidates_{std::move(candidates)} {
+    CHECK_EQ(candidates_.size(), static_cast<std::size_t>(model_.Size()));
+}
+
+bool rows::CandidateNeighbourFilter::Accept(const operations_research::Assignment *delta,
+                                            const operations_research::Assignment *deltadelta) {
+    const auto &container = delta->IntVarContainer();
+    const auto delta_size = container.Size();
+
+    // a node which gets a new predecessor is moved by the operator if its successor changes too, otherwise the arc
+    // reconnects the route the moved nodes were taken from
+    moved_nodes_.clear();
+    for (auto element_index = 0; element_index < delta_size; ++element_index) {
+        const auto &element = container.Element(element_index);
+        int64 index = -1;
+        if (element.Bound() && FindIndex(element.Var(), &index) && element.Value() != Value(index)) {
+            moved_nodes_.push_back(index);
+        }
+    }
+
+    for (auto element_index = 0; element_index < delta_size; ++element_index) {
+        const auto &element = container.Element(element_index);
+        if (!element.Bound()) {
+            continue;
+        }
+
+        int64 index = -1;
+        if (!FindIndex(element.Var(), &index)) {
+            continue;
+        }
+
+        const auto next = element.Value();
+        if (next == Value(index)
+            || std::find(std::cbegin(moved_nodes_), std::cend(moved_nodes_), next) == std::cend(moved_nodes_)
+            || IsCandidate(index, next)) {
+            continue;
+        }
+
+        return false;
+    }
+
+    return true;
+}
+
+std::string rows::CandidateNeighbourFilter::DebugString() const {
+    return "CandidateNeighbourFilter";
+}
+
+bool rows::CandidateNeighbourFilter::IsCandidate(int64 index, int64 next) const {
+    // inactive nodes point to themselves, first visits of routes are not restricted
+    if (next == index || model_.IsEnd(next) || model_.IsStart(index)) {
+        return true;
+    }
+
+    const auto &candidates = candidates_[index];
+    return std::binary_search(std::cbegin(candidates), std::cend(candidates), next);
+}
@@ -0,0 +1,36 @@
+#ifndef ROWS_CANDIDATE_NEIGHBOUR_FILTER_H
+#define ROWS_CANDIDATE_NEIGHBOUR_FILTER_H
+
+#include <vector>
+
+#include <ortools/constraint_solver/routing.h>
+#include <ortools/constraint_solver/constraint_solveri.h>
+
+namespace rows {
+
+    // rejects moves of local search operators which insert a moved node after another node unless the moved node
+    // is on the candidate list of its new predecessor, so the operators focus on nearby visits; arcs which reconnect
+    // the route a node was taken from are not restricted; the search is allowed to reach every solution that was
+    // reachable from the first solution, because the filter does not modify domains of variables
+    class CandidateNeighbourFilter : public operations_research::IntVarLocalSearchFilter {
+    public:
+        // candidates are sorted lists of successor indices for each node
+        CandidateNeighbourFilter(const operations_research::RoutingModel &model, std::vector<std::vector<int64> > candidates);
+
+        bool Accept(const operations_research::Assignment *delta, const operations_research::Assignment *deltadelta) override;
+
+        std::string DebugString() const override;
+
+    private:
+        bool IsCandidate(int64 index, int64 next) const;
+
+        const operations_research::RoutingModel &model_;
+        std::vector<std::vector<int64> > candidates_;
+
+        // buffer reused by Accept
+        std::vector<int64> moved_nodes_;
+    };
+}
+
+
+#endif //ROWS_CANDIDATE_NEIGHBOUR_FILTER_H
@@ -0,0 +1,421 @@
+#include "construction_heuristic.h"
+
+#include <algorithm>
+#include <tuple>
+#include <unordered_map>
+
+#include <glog/logging.h>
+
+namespace rows {
+
+    const int64 ConstructionHeuristic::NEW_CARER_COST = 15 * 60;
+
+    const std::size_t ConstructionHeuristic::MAX_SIBLING_PAIRS = 64;
+
+    ConstructionHeuristic::ConstructionHeuristic(const SolverWrapper &solver)
+            : solver_{solver},
+              nodes_(static_cast<std::size_t>(solver.nodes())),
+              vehicles_(static_cast<std::size_t>(solver.vehicles())),
+              fixed_starts_(static_cast<std::size_t>(solver.nodes()), -1),
+              inserted_visits_{0},
+              declined_visits_{0},
+              travel_time_{0} {
+        const auto horizon = (solver_.EndHorizon() - solver_.StartHorizon()).total_seconds();
+        nodes_[0] = Node{0, horizon, 0, 0, -1};
+
+        std::unordered_map<rows::ServiceUser, std::size_t> user_index;
+        for (operations_research::RoutingNodeIndex node{1}; node < solver_.nodes(); ++node) {
+            const auto &visit = solver_.NodeToVisit(node);
+
+            // the same time windows as in the routing model
+            const auto visit_start_begin = visit.time_windows().begin() - solver_.StartHorizon();
+            const auto visit_start_end = visit.time_windows().end() - solver_.StartHorizon();
+            auto &local_node = nodes_[node.value()];
+            if (solver_.HasTimeWindows()) {
+                local_node.Begin = solver_.GetBeginVisitWindow(visit_start_begin);
+                local_node.End = solver_.GetEndVisitWindow(visit_start_end);
+            } else {
+                local_node.Begin = visit_start_begin.total_seconds();
+                local_node.End = visit_start_end.total_seconds();
+            }
+            local_node.Service = solver_.problem_data().ServiceTime(node);
+
+            const auto user_it = user_index.emplace(visit.service_user(), user_index.size()).first;
+            local_node.User = user_it->second;
+
+            local_node.Sibling = -1;
+            for (const auto sibling_node : solver_.problem_data().GetNodes(node)) {
+                if (sibling_node != node) {
+                    local_node.Sibling = sibling_node.value();
+                }
+            }
+        }
+
+        user_vehicles_.resize(user_index.size());
+        if (solver_.neighbourhood_options().ContinuityOfCare) {
+            user_max_vehicles_.assign(user_index.size(), static_cast<std::size_t>(SolverWrapper::MAX_CARERS_SINGLE_VISITS));
+            for (std::size_t node = 1; node < nodes_.size(); ++node) {
+                if (nodes_[node].Sibling != -1) {
+                    user_max_vehicles_[nodes_[node].User] = static_cast<std::size_t>(SolverWrapper::MAX_CARERS_MULTIPLE_VISITS);
+                }
+            }
+        } else {
+            user_max_vehicles_.assign(user_index.size(), static_cast<std::size_t>(solver_.vehicles()));
+        }
+
+        const auto schedule_day = solver_.GetScheduleDate();
+        for (auto vehicle = 0; vehicle < solver_.vehicles(); ++vehicle) {
+            auto &local_vehicle = vehicles_[vehicle];
+            std::tie(local_vehicle.Begin, local_vehicle.End) = solver_.GetWorkingHours(vehicle);
+
+            const auto diary_opt = solver_.problem().diary(solver_.Carer(vehicle), schedule_day);
+            if (!diary_opt.is_initialized()) {
+                continue;
+            }
+
+            // breaks before and after the workday are fixed by the working hours of the vehicle,
+            // other breaks can move within their windows like the break intervals of the routing model
+            const auto breaks = solver_.GetEffectiveBreaks(diary_opt.get());
+            for (std::size_t break_index = 0; break_index < breaks.size(); ++break_index) {
+                if (solver_.out_office_hours_breaks_enabled() && (break_index == 0 || break_index + 1 == breaks.size())) {
+                    continue;
+                }
+
+                const auto &break_period = breaks[break_index];
+                const auto duration = break_period.duration().total_seconds();
+                if (duration <= 0) {
+                    continue;
+                }
+
+                const auto start_time = break_period.begin() - solver_.StartHorizon();
+                local_vehicle.Breaks.push_back(Break{solver_.GetBeginBreakWindow(start_time),
+                                                     solver_.GetEndBreakWindow(start_time),
+                                                     duration});
+            }
+
+            std::sort(std::begin(local_vehicle.Breaks), std::end(local_vehicle.Breaks),
+                      [](const Break &left, const Break &right) -> bool { return left.StartMin < right.StartMin; });
+        }
+    }
+
+    std::vector<std::vector<int64> > ConstructionHeuristic::Solve() {
+        for (auto &vehicle : vehicles_) {
+            vehicle.Route.clear();
+        }
+        std::fill(std::begin(fixed_starts_), std::end(fixed_starts_), -1);
+        for (auto &vehicles : user_vehicles_) {
+            vehicles.clear();
+        }
+        inserted_visits_ = 0;
+        declined_visits_ = 0;
+
+        // visits of two carers are represented by the node with the lower index of the routing model
+        const auto &index_manager = solver_.index_manager();
+        const auto node_index = [&index_manager](int node) -> int64 {
+            return index_manager.NodeToIndex(operations_research::RoutingNodeIndex{node});
+        };
+
+        std::vector<int> visits;
+        for (auto node = 1; node < static_cast<int>(nodes_.size()); ++node) {
+            const auto sibling = nodes_[node].Sibling;
+            if (sibling == -1 || node_index(node) < node_index(sibling)) {
+                visits.push_back(node);
+            }
+        }
+
+        // the tightest windows go first, visits of two carers are harder to insert, so they win ties
+        std::sort(std::begin(visits), std::end(visits), [this](int left, int right) -> bool {
+            const auto &left_node = nodes_[left];
+            const auto &right_node = nodes_[right];
+            return std::make_tuple(left_node.End - left_node.Begin, left_node.Sibling == -1, left_node.Begin, left)
+                   < std::make_tuple(right_node.End - right_node.Begin, right_node.Sibling == -1, right_node.Begin, right);
+        });
+
+        for (const auto node : visits) {
+            const auto sibling = nodes_[node].Sibling;
+            const auto inserted = sibling == -1 ? InsertSingle(node) : InsertSiblings(node, sibling);
+            if (inserted) {
+                ++inserted_visits_;
+            } else {
+                ++declined_visits_;
+            }
+        }
+
+        travel_time_ = 0;
+        std::vector<std::vector<int64> > routes(vehicles_.size());
+        for (std::size_t vehicle = 0; vehicle < vehicles_.size(); ++vehicle) {
+            auto previous_node = operations_research::RoutingNodeIndex{0};
+            for (const auto node : vehicles_[vehicle].Route) {
+                const operations_research::RoutingNodeIndex current_node{node};
+                travel_time_ += solver_.Distance(previous_node, current_node);
+                routes[vehicle].push_back(node_index(node));
+                previous_node = current_node;
+            }
+        }
+
+        return routes;
+    }
+
+    std::size_t ConstructionHeuristic::inserted_visits() const {
+        return inserted_visits_;
+    }
+
+    std::size_t ConstructionHeuristic::declined_visits() const {
+        return declined_visits_;
+    }
+
+    int64 ConstructionHeuristic::travel_time() const {
+        return travel_time_;
+    }
+
+    bool ConstructionHeuristic::IsAllowed(int vehicle, int node) const {
+        const auto &local_vehicle = vehicles_[vehicle];
+        if (local_vehicle.Begin >= local_vehicle.End) {
+            return false;
+        }
+
+        if (!solver_.HasSkills(vehicle, operations_research::RoutingNodeIndex{node})) {
+            return false;
+        }
+
+        const auto &user_vehicles = user_vehicles_[nodes_[node].User];
+        return user_vehicles.size() < user_max_vehicles_[nodes_[node].User]
+               || std::find(std::cbegin(user_vehicles), std::cend(user_vehicles), vehicle) != std::cend(user_vehicles);
+    }
+
+    int64 ConstructionHeuristic::GetEarliestStart(int node, int64 arrival) const {
+        const auto &local_node = nodes_[node];
+        const auto fixed_start = fixed_starts_[node];
+        const auto begin = fixed_start >= 0 ? fixed_start : local_node.Begin;
+        const auto end = fixed_start >= 0 ? fixed_start : local_node.End;
+
+        const auto start = std::max(arrival, begin);
+        if (start > end) {
+            return -1;
+        }
+        return start;
+    }
+
+    bool ConstructionHeuristic::Schedule(const VehicleRoute &vehicle,
+                                         int node,
+                                         std::size_t position,
+                                         std::vector<int64> &starts) const {
+        const auto route_size = vehicle.Route.size() + (node != -1 ? 1 : 0);
+        starts.resize(route_size);
+
+        auto time = vehicle.Begin;
+        auto previous_node = 0;
+        auto next_break = vehicle.Breaks.cbegin();
+        for (std::size_t step = 0; step < route_size; ++step) {
+            auto current_node = 0;
+            if (node == -1 || step < position) {
+                current_node = vehicle.Route[step];
+            } else if (step == position) {
+                current_node = node;
+            } else {
+                current_node = vehicle.Route[step - 1];
+            }
+
+            const auto travel = solver_.Distance(operations_research::RoutingNodeIndex{previous_node},
+                                                 operations_research::RoutingNodeIndex{current_node});
+            const auto service = nodes_[current_node].Service;
+            auto start = GetEarliestStart(current_node, time + travel);
+            if (start < 0) {
+                return false;
+            }
+
+            // a break starts as soon as possible if it cannot be postponed after the visit
+            // or if it does not delay the visit; before the first visit the carer is not working yet
+            while (next_break != vehicle.Breaks.cend()) {
+                const auto break_start = previous_node == 0 ? next_break->StartMin : std::max(time, next_break->StartMin);
+                const auto break_end = std::max(time, break_start + next_break->Duration);
+
+                if (start + service > next_break->StartMax) {
+                    if (break_start > next_break->StartMax) {
+                        return false;
+                    }
+
+                    time = break_end;
+                    ++next_break;
+                    start = GetEarliestStart(current_node, time + travel);
+                    if (start < 0) {
+                        return false;
+                    }
+                } else if (break_start <= next_break->StartMax && GetEarliestStart(current_node, break_end + travel) == start) {
+                    time = break_end;
+                    ++next_break;
+                } else {
+                    break;
+                }
+            }
+
+            starts[step] = start;
+            time = start + service;
+            previous_node = current_node;
+        }
+
+        if (time > vehicle.End) {
+            return false;
+        }
+
+        // remaining breaks are taken after the end of the route
+        for (; next_break != vehicle.Breaks.cend(); ++next_break) {
+            const auto break_start = previous_node == 0 ? next_break->StartMin : std::max(time, next_break->StartMin);
+            if (break_start > next_break->StartMax) {
+                return false;
+            }
+            time = std::max(time, break_start + next_break->Duration);
+        }
+
+        return true;
+    }
+
+    ConstructionHeuristic::Insertion ConstructionHeuristic::FindInsertion(int vehicle, int node) {
+        Insertion best_insertion{vehicle, 0, -1, -1};
+        if (!IsAllowed(vehicle, node)) {
+            return best_insertion;
+        }
+
+        const auto &local_vehicle = vehicles_[vehicle];
+        const auto &route = local_vehicle.Route;
+        // routes are feasible by construction
+        CHECK(Schedule(local_vehicle, -1, 0, route_starts_)) << "Route of vehicle " << vehicle << " is not feasible";
+
+        const auto &user_vehicles = user_vehicles_[nodes_[node].User];
+        const auto is_new_carer = std::find(std::cbegin(user_vehicles), std::cend(user_vehicles), vehicle) == std::cend(user_vehicles);
+        const auto latest_start = fixed_starts_[node] >= 0 ? fixed_starts_[node] : nodes_[node].End;
+
+        const operations_research::RoutingNodeIndex current_node{node};
+        for (std::size_t position = 0; position <= route.size(); ++position) {
+            const operations_research::RoutingNodeIndex previous_node{position > 0 ? route[position - 1] : 0};
+            const operations_research::RoutingNodeIndex next_node{position < route.size() ? route[position] : 0};
+
+            // the node cannot start in time after the previous visit, so it cannot start in time after any later visit
+            // either: start times in the route only grow and, if travel times satisfy the triangle inequality, a detour
+            // through later visits is not shorter than travelling directly; travel times of road networks may violate
+            // the inequality, then a feasible later position may be skipped, which makes the insertion worse,
+            // but never infeasible
+            if (position > 0 && route_starts_[position - 1] + nodes_[previous_node.value()].Service
+                                + solver_.Distance(previous_node, current_node) > latest_start) {
+                break;
+            }
+
+            if (!Schedule(local_vehicle, node, position, starts_)) {
+                continue;
+            }
+
+            auto cost = solver_.Distance(previous_node, current_node)
+                        + solver_.Distance(current_node, next_node)
+                        - solver_.Distance(previous_node, next_node);
+            if (is_new_carer) {
+                cost += NEW_CARER_COST;
+            }
+
+            if (best_insertion.Cost < 0 || cost < best_insertion.Cost) {
+                best_insertion.Position = position;
+                best_insertion.Start = starts_[position];
+                best_insertion.Cost = cost;
+            }
+        }
+
+        return best_insertion;
+    }
+
+    void ConstructionHeuristic::Insert(const Insertion &insertion, int node) {
+        DCHECK_GE(insertion.Cost, 0);
+
+        auto &route = vehicles_[insertion.Vehicle].Route;
+        route.insert(std::begin(route) + insertion.Position, node);
+
+        auto &user_vehicles = user_vehicles_[nodes_[node].User];
+        if (std::find(std::cbegin(user_vehicles), std::cend(user_vehicles), insertion.Vehicle) == std::cend(user_vehicles)) {
+            user_vehicles.push_back(insertion.Vehicle);
+        }
+    }
+
+    bool ConstructionHeuristic::InsertSingle(int node) {
+        Insertion best_insertion{-1, 0, -1, -1};
+        for (auto vehicle = 0; vehicle < static_cast<int>(vehicles_.size()); ++vehicle) {
+            const auto insertion = FindInsertion(vehicle, node);
+            if (insertion.Cost >= 0 && (best_insertion.Cost < 0 || insertion.Cost < best_insertion.Cost)) {
+                best_insertion = insertion;
+            }
+        }
+
+        if (best_insertion.Cost < 0) {
+            return false;
+        }
+
+        Insert(best_insertion, node);
+        return true;
+    }
+
+    bool ConstructionHeuristic::InsertSiblings(int first_node, int second_node) {
+        std::vector<Insertion> candidates;
+        for (auto vehicle = 0; vehicle < static_cast<int>(vehicles_.size()); ++vehicle) {
+            const auto insertion = FindInsertion(vehicle, first_node);
+            if (insertion.Cost >= 0) {
+                candidates.push_back(insertion);
+            }
+        }
+
+        if (candidates.size() < 2) {
+            return false;
+        }
+
+        std::vector<std::pair<std::size_t, std::size_t> > pairs;
+        for (std::size_t first_candidate = 0; first_candidate < candidates.size(); ++first_candidate) {
+            for (std::size_t second_candidate = first_candidate + 1; second_candidate < candidates.size(); ++second_candidate) {
+                pairs.emplace_back(first_candidate, second_candidate);
+            }
+        }
+
+        const auto pairs_to_try = std::min(MAX_SIBLING_PAIRS, pairs.size());
+        const auto pair_cost = [&candidates](const std::pair<std::size_t, std::size_t> &pair) -> int64 {
+            return candidates[pair.first].Cost + candidates[pair.second].Cost;
+        };
+        std::partial_sort(std::begin(pairs), std::begin(pairs) + pairs_to_try, std::end(pairs),
+                          [&pair_cost](const std::pair<std::size_t, std::size_t> &left,
+                                       const std::pair<std::size_t, std::size_t> &right) -> bool {
+                              return pair_cost(left) < pair_cost(right);
+                          });
+
+        const auto &user_vehicles = user_vehicles_[nodes_[first_node].User];
+        const auto max_user_vehicles = user_max_vehicles_[nodes_[first_node].User];
+        const auto is_new_carer = [&user_vehicles](int vehicle) -> bool {
+            return std::find(std::cbegin(user_vehicles), std::cend(user_vehicles), vehicle) == std::cend(user_vehicles);
+        };
+
+        for (std::size_t pair_index = 0; pair_index < pairs_to_try; ++pair_index) {
+            const auto &first_candidate = candidates[pairs[pair_index].first];
+            const auto &second_candidate = candidates[pairs[pair_index].second];
+
+            // the routing model requires the vehicle of the node with the lower index to be lower too
+            const auto first_vehicle = std::min(first_candidate.Vehicle, second_candidate.Vehicle);
+            const auto second_vehicle = std::max(first_candidate.Vehicle, second_candidate.Vehicle);
+            if (user_vehicles.size() + is_new_carer(first_vehicle) + is_new_carer(second_vehicle) > max_user_vehicles) {
+                continue;
+            }
+
+            // both carers start at the same time, the later of their earliest starts is tried
+            const auto start = std::max(first_candidate.Start, second_candidate.Start);
+            fixed_starts_[first_node] = start;
+            fixed_starts_[second_node] = start;
+
+            const auto first_insertion = FindInsertion(first_vehicle, first_node);
+            if (first_insertion.Cost >= 0) {
+                const auto second_insertion = FindInsertion(second_vehicle, second_node);
+                if (second_insertion.Cost >= 0) {
+                    Insert(first_insertion, first_node);
+                    Insert(second_insertion, second_node);
+                    return true;
+                }
+            }
+
+            fixed_starts_[first_node] = -1;
+            fixed_starts_[second_node] = -1;
+        }
+
+        return false;
+    }
+}
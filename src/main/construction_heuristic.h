@@ -0,0 +1,109 @@
+#ifndef ROWS_CONSTRUCTION_HEURISTIC_H
+#define ROWS_CONSTRUCTION_HEURISTIC_H
+
+#include <cstdint>
+#include <vector>
+
+#include <ortools/constraint_solver/routing.h>
+
+#include "solver_wrapper.h"
+
+namespace rows {
+
+    // builds initial routes without the constraint solver, visits are inserted in order of the tightness of their
+    // time windows at the cheapest position which keeps the schedule of the carer feasible; visits of two carers
+    // are inserted into two routes at once with a common start time
+    //
+    // the schedule of a route is computed conservatively, breaks are taken at the location of the previous visit
+    // before travelling to the next one, so routes accepted by the heuristic are feasible in the routing model
+    class ConstructionHeuristic {
+    public:
+        explicit ConstructionHeuristic(const SolverWrapper &solver);
+
+        // routes of vehicles as indices of the routing index manager, visits which could not be inserted are left out
+        std::vector<std::vector<int64> > Solve();
+
+        std::size_t inserted_visits() const;
+
+        std::size_t declined_visits() const;
+
+        // total travel time of the routes in seconds
+        int64 travel_time() const;
+
+    private:
+        // inserting a visit into a route of a carer who does not visit the service user yet costs as much as
+        // the given travel time in seconds, so the heuristic prefers carers who are already known to the user
+        static const int64 NEW_CARER_COST;
+
+        // maximum number of pairs of vehicles tried for a visit of two carers
+        static const std::size_t MAX_SIBLING_PAIRS;
+
+        struct Node {
+            int64 Begin;
+            int64 End;
+            int64 Service;
+            std::size_t User;
+            int Sibling;
+        };
+
+        struct Break {
+            int64 StartMin;
+            int64 StartMax;
+            int64 Duration;
+        };
+
+        struct VehicleRoute {
+            int64 Begin;
+            int64 End;
+            std::vector<Break> Breaks;
+            std::vector<int> Route;
+        };
+
+        struct Insertion {
+            int Vehicle;
+            std::size_t Position;
+            int64 Start;
+            int64 Cost;
+        };
+
+        bool IsAllowed(int vehicle, int node) const;
+
+        int64 GetEarliestStart(int node, int64 arrival) const;
+
+        // computes the earliest start time of every visit in the route with the node inserted at the position,
+        // the route is not changed; returns false if the route is not feasible
+        bool Schedule(const VehicleRoute &vehicle, int node, std::size_t position, std::vector<int64> &starts) const;
+
+        // the cheapest feasible insertion of the node into the route of the vehicle, the cost is negative if none
+        Insertion FindInsertion(int vehicle, int node);
+
+        void Insert(const Insertion &insertion, int node);
+
+        bool InsertSingle(int node);
+
+        bool InsertSiblings(int first_node, int second_node);
+
+        const SolverWrapper &solver_;
+
+        std::vector<Node> nodes_;
+        std::vector<VehicleRoute> vehicles_;
+
+        // start times of visits of two carers agreed when they were inserted, negative if the visit is not fixed
+        std::vector<int64> fixed_starts_;
+
+        // carers visiting each service user and the maximum number of carers allowed by the continuity of care
+        std::vector<std::vector<int> > user_vehicles_;
+        std::vector<std::size_t> user_max_vehicles_;
+
+        std::size_t inserted_visits_;
+        std::size_t declined_visits_;
+        int64 travel_time_;
+
+        // buffers reused by insertions
+        std::vector<int64> starts_;
+        std::vector<int64> route_starts_;
+    };
+}
+
+
+#endif //ROWS_CONSTRUCTION_HEURISTIC_H
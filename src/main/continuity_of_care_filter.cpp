@@ -0,0 +1,114 @@
+#include "continuity_of_care_filter.h"
+
+#include <glog/logging.h>
+
+#include "perf_counters.h"
+
+rows::ContinuityOfCareFilter::ContinuityOfCareFilter(const operations_research::RoutingModel &model,
+                                                     std::vector<std::vector<int64> > user_indices,
+                                                     std::vector<int64> max_carers)
+        : RouteChangeFilter(model),
+          user_indices_{std::move(user_indices)},
+          max_carers_{std::move(max_carers)},
+          user_by_index_(static_cast<std::size_t>(model.Size()), -1),
+          visits_(user_indices_.size() * model.vehicles(), 0),
+          carers_(user_indices_.size(), 0),
+          cell_stamps_(user_indices_.size() * model.vehicles(), 0),
+          cell_deltas_(user_indices_.size() * model.vehicles(), 0),
+          changed_cells_{},
+          user_stamps_(user_indices_.size(), 0),
+          new_carers_(user_indices_.size(), 0),
+          changed_users_{} {
+    CHECK_EQ(user_indices_.size(), max_carers_.size());
+
+    for (auto user = 0; user < static_cast<int>(user_indices_.size()); ++user) {
+        for (const auto index : user_indices_[user]) {
+            user_by_index_[index] = user;
+        }
+    }
+}
+
+std::string rows::ContinuityOfCareFilter::DebugString() const {
+    return "ContinuityOfCareFilter";
+}
+
+void rows::ContinuityOfCareFilter::OnSynchronizeRoutes() {
+    std::fill(std::begin(visits_), std::end(visits_), 0);
+    std::fill(std::begin(carers_), std::end(carers_), 0);
+
+    for (auto user = 0; user < static_cast<int>(user_indices_.size()); ++user) {
+        for (const auto index : user_indices_[user]) {
+            const auto vehicle = Vehicle(index);
+            if (vehicle >= 0 && visits_[Cell(user, vehicle)]++ == 0) {
+                ++carers_[user];
+            }
+        }
+    }
+}
+
+bool rows::ContinuityOfCareFilter::AcceptRoutes() {
+    ROWS_PERF_COUNT(PerfCounter::ContinuityFilterCall);
+
+    changed_cells_.clear();
+    changed_users_.clear();
+    for (const auto index : AffectedIndices()) {
+        if (model_.IsStart(index)) {
+            continue;
+        }
+
+        const auto user = user_by_index_[index];
+        if (user < 0) {
+            continue;
+        }
+
+        const auto vehicle = Vehicle(index);
+        const auto new_vehicle = NewVehicle(index);
+        if (vehicle == new_vehicle) {
+            continue;
+        }
+
+        if (vehicle >= 0) {
+            AddVisit(user, vehicle, -1);
+        }
+        if (new_vehicle >= 0) {
+            AddVisit(user, new_vehicle, 1);
+        }
+    }
+
+    const auto stamp = Stamp();
+    for (const auto cell : changed_cells_) {
+        const auto user = static_cast<int>(cell / model_.vehicles());
+        if (user_stamps_[user] != stamp) {
+            user_stamps_[user] = stamp;
+            new_carers_[user] = carers_[user];
+            changed_users_.push_back(user);
+        }
+
+        const auto visits = visits_[cell];
+        const auto new_visits = visits + cell_deltas_[cell];
+        if (visits == 0 && new_visits > 0) {
+            ++new_carers_[user];
+        } else if (visits > 0 && new_visits == 0) {
+            --new_carers_[user];
+        }
+    }
+
+    for (const auto user : changed_users_) {
+        if (new_carers_[user] > max_carers_[user] && new_carers_[user] > carers_[user]) {
+            ROWS_PERF_COUNT(PerfCounter::ContinuityFilterReject);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void rows::ContinuityOfCareFilter::AddVisit(int user, int64 vehicle, int delta) {
+    const auto cell = Cell(user, vehicle);
+    if (cell_stamps_[cell] != Stamp()) {
+        cell_stamps_[cell] = Stamp();
+        cell_deltas_[cell] = 0;
+        changed_cells_.push_back(cell);
+    }
+    cell_deltas_[cell] += delta;
+}
@@ -0,0 +1,51 @@
+#ifndef ROWS_CONTINUITY_OF_CARE_FILTER_H
+#define ROWS_CONTINUITY_OF_CARE_FILTER_H
+
+#include <vector>
+
+#include "route_change_filter.h"
+
+namespace rows {
+
+    // rejects moves which increase the number of distinct carers who visit a service user above the limit,
+    // users who are already visited by more carers can still be moved between routes as long as the number
+    // of their carers does not grow
+    class ContinuityOfCareFilter : public RouteChangeFilter {
+    public:
+        // indices of visits of every user and the maximum number of distinct carers of the user
+        ContinuityOfCareFilter(const operations_research::RoutingModel &model,
+                               std::vector<std::vector<int64> > user_indices,
+                               std::vector<int64> max_carers);
+
+        std::string DebugString() const override;
+
+    private:
+        void OnSynchronizeRoutes() override;
+
+        bool AcceptRoutes() override;
+
+        inline std::size_t Cell(int user, int64 vehicle) const {
+            return static_cast<std::size_t>(user) * model_.vehicles() + vehicle;
+        }
+
+        void AddVisit(int user, int64 vehicle, int delta);
+
+        std::vector<std::vector<int64> > user_indices_;
+        std::vector<int64> max_carers_;
+        std::vector<int> user_by_index_;
+
+        // visits of every user performed by every vehicle and the number of distinct carers in the last accepted solution
+        std::vector<int> visits_;
+        std::vector<int64> carers_;
+
+        std::vector<int64> cell_stamps_;
+        std::vector<int> cell_deltas_;
+        std::vector<std::size_t> changed_cells_;
+        std::vector<int64> user_stamps_;
+        std::vector<int64> new_carers_;
+        std::vector<int> changed_users_;
+    };
+}
+
+
+#endif //ROWS_CONTINUITY_OF_CARE_FILTER_H
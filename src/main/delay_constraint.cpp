@@ -2,6 +2,8 @@
 
 #include <chrono>
 
+#include "perf_counters.h"
+
 // TODO: test the less rigorous definition of the index
 // TODO: remove customers how are not satisfied in the expected sense
 
@@ -26,6 +28,8 @@ void rows::DelayConstraint::Post() {
 }
 
 void rows::DelayConstraint::InitialPropagate() {
+    ROWS_PERF_COUNT(PerfCounter::ConstraintInitialPropagate);
+
     auto has_incomplete_paths = false;
     for (int vehicle = 0; vehicle < model()->vehicles(); ++vehicle) {
         if (!completed_paths_[vehicle]->Bound()) {
@@ -77,6 +81,7 @@ void rows::DelayConstraint::PropagateAllPaths() {
 void rows::DelayConstraint::PostPathConstraints(int vehicle) {
     int64 current_index = delay_tracker_->Record(model()->Start(vehicle)).next;
     while (!model()->IsEnd(current_index)) {
+        ROWS_PERF_COUNT(PerfCounter::ConstraintPostNodeConstraints);
         PostNodeConstraints(current_index);
         current_index = delay_tracker_->Record(current_index).next;
     }
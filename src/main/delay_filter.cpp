@@ -0,0 +1,126 @@
+#include "delay_filter.h"
+
+#include <algorithm>
+
+#include "perf_counters.h"
+
+rows::DelayFilter::DelayFilter(const operations_research::RoutingModel &model,
+                               const SolverWrapper &solver,
+                               const DelayTracker &delay_tracker,
+                               operations_research::IntVar *objective)
+        : RouteChangeFilter(model),
+          solver_{solver},
+          delay_tracker_{delay_tracker},
+          objective_{objective},
+          objective_max_{kint64max},
+          start_{},
+          bound_(static_cast<std::size_t>(model.Size() + model.vehicles()), 0),
+          route_bound_(static_cast<std::size_t>(model.vehicles()), 0),
+          new_start_{} {
+    const auto num_indices = model.Size() + model.vehicles();
+    start_.resize(num_indices);
+    new_start_.resize(num_indices);
+    for (auto index = 0; index < num_indices; ++index) {
+        const auto num_samples = delay_tracker_.Duration(index).size();
+        start_[index].resize(num_samples, delay_tracker_.StartMin(index));
+        new_start_[index].resize(num_samples, delay_tracker_.StartMin(index));
+    }
+}
+
+bool rows::DelayFilter::Accept(const operations_research::Assignment *delta,
+                               const operations_research::Assignment *deltadelta) {
+    objective_max_ = kint64max;
+    if (delta->HasObjective() && delta->Objective() == objective_) {
+        objective_max_ = delta->ObjectiveMax();
+    }
+
+    // no move can be rejected without the bound of the objective
+    if (objective_max_ == kint64max) {
+        return true;
+    }
+
+    return RouteChangeFilter::Accept(delta, deltadelta);
+}
+
+void rows::DelayFilter::OnSynchronizeRoutes() {
+    for (auto vehicle = 0; vehicle < model_.vehicles(); ++vehicle) {
+        route_bound_[vehicle] = 0;
+
+        auto index = model_.Start(vehicle);
+        auto next = Value(index);
+        while (!model_.IsEnd(next)) {
+            PropagateStart(index, start_[index], next, start_[next]);
+            bound_[next] = GetBound(next, start_[next]);
+            route_bound_[vehicle] = std::max(route_bound_[vehicle], bound_[next]);
+
+            index = next;
+            next = Value(index);
+        }
+    }
+}
+
+bool rows::DelayFilter::AcceptRoutes() {
+    ROWS_PERF_COUNT(PerfCounter::DelayFilterCall);
+
+    for (auto vehicle = 0; vehicle < model_.vehicles(); ++vehicle) {
+        if (!IsChangedVehicle(vehicle) && route_bound_[vehicle] > objective_max_) {
+            ROWS_PERF_COUNT(PerfCounter::DelayFilterReject);
+            return false;
+        }
+    }
+
+    for (const auto vehicle : ChangedVehicles()) {
+        if (!AcceptRoute(vehicle)) {
+            ROWS_PERF_COUNT(PerfCounter::DelayFilterReject);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool rows::DelayFilter::AcceptRoute(int vehicle) {
+    auto index = model_.Start(vehicle);
+    auto next = NewNext(index);
+    const std::vector<int64> *start = &start_[index];
+    auto unchanged_prefix = true;
+    while (!model_.IsEnd(next)) {
+        int64 bound = 0;
+        if (unchanged_prefix && next == Value(index)) {
+            start = &start_[next];
+            bound = bound_[next];
+        } else {
+            unchanged_prefix = false;
+
+            auto &next_start = new_start_[next];
+            PropagateStart(index, *start, next, next_start);
+            start = &next_start;
+            bound = GetBound(next, next_start);
+        }
+
+        if (bound > objective_max_) {
+            return false;
+        }
+
+        index = next;
+        next = NewNext(index);
+    }
+
+    return true;
+}
+
+void rows::DelayFilter::PropagateStart(int64 index,
+                                       const std::vector<int64> &start,
+                                       int64 next,
+                                       std::vector<int64> &next_start) const {
+    // the same travel time as in records of the delay tracker, a break can only delay the arrival; the arc cost
+    // of the routing model is not used, because the cost may include other terms than the travel time
+    const auto &index_manager = solver_.index_manager();
+    const auto travel_time = solver_.Distance(index_manager.IndexToNode(index), index_manager.IndexToNode(next));
+    const auto next_start_min = delay_tracker_.StartMin(next);
+    const auto &duration = delay_tracker_.Duration(index);
+    const auto num_samples = duration.size();
+    for (std::size_t scenario = 0; scenario < num_samples; ++scenario) {
+        next_start[scenario] = std::max(next_start_min, start[scenario] + duration[scenario] + travel_time);
+    }
+}
@@ -0,0 +1,60 @@
+#ifndef ROWS_DELAY_FILTER_H
+#define ROWS_DELAY_FILTER_H
+
+#include <vector>
+
+#include <ortools/constraint_solver/routing.h>
+#include <ortools/constraint_solver/constraint_solveri.h>
+
+#include "delay_tracker.h"
+#include "route_change_filter.h"
+#include "solver_wrapper.h"
+
+namespace rows {
+
+    // rejects moves after which the delay constraint would raise the objective above the bound set by the metaheuristic,
+    // start times are propagated only along the routes changed by the move, reusing start times of the last accepted
+    // solution before the first changed successor; breaks and synchronisation of siblings are ignored, so the start
+    // times are lower bounds of the times computed by the delay tracker and the filter never rejects a move that
+    // the constraint would accept
+    class DelayFilter : public RouteChangeFilter {
+    public:
+        DelayFilter(const operations_research::RoutingModel &model,
+                    const SolverWrapper &solver,
+                    const DelayTracker &delay_tracker,
+                    operations_research::IntVar *objective);
+
+        bool Accept(const operations_research::Assignment *delta, const operations_research::Assignment *deltadelta) override;
+
+    protected:
+        // a lower bound of the objective implied by a visit given lower bounds of its start times in every scenario,
+        // the bound must not decrease if any start time increases
+        virtual int64 GetBound(int64 index, const std::vector<int64> &start) const = 0;
+
+        inline const DelayTracker &delay_tracker() const { return delay_tracker_; }
+
+    private:
+        void OnSynchronizeRoutes() override;
+
+        bool AcceptRoutes() override;
+
+        bool AcceptRoute(int vehicle);
+
+        void PropagateStart(int64 index, const std::vector<int64> &start, int64 next, std::vector<int64> &next_start) const;
+
+        const SolverWrapper &solver_;
+        const DelayTracker &delay_tracker_;
+        operations_research::IntVar *objective_;
+        int64 objective_max_;
+
+        // start times, bounds of visits and bounds of routes in the last accepted solution
+        std::vector<std::vector<int64> > start_;
+        std::vector<int64> bound_;
+        std::vector<int64> route_bound_;
+
+        std::vector<std::vector<int64> > new_start_;
+    };
+}
+
+
+#endif //ROWS_DELAY_FILTER_H
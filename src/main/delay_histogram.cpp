@@ -0,0 +1,71 @@
+#include "delay_histogram.h"
+
+#include <algorithm>
+
+#include <glog/logging.h>
+
+namespace rows {
+
+    DelaySketchOptions::DelaySketchOptions()
+            : DelaySketchOptions(0, 0) {}
+
+    DelaySketchOptions::DelaySketchOptions(int64 resolution, int64 max_delay)
+            : Resolution{resolution},
+              MaxDelay{max_delay} {}
+
+    DelayHistogram::DelayHistogram(int64 resolution, int64 max_delay)
+            : resolution_{resolution},
+              offset_{0},
+              total_weight_{0},
+              weights_{} {
+        CHECK_GT(resolution_, 0);
+        CHECK_GE(max_delay, 0);
+
+        offset_ = (max_delay + resolution_ - 1) / resolution_;
+        weights_.resize(static_cast<std::size_t>(2 * offset_ + 2), 0);
+    }
+
+    void DelayHistogram::Clear() {
+        std::fill(std::begin(weights_), std::end(weights_), 0);
+        total_weight_ = 0;
+    }
+
+    void DelayHistogram::Add(int64 delay, int64 weight) {
+        weights_[Bucket(delay)] += weight;
+        total_weight_ += weight;
+    }
+
+    void DelayHistogram::Move(int64 old_delay, int64 new_delay, int64 weight) {
+        const auto old_bucket = Bucket(old_delay);
+        const auto new_bucket = Bucket(new_delay);
+        if (old_bucket != new_bucket) {
+            weights_[old_bucket] -= weight;
+            weights_[new_bucket] += weight;
+            DCHECK_GE(weights_[old_bucket], 0);
+        }
+    }
+
+    int64 DelayHistogram::WeightAbove(int64 delay) const {
+        int64 weight = 0;
+        for (auto bucket = Bucket(delay) + 1; bucket < weights_.size(); ++bucket) {
+            weight += weights_[bucket];
+        }
+        return weight;
+    }
+
+    bool DelayHistogram::IsRiskinessAtMost(int64 riskiness) const {
+        // delays in the last bucket have no upper bound
+        const auto last_bucket = weights_.size() - 1;
+        if (weights_[last_bucket] > 0) {
+            return false;
+        }
+
+        int64 total_delay = 0;
+        for (std::size_t bucket = 0; bucket < last_bucket; ++bucket) {
+            if (weights_[bucket] > 0) {
+                total_delay += weights_[bucket] * std::max(UpperBound(bucket), -riskiness);
+            }
+        }
+        return total_delay <= 0;
+    }
+}
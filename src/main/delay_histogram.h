@@ -0,0 +1,76 @@
+#ifndef ROWS_DELAY_HISTOGRAM_H
+#define ROWS_DELAY_HISTOGRAM_H
+
+#include <vector>
+
+#include <ortools/base/integral_types.h>
+
+namespace rows {
+
+    // histograms of delays kept by the delay tracker next to the delays of every scenario
+    struct DelaySketchOptions {
+        DelaySketchOptions();
+
+        DelaySketchOptions(int64 resolution, int64 max_delay);
+
+        inline bool Enabled() const { return Resolution > 0; }
+
+        // width of a bucket in seconds, histograms are not kept if zero
+        int64 Resolution;
+
+        // delays longer than the maximum delay fall into a single bucket without an upper bound,
+        // delays shorter than its negation fall into a single bucket bounded by the negation
+        int64 MaxDelay;
+    };
+
+    // weight of scenarios in buckets of delays, a bucket contains delays in (upper bound - resolution, upper bound],
+    // upper bounds of buckets are multiples of the resolution, so delays greater than zero are counted exactly
+    class DelayHistogram {
+    public:
+        DelayHistogram(int64 resolution, int64 max_delay);
+
+        void Clear();
+
+        void Add(int64 delay, int64 weight);
+
+        void Move(int64 old_delay, int64 new_delay, int64 weight);
+
+        // weight of delays greater than the delay rounded up to a multiple of the resolution
+        int64 WeightAbove(int64 delay) const;
+
+        // checks if the essential riskiness is not greater than the given value, which is the case if the weighted sum
+        // of delays cut off below the negated riskiness is not positive, the upper bound of a bucket is used instead
+        // of every delay, so the histogram may fail to confirm a riskiness which the exact computation accepts
+        bool IsRiskinessAtMost(int64 riskiness) const;
+
+        inline int64 total_weight() const { return total_weight_; }
+
+    private:
+        inline std::size_t Bucket(int64 delay) const {
+            const auto bucket = (delay >= 0 ? (delay + resolution_ - 1) / resolution_ : -((-delay) / resolution_)) + offset_;
+            if (bucket < 0) {
+                return 0;
+            }
+
+            if (bucket > 2 * offset_ + 1) {
+                return static_cast<std::size_t>(2 * offset_ + 1);
+            }
+
+            return static_cast<std::size_t>(bucket);
+        }
+
+        inline int64 UpperBound(std::size_t bucket) const {
+            return (static_cast<int64>(bucket) - offset_) * resolution_;
+        }
+
+        int64 resolution_;
+        int64 offset_;
+        int64 total_weight_;
+
+        // the last bucket contains delays greater than the maximum delay
+        std::vector<int64> weights_;
+    };
+}
+
+
+#endif //ROWS_DELAY_HISTOGRAM_H
@@ -0,0 +1,30 @@
+#include "delay_probability_filter.h"
+
+#include <cmath>
+
+rows::DelayProbabilityFilter::DelayProbabilityFilter(const operations_research::RoutingModel &model,
+                                                     const SolverWrapper &solver,
+                                                     const DelayTracker &delay_tracker,
+                                                     operations_research::IntVar *worst_delay_probability)
+        : DelayFilter(model, solver, delay_tracker, worst_delay_probability) {}
+
+std::string rows::DelayProbabilityFilter::DebugString() const {
+    return "DelayProbabilityFilter";
+}
+
+int64 rows::DelayProbabilityFilter::GetBound(int64 index, const std::vector<int64> &start) const {
+    const auto num_scenarios = start.size();
+    if (num_scenarios == 0) {
+        return 0;
+    }
+
+    // the same weights and rounding as in the delay tracker
+    const auto start_max = delay_tracker().StartMax(index);
+    const auto &weights = delay_tracker().Weights();
+    int64 delayed_arrival_weight = 0;
+    for (std::size_t scenario = 0; scenario < num_scenarios; ++scenario) {
+        if (start[scenario] > start_max) { delayed_arrival_weight += weights[scenario]; }
+    }
+    const double probability = static_cast<double>(delayed_arrival_weight) * 100.0 / static_cast<double>(delay_tracker().TotalWeight());
+    return std::ceil(probability);
+}
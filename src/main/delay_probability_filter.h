@@ -0,0 +1,23 @@
+#ifndef ROWS_DELAY_PROBABILITY_FILTER_H
+#define ROWS_DELAY_PROBABILITY_FILTER_H
+
+#include "delay_filter.h"
+
+namespace rows {
+
+    class DelayProbabilityFilter : public DelayFilter {
+    public:
+        DelayProbabilityFilter(const operations_research::RoutingModel &model,
+                               const SolverWrapper &solver,
+                               const DelayTracker &delay_tracker,
+                               operations_research::IntVar *worst_delay_probability);
+
+        std::string DebugString() const override;
+
+    protected:
+        int64 GetBound(int64 index, const std::vector<int64> &start) const override;
+    };
+}
+
+
+#endif //ROWS_DELAY_PROBABILITY_FILTER_H
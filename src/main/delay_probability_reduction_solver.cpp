@@ -5,6 +5,7 @@
 #include "cancel_search_limit.h"
 #include "stalled_search_limit.h"
 #include "delay_probability_constraint.h"
+#include "delay_probability_filter.h"
 
 rows::DelayProbabilityReductionSolver::DelayProbabilityReductionSolver(const ProblemData &problem_data,
                                                                        const History &history,
@@ -28,10 +29,11 @@ void rows::DelayProbabilityReductionSolver::BeforeCloseModel(operations_research
     MetaheuristicSolver::BeforeCloseModel(model, printer);
 
     delay_probability_ = model.solver()->MakeIntVar(0, 100, "delay_probability");
-    model.solver()->AddConstraint(
-            model.solver()->RevAlloc(new DelayProbabilityConstraint(
-                    delay_probability_,
-                    std::make_unique<DelayTracker>(*this, history_, &model.GetDimensionOrDie(TIME_DIMENSION)))));
+    std::unique_ptr<DelayTracker> delay_tracker = std::make_unique<DelayTracker>(*this, history_, &model.GetDimensionOrDie(TIME_DIMENSION));
+    if (neighbourhood_options().LocalSearchFilters) {
+        model.AddLocalSearchFilter(model.solver()->RevAlloc(new DelayProbabilityFilter(model, *this, *delay_tracker, delay_probability_)));
+    }
+    model.solver()->AddConstraint(model.solver()->RevAlloc(new DelayProbabilityConstraint(delay_probability_, std::move(delay_tracker))));
     model.AddVariableMinimizedByFinalizer(delay_probability_);
 }
 
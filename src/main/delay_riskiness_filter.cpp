@@ -0,0 +1,27 @@
+#include "delay_riskiness_filter.h"
+
+#include <algorithm>
+
+rows::DelayRiskinessFilter::DelayRiskinessFilter(const operations_research::RoutingModel &model,
+                                                 const SolverWrapper &solver,
+                                                 const DelayTracker &delay_tracker,
+                                                 operations_research::IntVar *riskiness_index)
+        : DelayFilter(model, solver, delay_tracker, riskiness_index) {}
+
+std::string rows::DelayRiskinessFilter::DebugString() const {
+    return "DelayRiskinessFilter";
+}
+
+int64 rows::DelayRiskinessFilter::GetBound(int64 index, const std::vector<int64> &start) const {
+    if (start.empty()) {
+        return 0;
+    }
+
+    const auto start_max = delay_tracker().StartMax(index);
+    const auto min_max_start = std::minmax_element(std::cbegin(start), std::cend(start));
+    if (*min_max_start.first >= start_max && *min_max_start.second > start_max) {
+        return DelayTracker::MAX_RISKINESS;
+    }
+
+    return 0;
+}
@@ -0,0 +1,25 @@
+#ifndef ROWS_DELAY_RISKINESS_FILTER_H
+#define ROWS_DELAY_RISKINESS_FILTER_H
+
+#include "delay_filter.h"
+
+namespace rows {
+
+    // the essential riskiness computed by the constraint is not monotone in delays when the balance of delays is zero,
+    // so the filter bounds only the riskiness of visits which are late in every scenario
+    class DelayRiskinessFilter : public DelayFilter {
+    public:
+        DelayRiskinessFilter(const operations_research::RoutingModel &model,
+                             const SolverWrapper &solver,
+                             const DelayTracker &delay_tracker,
+                             operations_research::IntVar *riskiness_index);
+
+        std::string DebugString() const override;
+
+    protected:
+        int64 GetBound(int64 index, const std::vector<int64> &start) const override;
+    };
+}
+
+
+#endif //ROWS_DELAY_RISKINESS_FILTER_H
@@ -5,6 +5,7 @@
 #include "cancel_search_limit.h"
 #include "stalled_search_limit.h"
 #include "delay_riskiness_constraint.h"
+#include "delay_riskiness_filter.h"
 
 rows::DelayRiskinessReductionSolver::DelayRiskinessReductionSolver(const ProblemData &problem_data,
                                                                    const History &history,
@@ -28,6 +29,9 @@ void rows::DelayRiskinessReductionSolver::BeforeCloseModel(operations_research::
 
     riskiness_index_ = model.solver()->MakeIntVar(0, kint64max, "riskiness_index");
     std::unique_ptr<DelayTracker> delay_tracker = std::make_unique<DelayTracker>(*this, history_, &model.GetDimensionOrDie(TIME_DIMENSION));
+    if (neighbourhood_options().LocalSearchFilters) {
+        model.AddLocalSearchFilter(model.solver()->RevAlloc(new DelayRiskinessFilter(model, *this, *delay_tracker, riskiness_index_)));
+    }
     model.solver()->AddConstraint(model.solver()->RevAlloc(new DelayRiskinessConstraint(riskiness_index_, std::move(delay_tracker), failed_index_repository())));
     model.AddVariableMinimizedByFinalizer(riskiness_index_);
 }
@@ -65,84 +65,126 @@ rows::DelayTracker::DelayTracker(const rows::SolverWrapper &solver,
         start_[index].resize(num_samples, duration_sample_.start_min(index));
         delay_[index].resize(num_samples, 0);
     }
+
+    const auto &sketch_options = solver.delay_sketch_options();
+    if (sketch_options.Enabled()) {
+        delay_sketch_.resize(num_indices, DelayHistogram{sketch_options.Resolution, sketch_options.MaxDelay});
+        ClearDelaySketch();
+    }
 }
 
+const int64 rows::DelayTracker::MAX_RISKINESS = kint64max - 5;
+
 int64 rows::DelayTracker::GetMeanDelay(int64 node) const {
-    const auto &delay = Delay(node);
-    int64 total_delay = std::accumulate(std::cbegin(delay), std::cend(delay), static_cast<int64>(0));
-    return static_cast<double>(total_delay) / static_cast<double>(delay.size());
+    return GetMeanDelay(Delay(node), Weights());
 }
 
 int64 rows::DelayTracker::GetDelayProbability(int64 node) const {
-    const auto &delay = Delay(node);
+    if (HasDelaySketch()) {
+        // zero is an upper bound of a bucket, so the histogram gives the exact weight of delayed arrivals
+        const double probability = static_cast<double>(delay_sketch_[node].WeightAbove(0)) * 100.0
+                                   / static_cast<double>(TotalWeight());
+        return std::ceil(probability);
+    }
+
+    return GetDelayProbability(Delay(node), Weights());
+}
+
+int64 rows::DelayTracker::GetEssentialRiskiness(int64 node) const {
+    return GetEssentialRiskiness(Delay(node), Weights());
+}
+
+int64 rows::DelayTracker::GetMeanDelay(const std::vector<int64> &delay, const std::vector<int64> &weights) {
+    int64 total_delay = 0;
+    int64 total_weight = 0;
+    for (std::size_t scenario = 0; scenario < delay.size(); ++scenario) {
+        total_delay += weights[scenario] * delay[scenario];
+        total_weight += weights[scenario];
+    }
+    return static_cast<double>(total_delay) / static_cast<double>(total_weight);
+}
+
+int64 rows::DelayTracker::GetDelayProbability(const std::vector<int64> &delay, const std::vector<int64> &weights) {
     const auto num_scenarios = delay.size();
-    int64 delayed_arrival_count = 0;
+    int64 delayed_arrival_weight = 0;
+    int64 total_weight = 0;
     for (std::size_t scenario = 0; scenario < num_scenarios; ++scenario) {
-        if (delay[scenario] > 0) { ++delayed_arrival_count; }
+        if (delay[scenario] > 0) { delayed_arrival_weight += weights[scenario]; }
+        total_weight += weights[scenario];
     }
-    const double probability = static_cast<double>(delayed_arrival_count) * 100.0 / static_cast<double>(num_scenarios);
+    const double probability = static_cast<double>(delayed_arrival_weight) * 100.0 / static_cast<double>(total_weight);
     return std::ceil(probability);
 }
 
-int64 rows::DelayTracker::GetEssentialRiskiness(int64 node) const {
-    static const int64 MAX_RISKINESS = kint64max - 5;
+int64 rows::DelayTracker::GetEssentialRiskiness(const std::vector<int64> &delay, const std::vector<int64> &weights) {
+    // a scenario of weight w is equivalent to w scenarios with the same delay, so the number of delays
+    // which are not greater than the delay at a given position is replaced by their total weight
+    const auto num_delays = delay.size();
 
-    std::vector<int64> delays = Delay(node);
+    std::vector<std::pair<int64, int64> > delays;
+    delays.reserve(num_delays);
+    for (std::size_t scenario = 0; scenario < num_delays; ++scenario) {
+        delays.emplace_back(delay[scenario], weights[scenario]);
+    }
     std::sort(std::begin(delays), std::end(delays));
 
+    std::vector<int64> cumulative_weight(num_delays, 0);
+    int64 weight_sum = 0;
+    for (std::size_t delay_pos = 0; delay_pos < num_delays; ++delay_pos) {
+        weight_sum += delays[delay_pos].second;
+        cumulative_weight[delay_pos] = weight_sum;
+    }
+
     // if last element is negative then index is zero
-    const auto num_delays = delays.size();
     int64 delay_pos = num_delays - 1;
-    if (delays.at(delay_pos) <= 0) {
+    if (delays.at(delay_pos).first <= 0) {
         return 0;
     }
 
-    if (delays.at(0) >= 0) {
+    if (delays.at(0).first >= 0) {
         return MAX_RISKINESS;
     }
 
     // compute total delay
     int64 total_delay = 0;
-    for (; delay_pos >= 0 && delays.at(delay_pos) >= 0; --delay_pos) {
-        total_delay += delays.at(delay_pos);
+    for (; delay_pos >= 0 && delays.at(delay_pos).first >= 0; --delay_pos) {
+        total_delay += delays.at(delay_pos).second * delays.at(delay_pos).first;
     }
     CHECK_GT(total_delay, 0);
-//    CHECK_GT(delay_pos, 0);
 
-//    if (delays.at(0) >= 0) {
     if (delay_pos == -1) {
-//        return total_delay;
         return MAX_RISKINESS;
     }
 
     // find minimum traffic index that compensates the total delay
     int64 delay_budget = 0;
-    for (; delay_pos > 0 && delay_budget + (delay_pos + 1) * delays.at(delay_pos) + total_delay > 0; --delay_pos) {
-        delay_budget += delays.at(delay_pos);
+    for (; delay_pos > 0
+           && delay_budget + cumulative_weight.at(delay_pos) * delays.at(delay_pos).first + total_delay > 0; --delay_pos) {
+        delay_budget += delays.at(delay_pos).second * delays.at(delay_pos).first;
     }
 
-    int64 delay_balance = delay_budget + (delay_pos + 1) * delays.at(delay_pos) + total_delay;
+    int64 delay_balance = delay_budget + cumulative_weight.at(delay_pos) * delays.at(delay_pos).first + total_delay;
     if (delay_balance < 0) {
-        int64 riskiness_index = std::min(0l, delays.at(delay_pos + 1));
+        int64 riskiness_index = std::min(0l, delays.at(delay_pos + 1).first);
         CHECK_LE(riskiness_index, 0);
 
-        int64 remaining_balance = total_delay + delay_budget + (delay_pos + 1) * riskiness_index;
+        int64 remaining_balance = total_delay + delay_budget + cumulative_weight.at(delay_pos) * riskiness_index;
         CHECK_GE(remaining_balance, 0);
 
-        riskiness_index -= std::ceil(static_cast<double>(remaining_balance) / static_cast<double>(delay_pos + 1));
-        CHECK_LE(riskiness_index * (delay_pos + 1) + delay_budget + total_delay, 0);
+        riskiness_index -= std::ceil(static_cast<double>(remaining_balance) / static_cast<double>(cumulative_weight.at(delay_pos)));
+        CHECK_LE(riskiness_index * cumulative_weight.at(delay_pos) + delay_budget + total_delay, 0);
 
         return -riskiness_index;
     } else if (delay_balance > 0) {
         CHECK_EQ(delay_pos, 0);
-//        return delay_balance;
         return MAX_RISKINESS;
     }
 
-    return delays.at(delay_pos);
+    // the riskiness index is the negated delay which balances the total delay exactly
+    return -delays.at(delay_pos).first;
 }
 
-std::vector<int64> rows::DelayTracker::BuildPath(int vehicle, operations_research::Assignment const *assignment) {
+const std::vector<int64> &rows::DelayTracker::BuildPath(int vehicle, operations_research::Assignment const *assignment) {
     const AssignmentData assignment_data{assignment};
     return BuildPathFromSource<decltype(assignment_data)>(vehicle, assignment_data);
 }
@@ -173,16 +215,34 @@ void rows::DelayTracker::UpdatePath(int vehicle, operations_research::Assignment
 
 void rows::DelayTracker::ComputePathDelay(int vehicle) {
     const auto num_samples = duration_sample_.size();
+    const auto &weights = Weights();
 
     int64 current_index = records_[model_->Start(vehicle)].next;
     while (!model_->IsEnd(current_index)) {
-        for (std::size_t scenario = 0; scenario < num_samples; ++scenario) {
-            delay_[current_index][scenario] = start_[current_index][scenario] - duration_sample_.start_max(current_index);
+        if (HasDelaySketch()) {
+            auto &sketch = delay_sketch_[current_index];
+            for (std::size_t scenario = 0; scenario < num_samples; ++scenario) {
+                const auto delay = start_[current_index][scenario] - duration_sample_.start_max(current_index);
+                sketch.Move(delay_[current_index][scenario], delay, weights[scenario]);
+                delay_[current_index][scenario] = delay;
+            }
+        } else {
+            for (std::size_t scenario = 0; scenario < num_samples; ++scenario) {
+                delay_[current_index][scenario] = start_[current_index][scenario] - duration_sample_.start_max(current_index);
+            }
         }
         current_index = records_[current_index].next;
     }
 }
 
+void rows::DelayTracker::ClearDelaySketch() {
+    // all delays are reset to zero
+    for (auto &sketch : delay_sketch_) {
+        sketch.Clear();
+        sketch.Add(0, TotalWeight());
+    }
+}
+
 int64 rows::DelayTracker::GetArrivalTimeWithBreak(const rows::DelayTracker::TrackRecord &record, std::size_t scenario) const {
     CHECK_NE(record.next, -1);
 
@@ -212,33 +272,19 @@ int64 rows::DelayTracker::GetArrivalTimeNoBreak(const rows::DelayTracker::TrackR
 }
 
 rows::DelayTracker::PartialPath const *rows::DelayTracker::SelectBestPath(const PartialPath &left, const PartialPath &right) const {
-    CHECK(left.IsComplete());
-    CHECK(right.IsComplete());
-    CHECK_EQ(left.slack.size(), right.slack.size());
-
-    const auto num_slack = left.slack.size();
-    std::vector<int64> slack_diff;
-    slack_diff.resize(num_slack);
-
-    for (std::size_t pos = 0; pos < num_slack; ++pos) {
-        slack_diff[pos] = std::min(left.slack[pos], 3600l) - std::min(right.slack[pos], 3600l);
-    }
+    CHECK(left.complete);
+    CHECK(right.complete);
 
-    auto total_budget = std::accumulate(std::cbegin(slack_diff), std::cend(slack_diff), 0l);
-    if (total_budget > 0) {
+    // prefer the path with more slack before visits, first counting at most one hour per visit, then the total slack
+    if (left.capped_slack > right.capped_slack) {
         return &left;
-    } else if (total_budget < 0) {
+    } else if (left.capped_slack < right.capped_slack) {
         return &right;
     }
 
-    for (std::size_t pos = 0; pos < num_slack; ++pos) {
-        slack_diff[pos] = left.slack[pos] - right.slack[pos];
-    }
-    total_budget = std::accumulate(std::cbegin(slack_diff), std::cend(slack_diff), 0l);
-
-    if (total_budget > 0) {
+    if (left.total_slack > right.total_slack) {
         return &left;
-    } else if (total_budget < 0) {
+    } else if (left.total_slack < right.total_slack) {
         return &right;
     }
     return &left;
@@ -247,12 +293,12 @@ rows::DelayTracker::PartialPath const *rows::DelayTracker::SelectBestPath(const
 rows::DelayTracker::PartialPath const *rows::DelayTracker::SelectBestPath(const std::vector<PartialPath> &paths) const {
     const auto num_paths = paths.size();
     std::size_t result_pos = 0;
-    for (; result_pos < num_paths && !paths[result_pos].IsComplete(); ++result_pos);
+    for (; result_pos < num_paths && !paths[result_pos].complete; ++result_pos);
     if (result_pos == num_paths) { return nullptr; }
 
     rows::DelayTracker::PartialPath const *result_path = &paths[result_pos];
     for (std::size_t candidate_pos = result_pos + 1; candidate_pos < num_paths; ++candidate_pos) {
-        if (!paths[candidate_pos].IsComplete()) {
+        if (!paths[candidate_pos].complete) {
             continue;
         }
 
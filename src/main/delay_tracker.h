@@ -8,7 +8,10 @@
 #include <ortools/constraint_solver/routing.h>
 #include <ortools/constraint_solver/constraint_solveri.h>
 
+#include "delay_histogram.h"
 #include "duration_sample.h"
+#include "invariant_checks.h"
+#include "perf_counters.h"
 
 namespace rows {
 
@@ -23,6 +26,9 @@ namespace rows {
             int64 break_duration;
         };
 
+        // riskiness of a visit which is delayed in all scenarios
+        static const int64 MAX_RISKINESS;
+
         DelayTracker(const SolverWrapper &solver, const History &history, const operations_research::RoutingDimension *dimension);
 
         inline TrackRecord &Record(int64 node) { return records_[node]; }
@@ -39,12 +45,29 @@ namespace rows {
 
         inline const std::vector<int64> &Duration(int64 node) const { return duration_sample_.duration(node); }
 
+        // number of historical dates represented by every scenario
+        inline const std::vector<int64> &Weights() const { return duration_sample_.weights(); }
+
+        inline int64 TotalWeight() const { return duration_sample_.total_weight(); }
+
         int64 GetMeanDelay(int64 node) const;
 
         int64 GetDelayProbability(int64 node) const;
 
         int64 GetEssentialRiskiness(int64 node) const;
 
+        // statistics of delays in scenarios which represent as many historical dates as their weights
+        static int64 GetMeanDelay(const std::vector<int64> &delay, const std::vector<int64> &weights);
+
+        static int64 GetDelayProbability(const std::vector<int64> &delay, const std::vector<int64> &weights);
+
+        static int64 GetEssentialRiskiness(const std::vector<int64> &delay, const std::vector<int64> &weights);
+
+        inline bool HasDelaySketch() const { return !delay_sketch_.empty(); }
+
+        // histogram of delays in all scenarios, kept only if enabled in the solver
+        inline const DelayHistogram &DelaySketch(int64 node) const { return delay_sketch_[node]; }
+
         inline const operations_research::RoutingModel *model() const { return model_; }
 
         void UpdateAllPaths();
@@ -55,7 +78,7 @@ namespace rows {
 
         void UpdatePath(int vehicle, operations_research::Assignment const *assignment);
 
-        std::vector<int64> BuildPath(int vehicle, operations_research::Assignment const *assignment);
+        const std::vector<int64> &BuildPath(int vehicle, operations_research::Assignment const *assignment);
 
         inline bool has_sibling(int64 index) const { return duration_sample_.has_sibling(index); }
 
@@ -121,15 +144,18 @@ namespace rows {
 
         template<typename DataSource>
         void UpdateAllPathsFromSource(const DataSource &data) {
+            ROWS_PERF_COUNT(PerfCounter::DelayTrackerFullPropagation);
+
             for (std::size_t index = 0; index < records_.size(); ++index) {
                 std::fill(std::begin(start_[index]), std::end(start_[index]), duration_sample_.start_min(index));
                 std::fill(std::begin(delay_[index]), std::end(delay_[index]), 0);
                 records_[index].next = -1;
             }
+            ClearDelaySketch();
             std::fill(std::begin(visited_), std::end(visited_), false);
 
             for (int vehicle = 0; vehicle < model_->vehicles(); ++vehicle) {
-                const auto path = BuildPathFromSource<decltype(data)>(vehicle, data);
+                const auto &path = BuildPathFromSource<decltype(data)>(vehicle, data);
                 UpdatePathRecords<decltype(data)>(vehicle, path, data);
             }
 
@@ -203,6 +229,13 @@ namespace rows {
                 }
             }
 
+            // successors do not depend on the scenario, so they are checked once instead of in the propagation loop
+            for (const auto index : reverse_sorted_vertices) {
+                if (!model_->IsEnd(index) && visited_nodes[index]) {
+                    CHECK_NE(records_[index].next, -1);
+                }
+            }
+
             const auto num_samples = duration_sample_.size();
             for (std::size_t scenario = 0; scenario < num_samples; ++scenario) {
                 for (auto it = std::cbegin(reverse_sorted_vertices); it != std::cend(reverse_sorted_vertices); ++it) {
@@ -238,7 +271,6 @@ namespace rows {
                     }
 
                     const auto &record = records_[index];
-                    CHECK_NE(record.next, -1);
 
                     auto arrival_time = start_[index][scenario] + duration_sample_.duration(index, scenario) + record.travel_time;
                     if (arrival_time > record.break_min) {
@@ -251,11 +283,16 @@ namespace rows {
                         start_[record.next][scenario] = arrival_time;
                     }
                 }
+            }
 
-                for (int64 index = 0; index < solver_.index_manager().num_indices(); ++index) {
-                    int64 sibling = duration_sample_.sibling(index);
-                    if (sibling != -1) {
-                        CHECK_EQ(start_[index][scenario], start_[sibling][scenario]);
+            // siblings start at the same time in every scenario
+            if (ROWS_EXPENSIVE_CHECKS_ENABLED()) {
+                for (std::size_t scenario = 0; scenario < num_samples; ++scenario) {
+                    for (int64 index = 0; index < solver_.index_manager().num_indices(); ++index) {
+                        int64 sibling = duration_sample_.sibling(index);
+                        if (sibling != -1) {
+                            CHECK_EQ(start_[index][scenario], start_[sibling][scenario]);
+                        }
                     }
                 }
             }
@@ -265,15 +302,18 @@ namespace rows {
             }
         }
 
+        // state of a sequence of visits and breaks explored by the path builder, the sequence is not stored in the state,
+        // instead every break performed is appended to a log shared by all states, so branching copies a few integers
         struct PartialPath {
-            explicit PartialPath(std::size_t size)
+            PartialPath()
                     : current_time{0},
                       travel_time{0},
                       node_next_pos{0},
                       break_next_pos{0},
-                      path(size, 0) {}
-
-            bool IsComplete() const { return path[path.size() - 1] < 0; }
+                      last_break{-1},
+                      capped_slack{0},
+                      total_slack{0},
+                      complete{false} {}
 
             inline std::size_t CurrentPosition() const { return break_next_pos + node_next_pos - 1; }
 
@@ -281,13 +321,24 @@ namespace rows {
             int64 travel_time;
             std::size_t node_next_pos;
             std::size_t break_next_pos;
-            std::vector<int64> path;
-            std::vector<int64> slack;
+            int64 last_break;
+            int64 capped_slack;
+            int64 total_slack;
+            bool complete;
+        };
+
+        struct BreakLogEntry {
+            int64 previous;
+            std::size_t path_pos;
+            int64 element;
         };
 
         template<typename DataSource>
-        static std::vector<int64> GetNodePath(int vehicle, const operations_research::RoutingModel *model, const DataSource &data) {
-            std::vector<int64> path;
+        static void GetNodePath(int vehicle,
+                                const operations_research::RoutingModel *model,
+                                const DataSource &data,
+                                std::vector<int64> &path) {
+            path.clear();
 
             int64 current_node = model->Start(vehicle);
             while (!model->IsEnd(current_node)) {
@@ -295,8 +346,6 @@ namespace rows {
                 current_node = data.Value(model->NextVar(current_node));
             }
             path.emplace_back(current_node);
-
-            return path;
         }
 
         template<typename DataSource>
@@ -305,18 +354,16 @@ namespace rows {
                         const std::vector<TrackRecord> &records,
                         const operations_research::RoutingDimension *dimension,
                         const SolverWrapper &solver,
-                        int vehicle)
+                        const std::vector<operations_research::IntervalVar *> &breaks,
+                        const std::vector<int64> &nodes,
+                        std::vector<BreakLogEntry> &break_log)
                     : data_{data},
                       solver_{solver},
                       records_{records},
                       dimension_{dimension},
-                      vehicle_{vehicle},
-                      breaks{},
-                      nodes{GetNodePath<DataSource>(vehicle_, dimension_->model(), data_)} {
-                if (dimension_->HasBreakConstraints()) {
-                    breaks = dimension_->GetBreakIntervalsOfVehicle(vehicle_);
-                }
-            }
+                      break_log_{break_log},
+                      breaks{breaks},
+                      nodes{nodes} {}
 
             void Process(const PartialPath &path) {
                 const auto has_visit = path.node_next_pos < nodes.size();
@@ -397,22 +444,23 @@ namespace rows {
             }
 
             void PerformBreak(PartialPath &path) {
-                std::size_t path_pos = path.break_next_pos + path.node_next_pos - 1;
+                break_log_.push_back({path.last_break, path.CurrentPosition(), -static_cast<int64>(path.break_next_pos)});
 
-                path.path[path_pos] = -path.break_next_pos;
+                path.last_break = static_cast<int64>(break_log_.size()) - 1;
                 path.travel_time = std::max(0l, path.travel_time - waiting_time_for_break);
                 path.current_time = time_after_break;
                 ++path.break_next_pos;
             }
 
             void PerformVisit(PartialPath &path) {
-                std::size_t path_pos = path.break_next_pos + path.node_next_pos - 1;
+                // slack above one hour does not make a path more preferable
+                static const int64 MAX_PREFERRED_SLACK = 3600;
 
-                path.path[path_pos] = nodes[path.node_next_pos];
                 path.current_time = time_after_visit;
                 path.travel_time = next_travel_time;
                 ++path.node_next_pos;
-                path.slack.emplace_back(visit_slack_time);
+                path.capped_slack += std::min(visit_slack_time, MAX_PREFERRED_SLACK);
+                path.total_slack += visit_slack_time;
             }
 
             int64 next_travel_time{};
@@ -439,11 +487,11 @@ namespace rows {
             const SolverWrapper &solver_;
             const std::vector<TrackRecord> &records_;
             const operations_research::RoutingDimension *dimension_;
-            const int vehicle_;
+            std::vector<BreakLogEntry> &break_log_;
 
         public:
-            std::vector<operations_research::IntervalVar *> breaks;
-            const std::vector<int64> nodes;
+            const std::vector<operations_research::IntervalVar *> &breaks;
+            const std::vector<int64> &nodes;
         };
 
         static const int64 MAX_START_TIME = 48 * 60 * 60;
@@ -452,65 +500,80 @@ namespace rows {
 
         PartialPath const *SelectBestPath(const PartialPath &left, const PartialPath &right) const;
 
+        // the path is written to a buffer owned by the tracker which remains valid until the next call
         template<typename DataSource>
-        std::vector<int64> BuildPathFromSource(int vehicle, const DataSource &data) {
-            PathBuilder<DataSource> builder{data, records_, dimension_, solver_, vehicle};
+        const std::vector<int64> &BuildPathFromSource(int vehicle, const DataSource &data) {
+            ROWS_PERF_COUNT(PerfCounter::BuildPathFromSource);
+
+            static const std::vector<operations_research::IntervalVar *> NO_BREAKS{};
 
-            const auto num_breaks = builder.breaks.size();
-            const auto num_nodes = builder.nodes.size();
+            GetNodePath<DataSource>(vehicle, model_, data, path_nodes_);
+            const auto &breaks = dimension_->HasBreakConstraints() ? dimension_->GetBreakIntervalsOfVehicle(vehicle) : NO_BREAKS;
+            PathBuilder<DataSource> builder{data, records_, dimension_, solver_, breaks, path_nodes_, path_break_log_};
+
+            const auto num_breaks = breaks.size();
+            const auto num_nodes = path_nodes_.size();
 
             CHECK_GE(num_breaks, 2);
+            path_.clear();
             if (num_nodes == 2) {
-                return {};
+                return path_;
             }
 
             if (num_breaks == 2) {
-                auto node_path = builder.nodes;
-                node_path.emplace_back(-1);
-                return node_path;
+                path_.assign(std::cbegin(path_nodes_), std::cend(path_nodes_));
+                path_.emplace_back(-1);
+                return path_;
             }
 
             // deliberately skip the first break node since its end time is encoded as the start time of the first regular node
             const auto path_size = num_breaks + num_nodes - 1;
 
-            PartialPath initial_path{path_size};
-            initial_path.break_next_pos = 1;
-            initial_path.current_time = data.StartMin(builder.breaks[0]) + data.DurationMin(builder.breaks[0]);
+            path_break_log_.clear();
+            partial_paths_.clear();
+            partial_paths_.emplace_back();
+            partial_paths_[0].break_next_pos = 1;
+            partial_paths_[0].current_time = data.StartMin(breaks[0]) + data.DurationMin(breaks[0]);
 
-            std::vector<PartialPath> partial_paths{initial_path};
+            // paths are explored in the order of creation, so ties between paths are resolved as before
             std::size_t current_path_pos = 0;
-            while (current_path_pos < partial_paths.size()) {
-                for (std::size_t pos = partial_paths[current_path_pos].CurrentPosition(); pos < path_size; ++pos) {
-                    builder.Process(partial_paths[current_path_pos]);
+            while (current_path_pos < partial_paths_.size()) {
+                for (std::size_t pos = partial_paths_[current_path_pos].CurrentPosition(); pos < path_size; ++pos) {
+                    builder.Process(partial_paths_[current_path_pos]);
 
                     if (builder.failed) {
                         break;
                     }
 
                     if (builder.break_preferred) {
-                        if (partial_paths[current_path_pos].node_next_pos == builder.nodes.size()) {
-                            CHECK_EQ(partial_paths[current_path_pos].travel_time, 0);
+                        if (partial_paths_[current_path_pos].node_next_pos == num_nodes) {
+                            CHECK_EQ(partial_paths_[current_path_pos].travel_time, 0);
                         }
 
-                        builder.PerformBreak(partial_paths[current_path_pos]);
+                        builder.PerformBreak(partial_paths_[current_path_pos]);
                         continue;
                     } else if (builder.visit_preferred) {
-                        builder.PerformVisit(partial_paths[current_path_pos]);
+                        builder.PerformVisit(partial_paths_[current_path_pos]);
                         continue;
                     } else {
-                        PartialPath path_copy = partial_paths[current_path_pos];
+                        PartialPath path_copy = partial_paths_[current_path_pos];
 
-                        builder.PerformVisit(partial_paths[current_path_pos]);
+                        builder.PerformVisit(partial_paths_[current_path_pos]);
                         builder.PerformBreak(path_copy);
 
-                        partial_paths.emplace_back(std::move(path_copy));
+                        partial_paths_.push_back(path_copy);
                     }
                 }
 
+                // the path is complete if the last break is performed at the last position
+                auto &current_path = partial_paths_[current_path_pos];
+                current_path.complete = current_path.last_break >= 0
+                                        && path_break_log_[current_path.last_break].path_pos + 1 == path_size;
+
                 ++current_path_pos;
             }
 
-            const auto path_ptr = SelectBestPath(partial_paths);
+            const auto path_ptr = SelectBestPath(partial_paths_);
             if (path_ptr == nullptr) {
                 if (model_->solver()->CurrentlyInSolve()) {
                     model_->solver()->Fail();
@@ -528,144 +591,30 @@ namespace rows {
             }
             CHECK(path_ptr != nullptr);
 
-// problem 2
-//            if (vehicle == 46 && partial_paths.size() == 3) {
-//                CHECK_EQ(path_index, 2);
-//                return partial_paths[2].path;
-//            }
-// end of problem 2
-
-// problem 3
-//            if (vehicle == 12 && partial_paths.size() == 8) {
-//                CHECK_EQ(path_index, 1);
-//                return partial_paths[1].path;
-//            }
-//
-//            if (vehicle == 22 && partial_paths.size() == 3) {
-//                CHECK_EQ(path_index, 2);
-//                return partial_paths[2].path;
-//            }
-//
-//            if (vehicle == 23 && partial_paths.size() == 2) {
-//                CHECK_EQ(path_index, 1);
-//                return partial_paths[1].path;
-//            }
-//
-//            if (vehicle == 24 && partial_paths.size() == 2) {
-//                CHECK_EQ(path_index, 1);
-//                return partial_paths[1].path;
-//            }
-//
-//            if (vehicle == 26 && partial_paths.size() == 2) {
-//                CHECK_EQ(path_index, 1);
-//                return partial_paths[1].path;
-//            }
-//
-//            if (vehicle == 32 && partial_paths.size() == 3) {
-//                CHECK_EQ(path_index, 0);
-//                return partial_paths[0].path;
-//            }
-//
-//            if (vehicle == 36 && partial_paths.size() == 4) {
-//                CHECK_EQ(path_index, 1);
-//                return partial_paths[1].path;
-//            }
-//
-//            if (vehicle == 39 && partial_paths.size() == 6) {
-//                CHECK_EQ(path_index, 0);
-//                return partial_paths[0].path;
-//            }
-//
-//            if (vehicle == 43 && partial_paths.size() == 4) {
-//                CHECK_EQ(path_index, 1);
-//                return partial_paths[1].path;
-//            }
-//
-//            if (vehicle == 47 && partial_paths.size() == 2) {
-//                CHECK_EQ(path_index, 0);
-//                return partial_paths[0].path;
-//            }
-//
-//            if (vehicle == 48 && partial_paths.size() == 2) {
-//                CHECK_EQ(path_index, 1);
-//                return partial_paths[1].path;
-//            }
-//
-//            if (vehicle == 49 && partial_paths.size() == 5) {
-//                CHECK_EQ(path_index, 1);
-//                return partial_paths[1].path;
-//            }
-//
-//            if (vehicle == 50 && partial_paths.size() == 4) {
-//                CHECK_EQ(path_index, 1);
-//                return partial_paths[1].path;
-//            }
-//
-//            if (vehicle == 57 && partial_paths.size() == 4) {
-//                CHECK_EQ(path_index, 3);
-//                return partial_paths[3].path;
-//            }
-// end of problem 3
-
-// problem 12
-//            if (vehicle == 19 && partial_paths.size() == 2) {
-//                return partial_paths[1].path;
-//            }
-//
-//            if (vehicle == 24 && partial_paths.size() == 4) {
-//                return partial_paths[1].path;
-//            }
-//
-//            if (vehicle == 25 && partial_paths.size() == 2) {
-//                return partial_paths[0].path;
-//            }
-//
-//            if (vehicle == 26 && partial_paths.size() == 4) {
-//                return partial_paths[2].path;
-//            }
-//
-//            if (vehicle == 35 && partial_paths.size() == 15) {
-//                return partial_paths[11].path;
-//            }
-//
-//            if (vehicle == 36 && partial_paths.size() == 4) {
-//                return partial_paths[3].path;
-//            }
-//
-//            if (vehicle == 38 && partial_paths.size() == 3) {
-//                return partial_paths[1].path;
-//            }
-//
-//            if (vehicle == 41 && partial_paths.size() == 2) {
-//                return partial_paths[0].path;
-//            }
-//
-//            if (vehicle == 49 && partial_paths.size() == 5) {
-//                return partial_paths[4].path;
-//            }
-//
-//            if (vehicle == 54 && partial_paths.size() == 3) {
-//                return partial_paths[1].path;
-//            }
-//
-//            if (vehicle == 57 && partial_paths.size() == 2) {
-//                return partial_paths[1].path;
-//            }
-//
-//            if (vehicle == 70 && partial_paths.size() == 2) {
-//                return partial_paths[0].path;
-//            }
-// end of problem 12
-
-            if (path_ptr != nullptr) {
-                return path_ptr->path;
+            // breaks are recovered from the log, visits fill the remaining positions in the order of the route
+            path_.resize(path_size, 0);
+            for (auto log_pos = path_ptr->last_break; log_pos >= 0; log_pos = path_break_log_[log_pos].previous) {
+                const auto &entry = path_break_log_[log_pos];
+                path_[entry.path_pos] = entry.element;
+            }
+
+            std::size_t node_pos = 0;
+            for (auto &element : path_) {
+                if (element >= 0) {
+                    element = path_nodes_[node_pos];
+                    ++node_pos;
+                }
             }
-            return partial_paths[0].path;
+            DCHECK_EQ(node_pos, num_nodes);
+
+            return path_;
         }
 
         template<typename DataSource>
         void UpdatePath(int vehicle, const DataSource &data) {
-            const auto path = BuildPathFromSource<DataSource>(vehicle, data);
+            ROWS_PERF_COUNT(PerfCounter::DelayTrackerPartialPropagation);
+
+            const auto &path = BuildPathFromSource<DataSource>(vehicle, data);
             UpdatePathRecords<DataSource>(vehicle, path, data);
 
             const auto num_samples = duration_sample_.size();
@@ -740,15 +689,17 @@ namespace rows {
 
         void ComputePathDelay(int vehicle);
 
+        void ClearDelaySketch();
+
         template<typename DataSource>
         void PropagateNodeWithBreaks(int64 index, std::size_t scenario, const DataSource &data_source) {
             auto current_index = index;
             while (!model_->IsEnd(current_index)) {
                 const auto &current_record = records_[current_index];
+                CHECK_NE(current_record.next, -1);
                 const auto arrival_time = GetArrivalTimeWithBreak(current_record, scenario);
                 CHECK_LT(arrival_time, MAX_START_TIME);
                 CHECK_LE(start_[current_record.next][scenario], arrival_time);
-                CHECK_NE(current_record.next, -1);
 
                 start_[current_record.next][scenario] = arrival_time;
                 current_index = current_record.next;
@@ -763,6 +714,7 @@ namespace rows {
             auto current_index = index;
             while (!model_->IsEnd(current_index)) {
                 const auto &current_record = records_[current_index];
+                CHECK_NE(current_record.next, -1);
                 const auto arrival_time = GetArrivalTimeNoBreak(current_record, scenario);
                 if (arrival_time >= MAX_START_TIME) {
                     for (int vehicle = 0; vehicle < model_->vehicles(); ++vehicle) {
@@ -771,8 +723,6 @@ namespace rows {
                     LOG(FATAL) << "Assertion Failed";
                 }
 
-                CHECK_NE(current_record.next, -1);
-
                 if (start_[current_record.next][scenario] < arrival_time) {
                     start_[current_record.next][scenario] = arrival_time;
                     if (duration_sample_.has_sibling(current_record.next)) {
@@ -802,6 +752,13 @@ namespace rows {
         std::vector<bool> visited_;
         std::vector<std::vector<int64>> start_;
         std::vector<std::vector<int64>> delay_;
+        std::vector<DelayHistogram> delay_sketch_;
+
+        // working memory of the path builder reused by every call
+        std::vector<int64> path_;
+        std::vector<int64> path_nodes_;
+        std::vector<PartialPath> partial_paths_;
+        std::vector<BreakLogEntry> path_break_log_;
     };
 }
 
@@ -0,0 +1,42 @@
+#include "deterministic_search.h"
+
+#include <glog/logging.h>
+
+namespace rows {
+
+    DeterministicSearchOptions::DeterministicSearchOptions()
+            : DeterministicSearchOptions(kint64max, kint64max, 0) {}
+
+    DeterministicSearchOptions::DeterministicSearchOptions(int64 solution_limit, int64 branch_limit, int32 random_seed)
+            : SolutionLimit{solution_limit},
+              BranchLimit{branch_limit},
+              RandomSeed{random_seed} {}
+
+    void to_json(nlohmann::json &json, const DeterministicSearchOptions &options) {
+        json = nlohmann::json{
+                {"solution_limit", options.SolutionLimit},
+                {"branch_limit",   options.BranchLimit},
+                {"random_seed",    options.RandomSeed}
+        };
+    }
+
+    void from_json(const nlohmann::json &json, DeterministicSearchOptions &options) {
+        options.SolutionLimit = json.at("solution_limit").get<int64>();
+        options.BranchLimit = json.at("branch_limit").get<int64>();
+        options.RandomSeed = json.at("random_seed").get<int32>();
+    }
+
+    void ClearTimeLimits(operations_research::RoutingSearchParameters &parameters) {
+        parameters.clear_time_limit();
+        parameters.clear_lns_time_limit();
+    }
+
+    void ConfigureDeterministicSearch(operations_research::RoutingModel &model, const DeterministicSearchOptions &options) {
+        CHECK(options.SolutionLimit < kint64max || options.BranchLimit < kint64max)
+            << "Deterministic search requires a solution or a branch limit";
+
+        auto solver = model.solver();
+        solver->ReSeed(options.RandomSeed);
+        model.AddSearchMonitor(solver->MakeLimit(kint64max, options.BranchLimit, kint64max, options.SolutionLimit));
+    }
+}
@@ -0,0 +1,34 @@
+#ifndef ROWS_DETERMINISTIC_SEARCH_H
+#define ROWS_DETERMINISTIC_SEARCH_H
+
+#include <nlohmann/json.hpp>
+
+#include <ortools/constraint_solver/routing.h>
+#include <ortools/constraint_solver/routing_parameters.h>
+
+namespace rows {
+
+    // search limits which do not depend on the wall clock, so two runs on the same input explore the same solutions
+    struct DeterministicSearchOptions {
+        DeterministicSearchOptions();
+
+        DeterministicSearchOptions(int64 solution_limit, int64 branch_limit, int32 random_seed);
+
+        int64 SolutionLimit;
+        int64 BranchLimit;
+        int32 RandomSeed;
+    };
+
+    void to_json(nlohmann::json &json, const DeterministicSearchOptions &options);
+
+    void from_json(const nlohmann::json &json, DeterministicSearchOptions &options);
+
+    // removes the global and the large neighbourhood search time limits
+    void ClearTimeLimits(operations_research::RoutingSearchParameters &parameters);
+
+    // must be called after the model is closed
+    void ConfigureDeterministicSearch(operations_research::RoutingModel &model, const DeterministicSearchOptions &options);
+}
+
+
+#endif //ROWS_DETERMINISTIC_SEARCH_H
@@ -0,0 +1,96 @@
+#include "dropped_visit_tracker.h"
+
+#include <glog/logging.h>
+
+#include "problem_data.h"
+
+rows::DroppedVisitTracker::DroppedVisitTracker(const operations_research::RoutingModel &model,
+                                               const operations_research::RoutingIndexManager &index_manager,
+                                               const rows::ProblemData &problem_data)
+        : SearchMonitor(model.solver()),
+          model_{model},
+          evaluator_{problem_data, index_manager},
+          dropped_(static_cast<std::size_t>(model.nodes()), false),
+          last_delta_{nullptr},
+          neighbour_accepted_{false},
+          dropped_nodes_{0},
+          weighted_dropped_nodes_{0} {
+    for (int64 index = 1; index < model_.nodes(); ++index) {
+        next_indices_.emplace(model_.NextVar(index), index);
+    }
+}
+
+void rows::DroppedVisitTracker::EnterSearch() {
+    last_delta_ = nullptr;
+    neighbour_accepted_ = false;
+}
+
+bool rows::DroppedVisitTracker::AcceptDelta(operations_research::Assignment *delta,
+                                            operations_research::Assignment *deltadelta) {
+    // the delta is applied only if the neighbour is accepted, the assignment outlives the call to AcceptNeighbor
+    last_delta_ = delta;
+    return true;
+}
+
+void rows::DroppedVisitTracker::AcceptNeighbor() {
+    if (last_delta_ != nullptr) {
+        neighbour_accepted_ = ApplyDelta(*last_delta_);
+    }
+    last_delta_ = nullptr;
+}
+
+bool rows::DroppedVisitTracker::AtSolution() {
+    if (!neighbour_accepted_) {
+        // the solution was not found by local search, so there is no delta to the previous solution
+        for (int64 index = 1; index < model_.nodes(); ++index) {
+            const auto next_var = model_.NextVar(index);
+            SetDropped(index, next_var->Bound() && next_var->Value() == index);
+        }
+    }
+    neighbour_accepted_ = false;
+    return true;
+}
+
+void rows::DroppedVisitTracker::Synchronize(const operations_research::Assignment &solution) {
+    for (int64 index = 1; index < model_.nodes(); ++index) {
+        const auto next_var = model_.NextVar(index);
+        SetDropped(index, solution.Contains(next_var) && solution.Value(next_var) == index);
+    }
+}
+
+bool rows::DroppedVisitTracker::ApplyDelta(const operations_research::Assignment &delta) {
+    const auto &container = delta.IntVarContainer();
+    for (int position = 0; position < container.Size(); ++position) {
+        const auto &element = container.Element(position);
+        if (!element.Activated()) {
+            // large neighbourhood search relaxes the variable, its value is decided by a nested search later
+            return false;
+        }
+
+        const auto index_it = next_indices_.find(element.Var());
+        if (index_it != std::end(next_indices_)) {
+            SetDropped(index_it->second, element.Value() == index_it->second);
+        }
+    }
+    return true;
+}
+
+void rows::DroppedVisitTracker::SetDropped(int64 index, bool dropped) {
+    if (dropped_[index] == dropped) {
+        return;
+    }
+
+    dropped_[index] = dropped;
+    const auto sign = dropped ? 1 : -1;
+    dropped_nodes_ += sign;
+    weighted_dropped_nodes_ += sign * evaluator_.Weight(index);
+}
+
+int64 rows::DroppedVisitTracker::DroppedVisits() const {
+    DCHECK_EQ(weighted_dropped_nodes_ % 2, 0);
+    return weighted_dropped_nodes_ / 2;
+}
+
+std::string rows::DroppedVisitTracker::DebugString() const {
+    return "DroppedVisitTracker";
+}
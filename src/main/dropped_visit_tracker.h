@@ -0,0 +1,73 @@
+#ifndef ROWS_DROPPED_VISIT_TRACKER_H
+#define ROWS_DROPPED_VISIT_TRACKER_H
+
+#include <unordered_map>
+#include <vector>
+
+#include <ortools/constraint_solver/routing.h>
+#include <ortools/constraint_solver/constraint_solveri.h>
+
+#include "declined_visit_evaluator.h"
+
+namespace rows {
+
+    class ProblemData;
+
+    // maintains the number of dropped visits in the last solution, so the monitors can read the count at a solution
+    // without walking all nodes of the model
+    //
+    // solutions found by local search differ from the previous solution only by the delta of the accepted neighbour,
+    // the count is updated from the next variables in the delta; other solutions, including neighbours of large
+    // neighbourhood search operators which leave relaxed variables deactivated in the delta, are counted by a full scan
+    //
+    // the tracker must be added to the model before the monitors which read the count
+    class DroppedVisitTracker : public operations_research::SearchMonitor {
+    public:
+        DroppedVisitTracker(const operations_research::RoutingModel &model,
+                            const operations_research::RoutingIndexManager &index_manager,
+                            const ProblemData &problem_data);
+
+        void EnterSearch() override;
+
+        bool AcceptDelta(operations_research::Assignment *delta, operations_research::Assignment *deltadelta) override;
+
+        void AcceptNeighbor() override;
+
+        bool AtSolution() override;
+
+        std::string DebugString() const override;
+
+        // counts dropped nodes of the solution from scratch
+        void Synchronize(const operations_research::Assignment &solution);
+
+        // updates the count by the next variables in the delta relative to the last synchronized solution,
+        // returns false if the delta contains deactivated variables, in that case the count must be rebuilt by a full scan
+        bool ApplyDelta(const operations_research::Assignment &delta);
+
+        // number of nodes which are not visited
+        inline int64 DroppedNodes() const { return dropped_nodes_; }
+
+        // number of visits which are not performed, a visit of two carers is counted once
+        int64 DroppedVisits() const;
+
+        inline const operations_research::RoutingModel &model() const { return model_; }
+
+    private:
+        void SetDropped(int64 index, bool dropped);
+
+        const operations_research::RoutingModel &model_;
+        DeclinedVisitEvaluator evaluator_;
+
+        std::unordered_map<const operations_research::IntVar *, int64> next_indices_;
+        std::vector<bool> dropped_;
+
+        const operations_research::Assignment *last_delta_;
+        bool neighbour_accepted_;
+
+        int64 dropped_nodes_;
+        int64 weighted_dropped_nodes_;
+    };
+}
+
+
+#endif //ROWS_DROPPED_VISIT_TRACKER_H
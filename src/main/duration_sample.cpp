@@ -1,58 +1,145 @@
 #include "duration_sample.h"
 
+#include <algorithm>
+#include <numeric>
+
+#include <boost/format.hpp>
+
+rows::VisitDurationSample::VisitDurationSample(const rows::Problem &problem,
+                                               const rows::History &history,
+                                               const rows::ScenarioReductionOptions &options)
+        : dates_{},
+          weights_{},
+          total_weight_{0},
+          duration_sample_{} {
+    // build sample of historical visit durations
+    std::unordered_map<CalendarVisit, std::map<boost::gregorian::date, boost::posix_time::time_duration> > visit_samples;
+    for (const auto &visit : problem.visits()) {
+        visit_samples.emplace(visit, history.get_duration_sample(visit));
+    }
 
-rows::DurationSample::DurationSample(const rows::SolverWrapper &solver,
-                                     const rows::History &history,
-                                     const operations_research::RoutingDimension *dimension) {
-    const auto &index_manager = solver.index_manager();
+    // build index of dates
+    std::unordered_set<boost::gregorian::date> unique_dates;
+    for (const auto &visit_sample_pair: visit_samples) {
+        for (const auto &date_duration_pair : visit_sample_pair.second) {
+            unique_dates.emplace(date_duration_pair.first);
+        }
+    }
 
-    // build indexed sample of historical visit durations
-    // build mapping of sibling indices
-    std::unordered_map <int64, std::map<boost::gregorian::date, boost::posix_time::time_duration>> visit_samples;
-    for (const auto &visit : solver.problem().visits()) {
-        const auto visit_indices = index_manager.NodesToIndices(solver.GetNodes(visit));
-        CHECK_EQ(visit_indices.size(), visit.carer_count());
-        CHECK_GE(visit_indices.size(), 1);
-        CHECK_LE(visit_indices.size(), 2);
+    dates_ = std::vector<boost::gregorian::date>(std::cbegin(unique_dates), std::cend(unique_dates));
+    std::sort(std::begin(dates_), std::end(dates_));
+    const auto num_dates = dates_.size();
 
-        visit_indices_.emplace(visit_indices[0]);
-        if (visit_indices.size() == 2) {
-            visit_indices_.emplace(visit_indices[1]);
+    std::unordered_map<boost::gregorian::date, std::size_t> date_position;
+    for (std::size_t position = 0; position < num_dates; ++position) {
+        date_position[dates_[position]] = position;
+    }
 
-            sibling_index_.emplace(visit_indices[0], visit_indices[1]);
-            sibling_index_.emplace(visit_indices[1], visit_indices[0]);
+    // build matrix with visits duration: visit x date
+    std::vector<CalendarVisit> visits;
+    std::vector<std::vector<int64> > visit_durations;
+    for (const auto &visit_sample_pair : visit_samples) {
+        std::vector<int64> duration;
+        duration.resize(num_dates, visit_sample_pair.first.duration().total_seconds());
+
+        for (const auto &date_duration_pair : visit_sample_pair.second) {
+            duration.at(date_position.at(date_duration_pair.first)) = date_duration_pair.second.total_seconds();
         }
 
-        auto sample = history.get_duration_sample(visit);
+        visits.push_back(visit_sample_pair.first);
+        visit_durations.push_back(std::move(duration));
+    }
+
+    // keep dates selected as scenarios, every scenario is weighted by the number of dates it represents
+    const auto reduction = ReduceScenarios(options, dates_, visit_durations);
+    if (reduction.Scenarios.size() < num_dates) {
+        const auto error = EstimateReductionError(reduction, visit_durations);
+        LOG(INFO) << boost::format("Scenario reduction %1% keeps %2% of %3% dates."
+                                   " Error of visit duration mean: %4$.2f, max: %5$.2f, error of 90th percentile mean: %6$.2f, max %7$.2f")
+                     % options.Strategy
+                     % reduction.Scenarios.size()
+                     % num_dates
+                     % error.MeanError
+                     % error.MaxMeanError
+                     % error.MeanQuantileError
+                     % error.MaxQuantileError;
+
+        // the delay of a visit which starts on time is the time it overruns its planned duration, the delays of routes
+        // are not known before the third stage, so the overruns estimate errors of the delay statistics
+        std::vector<std::vector<int64> > visit_overruns;
+        for (std::size_t visit_pos = 0; visit_pos < visits.size(); ++visit_pos) {
+            const auto planned_duration = visits[visit_pos].duration().total_seconds();
+            std::vector<int64> overrun;
+            overrun.reserve(num_dates);
+            for (const auto duration : visit_durations[visit_pos]) {
+                overrun.push_back(duration - planned_duration);
+            }
+            visit_overruns.push_back(std::move(overrun));
+        }
 
-//        if (visit.id() == 8559516) {
-//            std::stringstream msg;
-//
-//            for (const auto &key_value_pair : sample) {
-//                msg << key_value_pair.first << ": " << key_value_pair.second << std::endl;
-//            }
-//
-//            LOG(INFO) << msg.str();
-//        }
+        const auto delay_error = EstimateDelayError(reduction, visit_overruns);
+        LOG(INFO) << boost::format("Scenario reduction %1% error of mean delay mean: %2$.2f, max: %3$.2f,"
+                                   " error of delay probability mean: %4$.2f, max: %5$.2f,"
+                                   " error of essential riskiness mean: %6$.2f, max: %7$.2f, mismatches: %8%")
+                     % options.Strategy
+                     % delay_error.MeanDelayError
+                     % delay_error.MaxMeanDelayError
+                     % delay_error.MeanDelayProbabilityError
+                     % delay_error.MaxDelayProbabilityError
+                     % delay_error.MeanRiskinessError
+                     % delay_error.MaxRiskinessError
+                     % delay_error.RiskinessMismatches;
+
+        std::vector<boost::gregorian::date> reduced_dates;
+        for (const auto position : reduction.Scenarios) {
+            reduced_dates.push_back(dates_.at(position));
+        }
+
+        for (auto &duration : visit_durations) {
+            std::vector<int64> reduced_duration;
+            reduced_duration.reserve(reduction.Scenarios.size());
+            for (const auto position : reduction.Scenarios) {
+                reduced_duration.push_back(duration.at(position));
+            }
+            duration = std::move(reduced_duration);
+        }
 
-        visit_samples.emplace(visit_indices[0], std::move(sample));
+        dates_ = std::move(reduced_dates);
     }
+    weights_ = reduction.Weights;
+    total_weight_ = std::accumulate(std::cbegin(weights_), std::cend(weights_), static_cast<int64>(0));
 
+    for (std::size_t visit_pos = 0; visit_pos < visits.size(); ++visit_pos) {
+        duration_sample_.emplace(visits[visit_pos], std::move(visit_durations[visit_pos]));
+    }
+}
 
-    // build index of dates
-    std::unordered_set <boost::gregorian::date> unique_dates;
-    for (const auto &visit_sample_pair: visit_samples) {
-        for (const auto &date_duration_pair : visit_sample_pair.second) {
-            unique_dates.emplace(date_duration_pair.first);
-        }
+const std::vector<int64> *rows::VisitDurationSample::duration(const rows::CalendarVisit &visit) const {
+    const auto visit_it = duration_sample_.find(visit);
+    if (visit_it == std::cend(duration_sample_)) {
+        return nullptr;
     }
+    return &visit_it->second;
+}
 
-    dates_ = std::vector<boost::gregorian::date>(std::cbegin(unique_dates), std::cend(unique_dates));
-    std::sort(std::begin(dates_), std::end(dates_));
-    num_dates_ = dates_.size();
+std::size_t rows::VisitDurationSample::memory_usage() const {
+    std::size_t memory = sizeof(VisitDurationSample)
+                         + dates_.capacity() * sizeof(boost::gregorian::date)
+                         + weights_.capacity() * sizeof(int64);
+    for (const auto &visit_sample_pair : duration_sample_) {
+        memory += sizeof(visit_sample_pair) + visit_sample_pair.second.capacity() * sizeof(int64);
+    }
+    return memory;
+}
+
+rows::DurationSample::DurationSample(const rows::SolverWrapper &solver,
+                                     const rows::History &history,
+                                     const operations_research::RoutingDimension *dimension) {
+    const auto &index_manager = solver.index_manager();
 
-    for (std::size_t position = 0; position < num_dates_; ++position) {
-        date_position_[dates_[position]] = position;
+    visit_sample_ = solver.duration_sample();
+    if (!visit_sample_) {
+        visit_sample_ = std::make_shared<const VisitDurationSample>(solver.problem(), history, solver.scenario_reduction_options());
     }
 
     start_min_.resize(index_manager.num_indices());
@@ -62,29 +149,27 @@ rows::DurationSample::DurationSample(const rows::SolverWrapper &solver,
         start_max_.at(index) = dimension->CumulVar(index)->Max();
     }
 
-    // build matrix with visits duration: visit index x date
-    duration_sample_.resize(solver.index_manager().num_indices());
-    for (const auto &visit_index_sample_pair : visit_samples) {
-        const auto &default_visit = solver.NodeToVisit(index_manager.IndexToNode(visit_index_sample_pair.first));
-        const auto default_duration = default_visit.duration().total_seconds();
-
-        std::vector <int64> duration;
-        duration.resize(num_dates_, default_duration);
+    // map indices of the routing model to rows of the shared sample, siblings share the row
+    // build mapping of sibling indices
+    zero_duration_ = std::make_shared<const std::vector<int64> >(visit_sample_->size(), 0);
+    index_duration_.resize(index_manager.num_indices(), zero_duration_.get());
+    for (const auto &visit : solver.problem().visits()) {
+        const auto visit_indices = index_manager.NodesToIndices(solver.GetNodes(visit));
+        CHECK_EQ(visit_indices.size(), visit.carer_count());
+        CHECK_GE(visit_indices.size(), 1);
+        CHECK_LE(visit_indices.size(), 2);
 
-        for (const auto &date_duration_pair : visit_index_sample_pair.second) {
-            duration.at(date_position_.at(date_duration_pair.first)) = date_duration_pair.second.total_seconds();
-        }
+        const auto visit_duration = visit_sample_->duration(visit);
+        CHECK(visit_duration != nullptr) << "Visit " << visit.id() << " is not in the shared sample of durations";
 
-        duration_sample_.at(visit_index_sample_pair.first) = std::move(duration);
-        const auto sibling_index_it = sibling_index_.find(visit_index_sample_pair.first);
-        if (sibling_index_it != std::cend(sibling_index_)) {
-            duration_sample_.at(sibling_index_it->second) = duration_sample_.at(sibling_index_it->first);
+        for (const auto index : visit_indices) {
+            visit_indices_.emplace(index);
+            index_duration_.at(index) = visit_duration;
         }
-    }
 
-    for (auto index = 0; index < index_manager.num_indices(); ++index) {
-        if (duration_sample_.at(index).empty()) {
-            duration_sample_.at(index).resize(num_dates_, 0);
+        if (visit_indices.size() == 2) {
+            sibling_index_.emplace(visit_indices[0], visit_indices[1]);
+            sibling_index_.emplace(visit_indices[1], visit_indices[0]);
         }
     }
 }
@@ -1,20 +1,58 @@
 #ifndef ROWS_DURATION_SAMPLE_H
 #define ROWS_DURATION_SAMPLE_H
 
+#include <memory>
+#include <unordered_map>
+#include <vector>
 
 #include <ortools/constraint_solver/routing.h>
 
+#include "calendar_visit.h"
 #include "history.h"
+#include "problem.h"
 #include "problem_data.h"
+#include "scenario_reduction.h"
 #include "solver_wrapper.h"
 
 namespace rows {
 
+    // historical durations of visits of a problem, which do not depend on the routing model,
+    // so the sample is built once and shared by delay trackers of all stages
+    class VisitDurationSample {
+    public:
+        VisitDurationSample(const Problem &problem, const History &history, const ScenarioReductionOptions &options);
+
+        inline std::size_t size() const { return dates_.size(); }
+
+        inline std::size_t num_visits() const { return duration_sample_.size(); }
+
+        inline const std::vector<boost::gregorian::date> &dates() const { return dates_; }
+
+        inline const std::vector<int64> &weights() const { return weights_; }
+
+        inline int64 total_weight() const { return total_weight_; }
+
+        // returns nullptr if the visit is not in the problem
+        const std::vector<int64> *duration(const CalendarVisit &visit) const;
+
+        std::size_t memory_usage() const;
+
+    private:
+        std::vector<boost::gregorian::date> dates_;
+        std::vector<int64> weights_;
+        int64 total_weight_;
+
+        // date -> duration in seconds
+        std::unordered_map<CalendarVisit, std::vector<int64> > duration_sample_;
+    };
+
+    // historical durations of visits indexed by nodes of the routing model
     class DurationSample {
     public:
+        // the history is used only if the solver does not share a sample of visit durations
         DurationSample(const SolverWrapper &solver, const History &history, const operations_research::RoutingDimension *dimension);
 
-        inline std::size_t size() const { return num_dates_; }
+        inline std::size_t size() const { return visit_sample_->size(); }
 
         inline std::size_t num_indices() const { return start_min_.size(); }
 
@@ -22,9 +60,16 @@ namespace rows {
 
         inline int64 start_max(int64 index) const { return start_max_.at(index); }
 
-        inline int64 duration(int64 index, std::size_t scenario) const { return duration_sample_.at(index).at(scenario); }
+        inline int64 duration(int64 index, std::size_t scenario) const { return index_duration_.at(index)->at(scenario); }
+
+        inline const std::vector<int64> &duration(int64 index) const { return *index_duration_.at(index); }
 
-        inline const std::vector<int64> &duration(int64 index) const { return duration_sample_.at(index); }
+        // number of historical dates represented by the scenario
+        inline int64 weight(std::size_t scenario) const { return visit_sample_->weights().at(scenario); }
+
+        inline const std::vector<int64> &weights() const { return visit_sample_->weights(); }
+
+        inline int64 total_weight() const { return visit_sample_->total_weight(); }
 
         inline bool is_visit(int64 index) const { return visit_indices_.find(index) != std::cend(visit_indices_); }
 
@@ -33,15 +78,14 @@ namespace rows {
         int64 sibling(int64 index) const;
 
     private:
-        std::vector<boost::gregorian::date> dates_;
-        std::size_t num_dates_;
-
-        std::unordered_map<boost::gregorian::date, std::size_t> date_position_;
+        std::shared_ptr<const VisitDurationSample> visit_sample_;
 
         std::vector<int64> start_min_;
         std::vector<int64> start_max_;
 
-        std::vector<std::vector<int64> > duration_sample_;
+        // rows of the shared sample, indices which are not visits point to the row of zeros
+        std::vector<const std::vector<int64> *> index_duration_;
+        std::shared_ptr<const std::vector<int64> > zero_duration_;
 
         std::unordered_map<int64, int64> sibling_index_;
         std::unordered_set<int64> visit_indices_;
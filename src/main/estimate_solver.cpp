@@ -104,8 +104,9 @@ namespace rows {
                                                                       - start_time_model_closing).count();
 
         auto solver_ptr = model.solver();
-        model.AddSearchMonitor(solver_ptr->RevAlloc(new ProgressPrinterMonitor(model, index_manager_, problem_data_, printer, cost_normalization_factor)));
-        model.AddSearchMonitor(solver_ptr->RevAlloc(new MinDroppedVisitsSolutionCollector(&model, true)));
+        const auto dropped_visit_tracker = AddDroppedVisitTracker(model);
+        model.AddSearchMonitor(solver_ptr->RevAlloc(new ProgressPrinterMonitor(model, index_manager_, problem_data_, printer, cost_normalization_factor, dropped_visit_tracker)));
+        model.AddSearchMonitor(solver_ptr->RevAlloc(new MinDroppedVisitsSolutionCollector(&model, dropped_visit_tracker, true)));
         model.AddSearchMonitor(solver_ptr->RevAlloc(new CancelSearchLimit(cancel_token, solver_ptr)));
 
         if (!no_progress_time_limit_.is_special() && no_progress_time_limit_.total_seconds() > 0) {
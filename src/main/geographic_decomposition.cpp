@@ -0,0 +1,509 @@
+#include "geographic_decomposition.h"
+
+#include <algorithm>
+#include <numeric>
+#include <unordered_map>
+
+#include <glog/logging.h>
+
+namespace rows {
+
+    DecompositionOptions::DecompositionOptions()
+            : DecompositionOptions(0, 1) {}
+
+    DecompositionOptions::DecompositionOptions(std::size_t clusters, std::size_t threads)
+            : Clusters{clusters},
+              Threads{threads},
+              MaxIterations{100},
+              TimeShare{0.5},
+              Seed{1} {}
+
+    std::vector<std::size_t> KMedoids(const std::vector<std::vector<int64> > &distances,
+                                      const std::vector<int64> &weights,
+                                      std::size_t clusters,
+                                      std::size_t max_iterations,
+                                      std::mt19937 &random_engine) {
+        const auto num_points = distances.size();
+        CHECK_EQ(weights.size(), num_points);
+
+        std::vector<std::size_t> point_cluster(num_points, 0);
+        const auto num_clusters = std::min(clusters, num_points);
+        if (num_clusters <= 1) {
+            return point_cluster;
+        }
+
+        // travel times are not symmetric, so the distance between points is the duration of the journey there and back
+        const auto distance = [&distances](std::size_t left, std::size_t right) -> int64 {
+            return distances[left][right] + distances[right][left];
+        };
+
+        // seeding of k-means++, the next medoid is selected with probability proportional to the weighted distance
+        // to the nearest medoid selected so far
+        std::vector<std::size_t> medoids;
+        medoids.reserve(num_clusters);
+        {
+            std::vector<double> seed_weights(num_points);
+            for (std::size_t point = 0; point < num_points; ++point) {
+                seed_weights[point] = static_cast<double>(std::max(weights[point], static_cast<int64>(1)));
+            }
+
+            std::vector<bool> is_medoid(num_points, false);
+            while (medoids.size() < num_clusters) {
+                std::size_t medoid = num_points;
+                if (std::accumulate(std::cbegin(seed_weights), std::cend(seed_weights), 0.0) > 0.0) {
+                    std::discrete_distribution<std::size_t> distribution{std::cbegin(seed_weights), std::cend(seed_weights)};
+                    medoid = distribution(random_engine);
+                } else {
+                    // remaining points share locations with medoids
+                    medoid = static_cast<std::size_t>(std::find(std::cbegin(is_medoid), std::cend(is_medoid), false)
+                                                      - std::cbegin(is_medoid));
+                }
+                CHECK_LT(medoid, num_points);
+
+                medoids.push_back(medoid);
+                is_medoid[medoid] = true;
+                for (std::size_t point = 0; point < num_points; ++point) {
+                    if (is_medoid[point]) {
+                        seed_weights[point] = 0.0;
+                        continue;
+                    }
+
+                    auto nearest_distance = distance(point, medoids.front());
+                    for (const auto other_medoid : medoids) {
+                        nearest_distance = std::min(nearest_distance, distance(point, other_medoid));
+                    }
+                    seed_weights[point] = static_cast<double>(std::max(weights[point], static_cast<int64>(1)))
+                                          * static_cast<double>(nearest_distance);
+                }
+            }
+        }
+
+        std::vector<std::vector<std::size_t> > members(num_clusters);
+        for (std::size_t iteration = 0; iteration < max_iterations; ++iteration) {
+            for (auto &cluster_members : members) {
+                cluster_members.clear();
+            }
+
+            for (std::size_t point = 0; point < num_points; ++point) {
+                std::size_t nearest_cluster = 0;
+                auto nearest_distance = distance(point, medoids[0]);
+                for (std::size_t cluster = 1; cluster < num_clusters; ++cluster) {
+                    const auto cluster_distance = distance(point, medoids[cluster]);
+                    if (cluster_distance < nearest_distance) {
+                        nearest_cluster = cluster;
+                        nearest_distance = cluster_distance;
+                    }
+                }
+
+                point_cluster[point] = nearest_cluster;
+                members[nearest_cluster].push_back(point);
+            }
+
+            auto medoids_changed = false;
+            for (std::size_t cluster = 0; cluster < num_clusters; ++cluster) {
+                auto best_medoid = medoids[cluster];
+                auto best_cost = std::numeric_limits<int64>::max();
+                for (const auto candidate : members[cluster]) {
+                    int64 cost = 0;
+                    for (const auto member : members[cluster]) {
+                        cost += weights[member] * distance(candidate, member);
+                    }
+
+                    if (cost < best_cost || (cost == best_cost && candidate == medoids[cluster])) {
+                        best_cost = cost;
+                        best_medoid = candidate;
+                    }
+                }
+
+                if (best_medoid != medoids[cluster]) {
+                    medoids[cluster] = best_medoid;
+                    medoids_changed = true;
+                }
+            }
+
+            if (!medoids_changed) {
+                break;
+            }
+        }
+
+        return point_cluster;
+    }
+
+    std::vector<std::size_t> AssignCarersToClusters(const std::vector<std::vector<int64> > &cluster_demand,
+                                                    const std::vector<std::vector<int64> > &carer_availability,
+                                                    const std::vector<std::size_t> &min_carers) {
+        const auto num_clusters = cluster_demand.size();
+        const auto num_carers = carer_availability.size();
+        CHECK_EQ(min_carers.size(), num_clusters);
+        CHECK_GT(num_clusters, 0);
+
+        auto remaining_demand = cluster_demand;
+        const auto get_overlap = [&remaining_demand, &carer_availability](std::size_t cluster, std::size_t carer) -> int64 {
+            const auto &demand = remaining_demand[cluster];
+            const auto &availability = carer_availability[carer];
+            DCHECK_EQ(demand.size(), availability.size());
+
+            int64 overlap = 0;
+            for (std::size_t slot = 0; slot < demand.size(); ++slot) {
+                overlap += std::min(availability[slot], std::max(demand[slot], static_cast<int64>(0)));
+            }
+            return overlap;
+        };
+
+        const auto get_total_demand = [&remaining_demand](std::size_t cluster) -> int64 {
+            int64 total_demand = 0;
+            for (const auto demand : remaining_demand[cluster]) {
+                total_demand += std::max(demand, static_cast<int64>(0));
+            }
+            return total_demand;
+        };
+
+        static const auto NOT_ASSIGNED = std::numeric_limits<std::size_t>::max();
+        std::vector<std::size_t> carer_cluster(num_carers, NOT_ASSIGNED);
+        std::vector<std::size_t> cluster_size(num_clusters, 0);
+        const auto assign = [&](std::size_t carer, std::size_t cluster) -> void {
+            carer_cluster[carer] = cluster;
+            ++cluster_size[cluster];
+
+            auto &demand = remaining_demand[cluster];
+            const auto &availability = carer_availability[carer];
+            for (std::size_t slot = 0; slot < demand.size(); ++slot) {
+                demand[slot] -= availability[slot];
+            }
+        };
+
+        // carers who are available for longer are assigned first
+        std::vector<std::size_t> carers(num_carers);
+        std::iota(std::begin(carers), std::end(carers), 0);
+        std::vector<int64> total_availability(num_carers, 0);
+        for (std::size_t carer = 0; carer < num_carers; ++carer) {
+            total_availability[carer] = std::accumulate(std::cbegin(carer_availability[carer]),
+                                                        std::cend(carer_availability[carer]),
+                                                        static_cast<int64>(0));
+        }
+        std::stable_sort(std::begin(carers), std::end(carers), [&total_availability](std::size_t left, std::size_t right) -> bool {
+            return total_availability[left] > total_availability[right];
+        });
+
+        std::vector<std::size_t> clusters(num_clusters);
+        std::iota(std::begin(clusters), std::end(clusters), 0);
+        std::stable_sort(std::begin(clusters), std::end(clusters), [&get_total_demand](std::size_t left, std::size_t right) -> bool {
+            return get_total_demand(left) > get_total_demand(right);
+        });
+
+        for (const auto cluster : clusters) {
+            while (cluster_size[cluster] < min_carers[cluster]) {
+                auto best_carer = NOT_ASSIGNED;
+                int64 best_overlap = -1;
+                for (const auto carer : carers) {
+                    if (carer_cluster[carer] != NOT_ASSIGNED) {
+                        continue;
+                    }
+
+                    const auto overlap = get_overlap(cluster, carer);
+                    if (overlap > best_overlap) {
+                        best_carer = carer;
+                        best_overlap = overlap;
+                    }
+                }
+
+                if (best_carer == NOT_ASSIGNED) {
+                    break;
+                }
+                assign(best_carer, cluster);
+            }
+        }
+
+        for (const auto carer : carers) {
+            if (carer_cluster[carer] != NOT_ASSIGNED) {
+                continue;
+            }
+
+            auto best_cluster = clusters.front();
+            auto best_overlap = get_overlap(best_cluster, carer);
+            auto best_demand = get_total_demand(best_cluster);
+            for (const auto cluster : clusters) {
+                const auto overlap = get_overlap(cluster, carer);
+                const auto demand = get_total_demand(cluster);
+                if (overlap > best_overlap || (overlap == best_overlap && demand > best_demand)) {
+                    best_cluster = cluster;
+                    best_overlap = overlap;
+                    best_demand = demand;
+                }
+            }
+            assign(carer, best_cluster);
+        }
+
+        return carer_cluster;
+    }
+
+    const boost::posix_time::time_duration GeographicDecomposition::TIME_SLOT = boost::posix_time::minutes(30);
+
+    GeographicDecomposition::GeographicDecomposition(DecompositionOptions options)
+            : options_{options} {}
+
+    std::size_t GeographicDecomposition::NumTimeSlots() {
+        return static_cast<std::size_t>(boost::posix_time::hours(24).total_seconds() / TIME_SLOT.total_seconds());
+    }
+
+    std::vector<int64> GeographicDecomposition::GetTimeSlots(const boost::posix_time::time_period &period,
+                                                             boost::gregorian::date date) const {
+        const auto num_slots = NumTimeSlots();
+
+        std::vector<int64> slots(num_slots, 0);
+        const boost::posix_time::ptime day_begin{date};
+        for (std::size_t slot = 0; slot < num_slots; ++slot) {
+            const boost::posix_time::time_period slot_period{day_begin + TIME_SLOT * static_cast<int>(slot), TIME_SLOT};
+            const auto overlap = slot_period.intersection(period);
+            if (!overlap.is_null()) {
+                slots[slot] = overlap.length().total_seconds();
+            }
+        }
+        return slots;
+    }
+
+    std::vector<Problem> GeographicDecomposition::Decompose(const ProblemData &problem_data) const {
+        const auto &problem = problem_data.problem();
+        if (problem.visits().empty() || options_.Clusters < 2) {
+            return {problem};
+        }
+
+        // every service user is represented by the routing node of one of their visits
+        std::unordered_map<ServiceUser, std::size_t> service_user_index;
+        std::vector<operations_research::RoutingNodeIndex> service_user_nodes;
+        std::vector<int64> service_user_workload;
+        for (const auto &visit : problem.visits()) {
+            const auto find_it = service_user_index.find(visit.service_user());
+            std::size_t index = 0;
+            if (find_it == std::end(service_user_index)) {
+                index = service_user_nodes.size();
+                service_user_index.emplace(visit.service_user(), index);
+                service_user_nodes.push_back(problem_data.GetNodes(visit).front());
+                service_user_workload.push_back(0);
+            } else {
+                index = find_it->second;
+            }
+
+            service_user_workload[index] += visit.duration().total_seconds() * visit.carer_count();
+        }
+
+        const auto num_service_users = service_user_nodes.size();
+        std::vector<std::vector<int64> > distances(num_service_users, std::vector<int64>(num_service_users, 0));
+        for (std::size_t from = 0; from < num_service_users; ++from) {
+            for (std::size_t to = 0; to < num_service_users; ++to) {
+                if (from != to) {
+                    distances[from][to] = problem_data.Distance(service_user_nodes[from], service_user_nodes[to]);
+                }
+            }
+        }
+
+        std::mt19937 random_engine{options_.Seed};
+        const auto service_user_cluster = KMedoids(distances,
+                                                   service_user_workload,
+                                                   options_.Clusters,
+                                                   options_.MaxIterations,
+                                                   random_engine);
+        const auto num_clusters = *std::max_element(std::cbegin(service_user_cluster), std::cend(service_user_cluster)) + 1;
+
+        const auto date = problem.Timespan().first.date();
+        std::vector<std::vector<int64> > cluster_demand(num_clusters, std::vector<int64>(NumTimeSlots(), 0));
+        std::vector<std::size_t> min_carers(num_clusters, 0);
+        for (const auto &visit : problem.visits()) {
+            const auto cluster = service_user_cluster[service_user_index.at(visit.service_user())];
+            const auto visit_slots = GetTimeSlots(boost::posix_time::time_period{visit.datetime(), visit.duration()}, date);
+            for (std::size_t slot = 0; slot < visit_slots.size(); ++slot) {
+                cluster_demand[cluster][slot] += visit_slots[slot] * visit.carer_count();
+            }
+
+            min_carers[cluster] = std::max(min_carers[cluster], static_cast<std::size_t>(visit.carer_count()));
+        }
+
+        // carers without a diary on the scheduling day cannot perform any visit
+        std::vector<std::size_t> working_carers;
+        std::vector<std::vector<int64> > carer_availability;
+        for (std::size_t carer_index = 0; carer_index < problem.carers().size(); ++carer_index) {
+            const auto diary = problem.diary(problem.carers()[carer_index].first, date);
+            if (!diary) {
+                continue;
+            }
+
+            std::vector<int64> availability(NumTimeSlots(), 0);
+            for (const auto &event : diary->events()) {
+                const auto event_slots = GetTimeSlots(event.period(), date);
+                for (std::size_t slot = 0; slot < event_slots.size(); ++slot) {
+                    availability[slot] += event_slots[slot];
+                }
+            }
+
+            working_carers.push_back(carer_index);
+            carer_availability.emplace_back(std::move(availability));
+        }
+
+        const auto carer_cluster = AssignCarersToClusters(cluster_demand, carer_availability, min_carers);
+
+        std::vector<std::vector<CalendarVisit> > cluster_visits(num_clusters);
+        for (const auto &visit : problem.visits()) {
+            cluster_visits[service_user_cluster[service_user_index.at(visit.service_user())]].push_back(visit);
+        }
+
+        std::vector<std::vector<std::pair<Carer, std::vector<Diary> > > > cluster_carers(num_clusters);
+        for (std::size_t position = 0; position < working_carers.size(); ++position) {
+            cluster_carers[carer_cluster[position]].push_back(problem.carers()[working_carers[position]]);
+        }
+
+        std::vector<std::vector<ExtendedServiceUser> > cluster_service_users(num_clusters);
+        for (const auto &service_user : problem.service_users()) {
+            const auto find_it = service_user_index.find(service_user);
+            if (find_it != std::end(service_user_index)) {
+                cluster_service_users[service_user_cluster[find_it->second]].push_back(service_user);
+            }
+        }
+
+        std::vector<Problem> sub_problems;
+        for (std::size_t cluster = 0; cluster < num_clusters; ++cluster) {
+            VLOG(1) << boost::format("Cluster %1%: %2% service users, %3% visits, %4% carers")
+                       % cluster
+                       % cluster_service_users[cluster].size()
+                       % cluster_visits[cluster].size()
+                       % cluster_carers[cluster].size();
+
+            sub_problems.emplace_back(std::move(cluster_visits[cluster]),
+                                      std::move(cluster_carers[cluster]),
+                                      std::move(cluster_service_users[cluster]));
+        }
+        return sub_problems;
+    }
+
+    std::vector<std::vector<int64> > MergeClusterRoutes(const std::vector<std::vector<ClusterRoute> > &cluster_routes,
+                                                        const SolverWrapper &solver) {
+        static const int64 SIBLING_PLACEHOLDER = -1;
+
+        struct SiblingPosition {
+            int Vehicle;
+            std::size_t Position;
+        };
+
+        std::vector<std::vector<int64> > routes{static_cast<std::size_t>(solver.vehicles())};
+        std::unordered_map<std::size_t, std::vector<SiblingPosition> > sibling_positions;
+        std::unordered_map<std::size_t, std::vector<int64> > sibling_indices;
+        for (const auto &carer_routes : cluster_routes) {
+            for (const auto &carer_route : carer_routes) {
+                const auto vehicle = solver.Vehicle(carer_route.first);
+                auto &route = routes.at(static_cast<std::size_t>(vehicle));
+                for (const auto &visit : carer_route.second) {
+                    const auto &visit_nodes = solver.GetNodes(visit);
+                    auto visit_indices = solver.index_manager().NodesToIndices(visit_nodes);
+                    if (visit_indices.size() == 1) {
+                        route.push_back(visit_indices.front());
+                        continue;
+                    }
+
+                    CHECK_EQ(visit_indices.size(), 2);
+                    sibling_positions[visit.id()].push_back({vehicle, route.size()});
+                    sibling_indices[visit.id()] = std::move(visit_indices);
+                    route.push_back(SIBLING_PLACEHOLDER);
+                }
+            }
+        }
+
+        for (auto &visit_positions : sibling_positions) {
+            auto &positions = visit_positions.second;
+            if (positions.size() != 2 || positions[0].Vehicle == positions[1].Vehicle) {
+                continue;
+            }
+
+            if (positions[0].Vehicle > positions[1].Vehicle) {
+                std::swap(positions[0], positions[1]);
+            }
+
+            auto visit_indices = sibling_indices.at(visit_positions.first);
+            std::sort(std::begin(visit_indices), std::end(visit_indices));
+            for (std::size_t carer_index = 0; carer_index < positions.size(); ++carer_index) {
+                routes[positions[carer_index].Vehicle][positions[carer_index].Position] = visit_indices[carer_index];
+            }
+        }
+
+        for (auto &route : routes) {
+            route.erase(std::remove(std::begin(route), std::end(route), SIBLING_PLACEHOLDER), std::end(route));
+        }
+
+        return routes;
+    }
+
+    std::vector<std::vector<int64> > RepairClusterRoutes(const std::vector<std::vector<int64> > &routes,
+                                                         operations_research::RoutingModel &model,
+                                                         const SolverWrapper &solver) {
+        if (model.ReadAssignmentFromRoutes(routes, true) != nullptr) {
+            return routes;
+        }
+
+        const auto &index_manager = solver.index_manager();
+        const auto has_sibling = [&solver, &index_manager](int64 index) -> bool {
+            return solver.problem_data().GetNodes(index_manager.IndexToNode(index)).size() > 1;
+        };
+
+        std::vector<bool> accepted(static_cast<std::size_t>(index_manager.num_indices()), false);
+        const auto get_accepted_routes = [&routes, &accepted]() -> std::vector<std::vector<int64> > {
+            std::vector<std::vector<int64> > accepted_routes{routes.size()};
+            for (std::size_t vehicle = 0; vehicle < routes.size(); ++vehicle) {
+                for (const auto index : routes[vehicle]) {
+                    if (accepted[index]) {
+                        accepted_routes[vehicle].push_back(index);
+                    }
+                }
+            }
+            return accepted_routes;
+        };
+
+        std::size_t rejected_routes = 0;
+        for (const auto &route : routes) {
+            for (const auto index : route) {
+                accepted[index] = !has_sibling(index);
+            }
+
+            if (model.ReadAssignmentFromRoutes(get_accepted_routes(), true) == nullptr) {
+                for (const auto index : route) {
+                    accepted[index] = false;
+                }
+                ++rejected_routes;
+            }
+        }
+
+        std::unordered_map<int64, int64> sibling_indices;
+        for (const auto &route : routes) {
+            for (const auto index : route) {
+                if (has_sibling(index)) {
+                    const auto visit_indices = index_manager.NodesToIndices(
+                            solver.problem_data().GetNodes(index_manager.IndexToNode(index)));
+                    sibling_indices[index] = visit_indices[0] == index ? visit_indices[1] : visit_indices[0];
+                }
+            }
+        }
+
+        std::size_t rejected_visits = 0;
+        for (const auto &route : routes) {
+            for (const auto index : route) {
+                if (accepted[index] || !has_sibling(index)) {
+                    continue;
+                }
+
+                const auto sibling_index = sibling_indices.at(index);
+                accepted[index] = true;
+                accepted[sibling_index] = true;
+                if (model.ReadAssignmentFromRoutes(get_accepted_routes(), true) == nullptr) {
+                    accepted[index] = false;
+                    accepted[sibling_index] = false;
+                    ++rejected_visits;
+                }
+            }
+        }
+
+        LOG(INFO) << boost::format("Repaired merged routes of clusters by removing %1% routes and %2% visits of two carers")
+                     % rejected_routes
+                     % rejected_visits;
+
+        auto repaired_routes = get_accepted_routes();
+        CHECK(model.ReadAssignmentFromRoutes(repaired_routes, true) != nullptr);
+        return repaired_routes;
+    }
+}
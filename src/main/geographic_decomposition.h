@@ -0,0 +1,90 @@
+#ifndef ROWS_GEOGRAPHIC_DECOMPOSITION_H
+#define ROWS_GEOGRAPHIC_DECOMPOSITION_H
+
+#include <random>
+#include <utility>
+#include <vector>
+
+#include <boost/date_time.hpp>
+
+#include <ortools/constraint_solver/routing.h>
+
+#include "problem.h"
+#include "problem_data.h"
+#include "solver_wrapper.h"
+
+namespace rows {
+
+    // splitting of a large problem into clusters of service users and carers that are solved independently
+    struct DecompositionOptions {
+        DecompositionOptions();
+
+        DecompositionOptions(std::size_t clusters, std::size_t threads);
+
+        // number of clusters, the decomposition is disabled if smaller than two
+        std::size_t Clusters;
+
+        // number of clusters solved at the same time
+        std::size_t Threads;
+
+        // maximum number of reassignments of service users to medoids
+        std::size_t MaxIterations;
+
+        // share of the time limits of the second stage given to the search of every cluster,
+        // the second stage which improves the merged routes is left with the remaining time
+        double TimeShare;
+
+        uint32_t Seed;
+    };
+
+    // partitions points into clusters around medoids, the medoid of a cluster minimizes the weighted travel time
+    // to other members and back; returns the cluster of every point
+    std::vector<std::size_t> KMedoids(const std::vector<std::vector<int64> > &distances,
+                                      const std::vector<int64> &weights,
+                                      std::size_t clusters,
+                                      std::size_t max_iterations,
+                                      std::mt19937 &random_engine);
+
+    // assigns every carer to the cluster whose uncovered demand overlaps the most with the availability of the carer,
+    // demand and availability are given in the same time slots; clusters receive their minimum number of carers first
+    std::vector<std::size_t> AssignCarersToClusters(const std::vector<std::vector<int64> > &cluster_demand,
+                                                    const std::vector<std::vector<int64> > &carer_availability,
+                                                    const std::vector<std::size_t> &min_carers);
+
+    // route of a carer in a cluster
+    using ClusterRoute = std::pair<Carer, std::vector<CalendarVisit> >;
+
+    // converts routes of clusters into indices of the solver of the whole problem, the lower index of a visit
+    // performed by two carers is assigned to the carer with the lower vehicle number as required by the model,
+    // a visit which was not performed by two distinct carers of a cluster is left out
+    std::vector<std::vector<int64> > MergeClusterRoutes(const std::vector<std::vector<ClusterRoute> > &cluster_routes,
+                                                        const SolverWrapper &solver);
+
+    // routes of a cluster are feasible on their own, so a conflict of merged routes is caused by a visit of two carers,
+    // hence routes which are not accepted by the model are restored from visits of a single carer first
+    // and visits of two carers are added back one by one; returns routes accepted by the model
+    std::vector<std::vector<int64> > RepairClusterRoutes(const std::vector<std::vector<int64> > &routes,
+                                                         operations_research::RoutingModel &model,
+                                                         const SolverWrapper &solver);
+
+    class GeographicDecomposition {
+    public:
+        explicit GeographicDecomposition(DecompositionOptions options);
+
+        // every visit and every carer with a diary on the scheduling day belongs to exactly one sub problem,
+        // all carers of a visit belong to the same cluster, so visits which require two carers are never split
+        std::vector<Problem> Decompose(const ProblemData &problem_data) const;
+
+    private:
+        static const boost::posix_time::time_duration TIME_SLOT;
+
+        static std::size_t NumTimeSlots();
+
+        std::vector<int64> GetTimeSlots(const boost::posix_time::time_period &period, boost::gregorian::date date) const;
+
+        DecompositionOptions options_;
+    };
+}
+
+
+#endif //ROWS_GEOGRAPHIC_DECOMPOSITION_H
@@ -0,0 +1,96 @@
+#include "improvement_rate_search_limit.h"
+
+#include <glog/logging.h>
+
+#include <boost/format.hpp>
+
+#include "util/routing.h"
+
+static const std::size_t MAX_SAMPLES = 256;
+
+rows::ImprovementRateSearchLimit::ImprovementRateSearchLimit(TimeAllocation allocation,
+                                                             int64 window_ms,
+                                                             double min_improvement,
+                                                             operations_research::RoutingModel *model,
+                                                             operations_research::Solver *const solver)
+        : SearchLimit(solver),
+          allocation_{std::move(allocation)},
+          window_ms_{window_ms},
+          min_improvement_{min_improvement},
+          model_{model},
+          improvement_rate_{window_ms, MAX_SAMPLES},
+          extension_logged_{false},
+          stopped_{false} {}
+
+bool rows::ImprovementRateSearchLimit::Check() {
+    // return true if solver should stop
+    if (stopped_) {
+        return true;
+    }
+
+    // stages must always return a solution
+    if (improvement_rate_.empty()) {
+        return false;
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    if (now >= allocation_.Latest) {
+        return Stop("the latest time of the stage expired");
+    }
+
+    const auto improvement = improvement_rate_.RelativeImprovement(NowMs());
+    if (now < allocation_.Allocated) {
+        if (improvement && *improvement < min_improvement_) {
+            return Stop((boost::format("the objective improved by %1% over the window before the allocation expired") % *improvement).str());
+        }
+        return false;
+    }
+
+    if (improvement && *improvement < min_improvement_) {
+        return Stop((boost::format("the allocation expired and the objective improved by %1% over the window") % *improvement).str());
+    }
+
+    if (!extension_logged_) {
+        extension_logged_ = true;
+        LOG(INFO) << boost::format("Time budget: %1% continues after its allocation because the objective still improves") % allocation_.Stage;
+    }
+    return false;
+}
+
+void rows::ImprovementRateSearchLimit::Init() {}
+
+void rows::ImprovementRateSearchLimit::Copy(const operations_research::SearchLimit *limit) {
+    const auto prototype_limit_to_use = reinterpret_cast<const rows::ImprovementRateSearchLimit *>(limit);
+    allocation_ = prototype_limit_to_use->allocation_;
+    window_ms_ = prototype_limit_to_use->window_ms_;
+    min_improvement_ = prototype_limit_to_use->min_improvement_;
+    improvement_rate_ = prototype_limit_to_use->improvement_rate_;
+    extension_logged_ = prototype_limit_to_use->extension_logged_;
+    stopped_ = prototype_limit_to_use->stopped_;
+}
+
+operations_research::SearchLimit *rows::ImprovementRateSearchLimit::MakeClone() const {
+    return solver()->RevAlloc(new ImprovementRateSearchLimit(allocation_, window_ms_, min_improvement_, model_, solver()));
+}
+
+void rows::ImprovementRateSearchLimit::EnterSearch() {
+    improvement_rate_ = ImprovementRate{window_ms_, MAX_SAMPLES};
+    stopped_ = false;
+
+    operations_research::SearchLimit::EnterSearch();
+}
+
+bool rows::ImprovementRateSearchLimit::AtSolution() {
+    improvement_rate_.Add(NowMs(), util::Cost(*model_));
+    return SearchLimit::AtSolution();
+}
+
+int64 rows::ImprovementRateSearchLimit::NowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+bool rows::ImprovementRateSearchLimit::Stop(const std::string &reason) {
+    LOG(INFO) << boost::format("Time budget: %1% stops because %2%") % allocation_.Stage % reason;
+    stopped_ = true;
+    return true;
+}
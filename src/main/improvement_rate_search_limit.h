@@ -0,0 +1,53 @@
+#ifndef ROWS_IMPROVEMENT_RATE_SEARCH_LIMIT_H
+#define ROWS_IMPROVEMENT_RATE_SEARCH_LIMIT_H
+
+#include <ortools/constraint_solver/constraint_solver.h>
+#include <ortools/constraint_solver/routing.h>
+
+#include "time_budget.h"
+
+namespace rows {
+
+    // stops the search of a stage which converged or exceeded its share of the time budget
+    //
+    // before the allocation expires the search stops if the objective improves by less than the minimum over the window,
+    // afterwards the search continues only while the objective improves faster, but never beyond the latest time,
+    // the search is not stopped before it finds the first solution
+    class ImprovementRateSearchLimit : public operations_research::SearchLimit {
+    public:
+        ImprovementRateSearchLimit(TimeAllocation allocation,
+                                   int64 window_ms,
+                                   double min_improvement,
+                                   operations_research::RoutingModel *model,
+                                   operations_research::Solver *solver);
+
+        bool Check() override;
+
+        void Init() override;
+
+        void Copy(const SearchLimit *limit) override;
+
+        operations_research::SearchLimit *MakeClone() const override;
+
+        void EnterSearch() override;
+
+        bool AtSolution() override;
+
+    private:
+        static int64 NowMs();
+
+        bool Stop(const std::string &reason);
+
+        TimeAllocation allocation_;
+        int64 window_ms_;
+        double min_improvement_;
+        operations_research::RoutingModel *model_;
+
+        ImprovementRate improvement_rate_;
+        bool extension_logged_;
+        bool stopped_;
+    };
+}
+
+
+#endif //ROWS_IMPROVEMENT_RATE_SEARCH_LIMIT_H
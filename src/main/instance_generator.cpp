@@ -0,0 +1,334 @@
+#include "instance_generator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <set>
+#include <utility>
+
+#include <boost/format.hpp>
+#include <glog/logging.h>
+
+namespace rows {
+
+    static const double CENTER_LATITUDE = 55.8642;
+    static const double CENTER_LONGITUDE = -4.2518;
+    static const double METERS_PER_DEGREE = 111320.0;
+
+    static std::string FormatCoordinate(double value) {
+        return (boost::format("%.6f") % value).str();
+    }
+
+    InstanceGeneratorOptions::InstanceGeneratorOptions()
+            : Seed{1},
+              Carers{10},
+              ServiceUsers{30},
+              VisitsPerDay{60},
+              Days{1},
+              HistoryDays{14},
+              Date{2017, boost::gregorian::Feb, 1},
+              AreaSize{10000.0},
+              Clusters{0},
+              ClusterRadius{1000.0},
+              SiblingFraction{0.1},
+              Skills{10},
+              SkillProbability{0.8},
+              ShiftLength{boost::posix_time::hours(8)},
+              SplitShiftFraction{0.5} {}
+
+    InstanceGenerator::InstanceGenerator(InstanceGeneratorOptions options)
+            : options_{std::move(options)},
+              random_engine_{options_.Seed} {
+        CHECK_GT(options_.Carers, 0);
+        CHECK_GT(options_.ServiceUsers, 0);
+        CHECK_GE(options_.VisitsPerDay, 0);
+        CHECK_GT(options_.Days, 0);
+        CHECK_GE(options_.HistoryDays, 0);
+        CHECK_GT(options_.AreaSize, 0.0);
+        CHECK_GE(options_.Clusters, 0);
+        CHECK_GT(options_.ClusterRadius, 0.0);
+        CHECK_GE(options_.SiblingFraction, 0.0);
+        CHECK_LE(options_.SiblingFraction, 1.0);
+        CHECK_GT(options_.Skills, 0);
+        CHECK_GE(options_.SkillProbability, 0.0);
+        CHECK_LE(options_.SkillProbability, 1.0);
+        CHECK_GT(options_.ShiftLength, boost::posix_time::hours(0));
+        CHECK_LE(options_.ShiftLength, boost::posix_time::hours(14));
+        CHECK_GE(options_.SplitShiftFraction, 0.0);
+        CHECK_LE(options_.SplitShiftFraction, 1.0);
+    }
+
+    nlohmann::json InstanceGenerator::GenerateProblem() {
+        std::vector<long> service_user_ids;
+
+        nlohmann::json problem;
+        problem["service_users"] = GenerateServiceUsers(service_user_ids);
+        problem["visits"] = GenerateVisits(service_user_ids);
+        problem["carers"] = GenerateCarers();
+        return problem;
+    }
+
+    nlohmann::json InstanceGenerator::GenerateHistory(const nlohmann::json &problem) {
+        std::normal_distribution<double> duration_factor_distribution{1.0, 0.2};
+
+        // visits recur every day, so the history is generated once for every time of the day a service user is visited
+        std::set<std::pair<long, boost::posix_time::time_duration> > recurring_visits;
+
+        nlohmann::json history = nlohmann::json::array();
+        for (const auto &service_user_visits : problem.at("visits")) {
+            const auto service_user = std::stol(service_user_visits.at("service_user").get<std::string>());
+
+            for (const auto &visit : service_user_visits.at("visits")) {
+                const auto visit_time = boost::posix_time::duration_from_string(visit.at("time").get<std::string>());
+                if (!recurring_visits.emplace(service_user, visit_time).second) {
+                    continue;
+                }
+
+                const auto visit_key = visit.at("key").get<long>();
+                const auto planned_duration = std::stol(visit.at("duration").get<std::string>());
+
+                for (auto day = 1; day <= options_.HistoryDays; ++day) {
+                    const boost::posix_time::ptime planned_check_in{options_.Date - boost::gregorian::days(day), visit_time};
+                    const auto planned_check_out = planned_check_in + boost::posix_time::seconds(planned_duration);
+
+                    const auto duration_factor = std::max(0.3, duration_factor_distribution(random_engine_));
+                    const auto real_duration = static_cast<long>(std::round(planned_duration * duration_factor));
+                    const auto real_check_in = planned_check_in;
+                    const auto real_check_out = real_check_in + boost::posix_time::seconds(real_duration);
+
+                    history.push_back({
+                                              {"visit",             visit_key},
+                                              {"service_user",      service_user},
+                                              {"tasks",             visit.at("tasks")},
+                                              {"carer_count",       visit.at("carer_count")},
+                                              {"planned_check_in",  boost::posix_time::to_iso_extended_string(planned_check_in)},
+                                              {"planned_check_out", boost::posix_time::to_iso_extended_string(planned_check_out)},
+                                              {"planned_duration",  std::to_string(planned_duration)},
+                                              {"real_check_in",     boost::posix_time::to_iso_extended_string(real_check_in)},
+                                              {"real_check_out",    boost::posix_time::to_iso_extended_string(real_check_out)},
+                                              {"real_duration",     std::to_string(real_duration)}
+                                      });
+                }
+            }
+        }
+        return history;
+    }
+
+    InstanceGenerator::Point InstanceGenerator::GeneratePoint(const Point &center, double radius) {
+        std::normal_distribution<double> offset_distribution{0.0, radius};
+
+        const auto latitude_offset = offset_distribution(random_engine_) / METERS_PER_DEGREE;
+        const auto longitude_offset = offset_distribution(random_engine_)
+                                      / (METERS_PER_DEGREE * std::cos(center.Latitude * M_PI / 180.0));
+        return {center.Latitude + latitude_offset, center.Longitude + longitude_offset};
+    }
+
+    InstanceGenerator::Point InstanceGenerator::GenerateUniformPoint() {
+        std::uniform_real_distribution<double> offset_distribution{-options_.AreaSize / 2.0, options_.AreaSize / 2.0};
+
+        const auto latitude_offset = offset_distribution(random_engine_) / METERS_PER_DEGREE;
+        const auto longitude_offset = offset_distribution(random_engine_)
+                                      / (METERS_PER_DEGREE * std::cos(CENTER_LATITUDE * M_PI / 180.0));
+        return {CENTER_LATITUDE + latitude_offset, CENTER_LONGITUDE + longitude_offset};
+    }
+
+    nlohmann::json InstanceGenerator::GenerateServiceUsers(std::vector<long> &service_user_ids) {
+        std::vector<Point> cluster_centers;
+        for (auto cluster = 0; cluster < options_.Clusters; ++cluster) {
+            cluster_centers.push_back(GenerateUniformPoint());
+        }
+
+        nlohmann::json service_users = nlohmann::json::array();
+        for (auto user_index = 0; user_index < options_.ServiceUsers; ++user_index) {
+            const long service_user_id = 100000 + user_index;
+            service_user_ids.push_back(service_user_id);
+
+            Point point{CENTER_LATITUDE, CENTER_LONGITUDE};
+            if (cluster_centers.empty()) {
+                point = GenerateUniformPoint();
+            } else {
+                std::uniform_int_distribution<std::size_t> cluster_distribution{0, cluster_centers.size() - 1};
+                point = GeneratePoint(cluster_centers[cluster_distribution(random_engine_)], options_.ClusterRadius);
+            }
+
+            service_users.push_back({
+                                            {"key",              std::to_string(service_user_id)},
+                                            {"address",          {
+                                                                         {"road", "Synthetic Street"},
+                                                                         {"house_number", std::to_string(user_index + 1)},
+                                                                         {"city", "Synthetic City"},
+                                                                         {"post_code", ""}
+                                                                 }},
+                                            {"location",         {
+                                                                         {"latitude", FormatCoordinate(point.Latitude)},
+                                                                         {"longitude", FormatCoordinate(point.Longitude)}
+                                                                 }},
+                                            {"carer_preference", nlohmann::json::array()}
+                                    });
+        }
+        return service_users;
+    }
+
+    std::vector<InstanceGenerator::VisitTemplate> InstanceGenerator::GenerateVisitTemplates(std::size_t service_users) {
+        static const int FIRST_SLOT = 7 * 4;
+        static const int LAST_SLOT = 21 * 4;
+        static const std::vector<int> DURATIONS{15 * 60, 30 * 60, 45 * 60, 60 * 60};
+
+        std::uniform_int_distribution<std::size_t> user_distribution{0, service_users - 1};
+        std::uniform_int_distribution<int> slot_distribution{FIRST_SLOT, LAST_SLOT};
+        std::uniform_int_distribution<std::size_t> duration_distribution{0, DURATIONS.size() - 1};
+        std::uniform_int_distribution<int> task_distribution{1, options_.Skills};
+        std::bernoulli_distribution sibling_distribution{options_.SiblingFraction};
+
+        CHECK_LE(options_.VisitsPerDay, static_cast<int>(service_users) * (LAST_SLOT - FIRST_SLOT + 1))
+            << "Too many visits for the number of service users";
+
+        std::vector<VisitTemplate> visit_templates;
+        std::set<std::pair<std::size_t, int> > used_slots;
+        for (auto visit_index = 0; visit_index < options_.VisitsPerDay; ++visit_index) {
+            std::size_t user_index = 0;
+            int slot = 0;
+            do {
+                user_index = user_distribution(random_engine_);
+                slot = slot_distribution(random_engine_);
+            } while (!used_slots.emplace(user_index, slot).second);
+
+            std::vector<int> tasks{task_distribution(random_engine_)};
+            const auto second_task = task_distribution(random_engine_);
+            if (second_task != tasks.front()) {
+                tasks.push_back(second_task);
+            }
+            std::sort(std::begin(tasks), std::end(tasks));
+
+            visit_templates.push_back({user_index,
+                                       boost::posix_time::time_duration{slot / 4, (slot % 4) * 15, 0},
+                                       DURATIONS[duration_distribution(random_engine_)],
+                                       std::move(tasks),
+                                       sibling_distribution(random_engine_) ? 2 : 1});
+        }
+        return visit_templates;
+    }
+
+    nlohmann::json InstanceGenerator::GenerateVisits(const std::vector<long> &service_user_ids) {
+        const auto visit_templates = GenerateVisitTemplates(service_user_ids.size());
+
+        std::vector<nlohmann::json> visits_by_user(service_user_ids.size(), nlohmann::json::array());
+        long visit_key = 1;
+        for (auto day = 0; day < options_.Days; ++day) {
+            const auto date = options_.Date + boost::gregorian::days(day);
+            for (const auto &visit_template : visit_templates) {
+                visits_by_user[visit_template.ServiceUserIndex].push_back({
+                                                                                  {"key",         visit_key++},
+                                                                                  {"date",        boost::gregorian::to_iso_extended_string(date)},
+                                                                                  {"time",        boost::posix_time::to_simple_string(visit_template.Time)},
+                                                                                  {"duration",    std::to_string(visit_template.Duration)},
+                                                                                  {"tasks",       visit_template.Tasks},
+                                                                                  {"carer_count", visit_template.CarerCount}
+                                                                          });
+            }
+        }
+
+        nlohmann::json visits = nlohmann::json::array();
+        for (std::size_t user_index = 0; user_index < service_user_ids.size(); ++user_index) {
+            if (visits_by_user[user_index].empty()) {
+                continue;
+            }
+
+            visits.push_back({
+                                     {"service_user", std::to_string(service_user_ids[user_index])},
+                                     {"visits",       visits_by_user[user_index]}
+                             });
+        }
+        return visits;
+    }
+
+    nlohmann::json InstanceGenerator::GenerateCarers() {
+        static const boost::posix_time::time_duration MAX_BREAK = boost::posix_time::hours(2);
+        static const boost::posix_time::time_duration LATEST_END = boost::posix_time::hours(23);
+        static const std::vector<boost::posix_time::time_duration> SHIFT_BEGINS{boost::posix_time::hours(7),
+                                                                                boost::posix_time::hours(9),
+                                                                                boost::posix_time::hours(13)};
+
+        std::vector<boost::posix_time::time_duration> shift_begins;
+        for (const auto &shift_begin : SHIFT_BEGINS) {
+            if (shift_begin + options_.ShiftLength + MAX_BREAK <= LATEST_END) {
+                shift_begins.push_back(shift_begin);
+            }
+        }
+        if (shift_begins.empty()) {
+            shift_begins.push_back(SHIFT_BEGINS.front());
+        }
+
+        std::uniform_int_distribution<std::size_t> shift_distribution{0, shift_begins.size() - 1};
+        std::bernoulli_distribution skill_distribution{options_.SkillProbability};
+        std::bernoulli_distribution split_shift_distribution{options_.SplitShiftFraction};
+        std::uniform_int_distribution<int> fallback_skill_distribution{1, options_.Skills};
+
+        nlohmann::json carers = nlohmann::json::array();
+        for (auto carer_index = 0; carer_index < options_.Carers; ++carer_index) {
+            std::vector<int> skills;
+            for (auto skill = 1; skill <= options_.Skills; ++skill) {
+                if (skill_distribution(random_engine_)) {
+                    skills.push_back(skill);
+                }
+            }
+            if (skills.empty()) {
+                skills.push_back(fallback_skill_distribution(random_engine_));
+            }
+
+            // carers keep the same shift pattern every day
+            const auto shift_begin = shift_begins[shift_distribution(random_engine_)];
+            const auto split_shift = split_shift_distribution(random_engine_);
+
+            nlohmann::json diaries = nlohmann::json::array();
+            for (auto day = 0; day < options_.Days; ++day) {
+                diaries.push_back(GenerateDiary(options_.Date + boost::gregorian::days(day), shift_begin, split_shift));
+            }
+
+            carers.push_back({
+                                     {"carer",   {
+                                                         {"sap_number", std::to_string(1000 + carer_index)},
+                                                         {"mobility", "foot"},
+                                                         {"skills", skills}
+                                                 }},
+                                     {"diaries", diaries}
+                             });
+        }
+        return carers;
+    }
+
+    nlohmann::json InstanceGenerator::GenerateDiary(const boost::gregorian::date &date,
+                                                    const boost::posix_time::time_duration &shift_begin,
+                                                    bool split_shift) {
+        static const std::vector<int> BREAK_MINUTES{30, 60, 90, 120};
+
+        const boost::posix_time::ptime begin{date, shift_begin};
+        nlohmann::json events = nlohmann::json::array();
+        if (split_shift) {
+            // gaps between working periods are interpreted as breaks
+            std::uniform_int_distribution<std::size_t> break_distribution{0, BREAK_MINUTES.size() - 1};
+            const auto break_duration = boost::posix_time::minutes(BREAK_MINUTES[break_distribution(random_engine_)]);
+            const auto first_period_end = begin + boost::posix_time::seconds(options_.ShiftLength.total_seconds() / 2);
+            const auto second_period_begin = first_period_end + break_duration;
+            const auto end = begin + options_.ShiftLength + break_duration;
+
+            events.push_back({
+                                     {"begin", boost::posix_time::to_iso_extended_string(begin)},
+                                     {"end", boost::posix_time::to_iso_extended_string(first_period_end)}
+                             });
+            events.push_back({
+                                     {"begin", boost::posix_time::to_iso_extended_string(second_period_begin)},
+                                     {"end", boost::posix_time::to_iso_extended_string(end)}
+                             });
+        } else {
+            events.push_back({
+                                     {"begin", boost::posix_time::to_iso_extended_string(begin)},
+                                     {"end", boost::posix_time::to_iso_extended_string(begin + options_.ShiftLength)}
+                             });
+        }
+
+        return {
+                {"date",   boost::gregorian::to_iso_extended_string(date)},
+                {"events", events}
+        };
+    }
+}
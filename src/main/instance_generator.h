@@ -0,0 +1,83 @@
+#ifndef ROWS_INSTANCE_GENERATOR_H
+#define ROWS_INSTANCE_GENERATOR_H
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <boost/date_time.hpp>
+#include <nlohmann/json.hpp>
+
+namespace rows {
+
+    struct InstanceGeneratorOptions {
+        InstanceGeneratorOptions();
+
+        uint32_t Seed;
+        int Carers;
+        int ServiceUsers;
+        int VisitsPerDay;
+        int Days;
+        int HistoryDays;
+        boost::gregorian::date Date;
+
+        double AreaSize; // side of the square area in meters
+        int Clusters; // service users are distributed uniformly if zero
+        double ClusterRadius; // standard deviation of the distance from the cluster center in meters
+
+        double SiblingFraction; // fraction of visits that require two carers
+        int Skills;
+        double SkillProbability; // probability that a carer has a given skill
+
+        boost::posix_time::time_duration ShiftLength;
+        double SplitShiftFraction; // fraction of carers who have a break in the middle of the shift
+    };
+
+    // generates synthetic problem instances in the same JSON format as the problem files used by the solver
+    class InstanceGenerator {
+    public:
+        explicit InstanceGenerator(InstanceGeneratorOptions options);
+
+        nlohmann::json GenerateProblem();
+
+        // past visits of service users from the problem, which are used to estimate the duration of visits
+        nlohmann::json GenerateHistory(const nlohmann::json &problem);
+
+    private:
+        struct Point {
+            double Latitude;
+            double Longitude;
+        };
+
+        struct VisitTemplate {
+            std::size_t ServiceUserIndex;
+            boost::posix_time::time_duration Time;
+            int Duration;
+            std::vector<int> Tasks;
+            int CarerCount;
+        };
+
+        Point GeneratePoint(const Point &center, double radius);
+
+        Point GenerateUniformPoint();
+
+        nlohmann::json GenerateServiceUsers(std::vector<long> &service_user_ids);
+
+        std::vector<VisitTemplate> GenerateVisitTemplates(std::size_t service_users);
+
+        nlohmann::json GenerateVisits(const std::vector<long> &service_user_ids);
+
+        nlohmann::json GenerateCarers();
+
+        nlohmann::json GenerateDiary(const boost::gregorian::date &date,
+                                     const boost::posix_time::time_duration &shift_begin,
+                                     bool split_shift);
+
+        InstanceGeneratorOptions options_;
+        std::mt19937 random_engine_;
+    };
+}
+
+
+#endif //ROWS_INSTANCE_GENERATOR_H
@@ -0,0 +1,58 @@
+#ifndef ROWS_INVARIANT_CHECKS_H
+#define ROWS_INVARIANT_CHECKS_H
+
+#include <cstdint>
+
+#include <glog/logging.h>
+
+// Cheap checks whose cost does not depend on the number of scenarios use CHECK and run in all builds.
+//
+// Expensive checks verify invariants at a cost comparable to the computation they verify, for example
+// consistency of start times of siblings in every scenario after the delay propagation. They run
+//  - in every call if the ROWS_EXPENSIVE_CHECKS option is set, which is the default for debug builds,
+//  - in a sample of calls in other debug builds,
+//  - never in release builds.
+//
+// Whole verification loops are guarded by ROWS_EXPENSIVE_CHECKS_ENABLED(), element checks inside hot loops
+// use ROWS_EXPENSIVE_CHECK_* which fall back to DCHECK_* unless the option is set.
+
+namespace rows {
+
+    // one in so many calls runs the expensive checks in the sampled mode
+    static const uint32_t EXPENSIVE_CHECKS_SAMPLING = 64;
+
+    inline bool SampleExpensiveChecks() {
+        static thread_local uint32_t calls = 0;
+        return (calls++ % EXPENSIVE_CHECKS_SAMPLING) == 0;
+    }
+}
+
+#if defined(ROWS_EXPENSIVE_CHECKS)
+
+#define ROWS_EXPENSIVE_CHECKS_POLICY "full"
+#define ROWS_EXPENSIVE_CHECKS_ENABLED() true
+#define ROWS_EXPENSIVE_CHECK(condition) CHECK(condition)
+#define ROWS_EXPENSIVE_CHECK_EQ(left, right) CHECK_EQ(left, right)
+#define ROWS_EXPENSIVE_CHECK_NE(left, right) CHECK_NE(left, right)
+#define ROWS_EXPENSIVE_CHECK_LT(left, right) CHECK_LT(left, right)
+#define ROWS_EXPENSIVE_CHECK_LE(left, right) CHECK_LE(left, right)
+
+#else
+
+#if !defined(NDEBUG)
+#define ROWS_EXPENSIVE_CHECKS_POLICY "sampled"
+#define ROWS_EXPENSIVE_CHECKS_ENABLED() (::rows::SampleExpensiveChecks())
+#else
+#define ROWS_EXPENSIVE_CHECKS_POLICY "none"
+#define ROWS_EXPENSIVE_CHECKS_ENABLED() false
+#endif
+
+#define ROWS_EXPENSIVE_CHECK(condition) DCHECK(condition)
+#define ROWS_EXPENSIVE_CHECK_EQ(left, right) DCHECK_EQ(left, right)
+#define ROWS_EXPENSIVE_CHECK_NE(left, right) DCHECK_NE(left, right)
+#define ROWS_EXPENSIVE_CHECK_LT(left, right) DCHECK_LT(left, right)
+#define ROWS_EXPENSIVE_CHECK_LE(left, right) DCHECK_LE(left, right)
+
+#endif
+
+#endif //ROWS_INVARIANT_CHECKS_H
@@ -1,9 +1,11 @@
 #include "location_container.h"
 
+#include <algorithm>
 #include <string>
 #include <cmath>
 #include <ostream>
 #include <chrono>
+#include <utility>
 
 #include <osrm/match_parameters.hpp>
 #include <osrm/nearest_parameters.hpp>
@@ -135,8 +137,118 @@ namespace rows {
         return distance_pairs;
     }
 
+    static const double EARTH_RADIUS = 6371000.0;
+
+    // latitude and longitude of the location in radians
+    static std::pair<double, double> ToRadians(const Location &location) {
+        static const double DEGREES_TO_RADIANS = M_PI / 180.0;
+
+        return {static_cast<double>(osrm::util::toFloating(location.latitude())) * DEGREES_TO_RADIANS,
+                static_cast<double>(osrm::util::toFloating(location.longitude())) * DEGREES_TO_RADIANS};
+    }
+
+    // displacement in meters between two locations along the north-south and the east-west axis,
+    // the equirectangular approximation is accurate enough at the scale of a city
+    static std::pair<double, double> GetDisplacement(const Location &from, const Location &to) {
+        const auto from_radians = ToRadians(from);
+        const auto to_radians = ToRadians(to);
+
+        const auto x = (to_radians.second - from_radians.second) * std::cos((from_radians.first + to_radians.first) / 2.0);
+        const auto y = to_radians.first - from_radians.first;
+        return {EARTH_RADIUS * y, EARTH_RADIUS * x};
+    }
+
+    EquirectangularLocationContainer::EquirectangularLocationContainer(double speed)
+            : speed_{speed} {
+        CHECK_GT(speed_, 0.0);
+    }
+
+    int64 EquirectangularLocationContainer::Distance(const Location &from, const Location &to) {
+        if (from == to) {
+            return 0;
+        }
+
+        const auto displacement = GetDisplacement(from, to);
+        const auto distance = std::sqrt(displacement.first * displacement.first + displacement.second * displacement.second);
+        return static_cast<int64>(std::ceil(distance / speed_));
+    }
+
+    ManhattanLocationContainer::ManhattanLocationContainer(double speed)
+            : speed_{speed} {
+        CHECK_GT(speed_, 0.0);
+    }
+
+    int64 ManhattanLocationContainer::Distance(const Location &from, const Location &to) {
+        if (from == to) {
+            return 0;
+        }
+
+        const auto displacement = GetDisplacement(from, to);
+        const auto distance = std::abs(displacement.first) + std::abs(displacement.second);
+        return static_cast<int64>(std::ceil(distance / speed_));
+    }
+
+    HaversineLocationContainer::HaversineLocationContainer(TravelSpeedModel model)
+            : model_{std::move(model)},
+              region_factors_{} {
+        CHECK_GT(model_.Speed, 0.0);
+        CHECK_GT(model_.RoadFactor, 0.0);
+        CHECK_GE(model_.FixedDuration, 0);
+        CHECK(model_.Regions.empty() || model_.RegionSize > 0.0) << "Regional corrections require a positive region size";
+
+        for (const auto &region : model_.Regions) {
+            CHECK_GT(region.Factor, 0.0);
+            region_factors_.emplace(GetRegionKey({region.Row, region.Column}), region.Factor);
+        }
+    }
+
+    int64 HaversineLocationContainer::Distance(const Location &from, const Location &to) {
+        if (from == to) {
+            return 0;
+        }
+
+        auto road_factor = model_.RoadFactor;
+        if (!region_factors_.empty()) {
+            const auto region_it = region_factors_.find(GetRegionKey(GetRegion(from, to, model_.RegionSize)));
+            if (region_it != std::end(region_factors_)) {
+                road_factor *= region_it->second;
+            }
+        }
+
+        const auto travel_time = GreatCircleDistance(from, to) * road_factor / model_.Speed;
+        return model_.FixedDuration + static_cast<int64>(std::ceil(travel_time));
+    }
+
+    double HaversineLocationContainer::GreatCircleDistance(const Location &from, const Location &to) {
+        const auto from_radians = ToRadians(from);
+        const auto to_radians = ToRadians(to);
+
+        const auto latitude_sin = std::sin((to_radians.first - from_radians.first) / 2.0);
+        const auto longitude_sin = std::sin((to_radians.second - from_radians.second) / 2.0);
+        const auto a = latitude_sin * latitude_sin
+                       + std::cos(from_radians.first) * std::cos(to_radians.first) * longitude_sin * longitude_sin;
+        return 2.0 * EARTH_RADIUS * std::asin(std::min(1.0, std::sqrt(a)));
+    }
+
+    std::pair<int, int> HaversineLocationContainer::GetRegion(const Location &from, const Location &to, double region_size) {
+        DCHECK_GT(region_size, 0.0);
+
+        const auto latitude = (static_cast<double>(osrm::util::toFloating(from.latitude()))
+                               + static_cast<double>(osrm::util::toFloating(to.latitude()))) / 2.0;
+        const auto longitude = (static_cast<double>(osrm::util::toFloating(from.longitude()))
+                                + static_cast<double>(osrm::util::toFloating(to.longitude()))) / 2.0;
+        return {static_cast<int>(std::floor(latitude / region_size)), static_cast<int>(std::floor(longitude / region_size))};
+    }
+
+    int64 HaversineLocationContainer::GetRegionKey(const std::pair<int, int> &region) {
+        return (static_cast<int64>(region.first) << 32) ^ static_cast<int64>(static_cast<uint32_t>(region.second));
+    }
+
     RealLocationContainer::RealLocationContainer(osrm::EngineConfig config)
-            : routing_service_{config} {}
+            : RealLocationContainer(std::make_shared<const osrm::OSRM>(config)) {}
+
+    RealLocationContainer::RealLocationContainer(std::shared_ptr<const osrm::OSRM> routing_service)
+            : routing_service_{std::move(routing_service)} {}
 
     int64 RealLocationContainer::Distance(const Location &from, const Location &to) {
         static const auto INFINITE_DISTANCE = std::numeric_limits<int64>::max();
@@ -153,7 +265,7 @@ namespace rows {
         osrm::json::Object result;
 
         try {
-            const auto status = routing_service_.Route(params, result);
+            const auto status = routing_service_->Route(params, result);
             if (status == osrm::Status::Ok) {
                 auto routes_it = result.values.find("routes");
                 if (routes_it == std::end(result.values)) {
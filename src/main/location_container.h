@@ -3,6 +3,7 @@
 
 #include <cstddef>
 #include <iterator>
+#include <memory>
 #include <vector>
 #include <unordered_map>
 
@@ -12,6 +13,7 @@
 #include <osrm/util/coordinate.hpp>
 
 #include "location.h"
+#include "travel_speed_model.h"
 
 namespace rows {
 
@@ -24,10 +26,58 @@ namespace rows {
     public:
         RealLocationContainer(osrm::EngineConfig config);
 
+        // queries the routing service shared with other containers, so the map is not loaded again
+        explicit RealLocationContainer(std::shared_ptr<const osrm::OSRM> routing_service);
+
         int64 Distance(const Location &from, const Location &to) override;
 
     private:
-        osrm::OSRM routing_service_;
+        std::shared_ptr<const osrm::OSRM> routing_service_;
+    };
+
+    // travel time along the straight line between two locations in the equirectangular projection, which is
+    // accurate at the scale of a city; does not require map files
+    class EquirectangularLocationContainer : public LocationContainer {
+    public:
+        // speed is given in meters per second
+        explicit EquirectangularLocationContainer(double speed);
+
+        int64 Distance(const Location &from, const Location &to) override;
+
+    private:
+        double speed_;
+    };
+
+    // travel time along the axis-aligned path between two locations, resembles a street grid; does not require map files
+    class ManhattanLocationContainer : public LocationContainer {
+    public:
+        // speed is given in meters per second
+        explicit ManhattanLocationContainer(double speed);
+
+        int64 Distance(const Location &from, const Location &to) override;
+
+    private:
+        double speed_;
+    };
+
+    // travel time estimated from the great-circle distance by the speed model, does not require map files
+    class HaversineLocationContainer : public LocationContainer {
+    public:
+        explicit HaversineLocationContainer(TravelSpeedModel model);
+
+        int64 Distance(const Location &from, const Location &to) override;
+
+        // distance in meters
+        static double GreatCircleDistance(const Location &from, const Location &to);
+
+        // cell of the grid which contains the midpoint of the journey
+        static std::pair<int, int> GetRegion(const Location &from, const Location &to, double region_size);
+
+    private:
+        static int64 GetRegionKey(const std::pair<int, int> &region);
+
+        TravelSpeedModel model_;
+        std::unordered_map<int64, double> region_factors_;
     };
 
     class CachedLocationContainer : public LocationContainer {
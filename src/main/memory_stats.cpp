@@ -0,0 +1,175 @@
+#include "memory_stats.h"
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#ifdef ROWS_ALLOCATION_COUNTING
+
+#include <cstdlib>
+#include <new>
+
+#include <malloc.h>
+
+namespace {
+
+    std::atomic<uint64_t> ALLOCATED_BYTES{0};
+    std::atomic<uint64_t> FREED_BYTES{0};
+    std::atomic<uint64_t> ALLOCATIONS{0};
+    std::atomic<uint64_t> DEALLOCATIONS{0};
+
+    void *CountingAllocate(std::size_t size) {
+        void *ptr = std::malloc(size == 0 ? 1 : size);
+        if (ptr == nullptr) {
+            throw std::bad_alloc();
+        }
+
+        ALLOCATED_BYTES.fetch_add(malloc_usable_size(ptr), std::memory_order_relaxed);
+        ALLOCATIONS.fetch_add(1, std::memory_order_relaxed);
+        return ptr;
+    }
+
+    void CountingFree(void *ptr) noexcept {
+        if (ptr == nullptr) {
+            return;
+        }
+
+        FREED_BYTES.fetch_add(malloc_usable_size(ptr), std::memory_order_relaxed);
+        DEALLOCATIONS.fetch_add(1, std::memory_order_relaxed);
+        std::free(ptr);
+    }
+}
+
+void *operator new(std::size_t size) { return CountingAllocate(size); }
+
+void *operator new[](std::size_t size) { return CountingAllocate(size); }
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept {
+    try {
+        return CountingAllocate(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept {
+    try {
+        return CountingAllocate(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void operator delete(void *ptr) noexcept { CountingFree(ptr); }
+
+void operator delete[](void *ptr) noexcept { CountingFree(ptr); }
+
+void operator delete(void *ptr, std::size_t) noexcept { CountingFree(ptr); }
+
+void operator delete[](void *ptr, std::size_t) noexcept { CountingFree(ptr); }
+
+#endif
+
+namespace rows {
+
+    // the highest peak observed before the high water mark was reset
+    static std::atomic<std::size_t> PEAK_RSS_BEFORE_RESET{0};
+
+    static std::size_t ReadStatusField(const std::string &line, const std::string &field) {
+        // lines of /proc/self/status have the format: "VmRSS:     1234 kB"
+        return std::stoul(line.substr(field.size())) * 1024;
+    }
+
+    MemoryUsage::MemoryUsage()
+            : MemoryUsage(0, 0, 0) {}
+
+    MemoryUsage::MemoryUsage(std::size_t rss, std::size_t peak_rss, std::size_t process_peak_rss)
+            : Rss{rss},
+              PeakRss{peak_rss},
+              ProcessPeakRss{process_peak_rss} {}
+
+    MemoryUsage MemoryUsage::Current() {
+        static const std::string RSS_FIELD{"VmRSS:"};
+        static const std::string PEAK_RSS_FIELD{"VmHWM:"};
+
+        MemoryUsage result;
+
+        std::ifstream status_stream{"/proc/self/status"};
+        std::string line;
+        while (std::getline(status_stream, line)) {
+            if (line.compare(0, RSS_FIELD.size(), RSS_FIELD) == 0) {
+                result.Rss = ReadStatusField(line, RSS_FIELD);
+            } else if (line.compare(0, PEAK_RSS_FIELD.size(), PEAK_RSS_FIELD) == 0) {
+                result.PeakRss = ReadStatusField(line, PEAK_RSS_FIELD);
+            }
+        }
+
+        if (result.PeakRss == 0) {
+            struct rusage usage{};
+            if (getrusage(RUSAGE_SELF, &usage) == 0) {
+                // the value is reported in kilobytes on Linux
+                result.PeakRss = static_cast<std::size_t>(usage.ru_maxrss) * 1024;
+            }
+        }
+
+        result.ProcessPeakRss = std::max(result.PeakRss, PEAK_RSS_BEFORE_RESET.load());
+        return result;
+    }
+
+    bool MemoryUsage::ResetPeak() {
+        const auto peak_rss = Current().PeakRss;
+        auto peak_rss_before_reset = PEAK_RSS_BEFORE_RESET.load();
+        while (peak_rss > peak_rss_before_reset
+               && !PEAK_RSS_BEFORE_RESET.compare_exchange_weak(peak_rss_before_reset, peak_rss)) {}
+
+        // writing 5 to clear_refs resets VmHWM to VmRSS, available since Linux 4.0
+        const auto file_descriptor = open("/proc/self/clear_refs", O_WRONLY);
+        if (file_descriptor < 0) {
+            return false;
+        }
+
+        const auto bytes_written = write(file_descriptor, "5", 1);
+        close(file_descriptor);
+        return bytes_written == 1;
+    }
+
+    AllocationStats::AllocationStats()
+            : AllocationStats(0, 0, 0, 0) {}
+
+    AllocationStats::AllocationStats(uint64_t allocated_bytes, uint64_t freed_bytes, uint64_t allocations, uint64_t deallocations)
+            : AllocatedBytes{allocated_bytes},
+              FreedBytes{freed_bytes},
+              Allocations{allocations},
+              Deallocations{deallocations} {}
+
+    AllocationStats AllocationStats::Snapshot() {
+#ifdef ROWS_ALLOCATION_COUNTING
+        return AllocationStats{ALLOCATED_BYTES.load(std::memory_order_relaxed),
+                               FREED_BYTES.load(std::memory_order_relaxed),
+                               ALLOCATIONS.load(std::memory_order_relaxed),
+                               DEALLOCATIONS.load(std::memory_order_relaxed)};
+#else
+        return AllocationStats{};
+#endif
+    }
+
+    bool AllocationStats::Enabled() {
+#ifdef ROWS_ALLOCATION_COUNTING
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    AllocationStats AllocationStats::operator-(const AllocationStats &other) const {
+        return AllocationStats{AllocatedBytes - other.AllocatedBytes,
+                               FreedBytes - other.FreedBytes,
+                               Allocations - other.Allocations,
+                               Deallocations - other.Deallocations};
+    }
+}
@@ -0,0 +1,49 @@
+#ifndef ROWS_MEMORY_STATS_H
+#define ROWS_MEMORY_STATS_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace rows {
+
+    struct MemoryUsage {
+        MemoryUsage();
+
+        MemoryUsage(std::size_t rss, std::size_t peak_rss, std::size_t process_peak_rss);
+
+        // resident set size of the current process in bytes, its high water mark since the last reset
+        // and the high water mark since the process started
+        static MemoryUsage Current();
+
+        // starts a new high water mark at the current resident set size, so the next peak covers only one stage;
+        // the mark is shared by all threads of the process; returns false if the kernel does not support the reset,
+        // then the peak remains the high water mark since the process started
+        static bool ResetPeak();
+
+        std::size_t Rss;
+        std::size_t PeakRss;
+        std::size_t ProcessPeakRss;
+    };
+
+    // byte counts are collected only in a diagnostic build with ROWS_ALLOCATION_COUNTING defined,
+    // otherwise all values remain zero
+    struct AllocationStats {
+        AllocationStats();
+
+        AllocationStats(uint64_t allocated_bytes, uint64_t freed_bytes, uint64_t allocations, uint64_t deallocations);
+
+        static AllocationStats Snapshot();
+
+        static bool Enabled();
+
+        AllocationStats operator-(const AllocationStats &other) const;
+
+        uint64_t AllocatedBytes;
+        uint64_t FreedBytes;
+        uint64_t Allocations;
+        uint64_t Deallocations;
+    };
+}
+
+
+#endif //ROWS_MEMORY_STATS_H
@@ -2,6 +2,7 @@
 
 #include "util/aplication_error.h"
 #include "progress_printer_monitor.h"
+#include "trace_writer.h"
 #include "cancel_search_limit.h"
 #include "stalled_search_limit.h"
 
@@ -24,6 +25,8 @@ void rows::MetaheuristicSolver::ConfigureModel(operations_research::RoutingModel
                                                const std::shared_ptr<Printer> &printer,
                                                std::shared_ptr<const std::atomic<bool> > cancel_token,
                                                double cost_normalization_factor) {
+    TraceSpan configure_model_span{"ConfigureModel", "model"};
+
     SolverWrapper::ConfigureModel(model, printer, cancel_token, cost_normalization_factor);
     AddTravelTime(model);
     AddVisitsHandling(model);
@@ -38,12 +41,16 @@ void rows::MetaheuristicSolver::ConfigureModel(operations_research::RoutingModel
 
     BeforeCloseModel(model, printer);
 
-    model.CloseModelWithParameters(parameters_);
+    {
+        TraceSpan close_model_span{"CloseModel", "model"};
+        model.CloseModelWithParameters(parameters_);
+    }
 
     AfterCloseModel(model, printer);
 
     auto solver = model.solver();
-    model.AddSearchMonitor(solver->RevAlloc(new ProgressPrinterMonitor(model, index_manager_, problem_data_, printer, cost_normalization_factor)));
+    const auto dropped_visit_tracker = AddDroppedVisitTracker(model);
+    model.AddSearchMonitor(solver->RevAlloc(new ProgressPrinterMonitor(model, index_manager_, problem_data_, printer, cost_normalization_factor, dropped_visit_tracker)));
 
 //    solution_collector_ = solver->MakeBestValueSolutionCollector(false);
 //    solution_collector_->AddObjective(model.CostVar());
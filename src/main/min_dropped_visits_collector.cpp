@@ -6,8 +6,15 @@
 
 rows::MinDroppedVisitsSolutionCollector::MinDroppedVisitsSolutionCollector(
         operations_research::RoutingModel const *model, bool abort_on_dropped_visits_increase)
+        : MinDroppedVisitsSolutionCollector(model, nullptr, abort_on_dropped_visits_increase) {}
+
+rows::MinDroppedVisitsSolutionCollector::MinDroppedVisitsSolutionCollector(
+        operations_research::RoutingModel const *model,
+        const DroppedVisitTracker *dropped_visit_tracker,
+        bool abort_on_dropped_visits_increase)
         : SolutionCollector(model->solver()),
           model_{model},
+          dropped_visit_tracker_{dropped_visit_tracker},
           abort_on_dropped_visits_increase_{abort_on_dropped_visits_increase},
           min_cost_{kint64max},
           min_dropped_visits_{kint64max} {}
@@ -21,7 +28,7 @@ void rows::MinDroppedVisitsSolutionCollector::EnterSearch() {
 
 bool rows::MinDroppedVisitsSolutionCollector::AtSolution() {
     if (prototype_ != nullptr) {
-        const auto dropped_visits = static_cast<int>(util::GetDroppedVisitCount(*model_));
+        const auto dropped_visits = GetDroppedVisitCount();
         const operations_research::IntVar *objective = prototype_->Objective();
 
         if (abort_on_dropped_visits_increase_) {
@@ -46,6 +53,15 @@ bool rows::MinDroppedVisitsSolutionCollector::AtSolution() {
     return true;
 }
 
+int64 rows::MinDroppedVisitsSolutionCollector::GetDroppedVisitCount() const {
+    if (dropped_visit_tracker_ == nullptr) {
+        return static_cast<int64>(util::GetDroppedVisitCount(*model_));
+    }
+
+    DCHECK_EQ(dropped_visit_tracker_->DroppedNodes(), static_cast<int64>(util::GetDroppedVisitCount(*model_)));
+    return dropped_visit_tracker_->DroppedNodes();
+}
+
 std::string rows::MinDroppedVisitsSolutionCollector::DebugString() const {
     if (prototype_ == nullptr) {
         return "MinDroppedVisitsSolutionCollector()";
@@ -4,12 +4,18 @@
 #include <ortools/constraint_solver/constraint_solver.h>
 #include <ortools/constraint_solver/routing.h>
 
+#include "dropped_visit_tracker.h"
+
 namespace rows {
 
     class MinDroppedVisitsSolutionCollector : public operations_research::SolutionCollector {
     public:
         MinDroppedVisitsSolutionCollector(operations_research::RoutingModel const *model, bool abort_on_dropped_visits_increase);
 
+        MinDroppedVisitsSolutionCollector(operations_research::RoutingModel const *model,
+                                          const DroppedVisitTracker *dropped_visit_tracker,
+                                          bool abort_on_dropped_visits_increase);
+
         ~MinDroppedVisitsSolutionCollector() override = default;
 
         void EnterSearch() override;
@@ -19,9 +25,12 @@ namespace rows {
         std::string DebugString() const override;
 
     private:
+        int64 GetDroppedVisitCount() const;
+
         int64 min_cost_;
         int64 min_dropped_visits_;
         operations_research::RoutingModel const *model_;
+        const DroppedVisitTracker *dropped_visit_tracker_;
 
         bool abort_on_dropped_visits_increase_;
     };
@@ -0,0 +1,120 @@
+#include "perf_counters.h"
+
+#include <algorithm>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace rows {
+
+    namespace {
+
+        // counters of running threads and the totals of threads which have finished
+        struct PerfCounterRegistry {
+            std::mutex Mutex;
+            std::vector<const std::array<std::atomic<uint64_t>, PerfCounterValues::SIZE> *> Threads;
+            std::array<uint64_t, PerfCounterValues::SIZE> Finished{};
+        };
+
+        PerfCounterRegistry &GetRegistry() {
+            static PerfCounterRegistry registry;
+            return registry;
+        }
+    }
+
+    constexpr std::size_t PerfCounterValues::SIZE;
+
+    thread_local PerfCounters::ThreadValues PerfCounters::values_;
+
+    std::string to_string(PerfCounter counter) {
+        switch (counter) {
+            case PerfCounter::TransitCallback:
+                return "transit_callback";
+            case PerfCounter::DelayTrackerFullPropagation:
+                return "delay_tracker_full_propagation";
+            case PerfCounter::DelayTrackerPartialPropagation:
+                return "delay_tracker_partial_propagation";
+            case PerfCounter::BuildPathFromSource:
+                return "build_path_from_source";
+            case PerfCounter::ConstraintInitialPropagate:
+                return "constraint_initial_propagate";
+            case PerfCounter::ConstraintPostNodeConstraints:
+                return "constraint_post_node_constraints";
+            case PerfCounter::Validation:
+                return "validation";
+            case PerfCounter::SolutionAccepted:
+                return "solution_accepted";
+            case PerfCounter::SiblingFilterCall:
+                return "sibling_filter_call";
+            case PerfCounter::SiblingFilterReject:
+                return "sibling_filter_reject";
+            case PerfCounter::ContinuityFilterCall:
+                return "continuity_filter_call";
+            case PerfCounter::ContinuityFilterReject:
+                return "continuity_filter_reject";
+            case PerfCounter::DelayFilterCall:
+                return "delay_filter_call";
+            case PerfCounter::DelayFilterReject:
+                return "delay_filter_reject";
+            case PerfCounter::DelaySketchSkip:
+                return "delay_sketch_skip";
+            default:
+                throw std::invalid_argument("Conversion to std::string not defined for counter="
+                                            + std::to_string(static_cast<std::size_t>(counter)));
+        }
+    }
+
+    PerfCounterValues::PerfCounterValues()
+            : values_{} {}
+
+    PerfCounterValues::PerfCounterValues(const std::array<uint64_t, SIZE> &values)
+            : values_{values} {}
+
+    PerfCounterValues PerfCounterValues::operator-(const PerfCounterValues &other) const {
+        std::array<uint64_t, SIZE> result{};
+        for (std::size_t index = 0; index < SIZE; ++index) {
+            result[index] = values_[index] - other.values_[index];
+        }
+        return PerfCounterValues{result};
+    }
+
+    void to_json(nlohmann::json &json, const PerfCounterValues &values) {
+        json = nlohmann::json::object();
+        for (std::size_t index = 0; index < PerfCounterValues::SIZE; ++index) {
+            const auto counter = static_cast<PerfCounter>(index);
+            json[to_string(counter)] = values[counter];
+        }
+    }
+
+    PerfCounters::ThreadValues::ThreadValues() {
+        for (auto &value : Values) {
+            value.store(0, std::memory_order_relaxed);
+        }
+
+        auto &registry = GetRegistry();
+        std::lock_guard<std::mutex> lock{registry.Mutex};
+        registry.Threads.push_back(&Values);
+    }
+
+    PerfCounters::ThreadValues::~ThreadValues() {
+        auto &registry = GetRegistry();
+        std::lock_guard<std::mutex> lock{registry.Mutex};
+        for (std::size_t index = 0; index < PerfCounterValues::SIZE; ++index) {
+            registry.Finished[index] += Values[index].load(std::memory_order_relaxed);
+        }
+        registry.Threads.erase(std::remove(std::begin(registry.Threads), std::end(registry.Threads), &Values),
+                               std::end(registry.Threads));
+    }
+
+    PerfCounterValues PerfCounters::Snapshot() {
+        auto &registry = GetRegistry();
+        std::lock_guard<std::mutex> lock{registry.Mutex};
+        auto values = registry.Finished;
+        for (const auto thread_values : registry.Threads) {
+            for (std::size_t index = 0; index < PerfCounterValues::SIZE; ++index) {
+                values[index] += (*thread_values)[index].load(std::memory_order_relaxed);
+            }
+        }
+        return PerfCounterValues{values};
+    }
+}
@@ -0,0 +1,85 @@
+#ifndef ROWS_PERF_COUNTERS_H
+#define ROWS_PERF_COUNTERS_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include <nlohmann/json.hpp>
+
+// counters are compiled in by default, define ROWS_DISABLE_PERF_COUNTERS to remove them from the hot paths
+#ifndef ROWS_DISABLE_PERF_COUNTERS
+#define ROWS_PERF_COUNT(counter) ::rows::PerfCounters::Increment(counter)
+#else
+#define ROWS_PERF_COUNT(counter) static_cast<void>(0)
+#endif
+
+namespace rows {
+
+    enum class PerfCounter : std::size_t {
+        TransitCallback = 0,
+        DelayTrackerFullPropagation,
+        DelayTrackerPartialPropagation,
+        BuildPathFromSource,
+        ConstraintInitialPropagate,
+        ConstraintPostNodeConstraints,
+        Validation,
+        SolutionAccepted,
+        SiblingFilterCall,
+        SiblingFilterReject,
+        ContinuityFilterCall,
+        ContinuityFilterReject,
+        DelayFilterCall,
+        DelayFilterReject,
+        DelaySketchSkip,
+        Size
+    };
+
+    std::string to_string(PerfCounter counter);
+
+    class PerfCounterValues {
+    public:
+        static constexpr std::size_t SIZE = static_cast<std::size_t>(PerfCounter::Size);
+
+        PerfCounterValues();
+
+        explicit PerfCounterValues(const std::array<uint64_t, SIZE> &values);
+
+        inline uint64_t operator[](PerfCounter counter) const { return values_[static_cast<std::size_t>(counter)]; }
+
+        PerfCounterValues operator-(const PerfCounterValues &other) const;
+
+    private:
+        std::array<uint64_t, SIZE> values_;
+    };
+
+    void to_json(nlohmann::json &json, const PerfCounterValues &values);
+
+    // each thread increments its own counters without synchronization, a snapshot sums the counters of all threads
+    // including threads which have already finished, so a stage summary is the difference between two snapshots
+    // and covers searches run by other threads, such as the clusters of the decomposition
+    class PerfCounters {
+    public:
+        static inline void Increment(PerfCounter counter) {
+            auto &value = values_.Values[static_cast<std::size_t>(counter)];
+            value.store(value.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+
+        static PerfCounterValues Snapshot();
+
+    private:
+        struct ThreadValues {
+            ThreadValues();
+
+            ~ThreadValues();
+
+            std::array<std::atomic<uint64_t>, PerfCounterValues::SIZE> Values;
+        };
+
+        static thread_local ThreadValues values_;
+    };
+}
+
+
+#endif //ROWS_PERF_COUNTERS_H
@@ -32,6 +32,21 @@ namespace rows {
               Solutions{solutions},
               MemoryUsage{memory_usage} {}
 
+    PerformanceSummary::PerformanceSummary(std::string stage, PerfCounterValues counters)
+            : Stage{std::move(stage)},
+              Counters{std::move(counters)} {}
+
+    MemorySummary::MemorySummary(std::string stage, MemoryUsage usage, AllocationStats allocations)
+            : Stage{std::move(stage)},
+              Usage{usage},
+              Allocations{allocations} {}
+
+    SolutionSummary::SolutionSummary(std::string stage, double cost, std::size_t dropped_visits, std::size_t invalid_routes)
+            : Stage{std::move(stage)},
+              Cost{cost},
+              DroppedVisits{dropped_visits},
+              InvalidRoutes{invalid_routes} {}
+
     ProblemDefinition::ProblemDefinition(int carers,
                                          int visits,
                                          std::string area,
@@ -77,6 +92,38 @@ namespace rows {
         };
     }
 
+    void to_json(nlohmann::json &json, const PerformanceSummary &performance_summary) {
+        json = nlohmann::json{
+                {"stage",    performance_summary.Stage},
+                {"counters", performance_summary.Counters}
+        };
+    }
+
+    void to_json(nlohmann::json &json, const MemorySummary &memory_summary) {
+        json = nlohmann::json{
+                {"stage",            memory_summary.Stage},
+                {"rss",              memory_summary.Usage.Rss},
+                {"peak_rss",         memory_summary.Usage.PeakRss},
+                {"process_peak_rss", memory_summary.Usage.ProcessPeakRss}
+        };
+
+        if (AllocationStats::Enabled()) {
+            json["allocated_bytes"] = memory_summary.Allocations.AllocatedBytes;
+            json["freed_bytes"] = memory_summary.Allocations.FreedBytes;
+            json["allocations"] = memory_summary.Allocations.Allocations;
+            json["deallocations"] = memory_summary.Allocations.Deallocations;
+        }
+    }
+
+    void to_json(nlohmann::json &json, const SolutionSummary &solution_summary) {
+        json = nlohmann::json{
+                {"stage",          solution_summary.Stage},
+                {"cost",           solution_summary.Cost},
+                {"dropped_visits", solution_summary.DroppedVisits},
+                {"invalid_routes", solution_summary.InvalidRoutes}
+        };
+    }
+
     Printer &Printer::operator<<(const std::string &text) {
         std::cout << text << std::endl;
         return *this;
@@ -123,6 +170,44 @@ namespace rows {
         return *this;
     }
 
+    Printer &ConsolePrinter::operator<<(const PerformanceSummary &performance_summary) {
+        Printer::operator<<((boost::format("Performance Counters: %1%") % performance_summary.Stage).str());
+        for (std::size_t index = 0; index < PerfCounterValues::SIZE; ++index) {
+            const auto counter = static_cast<PerfCounter>(index);
+            Printer::operator<<((boost::format("%34s | %12d") % to_string(counter) % performance_summary.Counters[counter]).str());
+        }
+        return *this;
+    }
+
+    Printer &ConsolePrinter::operator<<(const MemorySummary &memory_summary) {
+        if (AllocationStats::Enabled()) {
+            Printer::operator<<((boost::format("Memory Usage: %1% | RSS: %2% | Peak RSS: %3% | Process Peak RSS: %4% | Allocated: %5% | Freed: %6% | Allocations: %7%")
+                                 % memory_summary.Stage
+                                 % HumanReadableSize(memory_summary.Usage.Rss)
+                                 % HumanReadableSize(memory_summary.Usage.PeakRss)
+                                 % HumanReadableSize(memory_summary.Usage.ProcessPeakRss)
+                                 % HumanReadableSize(memory_summary.Allocations.AllocatedBytes)
+                                 % HumanReadableSize(memory_summary.Allocations.FreedBytes)
+                                 % memory_summary.Allocations.Allocations).str());
+        } else {
+            Printer::operator<<((boost::format("Memory Usage: %1% | RSS: %2% | Peak RSS: %3% | Process Peak RSS: %4%")
+                                 % memory_summary.Stage
+                                 % HumanReadableSize(memory_summary.Usage.Rss)
+                                 % HumanReadableSize(memory_summary.Usage.PeakRss)
+                                 % HumanReadableSize(memory_summary.Usage.ProcessPeakRss)).str());
+        }
+        return *this;
+    }
+
+    Printer &ConsolePrinter::operator<<(const SolutionSummary &solution_summary) {
+        Printer::operator<<((boost::format("Solution: %1% | Cost: %2% | Dropped Visits: %3% | Invalid Routes: %4%")
+                             % solution_summary.Stage
+                             % solution_summary.Cost
+                             % solution_summary.DroppedVisits
+                             % solution_summary.InvalidRoutes).str());
+        return *this;
+    }
+
     Printer &JsonPrinter::operator<<(const std::string &text) {
         Printer::operator<<(nlohmann::json{
                 {"type",    "message"},
@@ -154,6 +239,75 @@ namespace rows {
         return *this;
     }
 
+    Printer &JsonPrinter::operator<<(const PerformanceSummary &performance_summary) {
+        Printer::operator<<(nlohmann::json{
+                {"type",    "performance_summary"},
+                {"content", performance_summary}
+        }.dump());
+        return *this;
+    }
+
+    Printer &JsonPrinter::operator<<(const MemorySummary &memory_summary) {
+        Printer::operator<<(nlohmann::json{
+                {"type",    "memory_summary"},
+                {"content", memory_summary}
+        }.dump());
+        return *this;
+    }
+
+    Printer &JsonPrinter::operator<<(const SolutionSummary &solution_summary) {
+        Printer::operator<<(nlohmann::json{
+                {"type",    "solution_summary"},
+                {"content", solution_summary}
+        }.dump());
+        return *this;
+    }
+
+    JsonEventPrinter::JsonEventPrinter(std::function<void(nlohmann::json)> sink)
+            : sink_{std::move(sink)} {}
+
+    Printer &JsonEventPrinter::operator<<(const std::string &text) {
+        sink_({{"type",    "message"},
+               {"content", text}});
+        return *this;
+    }
+
+    Printer &JsonEventPrinter::operator<<(const ProblemDefinition &problem_definition) {
+        sink_({{"type",    "problem_definition"},
+               {"content", problem_definition}});
+        return *this;
+    }
+
+    Printer &JsonEventPrinter::operator<<(const TracingEvent &trace_event) {
+        sink_({{"type",    "tracing_event"},
+               {"content", trace_event}});
+        return *this;
+    }
+
+    Printer &JsonEventPrinter::operator<<(const ProgressStep &progress_step) {
+        sink_({{"type",    "progress_step"},
+               {"content", progress_step}});
+        return *this;
+    }
+
+    Printer &JsonEventPrinter::operator<<(const PerformanceSummary &performance_summary) {
+        sink_({{"type",    "performance_summary"},
+               {"content", performance_summary}});
+        return *this;
+    }
+
+    Printer &JsonEventPrinter::operator<<(const MemorySummary &memory_summary) {
+        sink_({{"type",    "memory_summary"},
+               {"content", memory_summary}});
+        return *this;
+    }
+
+    Printer &JsonEventPrinter::operator<<(const SolutionSummary &solution_summary) {
+        sink_({{"type",    "solution_summary"},
+               {"content", solution_summary}});
+        return *this;
+    }
+
     TracingEvent::TracingEvent(TracingEventType type, std::string comment)
             : Type(type),
               Comment(std::move(comment)) {}
@@ -195,4 +349,19 @@ namespace rows {
         LogPrinter::operator<<(static_cast<nlohmann::json>(progress_step).dump());
         return *this;
     }
+
+    Printer &LogPrinter::operator<<(const PerformanceSummary &performance_summary) {
+        LogPrinter::operator<<(static_cast<nlohmann::json>(performance_summary).dump());
+        return *this;
+    }
+
+    Printer &LogPrinter::operator<<(const MemorySummary &memory_summary) {
+        LogPrinter::operator<<(static_cast<nlohmann::json>(memory_summary).dump());
+        return *this;
+    }
+
+    Printer &LogPrinter::operator<<(const SolutionSummary &solution_summary) {
+        LogPrinter::operator<<(static_cast<nlohmann::json>(solution_summary).dump());
+        return *this;
+    }
 }
@@ -1,12 +1,16 @@
 #ifndef ROWS_PRINTER_H
 #define ROWS_PRINTER_H
 
+#include <functional>
 #include <string>
 
 #include <boost/date_time.hpp>
 #include <glog/logging.h>
 #include <nlohmann/json.hpp>
 
+#include "perf_counters.h"
+#include "memory_stats.h"
+
 namespace rows {
 
     struct ProblemDefinition {
@@ -64,6 +68,36 @@ namespace rows {
 
     void to_json(nlohmann::json &json, const ProgressStep &progress_step);
 
+    struct PerformanceSummary {
+        PerformanceSummary(std::string stage, PerfCounterValues counters);
+
+        std::string Stage;
+        PerfCounterValues Counters;
+    };
+
+    void to_json(nlohmann::json &json, const PerformanceSummary &performance_summary);
+
+    struct MemorySummary {
+        MemorySummary(std::string stage, MemoryUsage usage, AllocationStats allocations);
+
+        std::string Stage;
+        MemoryUsage Usage;
+        AllocationStats Allocations;
+    };
+
+    void to_json(nlohmann::json &json, const MemorySummary &memory_summary);
+
+    struct SolutionSummary {
+        SolutionSummary(std::string stage, double cost, std::size_t dropped_visits, std::size_t invalid_routes);
+
+        std::string Stage;
+        double Cost;
+        std::size_t DroppedVisits;
+        std::size_t InvalidRoutes;
+    };
+
+    void to_json(nlohmann::json &json, const SolutionSummary &solution_summary);
+
     class Printer {
     public:
         virtual ~Printer() = default;
@@ -75,6 +109,12 @@ namespace rows {
         virtual Printer &operator<<(const TracingEvent &trace_event) = 0;
 
         virtual Printer &operator<<(const ProgressStep &progress_step) = 0;
+
+        virtual Printer &operator<<(const PerformanceSummary &performance_summary) = 0;
+
+        virtual Printer &operator<<(const MemorySummary &memory_summary) = 0;
+
+        virtual Printer &operator<<(const SolutionSummary &solution_summary) = 0;
     };
 
     class ConsolePrinter : public Printer {
@@ -87,6 +127,12 @@ namespace rows {
 
         Printer &operator<<(const ProgressStep &progress_step) override;
 
+        Printer &operator<<(const PerformanceSummary &performance_summary) override;
+
+        Printer &operator<<(const MemorySummary &memory_summary) override;
+
+        Printer &operator<<(const SolutionSummary &solution_summary) override;
+
     private:
         bool header_printed_{false};
     };
@@ -102,6 +148,37 @@ namespace rows {
         Printer &operator<<(const TracingEvent &trace_event) override;
 
         Printer &operator<<(const ProgressStep &progress_step) override;
+
+        Printer &operator<<(const PerformanceSummary &performance_summary) override;
+
+        Printer &operator<<(const MemorySummary &memory_summary) override;
+
+        Printer &operator<<(const SolutionSummary &solution_summary) override;
+    };
+
+    // passes events as JSON objects in the format of the json printer to the sink instead of the standard output
+    class JsonEventPrinter : public Printer {
+    public:
+        explicit JsonEventPrinter(std::function<void(nlohmann::json)> sink);
+
+        ~JsonEventPrinter() override = default;
+
+        Printer &operator<<(const std::string &text) override;
+
+        Printer &operator<<(const ProblemDefinition &problem_definition) override;
+
+        Printer &operator<<(const TracingEvent &trace_event) override;
+
+        Printer &operator<<(const ProgressStep &progress_step) override;
+
+        Printer &operator<<(const PerformanceSummary &performance_summary) override;
+
+        Printer &operator<<(const MemorySummary &memory_summary) override;
+
+        Printer &operator<<(const SolutionSummary &solution_summary) override;
+
+    private:
+        std::function<void(nlohmann::json)> sink_;
     };
 
     class LogPrinter : public Printer {
@@ -115,6 +192,12 @@ namespace rows {
         Printer &operator<<(const TracingEvent &trace_event) override;
 
         Printer &operator<<(const ProgressStep &progress_step) override;
+
+        Printer &operator<<(const PerformanceSummary &performance_summary) override;
+
+        Printer &operator<<(const MemorySummary &memory_summary) override;
+
+        Printer &operator<<(const SolutionSummary &solution_summary) override;
     };
 }
 
@@ -1,3 +1,14 @@
 #include "problem_data.h"
 
+#include "problem.h"
+
 const operations_research::RoutingIndexManager::NodeIndex rows::ProblemData::DEPOT{0};
+
+rows::SynchronizedProblemDataFactory::SynchronizedProblemDataFactory(std::shared_ptr<ProblemDataFactory> data_factory)
+        : data_factory_{std::move(data_factory)},
+          mutex_{} {}
+
+std::shared_ptr<rows::ProblemData> rows::SynchronizedProblemDataFactory::makeProblem(rows::Problem problem) const {
+    std::lock_guard<std::mutex> lock{mutex_};
+    return data_factory_->makeProblem(std::move(problem));
+}
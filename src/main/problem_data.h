@@ -1,6 +1,9 @@
 #ifndef ROWS_PROBLEM_DATA_H
 #define ROWS_PROBLEM_DATA_H
 
+#include <memory>
+#include <mutex>
+
 #include <ortools/constraint_solver/routing_index_manager.h>
 
 #include <boost/date_time.hpp>
@@ -49,6 +52,19 @@ namespace rows {
     public:
         virtual std::shared_ptr<ProblemData> makeProblem(Problem problem) const = 0;
     };
+
+    // serializes creation of problem data by threads which share the factory, because neither the factory
+    // nor the routing engine which it may use are thread safe
+    class SynchronizedProblemDataFactory : public ProblemDataFactory {
+    public:
+        explicit SynchronizedProblemDataFactory(std::shared_ptr<ProblemDataFactory> data_factory);
+
+        std::shared_ptr<ProblemData> makeProblem(Problem problem) const override;
+
+    private:
+        std::shared_ptr<ProblemDataFactory> data_factory_;
+        mutable std::mutex mutex_;
+    };
 }
 
 #endif //ROWS_PROBLEM_DATA_H
@@ -7,6 +7,7 @@
 #include "progress_printer_monitor.h"
 #include "util/routing.h"
 #include "problem_data.h"
+#include "perf_counters.h"
 
 namespace rows {
 
@@ -21,8 +22,17 @@ namespace rows {
                                                    const ProblemData &problem_data,
                                                    std::shared_ptr<rows::Printer> printer,
                                                    double cost_normalization_factor)
+            : ProgressPrinterMonitor(model, index_manager, problem_data, printer, cost_normalization_factor, nullptr) {}
+
+    ProgressPrinterMonitor::ProgressPrinterMonitor(const operations_research::RoutingModel &model,
+                                                   const operations_research::RoutingIndexManager &index_manager,
+                                                   const ProblemData &problem_data,
+                                                   std::shared_ptr<rows::Printer> printer,
+                                                   double cost_normalization_factor,
+                                                   const DroppedVisitTracker *dropped_visit_tracker)
             : ProgressMonitor(model),
               dropped_visit_evaluator_{problem_data, index_manager},
+              dropped_visit_tracker_{dropped_visit_tracker},
               printer_(std::move(printer)),
               cost_normalization_factor_{cost_normalization_factor},
               last_solution_cost_{std::numeric_limits<double>::max()} {}
@@ -32,6 +42,8 @@ namespace rows {
     }
 
     bool ProgressPrinterMonitor::AtSolution() {
+        ROWS_PERF_COUNT(PerfCounter::SolutionAccepted);
+
         const auto current_solution_cost = util::Cost(model());
         if (current_solution_cost >= last_solution_cost_) {
             return operations_research::SearchMonitor::AtSolution();
@@ -41,7 +53,7 @@ namespace rows {
         const auto wall_time = util::WallTime(solver());
         const auto memory_usage = operations_research::Solver::MemoryUsage();
         printer_->operator<<(ProgressStep(current_solution_cost * cost_normalization_factor_,
-                                          dropped_visit_evaluator_.GetDroppedVisits(model()),
+                                          GetDroppedVisits(),
                                           boost::posix_time::time_duration{wall_time.hours(),
                                                                            wall_time.minutes(),
                                                                            wall_time.seconds()},
@@ -51,4 +63,13 @@ namespace rows {
 
         return operations_research::SearchMonitor::AtSolution();
     }
+
+    int64 ProgressPrinterMonitor::GetDroppedVisits() const {
+        if (dropped_visit_tracker_ == nullptr) {
+            return dropped_visit_evaluator_.GetDroppedVisits(model());
+        }
+
+        DCHECK_EQ(dropped_visit_tracker_->DroppedVisits(), dropped_visit_evaluator_.GetDroppedVisits(model()));
+        return dropped_visit_tracker_->DroppedVisits();
+    }
 }
@@ -10,6 +10,7 @@
 #include <printer.h>
 #include "progress_monitor.h"
 #include "declined_visit_evaluator.h"
+#include "dropped_visit_tracker.h"
 
 namespace rows {
 
@@ -26,14 +27,24 @@ namespace rows {
                                std::shared_ptr<rows::Printer> printer,
                                double cost_normalization_factor);
 
+        ProgressPrinterMonitor(const operations_research::RoutingModel &model,
+                               const operations_research::RoutingIndexManager &index_manager,
+                               const ProblemData &problem_data,
+                               std::shared_ptr<rows::Printer> printer,
+                               double cost_normalization_factor,
+                               const DroppedVisitTracker *dropped_visit_tracker);
+
         virtual ~ProgressPrinterMonitor();
 
         bool AtSolution() override;
 
     private:
+        int64 GetDroppedVisits() const;
+
         std::shared_ptr<rows::Printer> printer_;
 
         DeclinedVisitEvaluator dropped_visit_evaluator_;
+        const DroppedVisitTracker *dropped_visit_tracker_;
         double cost_normalization_factor_;
         double last_solution_cost_;
     };
@@ -1,9 +1,10 @@
 #include "real_problem_data.h"
 #include "problem.h"
+#include "trace_writer.h"
 
 #include <glog/logging.h>
 
-std::vector<rows::Location> DistinctLocations(const rows::Problem &problem) {
+std::vector<rows::Location> rows::GetDistinctLocations(const rows::Problem &problem) {
     std::unordered_set<rows::Location> locations;
     for (const auto &visit : problem.visits()) {
         const auto &location_opt = visit.location();
@@ -43,7 +44,10 @@ rows::RealProblemData::RealProblemData(Problem problem, std::unique_ptr<CachedLo
     }
     DCHECK_EQ(current_visit_node.value(), node_index_.size());
 
-    location_container_->ComputeDistances();
+    {
+        TraceSpan distance_matrix_span{"BuildDistanceMatrix", "data"};
+        location_container_->ComputeDistances();
+    }
 
     for (const auto &visit : problem_.visits()) {
         boost::posix_time::ptime datetime{visit.datetime().date()};
@@ -129,14 +133,45 @@ bool rows::RealProblemData::Contains(const rows::CalendarVisit &visit) const {
 }
 
 rows::RealProblemDataFactory::RealProblemDataFactory(osrm::EngineConfig engine_config)
-        : engine_config_{std::move(engine_config)} {}
+        : routing_service_{std::make_shared<const osrm::OSRM>(engine_config)} {}
 
 std::shared_ptr<rows::ProblemData> rows::RealProblemDataFactory::makeProblem(rows::Problem problem) const {
-    const auto locations = DistinctLocations(problem);
+    const auto locations = GetDistinctLocations(problem);
     return std::make_shared<RealProblemData>(problem, std::make_unique<CachedLocationContainer>(std::begin(locations),
                                                                                                 std::end(locations),
                                                                                                 std::make_unique<RealLocationContainer>(
-                                                                                                        engine_config_)));
+                                                                                                        routing_service_)));
+}
+
+rows::GeometricProblemDataFactory::GeometricProblemDataFactory(Metric metric, double speed)
+        : metric_{metric},
+          speed_{speed} {}
+
+std::shared_ptr<rows::ProblemData> rows::GeometricProblemDataFactory::makeProblem(rows::Problem problem) const {
+    std::unique_ptr<LocationContainer> location_container;
+    switch (metric_) {
+        case Metric::Euclidean:
+            location_container = std::make_unique<EquirectangularLocationContainer>(speed_);
+            break;
+        case Metric::Manhattan:
+            location_container = std::make_unique<ManhattanLocationContainer>(speed_);
+            break;
+        default:
+            LOG(FATAL) << "Metric is not supported";
+    }
+
+    const auto locations = GetDistinctLocations(problem);
+    return std::make_shared<RealProblemData>(problem, std::make_unique<CachedLocationContainer>(std::begin(locations),
+                                                                                                std::end(locations),
+                                                                                                std::move(location_container)));
 }
 
+rows::HaversineProblemDataFactory::HaversineProblemDataFactory(TravelSpeedModel model)
+        : model_{std::move(model)} {}
 
+std::shared_ptr<rows::ProblemData> rows::HaversineProblemDataFactory::makeProblem(rows::Problem problem) const {
+    const auto locations = GetDistinctLocations(problem);
+    return std::make_shared<RealProblemData>(problem, std::make_unique<CachedLocationContainer>(std::begin(locations),
+                                                                                                std::end(locations),
+                                                                                                std::make_unique<HaversineLocationContainer>(model_)));
+}
@@ -12,11 +12,15 @@
 #include "calendar_visit.h"
 #include "location_container.h"
 #include "problem_data.h"
+#include "travel_speed_model.h"
 
 namespace rows {
 
     class Problem;
 
+    // locations of visits in the problem without duplicates, the order is not specified
+    std::vector<Location> GetDistinctLocations(const Problem &problem);
+
     class RealProblemData : public ProblemData {
     public:
         static const int64 SECONDS_IN_DIMENSION;
@@ -71,6 +75,8 @@ namespace rows {
                 Problem::PartialVisitOperations> visit_index_;
     };
 
+    // travel times are found by the routing service, which is created once with the factory and shared by problems,
+    // each problem keeps only the distance matrix of its locations
     class RealProblemDataFactory : public ProblemDataFactory {
     public:
         explicit RealProblemDataFactory(osrm::EngineConfig engine_config);
@@ -78,7 +84,35 @@ namespace rows {
         std::shared_ptr<ProblemData> makeProblem(Problem problem) const override;
 
     private:
-        osrm::EngineConfig engine_config_;
+        std::shared_ptr<const osrm::OSRM> routing_service_;
+    };
+
+    // travel times are computed from coordinates without a map, suitable for synthetic instances
+    class GeometricProblemDataFactory : public ProblemDataFactory {
+    public:
+        enum class Metric {
+            Euclidean, Manhattan
+        };
+
+        // speed is given in meters per second
+        GeometricProblemDataFactory(Metric metric, double speed);
+
+        std::shared_ptr<ProblemData> makeProblem(Problem problem) const override;
+
+    private:
+        Metric metric_;
+        double speed_;
+    };
+
+    // travel times are estimated from the great-circle distance, suitable for scoping large areas without a map
+    class HaversineProblemDataFactory : public ProblemDataFactory {
+    public:
+        explicit HaversineProblemDataFactory(TravelSpeedModel model);
+
+        std::shared_ptr<ProblemData> makeProblem(Problem problem) const override;
+
+    private:
+        TravelSpeedModel model_;
     };
 }
 
@@ -0,0 +1,115 @@
+#include "reoptimization.h"
+
+#include <algorithm>
+#include <unordered_map>
+
+#include <glog/logging.h>
+
+namespace rows {
+
+    PreviousRoutes GetPreviousRoutes(const ReoptimizationOptions &options, const SolverWrapper &solver) {
+        const auto &problem_data = solver.problem_data();
+        const auto &index_manager = solver.index_manager();
+
+        std::unordered_map<std::size_t, std::vector<int64> > visit_indices;
+        for (operations_research::RoutingNodeIndex node{1}; node < problem_data.nodes(); ++node) {
+            const auto &visit = problem_data.NodeToVisit(node);
+            if (visit_indices.find(visit.id()) != std::end(visit_indices)) {
+                continue;
+            }
+
+            auto indices = index_manager.NodesToIndices(problem_data.GetNodes(visit));
+            std::sort(std::begin(indices), std::end(indices));
+            visit_indices.emplace(visit.id(), std::move(indices));
+        }
+
+        const auto num_vehicles = static_cast<std::size_t>(solver.vehicles());
+        PreviousRoutes previous_routes{std::vector<std::vector<int64> >(num_vehicles),
+                                       std::vector<std::vector<int64> >(num_vehicles),
+                                       0,
+                                       0};
+        std::unordered_map<std::size_t, std::size_t> used_indices;
+        for (int vehicle = 0; vehicle < solver.vehicles(); ++vehicle) {
+            auto visits = options.PreviousSolution.GetRoute(solver.Carer(vehicle)).visits();
+            std::stable_sort(std::begin(visits), std::end(visits),
+                             [](const ScheduledVisit &left, const ScheduledVisit &right) -> bool {
+                                 return left.datetime() < right.datetime();
+                             });
+
+            auto is_executed_prefix = true;
+            for (const auto &visit : visits) {
+                if (!visit.calendar_visit()) {
+                    continue;
+                }
+
+                const auto indices_it = visit_indices.find(visit.calendar_visit()->id());
+                if (indices_it == std::end(visit_indices)) {
+                    ++previous_routes.RemovedVisits;
+                    continue;
+                }
+
+                auto &used_visit_indices = used_indices[indices_it->first];
+                if (used_visit_indices >= indices_it->second.size()) {
+                    continue;
+                }
+
+                const auto index = indices_it->second[used_visit_indices++];
+                previous_routes.Routes[vehicle].push_back(index);
+
+                is_executed_prefix &= visit.datetime() < options.CurrentTime;
+                if (is_executed_prefix) {
+                    previous_routes.ExecutedRoutes[vehicle].push_back(index);
+                    ++previous_routes.ExecutedVisits;
+                }
+            }
+        }
+
+        return previous_routes;
+    }
+
+    std::vector<std::vector<int64> > FreezeExecutedRoutes(operations_research::RoutingModel &model,
+                                                          const ProblemData &problem_data,
+                                                          const std::vector<std::vector<int64> > &executed_routes,
+                                                          boost::posix_time::ptime current_time,
+                                                          const std::vector<std::vector<int64> > &routes) {
+        CHECK_EQ(executed_routes.size(), static_cast<std::size_t>(model.vehicles()));
+
+        auto solver = model.solver();
+        std::vector<bool> is_frozen(static_cast<std::size_t>(model.Size()), false);
+        for (int vehicle = 0; vehicle < model.vehicles(); ++vehicle) {
+            auto previous_index = model.Start(vehicle);
+            for (const auto index : executed_routes[vehicle]) {
+                solver->AddConstraint(solver->MakeEquality(model.NextVar(previous_index), index));
+                is_frozen[index] = true;
+                previous_index = index;
+            }
+        }
+
+        const auto &time_dimension = model.GetDimensionOrDie(SolverWrapper::TIME_DIMENSION);
+        const auto current_time_seconds = (current_time - problem_data.StartHorizon()).total_seconds();
+        std::vector<bool> is_expired(static_cast<std::size_t>(model.Size()), false);
+        for (int64 index = 0; index < model.Size(); ++index) {
+            if (model.IsStart(index) || is_frozen[index]) {
+                continue;
+            }
+
+            const auto cumul = time_dimension.CumulVar(index);
+            if (cumul->Max() < current_time_seconds) {
+                model.ActiveVar(index)->SetValue(0);
+                is_expired[index] = true;
+            } else {
+                cumul->SetMin(current_time_seconds);
+            }
+        }
+
+        std::vector<std::vector<int64> > routes_to_use{routes.size()};
+        for (std::size_t vehicle = 0; vehicle < routes.size(); ++vehicle) {
+            for (const auto index : routes[vehicle]) {
+                if (!is_expired[index]) {
+                    routes_to_use[vehicle].push_back(index);
+                }
+            }
+        }
+        return routes_to_use;
+    }
+}
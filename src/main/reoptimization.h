@@ -0,0 +1,43 @@
+#ifndef ROWS_REOPTIMIZATION_H
+#define ROWS_REOPTIMIZATION_H
+
+#include <vector>
+
+#include <boost/date_time.hpp>
+
+#include <ortools/constraint_solver/routing.h>
+
+#include "problem_data.h"
+#include "schedule_delta.h"
+#include "solver_wrapper.h"
+
+namespace rows {
+
+    // routes of the previous solution in indices of the current model
+    struct PreviousRoutes {
+        std::vector<std::vector<int64> > Routes;
+
+        // visits of every route which started before the current time, they are a prefix of the route
+        std::vector<std::vector<int64> > ExecutedRoutes;
+
+        std::size_t ExecutedVisits;
+
+        // visits of the previous solution which are no longer in the problem
+        std::size_t RemovedVisits;
+    };
+
+    // visits are matched by their identifiers, indices of a visit performed by two carers are sorted,
+    // so the vehicle with the lower number receives the lower index
+    PreviousRoutes GetPreviousRoutes(const ReoptimizationOptions &options, const SolverWrapper &solver);
+
+    // fixes executed visits at the beginning of routes, the remaining visits cannot start before the current time,
+    // returns routes without visits which can no longer start
+    std::vector<std::vector<int64> > FreezeExecutedRoutes(operations_research::RoutingModel &model,
+                                                          const ProblemData &problem_data,
+                                                          const std::vector<std::vector<int64> > &executed_routes,
+                                                          boost::posix_time::ptime current_time,
+                                                          const std::vector<std::vector<int64> > &routes);
+}
+
+
+#endif //ROWS_REOPTIMIZATION_H
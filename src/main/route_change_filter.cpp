@@ -0,0 +1,125 @@
+#include "route_change_filter.h"
+
+rows::RouteChangeFilter::RouteChangeFilter(const operations_research::RoutingModel &model)
+        : IntVarLocalSearchFilter(model.Nexts()),
+          model_{model},
+          synchronized_{false},
+          vehicles_(static_cast<std::size_t>(model.Size() + model.vehicles()), -1),
+          stamp_{0},
+          next_stamps_(static_cast<std::size_t>(model.Size()), 0),
+          new_nexts_(static_cast<std::size_t>(model.Size()), -1),
+          route_stamps_(static_cast<std::size_t>(model.Size() + model.vehicles()), 0),
+          new_vehicles_(static_cast<std::size_t>(model.Size() + model.vehicles()), -1),
+          affected_stamps_(static_cast<std::size_t>(model.Size() + model.vehicles()), 0),
+          affected_indices_{},
+          changed_vehicle_stamps_(static_cast<std::size_t>(model.vehicles()), 0),
+          changed_vehicles_{} {}
+
+bool rows::RouteChangeFilter::Accept(const operations_research::Assignment *delta,
+                                     const operations_research::Assignment *deltadelta) {
+    if (!synchronized_) {
+        return true;
+    }
+
+    ++stamp_;
+    affected_indices_.clear();
+    changed_vehicles_.clear();
+
+    const auto &container = delta->IntVarContainer();
+    const auto delta_size = container.Size();
+    for (auto element_index = 0; element_index < delta_size; ++element_index) {
+        const auto &element = container.Element(element_index);
+        int64 index = -1;
+        if (!FindIndex(element.Var(), &index)) {
+            continue;
+        }
+
+        // the move cannot be evaluated without knowing the successor
+        if (!element.Bound()) {
+            return true;
+        }
+
+        next_stamps_[index] = stamp_;
+        new_nexts_[index] = element.Value();
+
+        const auto vehicle = vehicles_[index];
+        if (vehicle >= 0 && changed_vehicle_stamps_[vehicle] != stamp_) {
+            changed_vehicle_stamps_[vehicle] = stamp_;
+            changed_vehicles_.push_back(static_cast<int>(vehicle));
+        }
+        AddAffectedIndex(index);
+    }
+
+    const auto max_route_length = model_.Size() + 1;
+    for (const auto vehicle : changed_vehicles_) {
+        // indices of the route before the move
+        for (auto index = Value(model_.Start(vehicle)); !model_.IsEnd(index); index = Value(index)) {
+            AddAffectedIndex(index);
+        }
+
+        auto route_length = 0;
+        for (auto index = model_.Start(vehicle); !model_.IsEnd(index); index = NewNext(index)) {
+            // the move creates a cycle
+            if (++route_length > max_route_length || route_stamps_[index] == stamp_) {
+                return false;
+            }
+
+            route_stamps_[index] = stamp_;
+            new_vehicles_[index] = vehicle;
+            AddAffectedIndex(index);
+        }
+    }
+
+    return AcceptRoutes();
+}
+
+int64 rows::RouteChangeFilter::NewVehicle(int64 index) const {
+    if (route_stamps_[index] == stamp_) {
+        return new_vehicles_[index];
+    }
+
+    // the index was removed from a changed route
+    const auto vehicle = vehicles_[index];
+    if (vehicle >= 0 && changed_vehicle_stamps_[vehicle] == stamp_) {
+        return -1;
+    }
+
+    return vehicle;
+}
+
+int64 rows::RouteChangeFilter::NewNext(int64 index) const {
+    if (next_stamps_[index] == stamp_) {
+        return new_nexts_[index];
+    }
+    return Value(index);
+}
+
+void rows::RouteChangeFilter::OnSynchronize(const operations_research::Assignment *delta) {
+    std::fill(std::begin(vehicles_), std::end(vehicles_), -1);
+
+    synchronized_ = true;
+    for (auto vehicle = 0; vehicle < model_.vehicles() && synchronized_; ++vehicle) {
+        auto index = model_.Start(vehicle);
+        while (!model_.IsEnd(index)) {
+            if (!IsVarSynced(index)) {
+                synchronized_ = false;
+                break;
+            }
+
+            vehicles_[index] = vehicle;
+            index = Value(index);
+        }
+        vehicles_[index] = vehicle;
+    }
+
+    if (synchronized_) {
+        OnSynchronizeRoutes();
+    }
+}
+
+void rows::RouteChangeFilter::AddAffectedIndex(int64 index) {
+    if (affected_stamps_[index] != stamp_) {
+        affected_stamps_[index] = stamp_;
+        affected_indices_.push_back(index);
+    }
+}
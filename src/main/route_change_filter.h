@@ -0,0 +1,68 @@
+#ifndef ROWS_ROUTE_CHANGE_FILTER_H
+#define ROWS_ROUTE_CHANGE_FILTER_H
+
+#include <vector>
+
+#include <ortools/constraint_solver/routing.h>
+#include <ortools/constraint_solver/constraint_solveri.h>
+
+namespace rows {
+
+    // base of local search filters which check the vehicles of indices after a move without propagation,
+    // routes which contain an index whose successor was changed by the move are rebuilt from their starts
+    class RouteChangeFilter : public operations_research::IntVarLocalSearchFilter {
+    public:
+        explicit RouteChangeFilter(const operations_research::RoutingModel &model);
+
+        bool Accept(const operations_research::Assignment *delta, const operations_research::Assignment *deltadelta) override;
+
+    protected:
+        // vehicle of the index in the last accepted solution, -1 if the index is not performed
+        inline int64 Vehicle(int64 index) const { return vehicles_[index]; }
+
+        // vehicle of the index after the move, -1 if the index is not performed
+        int64 NewVehicle(int64 index) const;
+
+        // successor of the index after the move
+        int64 NewNext(int64 index) const;
+
+        // indices on changed routes before or after the move
+        inline const std::vector<int64> &AffectedIndices() const { return affected_indices_; }
+
+        // changes for every evaluated move, so derived filters can reuse stamped buffers
+        inline int64 Stamp() const { return stamp_; }
+
+        // vehicles whose routes contain an index with a new successor
+        inline const std::vector<int> &ChangedVehicles() const { return changed_vehicles_; }
+
+        inline bool IsChangedVehicle(int vehicle) const { return changed_vehicle_stamps_[vehicle] == stamp_; }
+
+        const operations_research::RoutingModel &model_;
+
+    private:
+        void OnSynchronize(const operations_research::Assignment *delta) override;
+
+        virtual void OnSynchronizeRoutes() {}
+
+        virtual bool AcceptRoutes() = 0;
+
+        void AddAffectedIndex(int64 index);
+
+        bool synchronized_;
+        std::vector<int64> vehicles_;
+
+        // scratch buffers valid for the current stamp, so they are not cleared between moves
+        int64 stamp_;
+        std::vector<int64> next_stamps_;
+        std::vector<int64> new_nexts_;
+        std::vector<int64> route_stamps_;
+        std::vector<int64> new_vehicles_;
+        std::vector<int64> affected_stamps_;
+        std::vector<int64> affected_indices_;
+        std::vector<int64> changed_vehicle_stamps_;
+        std::vector<int> changed_vehicles_;
+    };
+}
+
+
+#endif //ROWS_ROUTE_CHANGE_FILTER_H
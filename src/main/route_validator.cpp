@@ -11,6 +11,8 @@
 #include "util/date_time.h"
 #include "route_validator.h"
 #include "solver_wrapper.h"
+#include "perf_counters.h"
+#include "trace_writer.h"
 
 namespace rows {
 
@@ -975,6 +977,8 @@ namespace rows {
                                                                          const SolverWrapper &solver) const {
         static const std::unordered_map<rows::CalendarVisit, boost::posix_time::time_duration> NO_OVERRIDE_ARRIVAL;
 
+        ROWS_PERF_COUNT(PerfCounter::Validation);
+
         using boost::posix_time::seconds;
         using boost::posix_time::ptime;
         using boost::posix_time::time_period;
@@ -1143,6 +1147,8 @@ namespace rows {
                                                                          const rows::SolverWrapper &solver) const {
         static const std::unordered_map<rows::CalendarVisit, boost::posix_time::time_duration> NO_OVERRIDE_ARRIVAL;
 
+        ROWS_PERF_COUNT(PerfCounter::Validation);
+
         using boost::posix_time::seconds;
         using boost::posix_time::ptime;
         using boost::posix_time::time_period;
@@ -1393,6 +1399,8 @@ namespace rows {
     RouteValidatorBase::ValidationResult SolutionValidator::ValidateFull(const operations_research::Assignment &solution,
                                                                          const operations_research::RoutingModel &model,
                                                                          const rows::SolverWrapper &solver) const {
+        TraceSpan validation_span{"ValidateSolution", "validation"};
+
         std::unordered_map<ServiceUser, std::unordered_set<int> > user_visited_vehicles;
         std::unordered_map<ServiceUser, bool> has_multiple_carer_visits;
 
@@ -0,0 +1,87 @@
+#include <algorithm>
+#include <memory>
+#include <string>
+
+#include <gflags/gflags.h>
+
+#include <glog/logging.h>
+
+#include <boost/format.hpp>
+
+#include "util/logging.h"
+#include "util/input.h"
+#include "util/validation.h"
+#include "solver_daemon.h"
+
+DEFINE_string(socket, "/tmp/rows-daemon.sock", "a file path to the Unix domain socket on which solve requests are served");
+
+DEFINE_int32(max_jobs, 1, "number of problems solved at the same time, further solve requests are rejected");
+DEFINE_validator(max_jobs, &util::numeric::IsPositive);
+
+DEFINE_int32(memory_limit,
+             0,
+             "resident memory of the daemon in megabytes above which solve requests are rejected. Unlimited if zero");
+
+DEFINE_int32(problem_cache_size, 4, "number of recently solved problems whose travel times are kept in memory");
+
+DEFINE_string(history, "", "a file path to the history of past visits");
+DEFINE_validator(history, &util::file::IsNullOrExists);
+
+bool ValidateTravelModel(const char *flagname, const std::string &value) {
+    if (value == "osrm" || value == "haversine" || value == "euclidean" || value == "manhattan") {
+        return true;
+    }
+
+    LOG(ERROR) << boost::format("Travel model '%1%' is not supported. Available options: osrm, haversine, euclidean or manhattan") % value;
+    return false;
+}
+
+DEFINE_string(travel_model,
+              "osrm",
+              "a method to compute travel times."
+              " Available options are: osrm which requires the map, haversine which estimates travel times from the distance,"
+              " euclidean and manhattan which use the straight line and the street grid distance of synthetic instances");
+DEFINE_validator(travel_model, &ValidateTravelModel);
+
+DEFINE_string(travel_speed_model,
+              "",
+              "a file path to the speed model used by the haversine travel model, which can be fitted by rows-travel-model,"
+              " the euclidean and manhattan travel models use only its speed");
+DEFINE_validator(travel_speed_model, &util::file::IsNullOrExists);
+
+// the map is validated only if the osrm travel model is used
+DEFINE_string(maps, "../data/scotland-latest.osrm", "a file path to the map");
+
+int main(int argc, char **argv) {
+    util::SetupLogging(argv[0]);
+    gflags::SetVersionString("1.0.0");
+    gflags::SetUsageMessage("Robust Optimization for Workforce Scheduling\n"
+                            "Example: rows-daemon"
+                            " --socket=/tmp/rows-daemon.sock"
+                            " --maps=./data/scotland-latest.osrm"
+                            " --max_jobs=2"
+                            " --memory_limit=8192");
+
+    static const auto REMOVE_FLAGS = false;
+    gflags::ParseCommandLineFlags(&argc, &argv, REMOVE_FLAGS);
+
+    std::shared_ptr<const rows::History> history;
+    if (!FLAGS_history.empty()) {
+        history = util::LoadHistory(FLAGS_history);
+    } else {
+        history = std::make_shared<const rows::History>();
+    }
+
+    rows::SolverDaemonOptions options;
+    options.SocketPath = FLAGS_socket;
+    options.MaxJobs = static_cast<std::size_t>(FLAGS_max_jobs);
+    options.MemoryLimit = static_cast<std::size_t>(std::max(FLAGS_memory_limit, 0)) * 1024 * 1024;
+    options.ProblemCacheSize = static_cast<std::size_t>(std::max(FLAGS_problem_cache_size, 0));
+
+    rows::SolverDaemon daemon{options,
+                              util::CreateProblemDataFactory(FLAGS_travel_model, FLAGS_travel_speed_model, FLAGS_maps),
+                              history};
+    daemon.Listen();
+    daemon.Run();
+    return 0;
+}
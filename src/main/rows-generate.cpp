@@ -0,0 +1,150 @@
+#include <fstream>
+#include <string>
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+
+#include <boost/date_time.hpp>
+#include <boost/format.hpp>
+
+#include <nlohmann/json.hpp>
+
+#include "util/logging.h"
+#include "util/validation.h"
+
+#include "instance_generator.h"
+
+DEFINE_string(problem_output, "problem.json", "a file path to save the problem instance");
+DEFINE_validator(problem_output, &util::file::IsNullOrNotExists);
+
+DEFINE_string(history_output, "", "a file path to save the history of past visits");
+DEFINE_validator(history_output, &util::file::IsNullOrNotExists);
+
+DEFINE_int32(seed, 1, "seed of the random number generator");
+
+DEFINE_int32(carers, 10, "number of carers");
+DEFINE_validator(carers, &util::numeric::IsPositive);
+
+DEFINE_int32(service_users, 30, "number of service users");
+DEFINE_validator(service_users, &util::numeric::IsPositive);
+
+DEFINE_int32(visits_per_day, 60, "number of visits per day");
+DEFINE_validator(visits_per_day, &util::numeric::IsPositive);
+
+DEFINE_int32(days, 1, "number of days in the planning horizon");
+DEFINE_validator(days, &util::numeric::IsPositive);
+
+DEFINE_int32(history_days, 14, "number of days covered by the history of past visits");
+
+DEFINE_string(date, "2017-02-01", "first day of the planning horizon");
+DEFINE_validator(date, &util::date::IsPositive);
+
+DEFINE_double(area_size, 10000.0, "side of the square area in meters where service users live");
+DEFINE_validator(area_size, &util::numeric::IsPositive);
+
+DEFINE_int32(clusters, 0, "number of geographic clusters of service users, distributed uniformly if zero");
+
+DEFINE_double(cluster_radius, 1000.0, "standard deviation of the distance from the cluster center in meters");
+DEFINE_validator(cluster_radius, &util::numeric::IsPositive);
+
+DEFINE_double(sibling_fraction, 0.1, "fraction of visits that require two carers");
+
+DEFINE_int32(skills, 10, "number of distinct skills and tasks");
+DEFINE_validator(skills, &util::numeric::IsPositive);
+
+DEFINE_double(skill_probability, 0.8, "probability that a carer has a given skill");
+
+DEFINE_string(shift_length, "08:00:00", "working time of a carer per day");
+DEFINE_validator(shift_length, &util::time_duration::IsPositive);
+
+DEFINE_double(split_shift_fraction, 0.5, "fraction of carers who have a break in the middle of the shift");
+
+void ParseArgs(int argc, char *argv[]) {
+    gflags::SetVersionString("0.0.1");
+    gflags::SetUsageMessage("Robust Optimization for Workforce Scheduling\n"
+                            "Generates synthetic problem instances that do not require map files,\n"
+                            "the solver reads them with --travel_model=euclidean or --travel_model=manhattan\n"
+                            "Example: rows-generate"
+                            " --problem_output=problem.json"
+                            " --history_output=history.json"
+                            " --carers=20"
+                            " --visits_per_day=120"
+                            " --clusters=3");
+
+    static const auto REMOVE_FLAGS = false;
+    gflags::ParseCommandLineFlags(&argc, &argv, REMOVE_FLAGS);
+
+    VLOG(1) << boost::format("Launched with the arguments:\n"
+                             "problem_output: %1%\n"
+                             "history_output: %2%\n"
+                             "seed: %3%\n"
+                             "carers: %4%\n"
+                             "service_users: %5%\n"
+                             "visits_per_day: %6%\n"
+                             "days: %7%\n"
+                             "history_days: %8%\n"
+                             "date: %9%\n"
+                             "area_size: %10%\n"
+                             "clusters: %11%\n"
+                             "cluster_radius: %12%\n"
+                             "sibling_fraction: %13%\n"
+                             "skills: %14%\n"
+                             "skill_probability: %15%\n"
+                             "shift_length: %16%\n"
+                             "split_shift_fraction: %17%")
+               % FLAGS_problem_output
+               % FLAGS_history_output
+               % FLAGS_seed
+               % FLAGS_carers
+               % FLAGS_service_users
+               % FLAGS_visits_per_day
+               % FLAGS_days
+               % FLAGS_history_days
+               % FLAGS_date
+               % FLAGS_area_size
+               % FLAGS_clusters
+               % FLAGS_cluster_radius
+               % FLAGS_sibling_fraction
+               % FLAGS_skills
+               % FLAGS_skill_probability
+               % FLAGS_shift_length
+               % FLAGS_split_shift_fraction;
+}
+
+void Save(const nlohmann::json &document, const std::string &file_path) {
+    std::ofstream output_stream{file_path, std::ios::out | std::ios::trunc};
+    CHECK(output_stream.is_open()) << "Failed to open the file: " << file_path;
+    output_stream << document.dump(2);
+}
+
+int main(int argc, char *argv[]) {
+    util::SetupLogging(argv[0]);
+    ParseArgs(argc, argv);
+
+    rows::InstanceGeneratorOptions options;
+    options.Seed = static_cast<uint32_t>(FLAGS_seed);
+    options.Carers = FLAGS_carers;
+    options.ServiceUsers = FLAGS_service_users;
+    options.VisitsPerDay = FLAGS_visits_per_day;
+    options.Days = FLAGS_days;
+    options.HistoryDays = FLAGS_history_days;
+    options.Date = boost::gregorian::from_simple_string(FLAGS_date);
+    options.AreaSize = FLAGS_area_size;
+    options.Clusters = FLAGS_clusters;
+    options.ClusterRadius = FLAGS_cluster_radius;
+    options.SiblingFraction = FLAGS_sibling_fraction;
+    options.Skills = FLAGS_skills;
+    options.SkillProbability = FLAGS_skill_probability;
+    options.ShiftLength = boost::posix_time::duration_from_string(FLAGS_shift_length);
+    options.SplitShiftFraction = FLAGS_split_shift_fraction;
+
+    rows::InstanceGenerator generator{options};
+    const auto problem = generator.GenerateProblem();
+    Save(problem, FLAGS_problem_output);
+
+    if (!FLAGS_history_output.empty()) {
+        Save(generator.GenerateHistory(problem), FLAGS_history_output);
+    }
+
+    return 0;
+}
@@ -0,0 +1,581 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+
+#include <boost/format.hpp>
+#include <boost/optional.hpp>
+
+#include <nlohmann/json.hpp>
+
+#include <ortools/constraint_solver/routing.h>
+
+#include "util/input.h"
+#include "util/logging.h"
+#include "util/routing.h"
+#include "util/validation.h"
+
+#include "async_printer.h"
+#include "break_constraint.h"
+#include "construction_heuristic.h"
+#include "delay_histogram.h"
+#include "delay_tracker.h"
+#include "dropped_visit_tracker.h"
+#include "history.h"
+#include "instance_generator.h"
+#include "invariant_checks.h"
+#include "location_container.h"
+#include "past_visit.h"
+#include "printer.h"
+#include "problem.h"
+#include "real_problem_data.h"
+#include "route_validator.h"
+#include "second_step_solver.h"
+#include "skill_set.h"
+
+DEFINE_string(filter, "", "run only benchmarks whose name contains the filter");
+
+DEFINE_int32(min_time_ms, 500, "minimum time in milliseconds spent in each benchmark");
+DEFINE_validator(min_time_ms, &util::numeric::IsPositive);
+
+DEFINE_string(output, "", "a file path to save the results, the standard output is used if empty");
+
+DEFINE_int32(seed, 1, "seed of the synthetic instance generator");
+
+DEFINE_int32(carers, 10, "number of carers in the synthetic instance");
+DEFINE_validator(carers, &util::numeric::IsPositive);
+
+DEFINE_int32(visits, 60, "number of visits in the synthetic instance");
+DEFINE_validator(visits, &util::numeric::IsPositive);
+
+DEFINE_int64(search_solutions, 100, "number of solutions explored by each iteration of the search benchmarks");
+DEFINE_validator(search_solutions, &util::numeric::IsPositive);
+
+static const double WALKING_SPEED = 1.4; // meters per second
+
+void ParseArgs(int argc, char *argv[]) {
+    gflags::SetVersionString("0.0.1");
+    gflags::SetUsageMessage("Robust Optimization for Workforce Scheduling\n"
+                            "Micro-benchmarks of the solver hot paths on a synthetic instance\n"
+                            "Example: rows-microbench"
+                            " --filter=DelayTracker"
+                            " --min_time_ms=1000");
+
+    static const auto REMOVE_FLAGS = false;
+    gflags::ParseCommandLineFlags(&argc, &argv, REMOVE_FLAGS);
+
+    VLOG(1) << boost::format("Launched with the arguments:\n"
+                             "filter: %1%\n"
+                             "min_time_ms: %2%\n"
+                             "output: %3%\n"
+                             "seed: %4%\n"
+                             "carers: %5%\n"
+                             "visits: %6%\n"
+                             "search_solutions: %7%")
+               % FLAGS_filter
+               % FLAGS_min_time_ms
+               % FLAGS_output
+               % FLAGS_seed
+               % FLAGS_carers
+               % FLAGS_visits
+               % FLAGS_search_solutions;
+}
+
+// prevents the compiler from optimizing away the computation under test
+static volatile int64 BENCHMARK_SINK = 0;
+
+class BenchmarkRunner {
+public:
+    BenchmarkRunner(std::ostream &output_stream, std::string filter, std::chrono::milliseconds min_time)
+            : output_stream_{output_stream},
+              filter_{std::move(filter)},
+              min_time_{min_time} {}
+
+    // the number of iterations is doubled until the benchmark runs at least the minimum time,
+    // if the number of items processed by each iteration is known the throughput is reported too
+    template<typename Function>
+    void Run(const std::string &name, Function function, uint64_t items_per_iteration = 0) {
+        if (!filter_.empty() && name.find(filter_) == std::string::npos) {
+            return;
+        }
+
+        static const uint64_t MAX_ITERATIONS = 1ul << 30;
+
+        uint64_t iterations = 1;
+        std::chrono::nanoseconds elapsed{0};
+        while (true) {
+            const auto start_time = std::chrono::steady_clock::now();
+            for (uint64_t iteration = 0; iteration < iterations; ++iteration) {
+                function();
+            }
+            elapsed = std::chrono::steady_clock::now() - start_time;
+
+            if (elapsed >= min_time_ || iterations >= MAX_ITERATIONS) {
+                break;
+            }
+            iterations *= 2;
+        }
+
+        nlohmann::json result{
+                {"name",                  name},
+                {"iterations",            iterations},
+                {"total_time_ns",         elapsed.count()},
+                {"time_per_iteration_ns", static_cast<double>(elapsed.count()) / iterations}
+        };
+        if (items_per_iteration > 0) {
+            result["items_per_second"] = static_cast<double>(items_per_iteration * iterations)
+                                         / std::chrono::duration_cast<std::chrono::duration<double> >(elapsed).count();
+        }
+        output_stream_ << result.dump() << std::endl;
+    }
+
+private:
+    std::ostream &output_stream_;
+    const std::string filter_;
+    const std::chrono::milliseconds min_time_;
+};
+
+std::unique_ptr<rows::CachedLocationContainer> CreateLocationContainer(const std::vector<rows::Location> &locations) {
+    return std::make_unique<rows::CachedLocationContainer>(std::begin(locations),
+                                                           std::end(locations),
+                                                           std::make_unique<rows::EquirectangularLocationContainer>(WALKING_SPEED));
+}
+
+const operations_research::Assignment *SolveFirstSolution(operations_research::RoutingModel &model) {
+    auto search_params = operations_research::DefaultRoutingSearchParameters();
+    search_params.set_first_solution_strategy(operations_research::FirstSolutionStrategy_Value_PARALLEL_CHEAPEST_INSERTION);
+    search_params.set_local_search_metaheuristic(operations_research::LocalSearchMetaheuristic_Value_GREEDY_DESCENT);
+    search_params.set_solution_limit(1);
+    return model.SolveWithParameters(search_params);
+}
+
+std::size_t CountDroppedVisits(const operations_research::RoutingModel &model, const operations_research::Assignment &solution) {
+    std::size_t dropped_visits = 0;
+    for (int64 index = 0; index < model.Size(); ++index) {
+        if (!model.IsStart(index) && solution.Value(model.NextVar(index)) == index) {
+            ++dropped_visits;
+        }
+    }
+    return dropped_visits;
+}
+
+int main(int argc, char *argv[]) {
+    util::SetupLogging(argv[0]);
+    ParseArgs(argc, argv);
+
+    // results of the delay tracker benchmarks are comparable only between builds with the same policy
+    LOG(INFO) << "Expensive invariant checks: " << ROWS_EXPENSIVE_CHECKS_POLICY;
+
+    rows::InstanceGeneratorOptions generator_options;
+    generator_options.Seed = static_cast<uint32_t>(FLAGS_seed);
+    generator_options.Carers = FLAGS_carers;
+    generator_options.VisitsPerDay = FLAGS_visits;
+    generator_options.ServiceUsers = std::max(1, FLAGS_visits / 2);
+
+    rows::InstanceGenerator generator{generator_options};
+    const auto problem_json = generator.GenerateProblem();
+    const auto history_json = generator.GenerateHistory(problem_json);
+
+    rows::Problem::JsonLoader problem_loader;
+    const auto problem = problem_loader.Load(problem_json);
+    const rows::History history{history_json.get<std::vector<rows::PastVisit> >()};
+    const auto locations = rows::GetDistinctLocations(problem);
+
+    rows::RealProblemData problem_data{problem, CreateLocationContainer(locations)};
+
+    const auto printer = util::CreatePrinter(util::LOG_FORMAT);
+    const auto cancel_token = std::make_shared<std::atomic<bool> >(false);
+    const auto visit_time_window = boost::posix_time::minutes(120);
+    const auto break_time_window = boost::posix_time::minutes(15);
+    const auto begin_end_shift_adjustment = boost::posix_time::minutes(15);
+
+    auto search_params = operations_research::DefaultRoutingSearchParameters();
+    search_params.set_first_solution_strategy(operations_research::FirstSolutionStrategy_Value_PARALLEL_CHEAPEST_INSERTION);
+
+    rows::SecondStepSolver solver{problem_data,
+                                  search_params,
+                                  visit_time_window,
+                                  break_time_window,
+                                  begin_end_shift_adjustment,
+                                  boost::date_time::not_a_date_time};
+    operations_research::RoutingModel model{solver.index_manager()};
+    solver.ConfigureModel(model, printer, cancel_token, 1.0);
+    const auto assignment = SolveFirstSolution(model);
+    CHECK(assignment) << "Failed to find the initial solution of the synthetic instance";
+
+    // the same model extended with break constraints to measure the cost of their propagation
+    rows::SecondStepSolver break_solver{problem_data,
+                                        search_params,
+                                        visit_time_window,
+                                        break_time_window,
+                                        begin_end_shift_adjustment,
+                                        boost::date_time::not_a_date_time};
+    operations_research::RoutingModel break_model{break_solver.index_manager()};
+    break_solver.ConfigureModel(break_model, printer, cancel_token, 1.0);
+    const auto break_time_dimension = &break_model.GetDimensionOrDie(rows::SolverWrapper::TIME_DIMENSION);
+    for (auto vehicle = 0; vehicle < break_model.vehicles(); ++vehicle) {
+        break_model.solver()->AddConstraint(
+                break_model.solver()->RevAlloc(new rows::BreakConstraint(break_time_dimension,
+                                                                         &break_solver.index_manager(),
+                                                                         vehicle,
+                                                                         break_time_dimension->GetBreakIntervalsOfVehicle(vehicle),
+                                                                         problem_data)));
+    }
+
+    std::vector<std::vector<int64> > routes;
+    model.AssignmentToRoutes(*assignment, &routes);
+    const auto break_assignment = break_model.ReadAssignmentFromRoutes(routes, true);
+    CHECK(break_assignment) << "Failed to restore the initial solution in the model with break constraints";
+
+    std::ofstream output_file_stream;
+    if (!FLAGS_output.empty()) {
+        output_file_stream.open(FLAGS_output, std::ios::out | std::ios::trunc);
+        CHECK(output_file_stream.is_open()) << "Failed to open the file: " << FLAGS_output;
+    }
+    std::ostream &output_stream = FLAGS_output.empty() ? std::cout : output_file_stream;
+
+    BenchmarkRunner runner{output_stream, FLAGS_filter, std::chrono::milliseconds(FLAGS_min_time_ms)};
+
+    runner.Run("ProblemData/ServicePlusTravelTime", [&problem_data]() -> void {
+        int64 total = 0;
+        const auto num_nodes = problem_data.nodes();
+        for (auto from = 0; from < num_nodes; ++from) {
+            for (auto to = 0; to < num_nodes; ++to) {
+                total += problem_data.ServicePlusTravelTime(operations_research::RoutingNodeIndex{from},
+                                                            operations_research::RoutingNodeIndex{to});
+            }
+        }
+        BENCHMARK_SINK = total;
+    });
+
+    runner.Run("ProblemData/Distance", [&problem_data]() -> void {
+        int64 total = 0;
+        const auto num_nodes = problem_data.nodes();
+        for (auto from = 0; from < num_nodes; ++from) {
+            for (auto to = 0; to < num_nodes; ++to) {
+                total += problem_data.Distance(operations_research::RoutingNodeIndex{from},
+                                               operations_research::RoutingNodeIndex{to});
+            }
+        }
+        BENCHMARK_SINK = total;
+    });
+
+    auto location_container = CreateLocationContainer(locations);
+    runner.Run("CachedLocationContainer/Distance", [&location_container, &locations]() -> void {
+        int64 total = 0;
+        for (const auto &from : locations) {
+            for (const auto &to : locations) {
+                total += location_container->Distance(from, to);
+            }
+        }
+        BENCHMARK_SINK = total;
+    });
+
+    rows::DelayTracker delay_tracker{solver, history, &model.GetDimensionOrDie(rows::SolverWrapper::TIME_DIMENSION)};
+    runner.Run("DelayTracker/UpdateAllPaths", [&delay_tracker, assignment]() -> void {
+        delay_tracker.UpdateAllPaths(assignment);
+    });
+
+    runner.Run("DelayTracker/BuildPath", [&delay_tracker, &model, assignment]() -> void {
+        std::size_t total = 0;
+        for (auto vehicle = 0; vehicle < model.vehicles(); ++vehicle) {
+            total += delay_tracker.BuildPath(vehicle, assignment).size();
+        }
+        BENCHMARK_SINK = total;
+    }, static_cast<uint64_t>(model.vehicles()));
+
+    delay_tracker.UpdateAllPaths(assignment);
+    std::vector<int64> visited_nodes;
+    for (int64 node = 0; node < model.Size(); ++node) {
+        if (!model.IsStart(node) && delay_tracker.IsVisited(node)) {
+            visited_nodes.push_back(node);
+        }
+    }
+    runner.Run("DelayTracker/GetEssentialRiskiness", [&delay_tracker, &visited_nodes]() -> void {
+        int64 total = 0;
+        for (const auto node : visited_nodes) {
+            total += delay_tracker.GetEssentialRiskiness(node);
+        }
+        BENCHMARK_SINK = total;
+    });
+
+    // checking a bound of the riskiness with a histogram of delays against sorting the delays of all scenarios,
+    // both decide if the riskiness of every visited node is at most ten minutes
+    static const int64 RISKINESS_BOUND = 600;
+    std::vector<rows::DelayHistogram> delay_histograms;
+    for (const auto node : visited_nodes) {
+        rows::DelayHistogram histogram{60, 7200};
+        const auto &delay = delay_tracker.Delay(node);
+        for (std::size_t scenario = 0; scenario < delay.size(); ++scenario) {
+            histogram.Add(delay[scenario], delay_tracker.Weights()[scenario]);
+        }
+        delay_histograms.push_back(std::move(histogram));
+    }
+    runner.Run("DelayHistogram/IsRiskinessAtMost", [&delay_histograms]() -> void {
+        std::size_t total = 0;
+        for (const auto &histogram : delay_histograms) {
+            if (histogram.IsRiskinessAtMost(RISKINESS_BOUND)) {
+                ++total;
+            }
+        }
+        BENCHMARK_SINK = total;
+    }, static_cast<uint64_t>(delay_histograms.size()));
+
+    runner.Run("DelayHistogram/SortDelays", [&delay_tracker, &visited_nodes]() -> void {
+        std::size_t total = 0;
+        for (const auto node : visited_nodes) {
+            if (rows::DelayTracker::GetEssentialRiskiness(delay_tracker.Delay(node), delay_tracker.Weights()) <= RISKINESS_BOUND) {
+                ++total;
+            }
+        }
+        BENCHMARK_SINK = total;
+    }, static_cast<uint64_t>(visited_nodes.size()));
+
+    // the dropped visit count of a solution found by local search, the full scan of next variables against
+    // the update by the delta of a move which drops two visited nodes and the move which restores them
+    const auto dropped_visit_tracker = model.solver()->RevAlloc(
+            new rows::DroppedVisitTracker(model, solver.index_manager(), problem_data));
+    dropped_visit_tracker->Synchronize(*assignment);
+    runner.Run("DroppedVisits/Scan", [&model, assignment]() -> void {
+        BENCHMARK_SINK = util::GetDroppedVisitCount(model, *assignment);
+    });
+
+    auto drop_delta = model.solver()->MakeAssignment();
+    auto restore_delta = model.solver()->MakeAssignment();
+    for (auto node_it = std::begin(visited_nodes); node_it != std::end(visited_nodes) && drop_delta->NumIntVars() < 2; ++node_it) {
+        const auto next_var = model.NextVar(*node_it);
+        drop_delta->Add(next_var)->SetValue(*node_it);
+        restore_delta->Add(next_var)->SetValue(assignment->Value(next_var));
+    }
+    runner.Run("DroppedVisits/Delta", [dropped_visit_tracker, drop_delta, restore_delta]() -> void {
+        dropped_visit_tracker->ApplyDelta(*drop_delta);
+        dropped_visit_tracker->ApplyDelta(*restore_delta);
+        BENCHMARK_SINK = dropped_visit_tracker->DroppedNodes();
+    }, 2);
+
+    const rows::SolutionValidator validator;
+    runner.Run("SolutionValidator/ValidateFull", [&validator, &model, &solver, assignment]() -> void {
+        const auto result = validator.ValidateFull(*assignment, model, solver);
+        BENCHMARK_SINK = result.error() == nullptr;
+    });
+
+    runner.Run("History/get_duration_sample", [&history, &problem]() -> void {
+        std::size_t total = 0;
+        for (const auto &visit : problem.visits()) {
+            total += history.get_duration_sample(visit).size();
+        }
+        BENCHMARK_SINK = total;
+    });
+
+    const auto time_dimension = &model.GetDimensionOrDie(rows::SolverWrapper::TIME_DIMENSION);
+    runner.Run("DelayTracker/ConstructFromHistory", [&solver, &history, time_dimension]() -> void {
+        rows::DelayTracker tracker{solver, history, time_dimension};
+        BENCHMARK_SINK = tracker.Weights().size();
+    });
+
+    solver.SetDurationSample(std::make_shared<const rows::VisitDurationSample>(solver.problem(), history, solver.scenario_reduction_options()));
+    runner.Run("DelayTracker/ConstructFromSharedSample", [&solver, &history, time_dimension]() -> void {
+        rows::DelayTracker tracker{solver, history, time_dimension};
+        BENCHMARK_SINK = tracker.Weights().size();
+    });
+    solver.SetDurationSample(nullptr);
+
+    runner.Run("Model/CheckAssignment", [&model, assignment]() -> void {
+        BENCHMARK_SINK = model.solver()->CheckAssignment(const_cast<operations_research::Assignment *>(assignment));
+    });
+
+    runner.Run("BreakConstraint/CheckAssignment", [&break_model, break_assignment]() -> void {
+        BENCHMARK_SINK = break_model.solver()->CheckAssignment(const_cast<operations_research::Assignment *>(break_assignment));
+    });
+
+    runner.Run("Problem/JsonLoad", [&problem_loader, &problem_json]() -> void {
+        const auto loaded_problem = problem_loader.Load(problem_json);
+        BENCHMARK_SINK = loaded_problem.visits().size();
+    });
+
+    // the cost of a progress step paid by the search thread, the JSON printer formats events without writing them
+    // to exclude the output, the asynchronous printer formats them in the background and drops those which do not fit
+    std::atomic<uint64_t> printed_bytes{0};
+    const auto json_printer = std::make_shared<rows::JsonEventPrinter>([&printed_bytes](nlohmann::json event) -> void {
+        printed_bytes += event.dump().size();
+    });
+    const rows::ProgressStep progress_step{123456.0, 3, boost::posix_time::seconds(42), 1000000, 1000, 64 * 1024 * 1024};
+
+    runner.Run("Printer/ProgressStep/Sync", [&json_printer, &progress_step]() -> void {
+        json_printer->operator<<(progress_step);
+    }, 1);
+
+    {
+        rows::AsyncPrinter async_printer{json_printer, 1024};
+        runner.Run("Printer/ProgressStep/Async", [&async_printer, &progress_step]() -> void {
+            async_printer << progress_step;
+        }, 1);
+        async_printer.Flush();
+        LOG(INFO) << boost::format("Asynchronous printer dropped %1% progress steps, %2% bytes were printed in total")
+                     % async_printer.dropped()
+                     % printed_bytes.load();
+    }
+
+    // a larger instance to measure how the time of building a model depends on skills and tasks
+    rows::InstanceGeneratorOptions skills_generator_options;
+    skills_generator_options.Seed = static_cast<uint32_t>(FLAGS_seed);
+    skills_generator_options.Carers = 150;
+    skills_generator_options.Skills = 40;
+    skills_generator_options.VisitsPerDay = 600;
+    skills_generator_options.ServiceUsers = 300;
+
+    rows::InstanceGenerator skills_generator{skills_generator_options};
+    const auto skills_problem = problem_loader.Load(skills_generator.GenerateProblem());
+    const auto skills_locations = rows::GetDistinctLocations(skills_problem);
+    rows::RealProblemData skills_problem_data{skills_problem, CreateLocationContainer(skills_locations)};
+
+    runner.Run("Skills/Compatibility/Vector", [&skills_problem]() -> void {
+        int64 total = 0;
+        for (const auto &visit : skills_problem.visits()) {
+            for (const auto &carer_diaries : skills_problem.carers()) {
+                total += carer_diaries.first.has_skills(visit.tasks());
+            }
+        }
+        BENCHMARK_SINK = total;
+    });
+
+    rows::SkillIndex skill_index;
+    std::vector<rows::SkillSet> carer_skills;
+    for (const auto &carer_diaries : skills_problem.carers()) {
+        carer_skills.push_back(skill_index.Intern(carer_diaries.first.skills()));
+    }
+    std::vector<rows::SkillSet> visit_tasks;
+    for (const auto &visit : skills_problem.visits()) {
+        visit_tasks.push_back(skill_index.Intern(visit.tasks()));
+    }
+    runner.Run("Skills/Compatibility/Bitset", [&carer_skills, &visit_tasks]() -> void {
+        int64 total = 0;
+        for (const auto &tasks : visit_tasks) {
+            for (const auto &skills : carer_skills) {
+                total += skills.Includes(tasks);
+            }
+        }
+        BENCHMARK_SINK = total;
+    });
+
+    runner.Run("Model/ConfigureModel/150Carers40Tasks", [&]() -> void {
+        rows::SecondStepSolver skills_solver{skills_problem_data,
+                                             search_params,
+                                             visit_time_window,
+                                             break_time_window,
+                                             begin_end_shift_adjustment,
+                                             boost::date_time::not_a_date_time};
+        operations_research::RoutingModel skills_model{skills_solver.index_manager()};
+        skills_solver.ConfigureModel(skills_model, printer, cancel_token, 1.0);
+        BENCHMARK_SINK = skills_model.Size();
+    });
+
+    // time to the first solution of the built-in strategies and of the construction heuristic completed by
+    // the default strategy, the runner reports only times, so the quality of the last solution is logged
+    std::vector<std::pair<std::string, operations_research::FirstSolutionStrategy::Value> > first_solution_strategies{
+            {"ParallelCheapestInsertion", operations_research::FirstSolutionStrategy_Value_PARALLEL_CHEAPEST_INSERTION},
+            {"LocalCheapestInsertion",    operations_research::FirstSolutionStrategy_Value_LOCAL_CHEAPEST_INSERTION},
+            {"PathCheapestArc",           operations_research::FirstSolutionStrategy_Value_PATH_CHEAPEST_ARC},
+            {"Construction",              operations_research::FirstSolutionStrategy_Value_PARALLEL_CHEAPEST_INSERTION}
+    };
+    const std::vector<std::pair<std::string, const rows::ProblemData *> > first_solution_instances{
+            {"",                   &problem_data},
+            {"/150Carers600Visits", &skills_problem_data}
+    };
+    for (const auto &instance : first_solution_instances) {
+        for (const auto &strategy : first_solution_strategies) {
+            const auto use_construction_heuristic = strategy.first == "Construction";
+            auto first_solution_params = search_params;
+            first_solution_params.set_first_solution_strategy(strategy.second);
+            first_solution_params.set_local_search_metaheuristic(operations_research::LocalSearchMetaheuristic_Value_GREEDY_DESCENT);
+            first_solution_params.set_solution_limit(1);
+
+            boost::optional<std::pair<int64, std::size_t> > cost_dropped_visits;
+            const auto name = "FirstSolution/" + strategy.first + instance.first;
+            runner.Run(name, [&]() -> void {
+                rows::SecondStepSolver first_solver{*instance.second,
+                                                    first_solution_params,
+                                                    visit_time_window,
+                                                    break_time_window,
+                                                    begin_end_shift_adjustment,
+                                                    boost::date_time::not_a_date_time};
+                operations_research::RoutingModel first_model{first_solver.index_manager()};
+                first_solver.ConfigureModel(first_model, printer, cancel_token, 1.0);
+
+                const operations_research::Assignment *initial_assignment = nullptr;
+                if (use_construction_heuristic) {
+                    rows::ConstructionHeuristic heuristic{first_solver};
+                    initial_assignment = first_model.ReadAssignmentFromRoutes(heuristic.Solve(), true);
+                    CHECK(initial_assignment) << "Routes of the construction heuristic are not feasible";
+                }
+
+                const auto solution = first_model.SolveFromAssignmentWithParameters(initial_assignment, first_solution_params);
+                if (solution != nullptr) {
+                    cost_dropped_visits = std::make_pair(solution->ObjectiveValue(), CountDroppedVisits(first_model, *solution));
+                    BENCHMARK_SINK = solution->ObjectiveValue();
+                }
+            });
+
+            if (cost_dropped_visits) {
+                LOG(INFO) << boost::format("%1%: cost %2%, dropped visits %3%")
+                             % name
+                             % cost_dropped_visits->first
+                             % cost_dropped_visits->second;
+            }
+        }
+    }
+
+    {
+        rows::SecondStepSolver construction_solver{skills_problem_data,
+                                                   search_params,
+                                                   visit_time_window,
+                                                   break_time_window,
+                                                   begin_end_shift_adjustment,
+                                                   boost::date_time::not_a_date_time};
+        rows::ConstructionHeuristic heuristic{construction_solver};
+        runner.Run("ConstructionHeuristic/Solve/150Carers600Visits", [&heuristic]() -> void {
+            BENCHMARK_SINK = heuristic.Solve().size();
+        });
+        LOG_IF(INFO, heuristic.inserted_visits() + heuristic.declined_visits() > 0)
+                << boost::format("Construction heuristic inserted %1% visits and declined %2% visits, travel time: %3%")
+                % heuristic.inserted_visits()
+                % heuristic.declined_visits()
+                % boost::posix_time::seconds(heuristic.travel_time());
+    }
+
+    // the same search with different restrictions of successors, the number of pruned arcs is logged,
+    // the search without local search filters shows how many moves per second the filters save
+    auto limited_search_params = search_params;
+    limited_search_params.set_local_search_metaheuristic(operations_research::LocalSearchMetaheuristic_Value_GUIDED_LOCAL_SEARCH);
+    limited_search_params.set_solution_limit(FLAGS_search_solutions);
+    const std::vector<std::pair<std::string, rows::NeighbourhoodOptions> > neighbourhoods{
+            {"Search/AllArcs",                     rows::NeighbourhoodOptions(false, 0)},
+            {"Search/PrunedArcs",                  rows::NeighbourhoodOptions(true, 0)},
+            {"Search/PrunedArcsNoFilters",         rows::NeighbourhoodOptions(true, 0, false)},
+            {"Search/PrunedArcsNearestNeighbours", rows::NeighbourhoodOptions(true, 8)}
+    };
+    for (const auto &neighbourhood : neighbourhoods) {
+        runner.Run(neighbourhood.first, [&]() -> void {
+            rows::SecondStepSolver search_solver{problem_data,
+                                                 limited_search_params,
+                                                 visit_time_window,
+                                                 break_time_window,
+                                                 begin_end_shift_adjustment,
+                                                 boost::date_time::not_a_date_time};
+            search_solver.SetNeighbourhoodOptions(neighbourhood.second);
+            operations_research::RoutingModel search_model{search_solver.index_manager()};
+            search_solver.ConfigureModel(search_model, printer, cancel_token, 1.0);
+            const auto solution = search_model.SolveWithParameters(limited_search_params);
+            BENCHMARK_SINK = solution != nullptr ? solution->ObjectiveValue() : -1;
+        });
+    }
+
+    return 0;
+}
@@ -0,0 +1,236 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <unordered_set>
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+
+#include <boost/filesystem.hpp>
+#include <boost/format.hpp>
+
+#include "util/logging.h"
+#include "util/validation.h"
+
+#include "run_manifest.h"
+
+DEFINE_string(manifest, "", "a file path to the manifest of the recorded run");
+DEFINE_validator(manifest, &util::file::Exists);
+
+DEFINE_string(solver, "", "a file path to the solver executable, by default rows-main next to rows-replay");
+
+DEFINE_string(replay_manifest, "replay_manifest.json", "a file path to save the manifest of the replayed run");
+
+DEFINE_string(replay_output, "replay_solution.gexf", "a file path to save the solution of the replayed run");
+
+DEFINE_double(cost_tolerance, 0.0, "relative difference of the cost which is not reported as a regression");
+
+DEFINE_double(wall_time_tolerance, 0.5, "relative difference of the stage wall time which is not reported as a regression");
+
+void ParseArgs(int argc, char *argv[]) {
+    gflags::SetVersionString("0.0.1");
+    gflags::SetUsageMessage("Robust Optimization for Workforce Scheduling\n"
+                            "Replays a solver run recorded in the manifest and compares the results\n"
+                            "Example: rows-replay"
+                            " --manifest=manifest.json"
+                            " --solver=./rows-main");
+
+    static const auto REMOVE_FLAGS = false;
+    gflags::ParseCommandLineFlags(&argc, &argv, REMOVE_FLAGS);
+
+    VLOG(1) << boost::format("Launched with the arguments:\n"
+                             "manifest: %1%\n"
+                             "solver: %2%\n"
+                             "replay-manifest: %3%\n"
+                             "replay-output: %4%\n"
+                             "cost-tolerance: %5%\n"
+                             "wall-time-tolerance: %6%")
+               % FLAGS_manifest
+               % FLAGS_solver
+               % FLAGS_replay_manifest
+               % FLAGS_replay_output
+               % FLAGS_cost_tolerance
+               % FLAGS_wall_time_tolerance;
+}
+
+std::string QuoteArgument(const std::string &value) {
+    std::string result{"'"};
+    for (const auto character : value) {
+        if (character == '\'') {
+            result += "'\\''";
+        } else {
+            result += character;
+        }
+    }
+    result += "'";
+    return result;
+}
+
+bool IsWithinTolerance(double recorded, double replayed, double tolerance) {
+    if (recorded == replayed) {
+        return true;
+    }
+
+    const auto scale = std::max(std::abs(recorded), std::abs(replayed));
+    return std::abs(recorded - replayed) <= tolerance * scale;
+}
+
+bool CheckInputs(const rows::RunManifest &manifest) {
+    auto inputs_match = true;
+    for (const auto &input : manifest.Inputs) {
+        const auto current_hash = rows::HashFile(input.Path);
+        if (current_hash != input.Hash) {
+            LOG(ERROR) << boost::format("Input %1% at %2% changed since the recording: %3% != %4%")
+                          % input.Name
+                          % input.Path
+                          % input.Hash
+                          % current_hash;
+            inputs_match = false;
+        }
+    }
+    return inputs_match;
+}
+
+std::string GetCommand(const std::string &solver_path, const rows::RunManifest &manifest) {
+    static const std::unordered_set<std::string> OVERRIDDEN_FLAGS{"output", "manifest", "trace_file"};
+
+    std::stringstream command;
+    command << QuoteArgument(solver_path);
+    for (const auto &flag : manifest.Flags) {
+        if (OVERRIDDEN_FLAGS.find(flag.first) != std::end(OVERRIDDEN_FLAGS)) {
+            continue;
+        }
+
+        command << " " << QuoteArgument("--" + flag.first + "=" + flag.second);
+    }
+    command << " " << QuoteArgument("--output=" + FLAGS_replay_output);
+    command << " " << QuoteArgument("--manifest=" + FLAGS_replay_manifest);
+    return command.str();
+}
+
+// returns the number of regressions
+std::size_t Compare(const rows::RunManifest &recorded, const rows::RunManifest &replayed) {
+    std::size_t regressions = 0;
+
+    if (recorded.ReturnCode != replayed.ReturnCode) {
+        std::cout << boost::format("Return code: %1% != %2%") % recorded.ReturnCode % replayed.ReturnCode << std::endl;
+        ++regressions;
+    }
+
+    std::cout << boost::format("%-16s | %16s | %16s | %8s | %8s | %8s | %8s")
+                 % "Solution" % "Cost" % "Replayed Cost" % "Dropped" % "Replayed" % "Invalid" % "Replayed" << std::endl;
+    const auto solution_count = std::max(recorded.Solutions.size(), replayed.Solutions.size());
+    for (std::size_t index = 0; index < solution_count; ++index) {
+        if (index >= recorded.Solutions.size() || index >= replayed.Solutions.size()) {
+            std::cout << "Number of solutions differs: " << recorded.Solutions.size() << " != " << replayed.Solutions.size() << std::endl;
+            ++regressions;
+            break;
+        }
+
+        const auto &recorded_solution = recorded.Solutions[index];
+        const auto &replayed_solution = replayed.Solutions[index];
+        const auto is_regression = recorded_solution.Stage != replayed_solution.Stage
+                                   || !IsWithinTolerance(recorded_solution.Cost, replayed_solution.Cost, FLAGS_cost_tolerance)
+                                   || recorded_solution.DroppedVisits != replayed_solution.DroppedVisits
+                                   || recorded_solution.InvalidRoutes != replayed_solution.InvalidRoutes;
+        std::cout << boost::format("%-16s | %16.2f | %16.2f | %8d | %8d | %8d | %8d%s")
+                     % recorded_solution.Stage
+                     % recorded_solution.Cost
+                     % replayed_solution.Cost
+                     % recorded_solution.DroppedVisits
+                     % replayed_solution.DroppedVisits
+                     % recorded_solution.InvalidRoutes
+                     % replayed_solution.InvalidRoutes
+                     % (is_regression ? " <<" : "") << std::endl;
+        if (is_regression) {
+            ++regressions;
+        }
+    }
+
+    // the trajectory is reproducible only if the search is deterministic
+    const auto trajectory_size = std::min(recorded.Trajectory.size(), replayed.Trajectory.size());
+    for (std::size_t index = 0; index < trajectory_size; ++index) {
+        const auto &recorded_point = recorded.Trajectory[index];
+        const auto &replayed_point = replayed.Trajectory[index];
+        if (recorded_point.Stage != replayed_point.Stage
+            || !IsWithinTolerance(recorded_point.Cost, replayed_point.Cost, FLAGS_cost_tolerance)
+            || recorded_point.DroppedVisits != replayed_point.DroppedVisits) {
+            std::cout << boost::format("Trajectory diverges at solution %1% of %2%: cost %3% != %4%, dropped visits %5% != %6%")
+                         % index
+                         % recorded_point.Stage
+                         % recorded_point.Cost
+                         % replayed_point.Cost
+                         % recorded_point.DroppedVisits
+                         % replayed_point.DroppedVisits << std::endl;
+            if (recorded.DeterministicSearch) {
+                ++regressions;
+            }
+            break;
+        }
+    }
+    if (recorded.Trajectory.size() != replayed.Trajectory.size()) {
+        std::cout << boost::format("Trajectory length: %1% != %2%") % recorded.Trajectory.size() % replayed.Trajectory.size() << std::endl;
+        if (recorded.DeterministicSearch) {
+            ++regressions;
+        }
+    }
+
+    // wall time is reported, but never affects the result, because it depends on the machine
+    std::cout << boost::format("%-16s | %12s | %12s | %8s") % "Stage" % "Wall Time" % "Replayed" % "Ratio" << std::endl;
+    for (const auto &recorded_stage : recorded.Stages) {
+        const auto replayed_stage_it = std::find_if(std::begin(replayed.Stages), std::end(replayed.Stages),
+                                                    [&recorded_stage](const rows::RunManifest::Stage &stage) -> bool {
+                                                        return stage.Name == recorded_stage.Name;
+                                                    });
+        if (replayed_stage_it == std::end(replayed.Stages)) {
+            std::cout << boost::format("%-16s | %10dms | %12s | %8s") % recorded_stage.Name % recorded_stage.WallTimeMs % "missing" % "" << std::endl;
+            continue;
+        }
+
+        const auto ratio = recorded_stage.WallTimeMs > 0
+                           ? static_cast<double>(replayed_stage_it->WallTimeMs) / recorded_stage.WallTimeMs
+                           : 1.0;
+        std::cout << boost::format("%-16s | %10dms | %10dms | %8.2f%s")
+                     % recorded_stage.Name
+                     % recorded_stage.WallTimeMs
+                     % replayed_stage_it->WallTimeMs
+                     % ratio
+                     % (std::abs(ratio - 1.0) > FLAGS_wall_time_tolerance ? " <<" : "") << std::endl;
+    }
+
+    return regressions;
+}
+
+int main(int argc, char *argv[]) {
+    util::SetupLogging(argv[0]);
+    ParseArgs(argc, argv);
+
+    const auto recorded_manifest = rows::RunManifest::Load(FLAGS_manifest);
+    if (!CheckInputs(recorded_manifest)) {
+        return 2;
+    }
+
+    auto solver_path = FLAGS_solver;
+    if (solver_path.empty()) {
+        solver_path = (boost::filesystem::path{argv[0]}.parent_path() / "rows-main").string();
+    }
+
+    FLAGS_replay_manifest = util::file::GenerateNewFilePath(FLAGS_replay_manifest);
+    FLAGS_replay_output = util::file::GenerateNewFilePath(FLAGS_replay_output);
+
+    const auto command = GetCommand(solver_path, recorded_manifest);
+    LOG(INFO) << "Replaying: " << command;
+    const auto status = std::system(command.c_str());
+    if (!boost::filesystem::exists(FLAGS_replay_manifest)) {
+        LOG(ERROR) << "The replayed run did not produce a manifest. Exit status: " << status;
+        return 2;
+    }
+
+    const auto replayed_manifest = rows::RunManifest::Load(FLAGS_replay_manifest);
+    const auto regressions = Compare(recorded_manifest, replayed_manifest);
+    std::cout << "Regressions: " << regressions << std::endl;
+    return regressions == 0 ? 0 : 1;
+}
@@ -27,11 +27,17 @@
 #include "event.h"
 #include "problem.h"
 #include "printer.h"
+#include "async_printer.h"
 #include "history.h"
 #include "scheduling_worker.h"
 #include "three_step_worker.h"
 #include "single_step_worker.h"
 #include "past_visit.h"
+#include "trace_writer.h"
+#include "deterministic_search.h"
+#include "run_manifest.h"
+#include "real_problem_data.h"
+#include "travel_speed_model.h"
 
 DEFINE_string(problem, "../problem.json", "a file path to the problem instance");
 DEFINE_validator(problem, &util::file::Exists);
@@ -39,8 +45,37 @@ DEFINE_validator(problem, &util::file::Exists);
 DEFINE_string(solution, "", "a file path to the solution file for warm start");
 DEFINE_validator(solution, &util::file::IsNullOrExists);
 
+DEFINE_string(delta,
+              "",
+              "a file path to changes of the schedule since the solution was computed,"
+              " visits of the solution which started before the time of the changes are kept and the rest is reoptimized"
+              " by the second stage, so the third stage must be none");
+DEFINE_validator(delta, &util::file::IsNullOrExists);
+
+// the map is validated only if the osrm travel model is used
 DEFINE_string(maps, "../data/scotland-latest.osrm", "a file path to the map");
-DEFINE_validator(maps, &util::file::Exists);
+
+bool ValidateTravelModel(const char *flagname, const std::string &value) {
+    if (value == "osrm" || value == "haversine" || value == "euclidean" || value == "manhattan") {
+        return true;
+    }
+
+    LOG(ERROR) << boost::format("Travel model '%1%' is not supported. Available options: osrm, haversine, euclidean or manhattan") % value;
+    return false;
+}
+
+DEFINE_string(travel_model,
+              "osrm",
+              "a method to compute travel times."
+              " Available options are: osrm which requires the map, haversine which estimates travel times from the distance,"
+              " euclidean and manhattan which use the straight line and the street grid distance of synthetic instances");
+DEFINE_validator(travel_model, &ValidateTravelModel);
+
+DEFINE_string(travel_speed_model,
+              "",
+              "a file path to the speed model used by the haversine travel model, which can be fitted by rows-travel-model,"
+              " the euclidean and manhattan travel models use only its speed");
+DEFINE_validator(travel_speed_model, &util::file::IsNullOrExists);
 
 DEFINE_string(console_format, "txt", "output format. Available options: txt, json or log");
 DEFINE_validator(console_format, &util::ValidateConsoleFormat);
@@ -95,6 +130,80 @@ DEFINE_validator(output, &util::file::IsNullOrNotExists);
 
 DEFINE_string(output_prefix, "solution", "a prefix that is added to the output file with a solution");
 
+DEFINE_string(trace_file, "", "a file path to save the trace of the computation in the Chrome trace event format");
+DEFINE_validator(trace_file, &util::file::IsNullOrNotExists);
+
+DEFINE_string(manifest, "", "a file path to save the manifest of the run, which can be replayed by rows-replay");
+DEFINE_validator(manifest, &util::file::IsNullOrNotExists);
+
+DEFINE_bool(deterministic, false, "replace wall-clock limits with solution and branch count limits and fix random seeds");
+
+static const auto DEFAULT_BRANCHES_LIMIT = std::numeric_limits<int64>::max();
+DEFINE_int64(branches_limit,
+             DEFAULT_BRANCHES_LIMIT,
+             "total number of branches explored in each stage of the computation in the deterministic mode");
+DEFINE_validator(branches_limit, &util::numeric::IsPositive);
+
+DEFINE_int32(random_seed, 12345, "seed of the random number generators in the deterministic mode");
+
+DEFINE_bool(prune_infeasible_arcs, true, "remove successors of visits which cannot be reached within the time window");
+
+DEFINE_int32(candidate_neighbours,
+             0,
+             "number of the nearest feasible successors of a visit considered by local search operators, unlimited if zero");
+
+DEFINE_bool(local_search_filters,
+            true,
+            "reject moves which break visits of multiple carers or continuity of care before the constraints propagate");
+
+DEFINE_bool(continuity_of_care,
+            false,
+            "limit the number of distinct carers who visit a service user");
+
+DEFINE_int32(decomposition_clusters,
+             0,
+             "number of geographic clusters solved independently to build the initial solution of the second stage,"
+             " the decomposition is disabled if smaller than two");
+
+DEFINE_int32(decomposition_threads, 1, "number of clusters solved at the same time");
+
+bool ValidateScenarioReduction(const char *flagname, const std::string &value) {
+    return static_cast<bool>(rows::ParseScenarioReductionStrategy(value));
+}
+
+DEFINE_string(scenario_reduction,
+              "none",
+              "a method to select historical dates evaluated as scenarios by the third stage."
+              " Available options are: none, uniform, stratified which samples every weekday and season"
+              " and kmedoids which clusters dates with similar visit durations");
+DEFINE_validator(scenario_reduction, &ValidateScenarioReduction);
+
+DEFINE_int32(scenarios, 0, "number of scenarios kept by the scenario reduction, all dates are kept if zero");
+
+DEFINE_int32(delay_sketch_resolution,
+             0,
+             "width in seconds of buckets in histograms of delays which confirm the riskiness of visits before it is computed"
+             " exactly by the third stage. Histograms are not used if zero");
+
+DEFINE_string(delay_sketch_range, "02:00:00", "delays are put into buckets of the histogram up to the range");
+DEFINE_validator(delay_sketch_range, &util::time_duration::IsNullOrPositive);
+
+DEFINE_bool(intermediate_solutions,
+            false,
+            "save the best solution of the second stage every time it improves."
+            " Solutions are validated and written by a background thread, so the search is not paused");
+
+DEFINE_int32(progress_buffer,
+             0,
+             "capacity of the buffer of progress steps which are formatted and printed by a background thread."
+             " Progress steps which do not fit are dropped. Progress steps are printed by the search thread if zero");
+
+DEFINE_string(time_budget,
+              "",
+              "overall time of the computation shared by the stages. A stage which stops improving gives its time to later stages"
+              " and no progress time limits which are not set explicitly are disabled");
+DEFINE_validator(time_budget, &util::time_duration::IsNullOrPositive);
+
 bool ValidateFirstStage(const char *flagname, const std::string &value) {
     return static_cast<bool>(rows::ParseFirstStageStrategy(value));
 }
@@ -106,7 +215,7 @@ bool ValidateThirdStage(const char *flagname, const std::string &value) {
 DEFINE_string(first_stage,
               "default",
               "a formulation used to compute schedule."
-              " Available options for this setting are: teams, soft-windows and none");
+              " Available options for this setting are: teams, soft-time-windows, construction and none");
 DEFINE_validator(first_stage, &ValidateFirstStage);
 
 DEFINE_string(third_stage,
@@ -159,7 +268,28 @@ void ParseArgs(int argc, char **argv) {
                              "post-opt-time-limit: %11%\n"
                              "solutions-limit: %12%\n"
                              "solve-all: %13%\n"
-                             "history: %14%")
+                             "history: %14%\n"
+                             "trace-file: %15%\n"
+                             "manifest: %16%\n"
+                             "deterministic: %17%\n"
+                             "branches-limit: %18%\n"
+                             "random-seed: %19%\n"
+                             "travel-model: %20%\n"
+                             "travel-speed-model: %21%\n"
+                             "prune-infeasible-arcs: %22%\n"
+                             "candidate-neighbours: %23%\n"
+                             "local-search-filters: %24%\n"
+                             "decomposition-clusters: %25%\n"
+                             "decomposition-threads: %26%\n"
+                             "delta: %27%\n"
+                             "time-budget: %28%\n"
+                             "scenario-reduction: %29%\n"
+                             "scenarios: %30%\n"
+                             "delay-sketch-resolution: %31%\n"
+                             "delay-sketch-range: %32%\n"
+                             "intermediate-solutions: %33%\n"
+                             "progress-buffer: %34%\n"
+                             "continuity-of-care: %35%")
                % FLAGS_problem
                % FLAGS_maps
                % FLAGS_solution
@@ -173,7 +303,28 @@ void ParseArgs(int argc, char **argv) {
                % FlagOrDefaultValue(FLAGS_postopt_noprogress_time_limit, "no")
                % FLAGS_solutions_limit
                % GetYesOrNoOption(FLAGS_solve_all)
-               % FlagOrDefaultValue(FLAGS_history, "not set");
+               % FlagOrDefaultValue(FLAGS_history, "not set")
+               % FlagOrDefaultValue(FLAGS_trace_file, "not set")
+               % FlagOrDefaultValue(FLAGS_manifest, "not set")
+               % GetYesOrNoOption(FLAGS_deterministic)
+               % FLAGS_branches_limit
+               % FLAGS_random_seed
+               % FLAGS_travel_model
+               % FlagOrDefaultValue(FLAGS_travel_speed_model, "default")
+               % GetYesOrNoOption(FLAGS_prune_infeasible_arcs)
+               % FLAGS_candidate_neighbours
+               % GetYesOrNoOption(FLAGS_local_search_filters)
+               % FLAGS_decomposition_clusters
+               % FLAGS_decomposition_threads
+               % FlagOrDefaultValue(FLAGS_delta, "not set")
+               % FlagOrDefaultValue(FLAGS_time_budget, "not set")
+               % FLAGS_scenario_reduction
+               % FLAGS_scenarios
+               % FLAGS_delay_sketch_resolution
+               % FLAGS_delay_sketch_range
+               % GetYesOrNoOption(FLAGS_intermediate_solutions)
+               % FLAGS_progress_buffer
+               % GetYesOrNoOption(FLAGS_continuity_of_care);
 }
 
 //int RunSingleStepSchedulingWorker() {
@@ -225,14 +376,20 @@ int RunSchedulingWorker(std::shared_ptr<rows::Printer> printer,
                         const rows::Problem &problem,
                         std::shared_ptr<const rows::History> history,
                         const std::string &output,
-                        osrm::EngineConfig &engine_config,
+                        std::shared_ptr<rows::ProblemDataFactory> problem_data_factory_ptr,
                         const boost::posix_time::time_duration &visit_time_window,
                         const boost::posix_time::time_duration &break_time_window,
                         const boost::posix_time::time_duration &begin_end_shift_time_extension,
                         const boost::posix_time::time_duration &pre_opt_noprogress_time_limit,
                         const boost::posix_time::time_duration &opt_noprogress_time_limit,
-                        const boost::posix_time::time_duration &post_opt_noprogress_time_limit) {
-    auto problem_data_factory_ptr = std::make_shared<rows::RealProblemDataFactory>(engine_config);
+                        const boost::posix_time::time_duration &post_opt_noprogress_time_limit,
+                        const boost::optional<rows::DeterministicSearchOptions> &deterministic_search,
+                        const rows::NeighbourhoodOptions &neighbourhood_options,
+                        const rows::DecompositionOptions &decomposition_options,
+                        const rows::ScenarioReductionOptions &scenario_reduction_options,
+                        const rows::DelaySketchOptions &delay_sketch_options,
+                        bool intermediate_solutions,
+                        const boost::optional<rows::TimeBudgetOptions> &time_budget) {
     auto problem_data = problem_data_factory_ptr->makeProblem(problem);
 
     if (first_stage_strategy != rows::FirstStageStrategy::NONE || third_stage_strategy != rows::ThirdStageStrategy::NONE) {
@@ -251,10 +408,31 @@ int RunSchedulingWorker(std::shared_ptr<rows::Printer> printer,
                         post_opt_noprogress_time_limit,
                         boost::none,
                         1.0)) {
+            if (deterministic_search) {
+                worker.EnableDeterministicSearch(*deterministic_search);
+            }
+            worker.SetNeighbourhoodOptions(neighbourhood_options);
+            worker.SetDecompositionOptions(decomposition_options);
+            worker.SetScenarioReductionOptions(scenario_reduction_options);
+            worker.SetDelaySketchOptions(delay_sketch_options);
+            if (intermediate_solutions) {
+                worker.EnableIntermediateSolutions();
+            }
+            if (time_budget) {
+                worker.EnableTimeBudget(*time_budget);
+            }
             worker.Run();
         }
         return worker.ReturnCode();
     } else {
+        LOG_IF(WARNING, deterministic_search) << "Deterministic search is not supported by the single step worker";
+        LOG_IF(WARNING, neighbourhood_options.CandidateNeighbours > 0) << "Candidate neighbours are not supported by the single step worker";
+        LOG_IF(WARNING, decomposition_options.Clusters > 1) << "Decomposition is not supported by the single step worker";
+        LOG_IF(WARNING, scenario_reduction_options.Strategy != rows::ScenarioReductionStrategy::NONE)
+        << "Scenario reduction is not supported by the single step worker";
+        LOG_IF(WARNING, time_budget) << "Time budget is not supported by the single step worker";
+        LOG_IF(WARNING, intermediate_solutions) << "Intermediate solutions are not supported by the single step worker";
+
         rows::SingleStepSchedulingWorker worker{std::move(printer)};
         if (worker.Init(*problem_data,
                         output,
@@ -275,14 +453,21 @@ int RunCancellableSchedulingWorker(std::shared_ptr<rows::Printer> printer,
                                    const rows::Problem &problem,
                                    std::shared_ptr<const rows::History> history,
                                    const std::string &output,
-                                   osrm::EngineConfig &engine_config,
+                                   std::shared_ptr<rows::ProblemDataFactory> problem_data_factory_ptr,
                                    const boost::posix_time::time_duration &visit_time_window,
                                    const boost::posix_time::time_duration &break_time_window,
                                    const boost::posix_time::time_duration &begin_end_shift_time_extension,
                                    const boost::posix_time::time_duration &pre_opt_noprogress_time_limit,
                                    const boost::posix_time::time_duration &opt_noprogress_time_limit,
-                                   const boost::posix_time::time_duration &post_opt_noprogress_time_limit) {
-    auto problem_data_factory_ptr = std::make_shared<rows::RealProblemDataFactory>(engine_config);
+                                   const boost::posix_time::time_duration &post_opt_noprogress_time_limit,
+                                   const boost::optional<rows::DeterministicSearchOptions> &deterministic_search,
+                                   const rows::NeighbourhoodOptions &neighbourhood_options,
+                                   const rows::DecompositionOptions &decomposition_options,
+                                   const rows::ScenarioReductionOptions &scenario_reduction_options,
+                                   const rows::DelaySketchOptions &delay_sketch_options,
+                                   bool intermediate_solutions,
+                                   const boost::optional<rows::ReoptimizationOptions> &reoptimization,
+                                   const boost::optional<rows::TimeBudgetOptions> &time_budget) {
     const auto problem_data = problem_data_factory_ptr->makeProblem(problem);
     if (first_stage_strategy != rows::FirstStageStrategy::NONE || third_stage_strategy != rows::ThirdStageStrategy::NONE) {
         rows::ThreeStepSchedulingWorker worker{std::move(printer),
@@ -300,6 +485,22 @@ int RunCancellableSchedulingWorker(std::shared_ptr<rows::Printer> printer,
                         post_opt_noprogress_time_limit,
                         boost::none,
                         1.0)) {
+            if (deterministic_search) {
+                worker.EnableDeterministicSearch(*deterministic_search);
+            }
+            worker.SetNeighbourhoodOptions(neighbourhood_options);
+            worker.SetDecompositionOptions(decomposition_options);
+            worker.SetScenarioReductionOptions(scenario_reduction_options);
+            worker.SetDelaySketchOptions(delay_sketch_options);
+            if (intermediate_solutions) {
+                worker.EnableIntermediateSolutions();
+            }
+            if (reoptimization) {
+                worker.EnableReoptimization(*reoptimization);
+            }
+            if (time_budget) {
+                worker.EnableTimeBudget(*time_budget);
+            }
             worker.Start();
             std::thread chat_thread(util::ChatBot<rows::SchedulingWorker>, std::ref(worker));
             chat_thread.detach();
@@ -307,6 +508,15 @@ int RunCancellableSchedulingWorker(std::shared_ptr<rows::Printer> printer,
         }
         return worker.ReturnCode();
     } else {
+        LOG_IF(WARNING, deterministic_search) << "Deterministic search is not supported by the single step worker";
+        LOG_IF(WARNING, neighbourhood_options.CandidateNeighbours > 0) << "Candidate neighbours are not supported by the single step worker";
+        LOG_IF(WARNING, decomposition_options.Clusters > 1) << "Decomposition is not supported by the single step worker";
+        LOG_IF(WARNING, scenario_reduction_options.Strategy != rows::ScenarioReductionStrategy::NONE)
+        << "Scenario reduction is not supported by the single step worker";
+        LOG_IF(WARNING, time_budget) << "Time budget is not supported by the single step worker";
+        LOG_IF(WARNING, intermediate_solutions) << "Intermediate solutions are not supported by the single step worker";
+        LOG_IF(WARNING, reoptimization) << "Reoptimization is not supported by the single step worker";
+
         rows::SingleStepSchedulingWorker worker{std::move(printer)};
         if (worker.Init(*problem_data,
                         output,
@@ -325,24 +535,120 @@ int RunCancellableSchedulingWorker(std::shared_ptr<rows::Printer> printer,
     }
 }
 
+std::shared_ptr<rows::ProblemDataFactory> CreateProblemDataFactory() {
+    return util::CreateProblemDataFactory(FLAGS_travel_model, FLAGS_travel_speed_model, FLAGS_maps);
+}
+
 int RunSchedulingWorkerEx(const std::shared_ptr<rows::Printer> &printer,
                           std::shared_ptr<const rows::History> history,
                           const rows::FirstStageStrategy &first_stage_strategy,
-                          const rows::ThirdStageStrategy &third_stage_strategy) {
-    auto engine_config = util::CreateEngineConfig(FLAGS_maps);
+                          const rows::ThirdStageStrategy &third_stage_strategy,
+                          const boost::optional<rows::DeterministicSearchOptions> &deterministic_search,
+                          const rows::NeighbourhoodOptions &neighbourhood_options,
+                          const rows::DecompositionOptions &decomposition_options,
+                          const rows::ScenarioReductionOptions &scenario_reduction_options,
+                          const rows::DelaySketchOptions &delay_sketch_options,
+                          bool intermediate_solutions,
+                          const boost::optional<rows::TimeBudgetOptions> &time_budget) {
+    auto problem = util::LoadReducedProblem(FLAGS_problem, FLAGS_scheduling_date, printer);
+
+    boost::optional<rows::ReoptimizationOptions> reoptimization = boost::none;
+    if (!FLAGS_delta.empty()) {
+        const auto delta = util::LoadScheduleDelta(FLAGS_delta);
+        problem = delta.Apply(problem);
+
+        const auto visit_time_window = util::GetTimeDurationOrDefault(FLAGS_visit_time_window, boost::posix_time::seconds(0));
+        reoptimization = rows::ReoptimizationOptions{util::LoadSolution(FLAGS_solution, problem, visit_time_window),
+                                                     delta.current_time()};
+    }
+
     return RunCancellableSchedulingWorker(printer,
                                           first_stage_strategy,
                                           third_stage_strategy,
-                                          util::LoadReducedProblem(FLAGS_problem, FLAGS_scheduling_date, printer),
+                                          problem,
                                           std::move(history),
                                           FLAGS_output,
-                                          engine_config,
+                                          CreateProblemDataFactory(),
                                           util::GetTimeDurationOrDefault(FLAGS_visit_time_window, boost::posix_time::not_a_date_time),
                                           util::GetTimeDurationOrDefault(FLAGS_break_time_window, boost::posix_time::not_a_date_time),
                                           util::GetTimeDurationOrDefault(FLAGS_begin_end_shift_time_extension, boost::posix_time::not_a_date_time),
                                           util::GetTimeDurationOrDefault(FLAGS_preopt_noprogress_time_limit, boost::posix_time::not_a_date_time),
                                           util::GetTimeDurationOrDefault(FLAGS_opt_noprogress_time_limit, boost::posix_time::not_a_date_time),
-                                          util::GetTimeDurationOrDefault(FLAGS_postopt_noprogress_time_limit, boost::posix_time::not_a_date_time));
+                                          util::GetTimeDurationOrDefault(FLAGS_postopt_noprogress_time_limit, boost::posix_time::not_a_date_time),
+                                          deterministic_search,
+                                          neighbourhood_options,
+                                          decomposition_options,
+                                          scenario_reduction_options,
+                                          delay_sketch_options,
+                                          intermediate_solutions,
+                                          reoptimization,
+                                          time_budget);
+}
+
+boost::optional<rows::DeterministicSearchOptions> GetDeterministicSearchOptions() {
+    static const int64 DEFAULT_DETERMINISTIC_SOLUTION_LIMIT = 1000;
+
+    if (!FLAGS_deterministic) {
+        return boost::none;
+    }
+
+    // the search would never terminate without any limit
+    auto solution_limit = FLAGS_solutions_limit;
+    if (solution_limit == DEFAULT_SOLUTION_LIMIT && FLAGS_branches_limit == DEFAULT_BRANCHES_LIMIT) {
+        solution_limit = DEFAULT_DETERMINISTIC_SOLUTION_LIMIT;
+    }
+
+    return rows::DeterministicSearchOptions(solution_limit, FLAGS_branches_limit, FLAGS_random_seed);
+}
+
+boost::optional<rows::TimeBudgetOptions> GetTimeBudgetOptions() {
+    if (FLAGS_time_budget.empty()) {
+        return boost::none;
+    }
+
+    if (FLAGS_deterministic) {
+        throw util::ApplicationError("The time budget depends on the wall clock and cannot be used in the deterministic mode",
+                                     util::ErrorCode::ERROR);
+    }
+
+    // stages are stopped by the budget, unless no progress time limits are set explicitly
+    for (const auto &flag_name : {"preopt_noprogress_time_limit", "opt_noprogress_time_limit", "postopt_noprogress_time_limit"}) {
+        if (gflags::GetCommandLineFlagInfoOrDie(flag_name).is_default) {
+            gflags::SetCommandLineOption(flag_name, "");
+        }
+    }
+
+    return rows::TimeBudgetOptions{util::GetTimeDurationOrDefault(FLAGS_time_budget, boost::posix_time::not_a_date_time)};
+}
+
+std::shared_ptr<rows::RunManifest> CreateRunManifest(const boost::optional<rows::DeterministicSearchOptions> &deterministic_search) {
+    auto manifest = std::make_shared<rows::RunManifest>();
+
+    manifest->Inputs.push_back({"problem", FLAGS_problem, rows::HashFile(FLAGS_problem)});
+    if (!FLAGS_history.empty()) {
+        manifest->Inputs.push_back({"history", FLAGS_history, rows::HashFile(FLAGS_history)});
+    }
+    if (!FLAGS_travel_speed_model.empty()) {
+        manifest->Inputs.push_back({"travel_speed_model", FLAGS_travel_speed_model, rows::HashFile(FLAGS_travel_speed_model)});
+    }
+    if (!FLAGS_solution.empty()) {
+        manifest->Inputs.push_back({"solution", FLAGS_solution, rows::HashFile(FLAGS_solution)});
+    }
+    if (!FLAGS_delta.empty()) {
+        manifest->Inputs.push_back({"delta", FLAGS_delta, rows::HashFile(FLAGS_delta)});
+    }
+
+    // record only flags of the solver, but not the flags of the libraries
+    std::vector<gflags::CommandLineFlagInfo> flags;
+    gflags::GetAllFlags(&flags);
+    for (const auto &flag : flags) {
+        if (flag.filename == __FILE__) {
+            manifest->Flags.emplace(flag.name, flag.current_value);
+        }
+    }
+
+    manifest->DeterministicSearch = deterministic_search;
+    return manifest;
 }
 
 int main(int argc, char **argv) {
@@ -352,42 +658,37 @@ int main(int argc, char **argv) {
     const auto first_stage_strategy = rows::ParseFirstStageStrategy(FLAGS_first_stage).get();
     const auto third_stage_strategy = rows::ParseThirdStageStrategy(FLAGS_third_stage).get();
 
+    if (!FLAGS_trace_file.empty()) {
+        rows::TraceWriter::Instance().Open(FLAGS_trace_file);
+    }
+
     std::shared_ptr<rows::Printer> printer = util::CreatePrinter(FLAGS_console_format);
+    if (FLAGS_progress_buffer > 0) {
+        printer = std::make_shared<rows::AsyncPrinter>(printer, static_cast<std::size_t>(FLAGS_progress_buffer));
+    }
+
+    const auto deterministic_search = GetDeterministicSearchOptions();
+    const auto time_budget = GetTimeBudgetOptions();
+    const rows::NeighbourhoodOptions neighbourhood_options{FLAGS_prune_infeasible_arcs,
+                                                           static_cast<std::size_t>(std::max(FLAGS_candidate_neighbours, 0)),
+                                                           FLAGS_local_search_filters,
+                                                           FLAGS_continuity_of_care};
+    const rows::DecompositionOptions decomposition_options{static_cast<std::size_t>(std::max(FLAGS_decomposition_clusters, 0)),
+                                                           static_cast<std::size_t>(std::max(FLAGS_decomposition_threads, 1))};
+    const rows::ScenarioReductionOptions scenario_reduction_options{rows::ParseScenarioReductionStrategy(FLAGS_scenario_reduction).get(),
+                                                                    static_cast<std::size_t>(std::max(FLAGS_scenarios, 0))};
+    const rows::DelaySketchOptions delay_sketch_options{
+            std::max(FLAGS_delay_sketch_resolution, 0),
+            util::GetTimeDurationOrDefault(FLAGS_delay_sketch_range, boost::posix_time::hours(2)).total_seconds()};
+    std::shared_ptr<rows::RunManifest> manifest;
+    if (!FLAGS_manifest.empty()) {
+        manifest = CreateRunManifest(deterministic_search);
+        printer = std::make_shared<rows::RecordingPrinter>(printer, manifest);
+    }
 
     std::shared_ptr<const rows::History> history;
     if (!FLAGS_history.empty()) {
-        const auto loading_history_start = std::chrono::high_resolution_clock::now();
-
-        std::ifstream past_visit_stream;
-        past_visit_stream.open(FLAGS_history);
-        if (!past_visit_stream.is_open()) {
-            throw util::ApplicationError((boost::format("Failed to open the file: %1%") % FLAGS_history).str(), util::ErrorCode::ERROR);
-        }
-
-        nlohmann::json past_visits_json;
-        try {
-            past_visit_stream >> past_visits_json;
-        } catch (...) {
-            throw util::ApplicationError((boost::format("Failed to open the file: %1%") % FLAGS_history).str(),
-                                         boost::current_exception_diagnostic_information(),
-                                         util::ErrorCode::ERROR);
-        }
-
-        try {
-            std::vector<rows::PastVisit> past_visits = past_visits_json.get<std::vector<rows::PastVisit>>();
-            history = std::make_shared<const rows::History>(std::move(past_visits));
-        } catch (...) {
-            throw util::ApplicationError((boost::format("Failed to parse the file: %1%") % FLAGS_history).str(),
-                                         boost::current_exception_diagnostic_information(),
-                                         util::ErrorCode::ERROR);
-        }
-
-        past_visit_stream.close();
-        const auto loading_history_end = std::chrono::high_resolution_clock::now();
-
-        LOG(INFO) << "Loaded past visits in "
-                  << std::chrono::duration_cast<std::chrono::seconds>(loading_history_end - loading_history_start).count()
-                  << " seconds";
+        history = util::LoadHistory(FLAGS_history);
     } else {
         history = std::make_shared<const rows::History>();
     }
@@ -399,6 +700,16 @@ int main(int argc, char **argv) {
     }
 
 
+    if (!FLAGS_delta.empty() && (FLAGS_solution.empty() || FLAGS_solve_all)) {
+        throw util::ApplicationError("The delta is applied to the previous solution of a single day, set the solution and do not solve all days",
+                                     util::ErrorCode::ERROR);
+    }
+
+    if (!FLAGS_delta.empty() && third_stage_strategy != rows::ThirdStageStrategy::NONE) {
+        throw util::ApplicationError("The third stage is not used in the reoptimization, set the third stage to none",
+                                     util::ErrorCode::ERROR);
+    }
+
     if (FLAGS_solve_all) {
         const auto problem = util::LoadProblem(FLAGS_problem, printer);
 
@@ -420,7 +731,7 @@ int main(int argc, char **argv) {
             sub_problems.push_back(problem.Trim(boost::posix_time::ptime(date, boost::posix_time::time_duration{}), boost::posix_time::hours(24)));
         }
 
-        auto engine_config = util::CreateEngineConfig(FLAGS_maps);
+        const auto problem_data_factory = CreateProblemDataFactory();
         const auto visit_time_window = util::GetTimeDurationOrDefault(FLAGS_visit_time_window, boost::posix_time::not_a_date_time);
         const auto break_time_window = util::GetTimeDurationOrDefault(FLAGS_break_time_window, boost::posix_time::not_a_date_time);
         const auto begin_end_shift_time_extension = util::GetTimeDurationOrDefault(FLAGS_begin_end_shift_time_extension,
@@ -452,13 +763,20 @@ int main(int argc, char **argv) {
                                    const rows::Problem &,
                                    std::shared_ptr<const rows::History>,
                                    const std::string &,
-                                   osrm::EngineConfig &,
+                                   std::shared_ptr<rows::ProblemDataFactory>,
+                                   const boost::posix_time::time_duration,
                                    const boost::posix_time::time_duration,
                                    const boost::posix_time::time_duration,
                                    const boost::posix_time::time_duration,
                                    const boost::posix_time::time_duration,
                                    const boost::posix_time::time_duration,
-                                   const boost::posix_time::time_duration)> compute_schedule(
+                                   const boost::optional<rows::DeterministicSearchOptions> &,
+                                   const rows::NeighbourhoodOptions &,
+                                   const rows::DecompositionOptions &,
+                                   const rows::ScenarioReductionOptions &,
+                                   const rows::DelaySketchOptions &,
+                                   bool,
+                                   const boost::optional<rows::TimeBudgetOptions> &)> compute_schedule(
                     RunSchedulingWorker);
             compute_schedule(printer,
                              first_stage_strategy,
@@ -466,13 +784,20 @@ int main(int argc, char **argv) {
                              sub_problem,
                              history,
                              output_file,
-                             engine_config,
+                             problem_data_factory,
                              visit_time_window,
                              break_time_window,
                              begin_end_shift_time_extension,
                              pre_opt_no_progress_time_limit,
                              opt_no_progress_time_limit,
-                             post_opt_no_progress_time_limit);
+                             post_opt_no_progress_time_limit,
+                             deterministic_search,
+                             neighbourhood_options,
+                             decomposition_options,
+                             scenario_reduction_options,
+                             delay_sketch_options,
+                             FLAGS_intermediate_solutions,
+                             time_budget);
 
             compute_tasks.push_back(compute_schedule.get_future());
         }
@@ -487,8 +812,26 @@ int main(int argc, char **argv) {
             }
         }
 
+        if (manifest) {
+            manifest->Save(FLAGS_manifest);
+        }
         return 0;
     } else {
-        return RunSchedulingWorkerEx(printer, history, first_stage_strategy, third_stage_strategy);
+        const auto return_code = RunSchedulingWorkerEx(printer,
+                                                        history,
+                                                        first_stage_strategy,
+                                                        third_stage_strategy,
+                                                        deterministic_search,
+                                                        neighbourhood_options,
+                                                        decomposition_options,
+                                                        scenario_reduction_options,
+                                                        delay_sketch_options,
+                                                        FLAGS_intermediate_solutions,
+                                                        time_budget);
+        if (manifest) {
+            manifest->ReturnCode = return_code;
+            manifest->Save(FLAGS_manifest);
+        }
+        return return_code;
     }
 }
\ No newline at end of file
@@ -0,0 +1,203 @@
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+
+#include <boost/format.hpp>
+
+#include <nlohmann/json.hpp>
+
+#include "util/input.h"
+#include "util/logging.h"
+#include "util/validation.h"
+
+#include "location_container.h"
+#include "problem.h"
+#include "real_problem_data.h"
+#include "travel_speed_model.h"
+
+DEFINE_string(problem, "../problem.json", "a file path to the problem instance which provides locations");
+DEFINE_validator(problem, &util::file::Exists);
+
+DEFINE_string(maps, "../data/scotland-latest.osrm", "a file path to the map");
+DEFINE_validator(maps, &util::file::Exists);
+
+DEFINE_string(output, "", "a file path to save the fitted speed model");
+DEFINE_validator(output, &util::file::IsNullOrNotExists);
+
+DEFINE_int32(samples, 2000, "number of journeys between random pairs of locations queried from the map");
+DEFINE_validator(samples, &util::numeric::IsPositive);
+
+DEFINE_double(validation_fraction, 0.25, "fraction of samples used to evaluate the fitted model");
+
+DEFINE_int32(seed, 1, "seed of the random number generator");
+
+DEFINE_double(speed, 8.0, "average speed in meters per second");
+DEFINE_validator(speed, &util::numeric::IsPositive);
+
+DEFINE_int64(fixed_duration, 60, "duration in seconds added to every journey");
+
+DEFINE_double(region_size, 0.05, "side of a region with a separate correction factor in degrees, regional corrections are disabled if zero");
+
+DEFINE_int32(min_region_samples, 30, "minimum number of samples to fit a regional correction factor");
+
+void ParseArgs(int argc, char *argv[]) {
+    gflags::SetVersionString("0.0.1");
+    gflags::SetUsageMessage("Robust Optimization for Workforce Scheduling\n"
+                            "Fits the speed model of the haversine travel model to travel times computed from the map\n"
+                            "Example: rows-travel-model"
+                            " --problem=problem.json"
+                            " --maps=./data/scotland-latest.osrm"
+                            " --output=travel_speed_model.json");
+
+    static const auto REMOVE_FLAGS = false;
+    gflags::ParseCommandLineFlags(&argc, &argv, REMOVE_FLAGS);
+
+    VLOG(1) << boost::format("Launched with the arguments:\n"
+                             "problem: %1%\n"
+                             "maps: %2%\n"
+                             "output: %3%\n"
+                             "samples: %4%\n"
+                             "validation_fraction: %5%\n"
+                             "seed: %6%\n"
+                             "speed: %7%\n"
+                             "fixed_duration: %8%\n"
+                             "region_size: %9%\n"
+                             "min_region_samples: %10%")
+               % FLAGS_problem
+               % FLAGS_maps
+               % FLAGS_output
+               % FLAGS_samples
+               % FLAGS_validation_fraction
+               % FLAGS_seed
+               % FLAGS_speed
+               % FLAGS_fixed_duration
+               % FLAGS_region_size
+               % FLAGS_min_region_samples;
+}
+
+std::vector<rows::TravelSample> GetSamples(const std::vector<rows::Location> &locations,
+                                           rows::LocationContainer &location_container,
+                                           std::mt19937 &random_engine) {
+    static const auto INFINITE_DISTANCE = std::numeric_limits<int64>::max();
+
+    std::uniform_int_distribution<std::size_t> location_distribution{0, locations.size() - 1};
+
+    std::vector<rows::TravelSample> samples;
+    samples.reserve(static_cast<std::size_t>(FLAGS_samples));
+    while (samples.size() < static_cast<std::size_t>(FLAGS_samples)) {
+        const auto &from = locations[location_distribution(random_engine)];
+        const auto &to = locations[location_distribution(random_engine)];
+        if (from == to) {
+            continue;
+        }
+
+        const auto duration = location_container.Distance(from, to);
+        if (duration == INFINITE_DISTANCE) {
+            continue;
+        }
+
+        samples.push_back({from, to, duration});
+    }
+    return samples;
+}
+
+double GetPercentile(const std::vector<double> &sorted_values, double percentile) {
+    DCHECK(!sorted_values.empty());
+
+    const auto index = static_cast<std::size_t>(std::round(percentile * (sorted_values.size() - 1)));
+    return sorted_values[index];
+}
+
+void PrintErrors(const std::string &model_name,
+                 const rows::TravelSpeedModel &model,
+                 const std::vector<rows::TravelSample> &samples) {
+    rows::HaversineLocationContainer location_container{model};
+
+    std::vector<double> absolute_errors;
+    std::vector<double> relative_errors;
+    absolute_errors.reserve(samples.size());
+    relative_errors.reserve(samples.size());
+    for (const auto &sample : samples) {
+        if (sample.Duration <= 0) {
+            continue;
+        }
+
+        const auto error = static_cast<double>(location_container.Distance(sample.From, sample.To) - sample.Duration);
+        absolute_errors.push_back(error);
+        relative_errors.push_back(error / sample.Duration);
+    }
+
+    if (absolute_errors.empty()) {
+        std::cout << boost::format("%1%: no samples to evaluate") % model_name << std::endl;
+        return;
+    }
+
+    std::sort(std::begin(absolute_errors), std::end(absolute_errors));
+    std::sort(std::begin(relative_errors), std::end(relative_errors));
+
+    auto mean_absolute_error = 0.0;
+    for (const auto error : absolute_errors) {
+        mean_absolute_error += std::abs(error);
+    }
+    mean_absolute_error /= absolute_errors.size();
+
+    std::cout << boost::format("%1%: samples %2%, mean absolute error %3$.1fs") % model_name % absolute_errors.size() % mean_absolute_error
+              << std::endl;
+    std::cout << boost::format("%10s | %12s | %12s") % "Percentile" % "Error" % "Relative" << std::endl;
+    for (const auto percentile : {0.05, 0.25, 0.5, 0.75, 0.95}) {
+        std::cout << boost::format("%10d | %11.1fs | %11.1f%%")
+                     % static_cast<int>(percentile * 100)
+                     % GetPercentile(absolute_errors, percentile)
+                     % (100.0 * GetPercentile(relative_errors, percentile)) << std::endl;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    util::SetupLogging(argv[0]);
+    ParseArgs(argc, argv);
+
+    const auto printer = util::CreatePrinter(util::LOG_FORMAT);
+    const auto problem = util::LoadProblem(FLAGS_problem, printer);
+    const auto locations = rows::GetDistinctLocations(problem);
+    CHECK_GT(locations.size(), 1) << "At least two distinct locations are required";
+
+    std::mt19937 random_engine{static_cast<uint32_t>(FLAGS_seed)};
+    rows::RealLocationContainer location_container{util::CreateEngineConfig(FLAGS_maps)};
+    auto samples = GetSamples(locations, location_container, random_engine);
+
+    const auto validation_samples_count = static_cast<std::size_t>(std::round(FLAGS_validation_fraction * samples.size()));
+    CHECK_LT(validation_samples_count, samples.size()) << "No samples are left to fit the model";
+    const std::vector<rows::TravelSample> validation_samples{std::begin(samples), std::begin(samples) + validation_samples_count};
+    const std::vector<rows::TravelSample> training_samples{std::begin(samples) + validation_samples_count, std::end(samples)};
+
+    const auto global_model = rows::FitTravelSpeedModel(training_samples, FLAGS_speed, FLAGS_fixed_duration, 0.0, 0);
+    const auto regional_model = rows::FitTravelSpeedModel(training_samples,
+                                                          FLAGS_speed,
+                                                          FLAGS_fixed_duration,
+                                                          FLAGS_region_size,
+                                                          static_cast<std::size_t>(FLAGS_min_region_samples));
+
+    const auto &evaluation_samples = validation_samples.empty() ? training_samples : validation_samples;
+    PrintErrors("Default", rows::TravelSpeedModel{}, evaluation_samples);
+    PrintErrors("Global road factor", global_model, evaluation_samples);
+    if (FLAGS_region_size > 0.0) {
+        PrintErrors((boost::format("Regional road factors (%1% regions)") % regional_model.Regions.size()).str(),
+                    regional_model,
+                    evaluation_samples);
+    }
+
+    if (!FLAGS_output.empty()) {
+        std::ofstream output_stream{FLAGS_output, std::ios::out | std::ios::trunc};
+        CHECK(output_stream.is_open()) << "Failed to open the file: " << FLAGS_output;
+        const nlohmann::json model_json = FLAGS_region_size > 0.0 ? regional_model : global_model;
+        output_stream << model_json.dump(2);
+    }
+
+    return 0;
+}
@@ -0,0 +1,216 @@
+#include "run_manifest.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+
+#include <boost/format.hpp>
+
+#include "util/aplication_error.h"
+
+namespace rows {
+
+    RunManifest::RunManifest()
+            : ReturnCode{0} {}
+
+    RunManifest RunManifest::Load(const std::string &file_path) {
+        std::ifstream input_stream{file_path};
+        if (!input_stream.is_open()) {
+            throw util::ApplicationError((boost::format("Failed to open the file: %1%") % file_path).str(), util::ErrorCode::ERROR);
+        }
+
+        nlohmann::json json;
+        input_stream >> json;
+        return json.get<RunManifest>();
+    }
+
+    void RunManifest::Save(const std::string &file_path) const {
+        std::ofstream output_stream{file_path, std::ios::out | std::ios::trunc};
+        if (!output_stream.is_open()) {
+            throw util::ApplicationError((boost::format("Failed to open the file: %1%") % file_path).str(), util::ErrorCode::ERROR);
+        }
+
+        output_stream << nlohmann::json(*this).dump(2);
+    }
+
+    void to_json(nlohmann::json &json, const RunManifest &manifest) {
+        nlohmann::json inputs = nlohmann::json::array();
+        for (const auto &input : manifest.Inputs) {
+            inputs.push_back({
+                                     {"name", input.Name},
+                                     {"path", input.Path},
+                                     {"hash", input.Hash}
+                             });
+        }
+
+        nlohmann::json stages = nlohmann::json::array();
+        for (const auto &stage : manifest.Stages) {
+            stages.push_back({
+                                     {"name",         stage.Name},
+                                     {"wall_time_ms", stage.WallTimeMs}
+                             });
+        }
+
+        nlohmann::json trajectory = nlohmann::json::array();
+        for (const auto &point : manifest.Trajectory) {
+            trajectory.push_back({
+                                         {"stage",          point.Stage},
+                                         {"cost",           point.Cost},
+                                         {"dropped_visits", point.DroppedVisits},
+                                         {"branches",       point.Branches},
+                                         {"solutions",      point.Solutions},
+                                         {"wall_time_ms",   point.WallTimeMs}
+                                 });
+        }
+
+        json = nlohmann::json{
+                {"inputs",      inputs},
+                {"flags",       manifest.Flags},
+                {"stages",      stages},
+                {"trajectory",  trajectory},
+                {"solutions",   manifest.Solutions},
+                {"return_code", manifest.ReturnCode}
+        };
+
+        if (manifest.DeterministicSearch) {
+            json["deterministic_search"] = *manifest.DeterministicSearch;
+        }
+    }
+
+    void from_json(const nlohmann::json &json, RunManifest &manifest) {
+        manifest.Inputs.clear();
+        for (const auto &input : json.at("inputs")) {
+            manifest.Inputs.push_back({input.at("name").get<std::string>(),
+                                       input.at("path").get<std::string>(),
+                                       input.at("hash").get<std::string>()});
+        }
+
+        manifest.Flags = json.at("flags").get<std::map<std::string, std::string> >();
+
+        manifest.Stages.clear();
+        for (const auto &stage : json.at("stages")) {
+            manifest.Stages.push_back({stage.at("name").get<std::string>(),
+                                       stage.at("wall_time_ms").get<int64_t>()});
+        }
+
+        manifest.Trajectory.clear();
+        for (const auto &point : json.at("trajectory")) {
+            manifest.Trajectory.push_back({point.at("stage").get<std::string>(),
+                                           point.at("cost").get<double>(),
+                                           point.at("dropped_visits").get<std::size_t>(),
+                                           point.at("branches").get<std::size_t>(),
+                                           point.at("solutions").get<std::size_t>(),
+                                           point.at("wall_time_ms").get<int64_t>()});
+        }
+
+        manifest.Solutions.clear();
+        for (const auto &solution : json.at("solutions")) {
+            manifest.Solutions.emplace_back(solution.at("stage").get<std::string>(),
+                                            solution.at("cost").get<double>(),
+                                            solution.at("dropped_visits").get<std::size_t>(),
+                                            solution.at("invalid_routes").get<std::size_t>());
+        }
+
+        manifest.ReturnCode = json.at("return_code").get<int>();
+
+        const auto deterministic_search_it = json.find("deterministic_search");
+        if (deterministic_search_it != std::end(json)) {
+            manifest.DeterministicSearch = deterministic_search_it->get<DeterministicSearchOptions>();
+        } else {
+            manifest.DeterministicSearch = boost::none;
+        }
+    }
+
+    std::string HashFile(const std::string &file_path) {
+        static const uint64_t FNV_OFFSET_BASIS = 14695981039346656037ull;
+        static const uint64_t FNV_PRIME = 1099511628211ull;
+
+        std::ifstream input_stream{file_path, std::ios::in | std::ios::binary};
+        if (!input_stream.is_open()) {
+            throw util::ApplicationError((boost::format("Failed to open the file: %1%") % file_path).str(), util::ErrorCode::ERROR);
+        }
+
+        uint64_t hash = FNV_OFFSET_BASIS;
+        std::istreambuf_iterator<char> input_it{input_stream};
+        const std::istreambuf_iterator<char> input_end_it;
+        for (; input_it != input_end_it; ++input_it) {
+            hash ^= static_cast<uint8_t>(*input_it);
+            hash *= FNV_PRIME;
+        }
+
+        return (boost::format("%016x") % hash).str();
+    }
+
+    RecordingPrinter::RecordingPrinter(std::shared_ptr<Printer> printer, std::shared_ptr<RunManifest> manifest)
+            : printer_{std::move(printer)},
+              manifest_{std::move(manifest)} {}
+
+    Printer &RecordingPrinter::operator<<(const std::string &text) {
+        printer_->operator<<(text);
+        return *this;
+    }
+
+    Printer &RecordingPrinter::operator<<(const ProblemDefinition &problem_definition) {
+        printer_->operator<<(problem_definition);
+        return *this;
+    }
+
+    Printer &RecordingPrinter::operator<<(const TracingEvent &trace_event) {
+        {
+            std::lock_guard<std::mutex> lock{mutex_};
+            if (trace_event.Type == TracingEventType::Started) {
+                open_stages_.emplace_back(trace_event.Comment, std::chrono::steady_clock::now());
+            } else if (trace_event.Type == TracingEventType::Finished) {
+                auto stage_it = std::find_if(open_stages_.rbegin(), open_stages_.rend(),
+                                             [&trace_event](const std::pair<std::string, std::chrono::steady_clock::time_point> &stage) -> bool {
+                                                 return stage.first == trace_event.Comment;
+                                             });
+                if (stage_it != open_stages_.rend()) {
+                    const auto wall_time = std::chrono::duration_cast<std::chrono::milliseconds>(
+                            std::chrono::steady_clock::now() - stage_it->second);
+                    manifest_->Stages.push_back({trace_event.Comment, wall_time.count()});
+                    open_stages_.erase(std::next(stage_it).base());
+                }
+            }
+        }
+
+        printer_->operator<<(trace_event);
+        return *this;
+    }
+
+    Printer &RecordingPrinter::operator<<(const ProgressStep &progress_step) {
+        {
+            std::lock_guard<std::mutex> lock{mutex_};
+            const auto stage = open_stages_.empty() ? std::string{} : open_stages_.back().first;
+            manifest_->Trajectory.push_back({stage,
+                                             progress_step.Cost,
+                                             progress_step.DroppedVisits,
+                                             progress_step.Branches,
+                                             progress_step.Solutions,
+                                             progress_step.WallTime.total_milliseconds()});
+        }
+
+        printer_->operator<<(progress_step);
+        return *this;
+    }
+
+    Printer &RecordingPrinter::operator<<(const PerformanceSummary &performance_summary) {
+        printer_->operator<<(performance_summary);
+        return *this;
+    }
+
+    Printer &RecordingPrinter::operator<<(const MemorySummary &memory_summary) {
+        printer_->operator<<(memory_summary);
+        return *this;
+    }
+
+    Printer &RecordingPrinter::operator<<(const SolutionSummary &solution_summary) {
+        {
+            std::lock_guard<std::mutex> lock{mutex_};
+            manifest_->Solutions.push_back(solution_summary);
+        }
+
+        printer_->operator<<(solution_summary);
+        return *this;
+    }
+}
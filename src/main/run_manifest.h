@@ -0,0 +1,96 @@
+#ifndef ROWS_RUN_MANIFEST_H
+#define ROWS_RUN_MANIFEST_H
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <boost/optional.hpp>
+#include <nlohmann/json.hpp>
+
+#include "printer.h"
+#include "deterministic_search.h"
+
+namespace rows {
+
+    // record of a solver run used to replay the computation and compare the results between versions of the solver
+    struct RunManifest {
+        struct Input {
+            std::string Name;
+            std::string Path;
+            std::string Hash;
+        };
+
+        struct Stage {
+            std::string Name;
+            int64_t WallTimeMs;
+        };
+
+        struct TrajectoryPoint {
+            std::string Stage;
+            double Cost;
+            std::size_t DroppedVisits;
+            std::size_t Branches;
+            std::size_t Solutions;
+            int64_t WallTimeMs;
+        };
+
+        RunManifest();
+
+        static RunManifest Load(const std::string &file_path);
+
+        void Save(const std::string &file_path) const;
+
+        std::vector<Input> Inputs;
+        std::map<std::string, std::string> Flags;
+        boost::optional<DeterministicSearchOptions> DeterministicSearch;
+        std::vector<Stage> Stages;
+        std::vector<TrajectoryPoint> Trajectory;
+        std::vector<SolutionSummary> Solutions;
+        int ReturnCode;
+    };
+
+    void to_json(nlohmann::json &json, const RunManifest &manifest);
+
+    void from_json(const nlohmann::json &json, RunManifest &manifest);
+
+    // 64-bit FNV-1a hash of the file content in the hexadecimal format
+    std::string HashFile(const std::string &file_path);
+
+    // forwards all events to the decorated printer and records stage boundaries,
+    // the objective trajectory and solution summaries in the manifest
+    class RecordingPrinter : public Printer {
+    public:
+        RecordingPrinter(std::shared_ptr<Printer> printer, std::shared_ptr<RunManifest> manifest);
+
+        ~RecordingPrinter() override = default;
+
+        Printer &operator<<(const std::string &text) override;
+
+        Printer &operator<<(const ProblemDefinition &problem_definition) override;
+
+        Printer &operator<<(const TracingEvent &trace_event) override;
+
+        Printer &operator<<(const ProgressStep &progress_step) override;
+
+        Printer &operator<<(const PerformanceSummary &performance_summary) override;
+
+        Printer &operator<<(const MemorySummary &memory_summary) override;
+
+        Printer &operator<<(const SolutionSummary &solution_summary) override;
+
+    private:
+        std::shared_ptr<Printer> printer_;
+        std::shared_ptr<RunManifest> manifest_;
+
+        std::mutex mutex_;
+        std::vector<std::pair<std::string, std::chrono::steady_clock::time_point> > open_stages_;
+    };
+}
+
+
+#endif //ROWS_RUN_MANIFEST_H
@@ -0,0 +1,388 @@
+#include "scenario_reduction.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <map>
+#include <numeric>
+#include <random>
+
+#include <boost/algorithm/string.hpp>
+#include <boost/format.hpp>
+
+#include <glog/logging.h>
+
+#include "delay_tracker.h"
+#include "geographic_decomposition.h"
+
+namespace rows {
+
+    namespace {
+
+        // quantile of visit durations which is compared between the reduced and the full set of dates
+        static const double ERROR_QUANTILE = 0.9;
+
+        // splits the positions into blocks of consecutive dates and selects a random date from every block,
+        // so the weight of a date is the size of its block
+        void SampleBlocks(const std::vector<std::size_t> &positions,
+                          std::size_t scenarios,
+                          std::mt19937 &random_engine,
+                          ScenarioReduction &reduction) {
+            const auto num_positions = positions.size();
+            CHECK_GT(scenarios, 0);
+            CHECK_LE(scenarios, num_positions);
+
+            for (std::size_t block = 0; block < scenarios; ++block) {
+                const auto block_begin = block * num_positions / scenarios;
+                const auto block_end = (block + 1) * num_positions / scenarios;
+                std::uniform_int_distribution<std::size_t> distribution{block_begin, block_end - 1};
+
+                reduction.Scenarios.push_back(positions[distribution(random_engine)]);
+                reduction.Weights.push_back(static_cast<int64>(block_end - block_begin));
+            }
+        }
+
+        std::size_t GetSeason(const boost::gregorian::date &date) {
+            // winter, spring, summer and autumn begin in December, March, June and September
+            return (static_cast<std::size_t>(date.month().as_number()) % 12) / 3;
+        }
+
+        ScenarioReduction ReduceUniform(const ScenarioReductionOptions &options,
+                                        const std::vector<boost::gregorian::date> &dates,
+                                        std::mt19937 &random_engine) {
+            std::vector<std::size_t> positions(dates.size());
+            std::iota(std::begin(positions), std::end(positions), 0);
+
+            ScenarioReduction reduction;
+            SampleBlocks(positions, options.Scenarios, random_engine, reduction);
+            return reduction;
+        }
+
+        ScenarioReduction ReduceStratified(const ScenarioReductionOptions &options,
+                                           const std::vector<boost::gregorian::date> &dates,
+                                           std::mt19937 &random_engine) {
+            std::map<std::pair<std::size_t, std::size_t>, std::vector<std::size_t> > strata;
+            for (std::size_t position = 0; position < dates.size(); ++position) {
+                const auto &date = dates[position];
+                strata[std::make_pair(static_cast<std::size_t>(date.day_of_week().as_number()), GetSeason(date))].push_back(position);
+            }
+
+            // every stratum is represented, remaining scenarios are allocated proportionally to the size of the stratum
+            // using the largest remainder method
+            const auto num_strata = strata.size();
+            LOG_IF(WARNING, options.Scenarios < num_strata)
+            << boost::format("Stratified scenario reduction keeps %1% scenarios instead of %2%, one for every stratum")
+               % num_strata
+               % options.Scenarios;
+
+            const auto extra_scenarios = options.Scenarios > num_strata ? options.Scenarios - num_strata : 0;
+            const auto extra_dates = dates.size() - num_strata;
+            std::vector<std::size_t> allocation(num_strata, 1);
+            std::vector<std::pair<double, std::size_t> > remainders;
+            std::size_t allocated_extra_scenarios = 0;
+            auto stratum_pos = 0;
+            for (const auto &stratum : strata) {
+                const auto quota = extra_dates > 0
+                                   ? static_cast<double>(extra_scenarios) * static_cast<double>(stratum.second.size() - 1)
+                                     / static_cast<double>(extra_dates)
+                                   : 0.0;
+                const auto whole_quota = static_cast<std::size_t>(std::floor(quota));
+                allocation[stratum_pos] += whole_quota;
+                allocated_extra_scenarios += whole_quota;
+                remainders.emplace_back(quota - static_cast<double>(whole_quota), stratum_pos);
+                ++stratum_pos;
+            }
+
+            std::stable_sort(std::begin(remainders), std::end(remainders),
+                             [](const std::pair<double, std::size_t> &left, const std::pair<double, std::size_t> &right) -> bool {
+                                 return left.first > right.first;
+                             });
+            for (auto remainder_it = std::cbegin(remainders);
+                 remainder_it != std::cend(remainders) && allocated_extra_scenarios < extra_scenarios;
+                 ++remainder_it, ++allocated_extra_scenarios) {
+                ++allocation[remainder_it->second];
+            }
+
+            ScenarioReduction reduction;
+            stratum_pos = 0;
+            for (const auto &stratum : strata) {
+                SampleBlocks(stratum.second, std::min(allocation[stratum_pos], stratum.second.size()), random_engine, reduction);
+                ++stratum_pos;
+            }
+            return reduction;
+        }
+
+        ScenarioReduction ReduceKMedoids(const ScenarioReductionOptions &options,
+                                         const std::vector<boost::gregorian::date> &dates,
+                                         const std::vector<std::vector<int64> > &samples,
+                                         std::mt19937 &random_engine) {
+            // dates are similar if visits take similar time, the distance is the total difference in visit durations
+            const auto num_dates = dates.size();
+            std::vector<std::vector<int64> > distances(num_dates, std::vector<int64>(num_dates, 0));
+            for (std::size_t left = 0; left < num_dates; ++left) {
+                for (std::size_t right = left + 1; right < num_dates; ++right) {
+                    int64 distance = 0;
+                    for (const auto &visit_sample : samples) {
+                        distance += std::abs(visit_sample[left] - visit_sample[right]);
+                    }
+                    distances[left][right] = distance;
+                    distances[right][left] = distance;
+                }
+            }
+
+            const std::vector<int64> weights(num_dates, 1);
+            const auto date_cluster = KMedoids(distances, weights, options.Scenarios, options.MaxIterations, random_engine);
+            const auto num_clusters = *std::max_element(std::cbegin(date_cluster), std::cend(date_cluster)) + 1;
+
+            std::vector<std::vector<std::size_t> > members(num_clusters);
+            for (std::size_t position = 0; position < num_dates; ++position) {
+                members[date_cluster[position]].push_back(position);
+            }
+
+            // the scenario of a cluster is the date with the smallest total distance to other dates in the cluster
+            ScenarioReduction reduction;
+            for (const auto &cluster_members : members) {
+                if (cluster_members.empty()) {
+                    continue;
+                }
+
+                auto medoid = cluster_members.front();
+                auto medoid_distance = std::numeric_limits<int64>::max();
+                for (const auto candidate : cluster_members) {
+                    int64 candidate_distance = 0;
+                    for (const auto member : cluster_members) {
+                        candidate_distance += distances[candidate][member];
+                    }
+
+                    if (candidate_distance < medoid_distance) {
+                        medoid = candidate;
+                        medoid_distance = candidate_distance;
+                    }
+                }
+
+                reduction.Scenarios.push_back(medoid);
+                reduction.Weights.push_back(static_cast<int64>(cluster_members.size()));
+            }
+            return reduction;
+        }
+
+        // the smallest duration such that dates of the given fraction of the total weight have shorter or equal durations
+        int64 GetQuantile(std::vector<std::pair<int64, int64> > &weighted_durations, double quantile) {
+            std::sort(std::begin(weighted_durations), std::end(weighted_durations));
+
+            int64 total_weight = 0;
+            for (const auto &weighted_duration : weighted_durations) {
+                total_weight += weighted_duration.second;
+            }
+
+            const auto quantile_weight = quantile * static_cast<double>(total_weight);
+            int64 cumulative_weight = 0;
+            for (const auto &weighted_duration : weighted_durations) {
+                cumulative_weight += weighted_duration.second;
+                if (static_cast<double>(cumulative_weight) >= quantile_weight) {
+                    return weighted_duration.first;
+                }
+            }
+            return weighted_durations.back().first;
+        }
+    }
+
+    ScenarioReductionOptions::ScenarioReductionOptions()
+            : ScenarioReductionOptions(ScenarioReductionStrategy::NONE, 0) {}
+
+    ScenarioReductionOptions::ScenarioReductionOptions(ScenarioReductionStrategy strategy, std::size_t scenarios)
+            : Strategy{strategy},
+              Scenarios{scenarios},
+              MaxIterations{100},
+              Seed{12345} {}
+
+    ScenarioReduction ReduceScenarios(const ScenarioReductionOptions &options,
+                                      const std::vector<boost::gregorian::date> &dates,
+                                      const std::vector<std::vector<int64> > &samples) {
+        const auto num_dates = dates.size();
+        for (const auto &visit_sample : samples) {
+            CHECK_EQ(visit_sample.size(), num_dates);
+        }
+
+        ScenarioReduction reduction;
+        if (options.Strategy == ScenarioReductionStrategy::NONE || options.Scenarios == 0 || options.Scenarios >= num_dates) {
+            reduction.Scenarios.resize(num_dates);
+            std::iota(std::begin(reduction.Scenarios), std::end(reduction.Scenarios), 0);
+            reduction.Weights.resize(num_dates, 1);
+            return reduction;
+        }
+
+        std::mt19937 random_engine{options.Seed};
+        switch (options.Strategy) {
+            case ScenarioReductionStrategy::UNIFORM:
+                reduction = ReduceUniform(options, dates, random_engine);
+                break;
+            case ScenarioReductionStrategy::STRATIFIED:
+                reduction = ReduceStratified(options, dates, random_engine);
+                break;
+            case ScenarioReductionStrategy::KMEDOIDS:
+                reduction = ReduceKMedoids(options, dates, samples, random_engine);
+                break;
+            default:
+                LOG(FATAL) << "Scenario reduction strategy " << options.Strategy << " is not implemented";
+        }
+
+        // scenarios are kept in the order of dates
+        std::vector<std::size_t> order(reduction.Scenarios.size());
+        std::iota(std::begin(order), std::end(order), 0);
+        std::sort(std::begin(order), std::end(order), [&reduction](std::size_t left, std::size_t right) -> bool {
+            return reduction.Scenarios[left] < reduction.Scenarios[right];
+        });
+
+        ScenarioReduction sorted_reduction;
+        for (const auto position : order) {
+            sorted_reduction.Scenarios.push_back(reduction.Scenarios[position]);
+            sorted_reduction.Weights.push_back(reduction.Weights[position]);
+        }
+        DCHECK_EQ(std::accumulate(std::cbegin(sorted_reduction.Weights), std::cend(sorted_reduction.Weights), static_cast<int64>(0)),
+                  static_cast<int64>(num_dates));
+        return sorted_reduction;
+    }
+
+    ScenarioReductionError EstimateReductionError(const ScenarioReduction &reduction,
+                                                  const std::vector<std::vector<int64> > &samples) {
+        ScenarioReductionError error{0.0, 0.0, 0.0, 0.0};
+        if (samples.empty()) {
+            return error;
+        }
+
+        const auto total_weight = std::accumulate(std::cbegin(reduction.Weights), std::cend(reduction.Weights), static_cast<int64>(0));
+        std::vector<std::pair<int64, int64> > weighted_durations;
+        for (const auto &visit_sample : samples) {
+            if (visit_sample.empty()) {
+                continue;
+            }
+
+            const auto full_mean = static_cast<double>(std::accumulate(std::cbegin(visit_sample), std::cend(visit_sample), static_cast<int64>(0)))
+                                   / static_cast<double>(visit_sample.size());
+            double reduced_mean = 0.0;
+            for (std::size_t scenario_pos = 0; scenario_pos < reduction.Scenarios.size(); ++scenario_pos) {
+                reduced_mean += static_cast<double>(visit_sample[reduction.Scenarios[scenario_pos]] * reduction.Weights[scenario_pos]);
+            }
+            reduced_mean /= static_cast<double>(total_weight);
+
+            weighted_durations.clear();
+            for (const auto duration : visit_sample) {
+                weighted_durations.emplace_back(duration, 1);
+            }
+            const auto full_quantile = GetQuantile(weighted_durations, ERROR_QUANTILE);
+
+            weighted_durations.clear();
+            for (std::size_t scenario_pos = 0; scenario_pos < reduction.Scenarios.size(); ++scenario_pos) {
+                weighted_durations.emplace_back(visit_sample[reduction.Scenarios[scenario_pos]], reduction.Weights[scenario_pos]);
+            }
+            const auto reduced_quantile = GetQuantile(weighted_durations, ERROR_QUANTILE);
+
+            const auto mean_error = std::abs(full_mean - reduced_mean);
+            const auto quantile_error = static_cast<double>(std::abs(full_quantile - reduced_quantile));
+            error.MeanError += mean_error;
+            error.MaxMeanError = std::max(error.MaxMeanError, mean_error);
+            error.MeanQuantileError += quantile_error;
+            error.MaxQuantileError = std::max(error.MaxQuantileError, quantile_error);
+        }
+
+        error.MeanError /= static_cast<double>(samples.size());
+        error.MeanQuantileError /= static_cast<double>(samples.size());
+        return error;
+    }
+
+    ScenarioReductionDelayError EstimateDelayError(const ScenarioReduction &reduction,
+                                                   const std::vector<std::vector<int64> > &delays) {
+        ScenarioReductionDelayError error{0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0};
+        if (delays.empty()) {
+            return error;
+        }
+
+        std::vector<int64> reduced_delay;
+        std::size_t finite_riskiness_count = 0;
+        for (const auto &visit_delay : delays) {
+            if (visit_delay.empty()) {
+                continue;
+            }
+
+            const std::vector<int64> full_weights(visit_delay.size(), 1);
+            reduced_delay.clear();
+            for (const auto position : reduction.Scenarios) {
+                reduced_delay.push_back(visit_delay[position]);
+            }
+
+            const auto mean_delay_error = static_cast<double>(std::abs(DelayTracker::GetMeanDelay(visit_delay, full_weights)
+                                                                       - DelayTracker::GetMeanDelay(reduced_delay, reduction.Weights)));
+            error.MeanDelayError += mean_delay_error;
+            error.MaxMeanDelayError = std::max(error.MaxMeanDelayError, mean_delay_error);
+
+            const auto probability_error = static_cast<double>(std::abs(DelayTracker::GetDelayProbability(visit_delay, full_weights)
+                                                                        - DelayTracker::GetDelayProbability(reduced_delay, reduction.Weights)));
+            error.MeanDelayProbabilityError += probability_error;
+            error.MaxDelayProbabilityError = std::max(error.MaxDelayProbabilityError, probability_error);
+
+            const auto full_riskiness = DelayTracker::GetEssentialRiskiness(visit_delay, full_weights);
+            const auto reduced_riskiness = DelayTracker::GetEssentialRiskiness(reduced_delay, reduction.Weights);
+            const auto is_full_finite = full_riskiness != DelayTracker::MAX_RISKINESS;
+            const auto is_reduced_finite = reduced_riskiness != DelayTracker::MAX_RISKINESS;
+            if (is_full_finite && is_reduced_finite) {
+                const auto riskiness_error = static_cast<double>(std::abs(full_riskiness - reduced_riskiness));
+                error.MeanRiskinessError += riskiness_error;
+                error.MaxRiskinessError = std::max(error.MaxRiskinessError, riskiness_error);
+                ++finite_riskiness_count;
+            } else if (is_full_finite != is_reduced_finite) {
+                ++error.RiskinessMismatches;
+            }
+        }
+
+        error.MeanDelayError /= static_cast<double>(delays.size());
+        error.MeanDelayProbabilityError /= static_cast<double>(delays.size());
+        if (finite_riskiness_count > 0) {
+            error.MeanRiskinessError /= static_cast<double>(finite_riskiness_count);
+        }
+        return error;
+    }
+
+    boost::optional<ScenarioReductionStrategy> ParseScenarioReductionStrategy(const std::string &value) {
+        const auto value_to_use = boost::algorithm::to_lower_copy(value);
+
+        if (value_to_use == "none") {
+            return boost::make_optional(ScenarioReductionStrategy::NONE);
+        }
+
+        if (value_to_use == "uniform") {
+            return boost::make_optional(ScenarioReductionStrategy::UNIFORM);
+        }
+
+        if (value_to_use == "stratified") {
+            return boost::make_optional(ScenarioReductionStrategy::STRATIFIED);
+        }
+
+        if (value_to_use == "kmedoids") {
+            return boost::make_optional(ScenarioReductionStrategy::KMEDOIDS);
+        }
+
+        return boost::none;
+    }
+
+    std::ostream &operator<<(std::ostream &out, ScenarioReductionStrategy value) {
+        switch (value) {
+            case ScenarioReductionStrategy::NONE:
+                out << "NONE";
+                break;
+            case ScenarioReductionStrategy::UNIFORM:
+                out << "UNIFORM";
+                break;
+            case ScenarioReductionStrategy::STRATIFIED:
+                out << "STRATIFIED";
+                break;
+            case ScenarioReductionStrategy::KMEDOIDS:
+                out << "KMEDOIDS";
+                break;
+            default:
+                LOG(FATAL) << "Translation of value " << static_cast<int>(value) << " to string is not implemented";
+        }
+        return out;
+    }
+}
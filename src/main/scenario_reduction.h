@@ -0,0 +1,86 @@
+#ifndef ROWS_SCENARIO_REDUCTION_H
+#define ROWS_SCENARIO_REDUCTION_H
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <boost/date_time.hpp>
+#include <boost/optional.hpp>
+
+#include <ortools/base/integral_types.h>
+
+namespace rows {
+
+    enum class ScenarioReductionStrategy {
+        NONE,
+        UNIFORM,
+        STRATIFIED,
+        KMEDOIDS
+    };
+
+    boost::optional<ScenarioReductionStrategy> ParseScenarioReductionStrategy(const std::string &value);
+
+    std::ostream &operator<<(std::ostream &out, ScenarioReductionStrategy value);
+
+    // selection of historical dates evaluated as scenarios by the delay tracker
+    struct ScenarioReductionOptions {
+        ScenarioReductionOptions();
+
+        ScenarioReductionOptions(ScenarioReductionStrategy strategy, std::size_t scenarios);
+
+        ScenarioReductionStrategy Strategy;
+
+        // number of scenarios kept, all dates are kept if zero or not smaller than the number of dates
+        std::size_t Scenarios;
+
+        // maximum number of reassignments of dates to medoids
+        std::size_t MaxIterations;
+
+        uint32_t Seed;
+    };
+
+    // every scenario represents as many historical dates as its weight, so the weights sum up to the number of dates
+    struct ScenarioReduction {
+        // positions of dates in ascending order
+        std::vector<std::size_t> Scenarios;
+        std::vector<int64> Weights;
+    };
+
+    // samples contain the duration of every visit on every date
+    ScenarioReduction ReduceScenarios(const ScenarioReductionOptions &options,
+                                      const std::vector<boost::gregorian::date> &dates,
+                                      const std::vector<std::vector<int64> > &samples);
+
+    // errors of the weighted statistics of visit durations in seconds compared to statistics over all dates
+    struct ScenarioReductionError {
+        double MeanError;
+        double MaxMeanError;
+        double MeanQuantileError;
+        double MaxQuantileError;
+    };
+
+    ScenarioReductionError EstimateReductionError(const ScenarioReduction &reduction,
+                                                  const std::vector<std::vector<int64> > &samples);
+
+    // errors of the weighted delay statistics used by the third stage compared to statistics over all dates,
+    // riskiness is compared only if it is finite both for the reduced and for all dates, otherwise the visit
+    // is counted as a riskiness mismatch if exactly one of them is infinite
+    struct ScenarioReductionDelayError {
+        double MeanDelayError;
+        double MaxMeanDelayError;
+        double MeanDelayProbabilityError;
+        double MaxDelayProbabilityError;
+        double MeanRiskinessError;
+        double MaxRiskinessError;
+        std::size_t RiskinessMismatches;
+    };
+
+    // delays contain the delay of every visit on every date in seconds
+    ScenarioReductionDelayError EstimateDelayError(const ScenarioReduction &reduction,
+                                                   const std::vector<std::vector<int64> > &delays);
+}
+
+
+#endif //ROWS_SCENARIO_REDUCTION_H
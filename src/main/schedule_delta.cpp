@@ -0,0 +1,100 @@
+#include "schedule_delta.h"
+
+#include <unordered_map>
+#include <unordered_set>
+
+#include <glog/logging.h>
+
+#include "util/aplication_error.h"
+
+namespace rows {
+
+    ScheduleDelta::ScheduleDelta()
+            : ScheduleDelta(boost::posix_time::not_a_date_time, {}, {}, {}) {}
+
+    ScheduleDelta::ScheduleDelta(boost::posix_time::ptime current_time,
+                                 std::vector<std::size_t> removed_visits,
+                                 std::vector<Carer> removed_carers,
+                                 std::vector<CalendarVisit> added_visits)
+            : current_time_{current_time},
+              removed_visits_{std::move(removed_visits)},
+              removed_carers_{std::move(removed_carers)},
+              added_visits_{std::move(added_visits)} {}
+
+    Problem ScheduleDelta::Apply(const Problem &problem) const {
+        const std::unordered_set<std::size_t> removed_visits{std::cbegin(removed_visits_), std::cend(removed_visits_)};
+        const std::unordered_set<Carer> removed_carers{std::cbegin(removed_carers_), std::cend(removed_carers_)};
+
+        std::vector<CalendarVisit> visits;
+        std::unordered_set<std::size_t> visit_ids;
+        for (const auto &visit : problem.visits()) {
+            if (removed_visits.find(visit.id()) == std::end(removed_visits)) {
+                visits.push_back(visit);
+                visit_ids.insert(visit.id());
+            }
+        }
+
+        std::unordered_map<long, const ExtendedServiceUser *> service_users;
+        for (const auto &service_user : problem.service_users()) {
+            service_users.emplace(service_user.id(), &service_user);
+        }
+
+        for (const auto &added_visit : added_visits_) {
+            if (!visit_ids.insert(added_visit.id()).second) {
+                throw util::ApplicationError((boost::format("Visit %1% is already scheduled") % added_visit.id()).str(),
+                                             util::ErrorCode::ERROR);
+            }
+
+            const auto service_user_it = service_users.find(added_visit.service_user().id());
+            if (service_user_it == std::end(service_users)) {
+                throw util::ApplicationError((boost::format("Service user %1% of the visit %2% is not defined in the problem")
+                                              % added_visit.service_user().id()
+                                              % added_visit.id()).str(),
+                                             util::ErrorCode::ERROR);
+            }
+
+            auto visit = added_visit;
+            visit.address(service_user_it->second->address());
+            visit.location(service_user_it->second->location());
+            visits.emplace_back(std::move(visit));
+        }
+
+        std::vector<std::pair<Carer, std::vector<Diary> > > carers;
+        for (const auto &carer_diaries : problem.carers()) {
+            if (removed_carers.find(carer_diaries.first) == std::end(removed_carers)) {
+                carers.push_back(carer_diaries);
+            }
+        }
+
+        LOG(INFO) << boost::format("Applied the schedule delta at %1%: removed %2% visits and %3% carers, added %4% visits")
+                     % current_time_
+                     % (problem.visits().size() + added_visits_.size() - visits.size())
+                     % (problem.carers().size() - carers.size())
+                     % added_visits_.size();
+
+        return {std::move(visits), std::move(carers), problem.service_users()};
+    }
+
+    const boost::posix_time::ptime &ScheduleDelta::current_time() const {
+        return current_time_;
+    }
+
+    const std::vector<std::size_t> &ScheduleDelta::removed_visits() const {
+        return removed_visits_;
+    }
+
+    const std::vector<Carer> &ScheduleDelta::removed_carers() const {
+        return removed_carers_;
+    }
+
+    const std::vector<CalendarVisit> &ScheduleDelta::added_visits() const {
+        return added_visits_;
+    }
+
+    ReoptimizationOptions::ReoptimizationOptions()
+            : ReoptimizationOptions(Solution{}, boost::posix_time::not_a_date_time) {}
+
+    ReoptimizationOptions::ReoptimizationOptions(Solution previous_solution, boost::posix_time::ptime current_time)
+            : PreviousSolution{std::move(previous_solution)},
+              CurrentTime{current_time} {}
+}
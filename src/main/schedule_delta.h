@@ -0,0 +1,141 @@
+#ifndef ROWS_SCHEDULE_DELTA_H
+#define ROWS_SCHEDULE_DELTA_H
+
+#include <string>
+#include <vector>
+
+#include <boost/date_time.hpp>
+#include <boost/format.hpp>
+
+#include "util/json.h"
+#include "data_time.h"
+#include "carer.h"
+#include "calendar_visit.h"
+#include "problem.h"
+#include "solution.h"
+
+namespace rows {
+
+    // changes of the schedule which happened since the previous solution was computed
+    class ScheduleDelta {
+    public:
+        ScheduleDelta();
+
+        ScheduleDelta(boost::posix_time::ptime current_time,
+                      std::vector<std::size_t> removed_visits,
+                      std::vector<Carer> removed_carers,
+                      std::vector<CalendarVisit> added_visits);
+
+        // removes cancelled visits and absent carers, new visits receive the address and the location of their service user
+        Problem Apply(const Problem &problem) const;
+
+        const boost::posix_time::ptime &current_time() const;
+
+        const std::vector<std::size_t> &removed_visits() const;
+
+        const std::vector<Carer> &removed_carers() const;
+
+        const std::vector<CalendarVisit> &added_visits() const;
+
+        class JsonLoader : protected rows::JsonLoader {
+        public:
+            /*!
+             * @throws std::domain_error
+             */
+            template<typename JsonType>
+            ScheduleDelta Load(const JsonType &document) const;
+        };
+
+    private:
+        boost::posix_time::ptime current_time_;
+        std::vector<std::size_t> removed_visits_;
+        std::vector<Carer> removed_carers_;
+        std::vector<CalendarVisit> added_visits_;
+    };
+
+    // previous solution of the problem and the time of the disruption, visits which started before that time are kept
+    struct ReoptimizationOptions {
+        ReoptimizationOptions();
+
+        ReoptimizationOptions(Solution previous_solution, boost::posix_time::ptime current_time);
+
+        Solution PreviousSolution;
+        boost::posix_time::ptime CurrentTime;
+    };
+}
+
+namespace rows {
+
+    template<typename JsonType>
+    ScheduleDelta ScheduleDelta::JsonLoader::Load(const JsonType &document) const {
+        static const DateTime::JsonLoader datetime_loader{};
+
+        const auto current_time_it = document.find("current_time");
+        if (current_time_it == std::end(document)) { throw OnKeyNotFound("current_time"); }
+        const auto current_time = datetime_loader.Load(current_time_it.value());
+
+        std::vector<std::size_t> removed_visits;
+        const auto removed_visits_it = document.find("removed_visits");
+        if (removed_visits_it != std::end(document)) {
+            removed_visits = removed_visits_it.value().template get<std::vector<std::size_t> >();
+        }
+
+        std::vector<Carer> removed_carers;
+        const auto removed_carers_it = document.find("removed_carers");
+        if (removed_carers_it != std::end(document)) {
+            for (const auto &carer_json : removed_carers_it.value()) {
+                removed_carers.emplace_back(carer_json.template get<std::string>());
+            }
+        }
+
+        // location of a new visit is not known until the delta is applied to the problem
+        std::vector<CalendarVisit> added_visits;
+        const auto added_visits_it = document.find("added_visits");
+        if (added_visits_it != std::end(document)) {
+            for (const auto &visit_json : added_visits_it.value()) {
+                const auto key_it = visit_json.find("key");
+                if (key_it == std::end(visit_json)) { throw OnKeyNotFound("key"); }
+
+                const auto service_user_it = visit_json.find("service_user");
+                if (service_user_it == std::end(visit_json)) { throw OnKeyNotFound("service_user"); }
+
+                const auto duration_it = visit_json.find("duration");
+                if (duration_it == std::end(visit_json)) { throw OnKeyNotFound("duration"); }
+
+                boost::posix_time::seconds duration{0};
+                if (duration_it.value().is_string()) {
+                    duration = boost::posix_time::seconds(std::stol(duration_it.value().template get<std::string>()));
+                } else if (duration_it.value().is_number()) {
+                    duration = boost::posix_time::seconds(duration_it.value().template get<int>());
+                } else {
+                    throw std::domain_error((boost::format("Unknown format of duration %s") % duration_it.value()).str());
+                }
+
+                auto carer_count = 1;
+                const auto carer_count_it = visit_json.find("carer_count");
+                if (carer_count_it != std::end(visit_json)) {
+                    carer_count = carer_count_it.value().template get<int>();
+                }
+
+                std::vector<int> tasks;
+                const auto tasks_it = visit_json.find("tasks");
+                if (tasks_it != std::end(visit_json)) {
+                    tasks = tasks_it.value().template get<std::vector<int> >();
+                }
+
+                added_visits.emplace_back(key_it.value().template get<std::size_t>(),
+                                          ServiceUser{std::stol(service_user_it.value().template get<std::string>())},
+                                          Address{},
+                                          boost::none,
+                                          datetime_loader.Load(visit_json),
+                                          duration,
+                                          carer_count,
+                                          std::move(tasks));
+            }
+        }
+
+        return {current_time, std::move(removed_visits), std::move(removed_carers), std::move(added_visits)};
+    }
+}
+
+#endif //ROWS_SCHEDULE_DELTA_H
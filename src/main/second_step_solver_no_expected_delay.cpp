@@ -3,6 +3,7 @@
 #include "util/aplication_error.h"
 #include "break_constraint.h"
 #include "progress_printer_monitor.h"
+#include "trace_writer.h"
 #include "cancel_search_limit.h"
 #include "solution_log_monitor.h"
 #include "stalled_search_limit.h"
@@ -30,6 +31,8 @@ void rows::SecondStepSolverNoExpectedDelay::ConfigureModel(operations_research::
                                                            const std::shared_ptr<Printer> &printer,
                                                            std::shared_ptr<const std::atomic<bool> > cancel_token,
                                                            double cost_normalization_factor) {
+    TraceSpan configure_model_span{"ConfigureModel", "model"};
+
     SolverWrapper::ConfigureModel(model, printer, cancel_token, cost_normalization_factor);
 
     operations_research::Solver *const solver = model.solver();
@@ -56,11 +59,15 @@ void rows::SecondStepSolverNoExpectedDelay::ConfigureModel(operations_research::
                                           break_time_window_,
                                           GetAdjustment()));
 
-    model.CloseModelWithParameters(parameters_);
+    {
+        TraceSpan close_model_span{"CloseModel", "model"};
+        model.CloseModelWithParameters(parameters_);
+    }
 
-    model.AddSearchMonitor(solver->RevAlloc(new ProgressPrinterMonitor(model, index_manager_, problem_data_, printer, cost_normalization_factor)));
-    model.AddSearchMonitor(solver->RevAlloc(new SolutionLogMonitor(&index_manager_, &model, solution_repository_)));
-    solution_collector_ = solver->RevAlloc(new MinDroppedVisitsSolutionCollector(&model, true));
+    const auto dropped_visit_tracker = AddDroppedVisitTracker(model);
+    model.AddSearchMonitor(solver->RevAlloc(new ProgressPrinterMonitor(model, index_manager_, problem_data_, printer, cost_normalization_factor, dropped_visit_tracker)));
+    model.AddSearchMonitor(solver->RevAlloc(new SolutionLogMonitor(&index_manager_, &model, dropped_visit_tracker, solution_repository_)));
+    solution_collector_ = solver->RevAlloc(new MinDroppedVisitsSolutionCollector(&model, dropped_visit_tracker, true));
     model.AddSearchMonitor(solution_collector_);
 
     if (!no_progress_time_limit_.is_special() && no_progress_time_limit_.total_seconds() > 0) {
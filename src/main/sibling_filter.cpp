@@ -0,0 +1,112 @@
+#include "sibling_filter.h"
+
+#include <algorithm>
+
+#include <glog/logging.h>
+
+#include "perf_counters.h"
+#include "solver_wrapper.h"
+
+rows::SiblingFilter::SiblingFilter(const operations_research::RoutingModel &model,
+                                   std::vector<std::pair<int64, int64> > siblings)
+        : RouteChangeFilter(model),
+          time_dimension_{model.GetDimensionOrDie(rows::SolverWrapper::TIME_DIMENSION)},
+          siblings_{std::move(siblings)},
+          sibling_by_index_(static_cast<std::size_t>(model.Size()), -1),
+          sibling_stamps_(siblings_.size(), 0),
+          window_stamps_(static_cast<std::size_t>(model.vehicles()), 0),
+          earliest_start_(static_cast<std::size_t>(model.Size() + model.vehicles()), 0),
+          latest_start_(static_cast<std::size_t>(model.Size() + model.vehicles()), 0),
+          route_{} {
+    for (auto sibling_pos = 0; sibling_pos < static_cast<int>(siblings_.size()); ++sibling_pos) {
+        const auto &sibling_pair = siblings_[sibling_pos];
+        CHECK_LT(sibling_pair.first, sibling_pair.second);
+
+        sibling_by_index_[sibling_pair.first] = sibling_pos;
+        sibling_by_index_[sibling_pair.second] = sibling_pos;
+    }
+}
+
+std::string rows::SiblingFilter::DebugString() const {
+    return "SiblingFilter";
+}
+
+bool rows::SiblingFilter::AcceptRoutes() {
+    ROWS_PERF_COUNT(PerfCounter::SiblingFilterCall);
+
+    const auto stamp = Stamp();
+    for (const auto index : AffectedIndices()) {
+        if (model_.IsStart(index)) {
+            continue;
+        }
+
+        const auto sibling_pos = sibling_by_index_[index];
+        if (sibling_pos < 0 || sibling_stamps_[sibling_pos] == stamp) {
+            continue;
+        }
+        sibling_stamps_[sibling_pos] = stamp;
+
+        if (!AcceptSiblings(siblings_[sibling_pos])) {
+            ROWS_PERF_COUNT(PerfCounter::SiblingFilterReject);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool rows::SiblingFilter::AcceptSiblings(const std::pair<int64, int64> &siblings) {
+    const auto first_vehicle = NewVehicle(siblings.first);
+    const auto second_vehicle = NewVehicle(siblings.second);
+
+    if (first_vehicle < 0 && second_vehicle < 0) {
+        return true;
+    }
+
+    // both nodes are performed by different vehicles in the order required by the model
+    if (first_vehicle < 0 || second_vehicle < 0 || first_vehicle >= second_vehicle) {
+        return false;
+    }
+
+    UpdateStartWindows(first_vehicle);
+    UpdateStartWindows(second_vehicle);
+
+    const auto earliest_start = std::max(earliest_start_[siblings.first], earliest_start_[siblings.second]);
+    const auto latest_start = std::min(latest_start_[siblings.first], latest_start_[siblings.second]);
+    return earliest_start <= latest_start;
+}
+
+void rows::SiblingFilter::UpdateStartWindows(int64 vehicle) {
+    const auto stamp = Stamp();
+    if (window_stamps_[vehicle] == stamp) {
+        return;
+    }
+    window_stamps_[vehicle] = stamp;
+
+    route_.clear();
+    for (auto index = model_.Start(vehicle); !model_.IsEnd(index); index = NewNext(index)) {
+        route_.push_back(index);
+    }
+    route_.push_back(model_.End(vehicle));
+
+    // the slack is not bounded from above, so only travel and service times push visits forward
+    auto previous_index = route_.front();
+    earliest_start_[previous_index] = time_dimension_.CumulVar(previous_index)->Min();
+    for (std::size_t route_pos = 1; route_pos < route_.size(); ++route_pos) {
+        const auto index = route_[route_pos];
+        earliest_start_[index] = std::max(
+                earliest_start_[previous_index] + time_dimension_.GetTransitValue(previous_index, index, vehicle),
+                time_dimension_.CumulVar(index)->Min());
+        previous_index = index;
+    }
+
+    auto next_index = route_.back();
+    latest_start_[next_index] = time_dimension_.CumulVar(next_index)->Max();
+    for (auto route_pos = static_cast<int>(route_.size()) - 2; route_pos >= 0; --route_pos) {
+        const auto index = route_[route_pos];
+        latest_start_[index] = std::min(
+                latest_start_[next_index] - time_dimension_.GetTransitValue(index, next_index, vehicle),
+                time_dimension_.CumulVar(index)->Max());
+        next_index = index;
+    }
+}
@@ -0,0 +1,41 @@
+#ifndef ROWS_SIBLING_FILTER_H
+#define ROWS_SIBLING_FILTER_H
+
+#include <utility>
+#include <vector>
+
+#include "route_change_filter.h"
+
+namespace rows {
+
+    // rejects moves which perform only one node of a visit that needs two carers, assign both nodes
+    // to the same vehicle or break the order of vehicles expected by the model, and moves after which
+    // the nodes cannot start at the same time even if travel times are the only delays on their routes
+    class SiblingFilter : public RouteChangeFilter {
+    public:
+        // the first index of every pair must be lower than the second index
+        SiblingFilter(const operations_research::RoutingModel &model, std::vector<std::pair<int64, int64> > siblings);
+
+        std::string DebugString() const override;
+
+    private:
+        bool AcceptRoutes() override;
+
+        bool AcceptSiblings(const std::pair<int64, int64> &siblings);
+
+        void UpdateStartWindows(int64 vehicle);
+
+        const operations_research::RoutingDimension &time_dimension_;
+        std::vector<std::pair<int64, int64> > siblings_;
+        std::vector<int> sibling_by_index_;
+
+        std::vector<int64> sibling_stamps_;
+        std::vector<int64> window_stamps_;
+        std::vector<int64> earliest_start_;
+        std::vector<int64> latest_start_;
+        std::vector<int64> route_;
+    };
+}
+
+
+#endif //ROWS_SIBLING_FILTER_H
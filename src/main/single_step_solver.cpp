@@ -6,6 +6,7 @@
 #include "single_step_solver.h"
 #include "break_constraint.h"
 #include "progress_printer_monitor.h"
+#include "trace_writer.h"
 #include "cancel_search_limit.h"
 #include "stalled_search_limit.h"
 #include "min_dropped_visits_collector.h"
@@ -38,6 +39,8 @@ namespace rows {
                                           const std::shared_ptr<Printer> &printer,
                                           std::shared_ptr<const std::atomic<bool> > cancel_token,
                                           double cost_normalization_factor) {
+        TraceSpan configure_model_span{"ConfigureModel", "model"};
+
         SolverWrapper::ConfigureModel(model, printer, cancel_token, cost_normalization_factor);
 
         AddTravelTime(model);
@@ -59,7 +62,10 @@ namespace rows {
         VLOG(1) << "Finalizing definition of the routing model...";
         const auto start_time_model_closing = std::chrono::high_resolution_clock::now();
 
-        model.CloseModelWithParameters(parameters_);
+        {
+            TraceSpan close_model_span{"CloseModel", "model"};
+            model.CloseModelWithParameters(parameters_);
+        }
 
         const auto end_time_model_closing = std::chrono::high_resolution_clock::now();
         VLOG(1) << boost::format("Definition of the routing model finalized in %1% seconds")
@@ -67,9 +73,10 @@ namespace rows {
                                                                       - start_time_model_closing).count();
 
         auto solver_ptr = model.solver();
+        const auto dropped_visit_tracker = AddDroppedVisitTracker(model);
         model.AddSearchMonitor(
-                solver_ptr->RevAlloc(new ProgressPrinterMonitor(model, index_manager_, problem_data_, printer, cost_normalization_factor)));
-        model.AddSearchMonitor(solver_ptr->RevAlloc(new MinDroppedVisitsSolutionCollector(&model, true)));
+                solver_ptr->RevAlloc(new ProgressPrinterMonitor(model, index_manager_, problem_data_, printer, cost_normalization_factor, dropped_visit_tracker)));
+        model.AddSearchMonitor(solver_ptr->RevAlloc(new MinDroppedVisitsSolutionCollector(&model, dropped_visit_tracker, true)));
         model.AddSearchMonitor(solver_ptr->RevAlloc(new CancelSearchLimit(cancel_token, solver_ptr)));
 
         if (!no_progress_time_limit_.is_special() && no_progress_time_limit_.total_seconds() > 0) {
@@ -0,0 +1,69 @@
+#include "skill_set.h"
+
+#include <algorithm>
+
+namespace rows {
+
+    SkillSet::SkillSet()
+            : words_{} {}
+
+    void SkillSet::Insert(std::size_t position) {
+        const auto word = position / WORD_SIZE;
+        if (word >= words_.size()) {
+            words_.resize(word + 1, 0);
+        }
+
+        words_[word] |= static_cast<uint64_t>(1) << (position % WORD_SIZE);
+    }
+
+    bool SkillSet::Contains(std::size_t position) const {
+        const auto word = position / WORD_SIZE;
+        if (word >= words_.size()) {
+            return false;
+        }
+
+        return (words_[word] & (static_cast<uint64_t>(1) << (position % WORD_SIZE))) != 0;
+    }
+
+    bool SkillSet::Includes(const SkillSet &other) const {
+        if (other.words_.size() > words_.size()) {
+            return false;
+        }
+
+        for (std::size_t word = 0; word < other.words_.size(); ++word) {
+            if ((other.words_[word] & ~words_[word]) != 0) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool SkillSet::Empty() const {
+        return words_.empty();
+    }
+
+    bool SkillSet::operator==(const SkillSet &other) const {
+        return words_ == other.words_;
+    }
+
+    bool SkillSet::operator!=(const SkillSet &other) const {
+        return !this->operator==(other);
+    }
+
+    SkillIndex::SkillIndex()
+            : positions_{} {}
+
+    SkillSet SkillIndex::Intern(const std::vector<int> &skills) {
+        SkillSet skill_set;
+        for (const auto skill : skills) {
+            const auto position_it = positions_.emplace(skill, positions_.size()).first;
+            skill_set.Insert(position_it->second);
+        }
+        return skill_set;
+    }
+
+    std::size_t SkillIndex::size() const {
+        return positions_.size();
+    }
+}
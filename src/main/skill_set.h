@@ -0,0 +1,68 @@
+#ifndef ROWS_SKILL_SET_H
+#define ROWS_SKILL_SET_H
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include <boost/functional/hash.hpp>
+
+namespace rows {
+
+    // bitset of skills or tasks interned by the SkillIndex, so the inclusion test is a single pass over machine words
+    class SkillSet {
+    public:
+        SkillSet();
+
+        void Insert(std::size_t position);
+
+        bool Contains(std::size_t position) const;
+
+        // true if every element of the other set belongs to this set
+        bool Includes(const SkillSet &other) const;
+
+        bool Empty() const;
+
+        bool operator==(const SkillSet &other) const;
+
+        bool operator!=(const SkillSet &other) const;
+
+        friend struct std::hash<rows::SkillSet>;
+
+    private:
+        static const std::size_t WORD_SIZE = 64;
+
+        // trailing zero words are never stored, so equal sets have equal representations
+        std::vector<uint64_t> words_;
+    };
+
+    // assigns consecutive positions to skill numbers in the order they are first seen
+    class SkillIndex {
+    public:
+        SkillIndex();
+
+        SkillSet Intern(const std::vector<int> &skills);
+
+        std::size_t size() const;
+
+    private:
+        std::unordered_map<int, std::size_t> positions_;
+    };
+}
+
+namespace std {
+
+    template<>
+    struct hash<rows::SkillSet> {
+        typedef rows::SkillSet argument_type;
+        typedef std::size_t result_type;
+
+        result_type operator()(const argument_type &object) const noexcept {
+            return boost::hash_range(std::cbegin(object.words_), std::cend(object.words_));
+        }
+    };
+}
+
+
+#endif //ROWS_SKILL_SET_H
@@ -1,7 +1,5 @@
 #include "solution_dumper.h"
 
-#include <chrono>
-
 #include <boost/format.hpp>
 
 #include <glog/logging.h>
@@ -10,21 +8,23 @@
 
 rows::SolutionDumper::SolutionDumper(boost::filesystem::path export_directory,
                                      std::string file_name_pattern,
-                                     const operations_research::RoutingModel &model)
+                                     const operations_research::RoutingModel &model,
+                                     std::shared_ptr<AsyncSolutionWriter> writer)
         : ProgressMonitor(model),
           export_directory_(std::move(export_directory)),
-          file_name_pattern_(std::move(file_name_pattern)) {}
+          file_name_pattern_(std::move(file_name_pattern)),
+          writer_(std::move(writer)) {}
 
 bool rows::SolutionDumper::AtSolution() {
     const auto dropped_visits = util::GetDroppedVisitCount(model());
 
     if (dropped_visits < 10) {
+        // copying values of the solution is cheap compared to the validation and the output, which are left to the writer
+        auto snapshot = TakeSolutionSnapshot(model());
+
         const auto solution_file
                 = export_directory_ / (boost::format(file_name_pattern_) % dropped_visits).str();
-        const auto solution_saved = model().WriteAssignment(solution_file.string());
-        if (!solution_saved) {
-            LOG(WARNING) << "Failed to save the solution";
-        }
+        writer_->Submit(solution_file.string(), std::move(snapshot));
     }
 
     return true;
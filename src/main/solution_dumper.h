@@ -1,26 +1,31 @@
 #ifndef ROWS_SOLUTION_CATCHER_H
 #define ROWS_SOLUTION_CATCHER_H
 
+#include <memory>
 #include <string>
 
 #include <boost/filesystem/path.hpp>
 
 #include "progress_monitor.h"
+#include "async_solution_writer.h"
 
 
 namespace rows {
 
+    // passes snapshots of every solution to the writer, which saves them in a background thread
     class SolutionDumper : public rows::ProgressMonitor {
     public:
         SolutionDumper(boost::filesystem::path export_directory,
                        std::string file_name_pattern,
-                       const operations_research::RoutingModel &model);
+                       const operations_research::RoutingModel &model,
+                       std::shared_ptr<AsyncSolutionWriter> writer);
 
         bool AtSolution() override;
 
     private:
         boost::filesystem::path export_directory_;
         std::string file_name_pattern_;
+        std::shared_ptr<AsyncSolutionWriter> writer_;
     };
 }
 
@@ -7,9 +7,16 @@
 rows::SolutionLogMonitor::SolutionLogMonitor(operations_research::RoutingIndexManager const *index_manager,
                                              operations_research::RoutingModel const *model,
                                              std::shared_ptr<rows::SolutionRepository> solution_repository)
+        : SolutionLogMonitor(index_manager, model, nullptr, std::move(solution_repository)) {}
+
+rows::SolutionLogMonitor::SolutionLogMonitor(operations_research::RoutingIndexManager const *index_manager,
+                                             operations_research::RoutingModel const *model,
+                                             const DroppedVisitTracker *dropped_visit_tracker,
+                                             std::shared_ptr<rows::SolutionRepository> solution_repository)
         : SearchLimit(model->solver()),
           index_manager_{index_manager},
           model_{model},
+          dropped_visit_tracker_{dropped_visit_tracker},
           min_dropped_visits_{std::numeric_limits<int>::max()},
           dropped_visits_buffer_{5},
           cut_off_threshold_{2},
@@ -18,7 +25,7 @@ rows::SolutionLogMonitor::SolutionLogMonitor(operations_research::RoutingIndexMa
 
 bool rows::SolutionLogMonitor::AtSolution() {
     const auto routes = util::GetRoutes(*model_);
-    const auto dropped_visits_count = static_cast<int>(util::GetDroppedVisitCount(*model_));
+    const auto dropped_visits_count = GetDroppedVisitCount();
     CHECK_EQ(model_->nodes(),
              dropped_visits_count + util::GetVisitedNodes(routes, model_->GetDepot()).size() + 1);
 
@@ -63,6 +70,7 @@ void rows::SolutionLogMonitor::Init() {}
 void rows::SolutionLogMonitor::Copy(const operations_research::SearchLimit *limit) {
     auto prototype_limit_ptr = reinterpret_cast<const SolutionLogMonitor *>(limit);
     model_ = prototype_limit_ptr->model_;
+    dropped_visit_tracker_ = prototype_limit_ptr->dropped_visit_tracker_;
     solution_repository_ = prototype_limit_ptr->solution_repository_;
     min_dropped_visits_ = prototype_limit_ptr->min_dropped_visits_;
     dropped_visits_buffer_ = prototype_limit_ptr->dropped_visits_buffer_;
@@ -71,5 +79,14 @@ void rows::SolutionLogMonitor::Copy(const operations_research::SearchLimit *limi
 }
 
 operations_research::SearchLimit *rows::SolutionLogMonitor::MakeClone() const {
-    return solver()->RevAlloc(new SolutionLogMonitor(index_manager_, model_, solution_repository_));
+    return solver()->RevAlloc(new SolutionLogMonitor(index_manager_, model_, dropped_visit_tracker_, solution_repository_));
+}
+
+int rows::SolutionLogMonitor::GetDroppedVisitCount() const {
+    if (dropped_visit_tracker_ == nullptr) {
+        return static_cast<int>(util::GetDroppedVisitCount(*model_));
+    }
+
+    DCHECK_EQ(dropped_visit_tracker_->DroppedNodes(), static_cast<int64>(util::GetDroppedVisitCount(*model_)));
+    return static_cast<int>(dropped_visit_tracker_->DroppedNodes());
 }
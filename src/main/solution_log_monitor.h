@@ -9,6 +9,7 @@
 #include <boost/circular_buffer.hpp>
 
 #include "solution_repository.h"
+#include "dropped_visit_tracker.h"
 
 namespace rows {
 
@@ -18,6 +19,11 @@ namespace rows {
                            operations_research::RoutingModel const *model,
                            std::shared_ptr<rows::SolutionRepository> solution_repository);
 
+        SolutionLogMonitor(operations_research::RoutingIndexManager const *index_manager,
+                           operations_research::RoutingModel const *model,
+                           const DroppedVisitTracker *dropped_visit_tracker,
+                           std::shared_ptr<rows::SolutionRepository> solution_repository);
+
         bool Check() override;
 
         void EnterSearch() override;
@@ -31,8 +37,11 @@ namespace rows {
         operations_research::SearchLimit *MakeClone() const override;
 
     private:
+        int GetDroppedVisitCount() const;
+
         operations_research::RoutingIndexManager const *index_manager_;
         operations_research::RoutingModel const *model_;
+        const DroppedVisitTracker *dropped_visit_tracker_;
         std::shared_ptr<rows::SolutionRepository> solution_repository_;
 
         int min_dropped_visits_;
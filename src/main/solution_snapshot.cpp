@@ -0,0 +1,136 @@
+#include "solution_snapshot.h"
+
+#include <boost/format.hpp>
+
+#include <glog/logging.h>
+
+#include "util/aplication_error.h"
+#include "solver_wrapper.h"
+
+namespace rows {
+
+    namespace {
+
+        template<typename DataSource>
+        SolutionSnapshot TakeSnapshotFromSource(const operations_research::RoutingModel &model, const DataSource &data) {
+            const auto time_dimension = model.GetMutableDimension(SolverWrapper::TIME_DIMENSION);
+            CHECK(time_dimension != nullptr);
+
+            SolutionSnapshot snapshot;
+            snapshot.Routes.resize(static_cast<std::size_t>(model.vehicles()));
+            for (auto vehicle = 0; vehicle < model.vehicles(); ++vehicle) {
+                auto index = data.Value(model.NextVar(model.Start(vehicle)));
+                while (!model.IsEnd(index)) {
+                    snapshot.Routes[vehicle].push_back(index);
+                    index = data.Value(model.NextVar(index));
+                }
+            }
+
+            const auto num_indices = model.Size() + model.vehicles();
+            snapshot.Cumuls.reserve(static_cast<std::size_t>(num_indices));
+            for (int64 index = 0; index < num_indices; ++index) {
+                snapshot.Cumuls.push_back(data.Min(time_dimension->CumulVar(index)));
+            }
+
+            snapshot.Breaks.resize(static_cast<std::size_t>(model.vehicles()));
+            for (auto vehicle = 0; vehicle < model.vehicles(); ++vehicle) {
+                for (const auto break_interval : time_dimension->GetBreakIntervalsOfVehicle(vehicle)) {
+                    snapshot.Breaks[vehicle].push_back(SolutionSnapshot::Break{data.StartMin(break_interval),
+                                                                               data.DurationMin(break_interval),
+                                                                               data.PerformedMin(break_interval) == 1});
+                }
+            }
+
+            return snapshot;
+        }
+
+        class SolverData {
+        public:
+            inline int64 Min(const operations_research::IntVar *variable) const { return variable->Min(); }
+
+            inline int64 Value(const operations_research::IntVar *variable) const { return variable->Value(); }
+
+            inline int64 StartMin(const operations_research::IntervalVar *variable) const { return variable->StartMin(); }
+
+            inline int64 DurationMin(const operations_research::IntervalVar *variable) const { return variable->DurationMin(); }
+
+            inline int64 PerformedMin(const operations_research::IntervalVar *variable) const { return variable->MustBePerformed() ? 1 : 0; }
+        };
+
+        class AssignmentData {
+        public:
+            explicit AssignmentData(const operations_research::Assignment &assignment)
+                    : assignment_{assignment} {}
+
+            inline int64 Min(const operations_research::IntVar *variable) const { return assignment_.Min(variable); }
+
+            inline int64 Value(const operations_research::IntVar *variable) const { return assignment_.Value(variable); }
+
+            inline int64 StartMin(const operations_research::IntervalVar *variable) const { return assignment_.StartMin(variable); }
+
+            inline int64 DurationMin(const operations_research::IntervalVar *variable) const { return assignment_.DurationMin(variable); }
+
+            inline int64 PerformedMin(const operations_research::IntervalVar *variable) const { return assignment_.PerformedMin(variable); }
+
+        private:
+            const operations_research::Assignment &assignment_;
+        };
+    }
+
+    SolutionSnapshot TakeSolutionSnapshot(const operations_research::RoutingModel &model) {
+        return TakeSnapshotFromSource(model, SolverData{});
+    }
+
+    SolutionSnapshot TakeSolutionSnapshot(const operations_research::RoutingModel &model,
+                                          const operations_research::Assignment &solution) {
+        return TakeSnapshotFromSource(model, AssignmentData{solution});
+    }
+
+    operations_research::Assignment *RestoreSolutionSnapshot(operations_research::RoutingModel &model,
+                                                             const SolutionSnapshot &snapshot) {
+        const auto time_dimension = model.GetMutableDimension(SolverWrapper::TIME_DIMENSION);
+        CHECK(time_dimension != nullptr);
+
+        const auto num_indices = model.Size() + model.vehicles();
+        if (snapshot.Cumuls.size() != static_cast<std::size_t>(num_indices)
+            || snapshot.Breaks.size() != static_cast<std::size_t>(model.vehicles())) {
+            throw util::ApplicationError((boost::format("Snapshot of %1% indices and %2% vehicles does not match the model of %3% indices and %4% vehicles")
+                                          % snapshot.Cumuls.size()
+                                          % snapshot.Breaks.size()
+                                          % num_indices
+                                          % model.vehicles()).str(), util::ErrorCode::ERROR);
+        }
+
+        const auto restored_solution = model.ReadAssignmentFromRoutes(snapshot.Routes, true);
+        if (restored_solution == nullptr) {
+            throw util::ApplicationError("Failed to restore routes of the solution snapshot", util::ErrorCode::ERROR);
+        }
+
+        const auto solution = model.solver()->MakeAssignment(restored_solution);
+        for (int64 index = 0; index < num_indices; ++index) {
+            solution->Add(time_dimension->CumulVar(index))->SetValue(snapshot.Cumuls[index]);
+        }
+
+        for (auto vehicle = 0; vehicle < model.vehicles(); ++vehicle) {
+            const auto &break_intervals = time_dimension->GetBreakIntervalsOfVehicle(vehicle);
+            const auto &breaks = snapshot.Breaks[vehicle];
+            if (break_intervals.size() != breaks.size()) {
+                throw util::ApplicationError((boost::format("Snapshot contains %1% breaks of vehicle %2%, but the model has %3%")
+                                              % breaks.size()
+                                              % vehicle
+                                              % break_intervals.size()).str(), util::ErrorCode::ERROR);
+            }
+
+            for (std::size_t break_pos = 0; break_pos < breaks.size(); ++break_pos) {
+                const auto &break_value = breaks[break_pos];
+                auto break_element = solution->Add(break_intervals[break_pos]);
+                break_element->SetStartValue(break_value.Start);
+                break_element->SetDurationValue(break_value.Duration);
+                break_element->SetEndValue(break_value.Start + break_value.Duration);
+                break_element->SetPerformedValue(break_value.Performed ? 1 : 0);
+            }
+        }
+
+        return solution;
+    }
+}
@@ -0,0 +1,41 @@
+#ifndef ROWS_SOLUTION_SNAPSHOT_H
+#define ROWS_SOLUTION_SNAPSHOT_H
+
+#include <vector>
+
+#include <ortools/constraint_solver/routing.h>
+
+namespace rows {
+
+    // values of a solution taken when it was found, so a solution written in the background does not depend on values
+    // derived from its routes by another model, which may differ from the values chosen by the search
+    struct SolutionSnapshot {
+        struct Break {
+            int64 Start;
+            int64 Duration;
+            bool Performed;
+        };
+
+        std::vector<std::vector<int64> > Routes;
+
+        // values of the time dimension at every index of the routing model including ends of routes
+        std::vector<int64> Cumuls;
+
+        // breaks of every vehicle in the order of the time dimension
+        std::vector<std::vector<Break> > Breaks;
+    };
+
+    // takes values of variables of the model, which must be bound to a solution, e.g. by a search monitor
+    SolutionSnapshot TakeSolutionSnapshot(const operations_research::RoutingModel &model);
+
+    SolutionSnapshot TakeSolutionSnapshot(const operations_research::RoutingModel &model,
+                                          const operations_research::Assignment &solution);
+
+    // restores the routes in the model and replaces values of the time dimension and breaks by values
+    // of the snapshot, throws if the routes cannot be restored or the snapshot does not match the model
+    operations_research::Assignment *RestoreSolutionSnapshot(operations_research::RoutingModel &model,
+                                                             const SolutionSnapshot &snapshot);
+}
+
+
+#endif //ROWS_SOLUTION_SNAPSHOT_H
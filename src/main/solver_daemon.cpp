@@ -0,0 +1,455 @@
+#include "solver_daemon.h"
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <boost/date_time.hpp>
+#include <boost/format.hpp>
+
+#include <glog/logging.h>
+
+#include "util/aplication_error.h"
+#include "util/input.h"
+#include "memory_stats.h"
+#include "printer.h"
+#include "three_step_worker.h"
+
+namespace rows {
+
+    namespace {
+
+        boost::posix_time::time_duration GetDuration(const nlohmann::json &parameters,
+                                                     const std::string &key,
+                                                     boost::posix_time::time_duration default_value) {
+            const auto value_it = parameters.find(key);
+            if (value_it == std::end(parameters)) {
+                return default_value;
+            }
+            return util::GetTimeDurationOrDefault(value_it->get<std::string>(), default_value);
+        }
+
+        std::string GetString(const nlohmann::json &parameters, const std::string &key, const std::string &default_value) {
+            const auto value_it = parameters.find(key);
+            if (value_it == std::end(parameters)) {
+                return default_value;
+            }
+            return value_it->get<std::string>();
+        }
+    }
+
+    class SolverDaemon::Connection {
+    public:
+        explicit Connection(int socket)
+                : socket_{socket},
+                  mutex_{},
+                  buffer_{} {}
+
+        ~Connection() {
+            close(socket_);
+        }
+
+        // returns false once the peer closed the connection
+        bool ReadLine(std::string &line) {
+            static const std::size_t CHUNK_SIZE = 4096;
+
+            std::size_t line_end = buffer_.find('\n');
+            while (line_end == std::string::npos) {
+                char chunk[CHUNK_SIZE];
+                const auto bytes_read = recv(socket_, chunk, CHUNK_SIZE, 0);
+                if (bytes_read <= 0) {
+                    return false;
+                }
+
+                buffer_.append(chunk, static_cast<std::size_t>(bytes_read));
+                line_end = buffer_.find('\n');
+            }
+
+            line = buffer_.substr(0, line_end);
+            buffer_.erase(0, line_end + 1);
+            return true;
+        }
+
+        // messages are dropped if the peer is gone, jobs continue until they finish or are cancelled
+        void Send(const nlohmann::json &message) {
+            const auto text = message.dump() + "\n";
+
+            std::lock_guard<std::mutex> lock{mutex_};
+            std::size_t bytes_sent = 0;
+            while (bytes_sent < text.size()) {
+                const auto result = send(socket_, text.data() + bytes_sent, text.size() - bytes_sent, MSG_NOSIGNAL);
+                if (result <= 0) {
+                    return;
+                }
+                bytes_sent += static_cast<std::size_t>(result);
+            }
+        }
+
+        void Close() {
+            shutdown(socket_, SHUT_RDWR);
+        }
+
+    private:
+        const int socket_;
+        std::mutex mutex_;
+        std::string buffer_;
+    };
+
+    struct SolverDaemon::Job {
+        std::string Id;
+        std::string Output;
+        std::shared_ptr<Connection> Client;
+        std::unique_ptr<ThreeStepSchedulingWorker> Worker;
+    };
+
+    SolverDaemonOptions::SolverDaemonOptions()
+            : SocketPath{"/tmp/rows-daemon.sock"},
+              MaxJobs{1},
+              MemoryLimit{0},
+              ProblemCacheSize{4} {}
+
+    SolverDaemon::SolverDaemon(SolverDaemonOptions options,
+                               std::shared_ptr<ProblemDataFactory> data_factory,
+                               std::shared_ptr<const History> history)
+            : options_{std::move(options)},
+              data_factory_{std::make_shared<SynchronizedProblemDataFactory>(std::move(data_factory))},
+              history_{std::move(history)},
+              socket_{-1},
+              shutdown_{false},
+              active_threads_{0} {}
+
+    SolverDaemon::~SolverDaemon() {
+        Shutdown();
+        WaitForThreads();
+
+        if (socket_ >= 0) {
+            close(socket_);
+            unlink(options_.SocketPath.c_str());
+        }
+    }
+
+    void SolverDaemon::Listen() {
+        sockaddr_un address{};
+        if (options_.SocketPath.size() >= sizeof(address.sun_path)) {
+            throw util::ApplicationError((boost::format("Socket path is too long: %1%") % options_.SocketPath).str(),
+                                         util::ErrorCode::ERROR);
+        }
+
+        socket_ = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (socket_ < 0) {
+            throw util::ApplicationError((boost::format("Failed to create the socket: %1%") % std::strerror(errno)).str(),
+                                         util::ErrorCode::ERROR);
+        }
+
+        address.sun_family = AF_UNIX;
+        std::strncpy(address.sun_path, options_.SocketPath.c_str(), sizeof(address.sun_path) - 1);
+        unlink(options_.SocketPath.c_str());
+        if (bind(socket_, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0 || listen(socket_, SOMAXCONN) < 0) {
+            throw util::ApplicationError((boost::format("Failed to listen on the socket %1%: %2%")
+                                          % options_.SocketPath
+                                          % std::strerror(errno)).str(),
+                                         util::ErrorCode::ERROR);
+        }
+
+        LOG(INFO) << "Listening on " << options_.SocketPath;
+    }
+
+    void SolverDaemon::Run() {
+        CHECK_GE(socket_, 0) << "The daemon must listen before it runs";
+
+        while (!shutdown_) {
+            const auto client_socket = accept(socket_, nullptr, nullptr);
+            if (client_socket < 0) {
+                if (shutdown_ || errno != EINTR) {
+                    break;
+                }
+                continue;
+            }
+
+            auto connection = std::make_shared<Connection>(client_socket);
+            std::lock_guard<std::mutex> lock{mutex_};
+            if (shutdown_) {
+                break;
+            }
+
+            connections_.push_back(connection);
+            StartThread([this, connection]() -> void { Serve(connection); });
+        }
+
+        WaitForThreads();
+    }
+
+    void SolverDaemon::StartThread(std::function<void()> task) {
+        ++active_threads_;
+        std::thread([this, task]() mutable -> void {
+            task();
+
+            // resources of the task are released before the daemon can be destroyed
+            task = nullptr;
+
+            std::lock_guard<std::mutex> lock{mutex_};
+            --active_threads_;
+            threads_finished_.notify_all();
+        }).detach();
+    }
+
+    void SolverDaemon::WaitForThreads() {
+        std::unique_lock<std::mutex> lock{mutex_};
+        threads_finished_.wait(lock, [this]() -> bool { return active_threads_ == 0; });
+    }
+
+    void SolverDaemon::Shutdown() {
+        if (shutdown_.exchange(true)) {
+            return;
+        }
+
+        LOG(INFO) << "Shutting down";
+        std::lock_guard<std::mutex> lock{mutex_};
+        for (auto &job : jobs_) {
+            job.second->Worker->Cancel();
+        }
+
+        for (auto &connection : connections_) {
+            connection->Close();
+        }
+
+        if (socket_ >= 0) {
+            shutdown(socket_, SHUT_RDWR);
+        }
+    }
+
+    void SolverDaemon::Serve(std::shared_ptr<Connection> connection) {
+        std::string line;
+        while (!shutdown_ && connection->ReadLine(line)) {
+            if (line.empty()) {
+                continue;
+            }
+
+            try {
+                Dispatch(nlohmann::json::parse(line), connection);
+            } catch (const std::exception &ex) {
+                connection->Send({{"type",    "error"},
+                                  {"message", ex.what()}});
+            }
+        }
+
+        // jobs of a closed connection are no longer needed
+        std::lock_guard<std::mutex> lock{mutex_};
+        for (auto &job : jobs_) {
+            if (job.second->Client == connection) {
+                job.second->Worker->Cancel();
+            }
+        }
+        connections_.erase(std::remove(std::begin(connections_), std::end(connections_), connection), std::end(connections_));
+    }
+
+    void SolverDaemon::Dispatch(const nlohmann::json &request, const std::shared_ptr<Connection> &connection) {
+        const auto command = GetString(request, "command", "");
+        if (command == "solve") {
+            Solve(request, connection);
+        } else if (command == "cancel") {
+            Cancel(request, connection);
+        } else if (command == "status") {
+            connection->Send(Status());
+        } else if (command == "shutdown") {
+            connection->Send({{"type", "shutdown"}});
+            Shutdown();
+        } else {
+            connection->Send({{"type",    "error"},
+                              {"message", (boost::format("Unknown command: '%1%'") % command).str()}});
+        }
+    }
+
+    void SolverDaemon::Solve(const nlohmann::json &request, const std::shared_ptr<Connection> &connection) {
+        const auto id = GetString(request, "id", "");
+        const auto reject = [&connection, &id](const std::string &reason) -> void {
+            connection->Send({{"id",      id},
+                              {"type",    "rejected"},
+                              {"message", reason}});
+        };
+
+        const auto problem_it = request.find("problem");
+        if (id.empty() || problem_it == std::end(request)) {
+            reject("Solve request requires the id and the problem");
+            return;
+        }
+
+        const auto parameters_it = request.find("parameters");
+        const auto parameters = parameters_it == std::end(request) ? nlohmann::json::object() : *parameters_it;
+        const auto first_stage = ParseFirstStageStrategy(GetString(parameters, "first_stage", "default"));
+        const auto third_stage = ParseThirdStageStrategy(GetString(parameters, "third_stage", "default"));
+        if (!first_stage || !third_stage) {
+            reject("Unknown strategy of the first or the third stage");
+            return;
+        }
+
+        auto job = std::make_shared<Job>();
+        job->Id = id;
+        job->Output = GetString(parameters, "output", (boost::format("solution_%1%.gexf") % id).str());
+        job->Client = connection;
+
+        // printer of the job is called only by the thread of the job
+        std::weak_ptr<Connection> weak_connection = connection;
+        auto printer = std::make_shared<JsonEventPrinter>([weak_connection, id](nlohmann::json event) -> void {
+            const auto client = weak_connection.lock();
+            if (client) {
+                event["id"] = id;
+                client->Send(event);
+            }
+        });
+        job->Worker = std::make_unique<ThreeStepSchedulingWorker>(std::move(printer), *first_stage, *third_stage, data_factory_);
+
+        {
+            std::lock_guard<std::mutex> lock{mutex_};
+            if (shutdown_) {
+                reject("Shutting down");
+                return;
+            }
+
+            if (jobs_.find(id) != std::end(jobs_)) {
+                reject("Job with the same id is running");
+                return;
+            }
+
+            if (jobs_.size() >= options_.MaxJobs) {
+                reject((boost::format("Limit of %1% running jobs reached") % options_.MaxJobs).str());
+                return;
+            }
+
+            const auto memory_usage = MemoryUsage::Current();
+            if (options_.MemoryLimit > 0 && memory_usage.Rss > options_.MemoryLimit) {
+                reject((boost::format("Memory usage %1% bytes exceeds the limit of %2% bytes")
+                        % memory_usage.Rss
+                        % options_.MemoryLimit).str());
+                return;
+            }
+
+            jobs_.emplace(id, job);
+            connection->Send({{"id",   id},
+                              {"type", "accepted"}});
+            const auto problem_json = *problem_it;
+            StartThread([this, job, problem_json, parameters]() -> void { RunJob(job, problem_json, parameters); });
+        }
+    }
+
+    void SolverDaemon::Cancel(const nlohmann::json &request, const std::shared_ptr<Connection> &connection) {
+        const auto id = GetString(request, "id", "");
+
+        std::lock_guard<std::mutex> lock{mutex_};
+        const auto job_it = jobs_.find(id);
+        if (job_it == std::end(jobs_)) {
+            connection->Send({{"id",      id},
+                              {"type",    "error"},
+                              {"message", "Job not found"}});
+            return;
+        }
+
+        job_it->second->Worker->Cancel();
+        connection->Send({{"id",   id},
+                          {"type", "cancelled"}});
+    }
+
+    nlohmann::json SolverDaemon::Status() const {
+        const auto memory_usage = MemoryUsage::Current();
+
+        std::size_t problem_cache_size = 0;
+        {
+            std::lock_guard<std::mutex> problem_cache_lock{problem_cache_mutex_};
+            problem_cache_size = problem_cache_.size();
+        }
+
+        std::lock_guard<std::mutex> lock{mutex_};
+        std::vector<std::string> jobs;
+        for (const auto &job : jobs_) {
+            jobs.push_back(job.first);
+        }
+
+        return {{"type",          "status"},
+                {"jobs",          jobs},
+                {"max_jobs",      options_.MaxJobs},
+                {"rss",           memory_usage.Rss},
+                {"memory_limit",  options_.MemoryLimit},
+                {"problem_cache", problem_cache_size}};
+    }
+
+    void SolverDaemon::RunJob(std::shared_ptr<Job> job, nlohmann::json problem_json, nlohmann::json parameters) {
+        nlohmann::json result{{"id",     job->Id},
+                              {"type",   "finished"},
+                              {"output", job->Output}};
+
+        try {
+            const auto problem_data = GetProblemData(problem_json, GetString(parameters, "scheduling_date", ""));
+            if (job->Worker->Init(problem_data,
+                                  history_,
+                                  job->Output,
+                                  GetDuration(parameters, "visit_time_window", boost::posix_time::minutes(120)),
+                                  GetDuration(parameters, "break_time_window", boost::posix_time::minutes(120)),
+                                  GetDuration(parameters, "begin_end_shift_time_extension", boost::posix_time::minutes(15)),
+                                  GetDuration(parameters, "preopt_noprogress_time_limit", boost::posix_time::minutes(1)),
+                                  GetDuration(parameters, "opt_noprogress_time_limit", boost::posix_time::minutes(5)),
+                                  GetDuration(parameters, "postopt_noprogress_time_limit", boost::posix_time::minutes(5)),
+                                  boost::none,
+                                  1.0)) {
+                job->Worker->Run();
+            }
+            result["return_code"] = job->Worker->ReturnCode();
+        } catch (const std::exception &ex) {
+            LOG(WARNING) << boost::format("Job %1% failed: %2%") % job->Id % ex.what();
+            result["return_code"] = 1;
+            result["message"] = ex.what();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock{mutex_};
+            jobs_.erase(job->Id);
+        }
+        job->Client->Send(result);
+    }
+
+    std::shared_ptr<const ProblemData> SolverDaemon::GetProblemData(const nlohmann::json &problem_json,
+                                                                    const std::string &scheduling_date) {
+        auto key = problem_json.dump();
+        key.push_back('\n');
+        key.append(scheduling_date);
+        const auto hash = std::hash<std::string>{}(key);
+
+        const auto find_entry = [this, hash, &key]() -> std::list<ProblemCacheEntry>::iterator {
+            return std::find_if(std::begin(problem_cache_), std::end(problem_cache_),
+                                [hash, &key](const ProblemCacheEntry &entry) -> bool {
+                                    return entry.Hash == hash && entry.Key == key;
+                                });
+        };
+
+        {
+            std::lock_guard<std::mutex> lock{problem_cache_mutex_};
+            const auto cache_it = find_entry();
+            if (cache_it != std::end(problem_cache_)) {
+                problem_cache_.splice(std::begin(problem_cache_), problem_cache_, cache_it);
+                return problem_cache_.front().Data;
+            }
+        }
+
+        // the lock is not held while the problem data is created, so the status of the daemon does not wait for it
+        auto problem = util::ReduceProblem(util::ParseProblem(problem_json), scheduling_date, std::make_shared<LogPrinter>());
+        std::shared_ptr<const ProblemData> problem_data = data_factory_->makeProblem(std::move(problem));
+        if (options_.ProblemCacheSize > 0) {
+            std::lock_guard<std::mutex> lock{problem_cache_mutex_};
+            const auto cache_it = find_entry();
+            if (cache_it != std::end(problem_cache_)) {
+                // another job created the same problem in the meantime
+                problem_cache_.splice(std::begin(problem_cache_), problem_cache_, cache_it);
+                return problem_cache_.front().Data;
+            }
+
+            problem_cache_.push_front({hash, std::move(key), problem_data});
+            if (problem_cache_.size() > options_.ProblemCacheSize) {
+                problem_cache_.pop_back();
+            }
+        }
+        return problem_data;
+    }
+}
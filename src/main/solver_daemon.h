@@ -0,0 +1,115 @@
+#ifndef ROWS_SOLVER_DAEMON_H
+#define ROWS_SOLVER_DAEMON_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <functional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "history.h"
+#include "problem_data.h"
+
+namespace rows {
+
+    struct SolverDaemonOptions {
+        SolverDaemonOptions();
+
+        std::string SocketPath;
+
+        // number of problems solved at the same time, further solve requests are rejected
+        std::size_t MaxJobs;
+
+        // resident memory of the process in bytes above which solve requests are rejected, unlimited if zero
+        std::size_t MemoryLimit;
+
+        // number of recently solved problems whose travel times are kept in memory
+        std::size_t ProblemCacheSize;
+    };
+
+    // serves solve requests received over a Unix domain socket, every message is a JSON object in a single line
+    //
+    // requests:
+    //  {"command": "solve", "id": "job", "problem": {...}, "parameters": {...}}
+    //  {"command": "cancel", "id": "job"}
+    //  {"command": "status"}
+    //  {"command": "shutdown"}
+    //
+    // a solve request is answered by the 'accepted' or 'rejected' message followed by progress events of the json printer
+    // and the 'finished' message, all messages of a job carry its id
+    class SolverDaemon {
+    public:
+        SolverDaemon(SolverDaemonOptions options,
+                     std::shared_ptr<ProblemDataFactory> data_factory,
+                     std::shared_ptr<const History> history);
+
+        ~SolverDaemon();
+
+        // binds the socket, the daemon accepts connections once it runs
+        void Listen();
+
+        // serves connections until shutdown is requested
+        void Run();
+
+        void Shutdown();
+
+    private:
+        class Connection;
+
+        struct Job;
+
+        // problems are compared by their hash first and then by the full key, because different problems may share the hash
+        struct ProblemCacheEntry {
+            std::size_t Hash;
+            std::string Key;
+            std::shared_ptr<const ProblemData> Data;
+        };
+
+        // runs the task in a detached thread, requires the lock of the mutex
+        void StartThread(std::function<void()> task);
+
+        void WaitForThreads();
+
+        void Serve(std::shared_ptr<Connection> connection);
+
+        void Dispatch(const nlohmann::json &request, const std::shared_ptr<Connection> &connection);
+
+        void Solve(const nlohmann::json &request, const std::shared_ptr<Connection> &connection);
+
+        void Cancel(const nlohmann::json &request, const std::shared_ptr<Connection> &connection);
+
+        nlohmann::json Status() const;
+
+        void RunJob(std::shared_ptr<Job> job, nlohmann::json problem_json, nlohmann::json parameters);
+
+        std::shared_ptr<const ProblemData> GetProblemData(const nlohmann::json &problem_json, const std::string &scheduling_date);
+
+        SolverDaemonOptions options_;
+
+        // shared by jobs and workers of clusters, so problem data is created by one thread at a time
+        std::shared_ptr<ProblemDataFactory> data_factory_;
+        std::shared_ptr<const History> history_;
+
+        int socket_;
+        std::atomic<bool> shutdown_;
+
+        mutable std::mutex mutex_;
+        std::unordered_map<std::string, std::shared_ptr<Job> > jobs_;
+        std::vector<std::shared_ptr<Connection> > connections_;
+        std::size_t active_threads_;
+        std::condition_variable threads_finished_;
+
+        mutable std::mutex problem_cache_mutex_;
+        std::list<ProblemCacheEntry> problem_cache_;
+    };
+}
+
+#endif //ROWS_SOLVER_DAEMON_H
@@ -30,6 +30,11 @@
 #include "solver_wrapper.h"
 #include "progress_printer_monitor.h"
 #include "declined_visit_evaluator.h"
+#include "perf_counters.h"
+#include "candidate_neighbour_filter.h"
+#include "continuity_of_care_filter.h"
+#include "sibling_filter.h"
+#include "trace_writer.h"
 
 // TODO: add support for mobile workers
 // TODO: add information about partner
@@ -43,6 +48,26 @@ namespace rows {
 
     const std::string SolverWrapper::TIME_DIMENSION{"Time"};
 
+    NeighbourhoodOptions::NeighbourhoodOptions()
+            : NeighbourhoodOptions(true, 0) {}
+
+    NeighbourhoodOptions::NeighbourhoodOptions(bool prune_infeasible_arcs, std::size_t candidate_neighbours)
+            : NeighbourhoodOptions(prune_infeasible_arcs, candidate_neighbours, true) {}
+
+    NeighbourhoodOptions::NeighbourhoodOptions(bool prune_infeasible_arcs,
+                                               std::size_t candidate_neighbours,
+                                               bool local_search_filters)
+            : NeighbourhoodOptions(prune_infeasible_arcs, candidate_neighbours, local_search_filters, false) {}
+
+    NeighbourhoodOptions::NeighbourhoodOptions(bool prune_infeasible_arcs,
+                                               std::size_t candidate_neighbours,
+                                               bool local_search_filters,
+                                               bool continuity_of_care)
+            : PruneInfeasibleArcs{prune_infeasible_arcs},
+              CandidateNeighbours{candidate_neighbours},
+              LocalSearchFilters{local_search_filters},
+              ContinuityOfCare{continuity_of_care} {}
+
     SolverWrapper::SolverWrapper(const ProblemData &problem_data,
                                  const operations_research::RoutingSearchParameters &search_parameters)
             : SolverWrapper(problem_data,
@@ -66,7 +91,13 @@ namespace rows {
               service_users_(),
               problem_data_{problem_data},
               index_manager_{nodes(), vehicles(), rows::RealProblemData::DEPOT},
-              failed_index_repository_{std::make_shared<FailedIndexRepository>()} {
+              failed_index_repository_{std::make_shared<FailedIndexRepository>()},
+              neighbourhood_options_{},
+              scenario_reduction_options_{},
+              delay_sketch_options_{},
+              duration_sample_{},
+              vehicle_skills_{},
+              node_tasks_{} {
         for (const auto &service_user : problem_data_.problem().service_users()) {
             const auto visit_count = std::count_if(std::begin(problem_data_.problem().visits()),
                                                    std::end(problem_data_.problem().visits()),
@@ -79,6 +110,17 @@ namespace rows {
                 DCHECK(insert_it.second);
             }
         }
+
+        SkillIndex skill_index;
+        vehicle_skills_.reserve(static_cast<std::size_t>(vehicles()));
+        for (auto vehicle = 0; vehicle < vehicles(); ++vehicle) {
+            vehicle_skills_.push_back(skill_index.Intern(Carer(vehicle).skills()));
+        }
+
+        node_tasks_.resize(static_cast<std::size_t>(nodes()));
+        for (operations_research::RoutingIndexManager::NodeIndex visit_node{1}; visit_node < problem_data_.nodes(); ++visit_node) {
+            node_tasks_[visit_node.value()] = skill_index.Intern(problem_data_.NodeToVisit(visit_node).tasks());
+        }
     }
 
     boost::optional<rows::Diary> FindDiaryOrNone(const std::vector<rows::Diary> &diaries, boost::gregorian::date date) {
@@ -97,6 +139,10 @@ namespace rows {
         return problem().carers().at(static_cast<std::size_t>(vehicle)).first;
     }
 
+    bool SolverWrapper::HasSkills(int vehicle, operations_research::RoutingNodeIndex node) const {
+        return vehicle_skills_.at(static_cast<std::size_t>(vehicle)).Includes(node_tasks_.at(static_cast<std::size_t>(node.value())));
+    }
+
     const rows::SolverWrapper::LocalServiceUser &SolverWrapper::User(const rows::ServiceUser &user) const {
         const auto find_it = service_users_.find(user);
         DCHECK(find_it != std::end(service_users_));
@@ -136,6 +182,29 @@ namespace rows {
         return breaks_to_use;
     }
 
+    std::pair<int64, int64> SolverWrapper::GetWorkingHours(int vehicle) const {
+        const auto &carer = Carer(vehicle);
+        const auto &diary_opt = problem().diary(carer, GetScheduleDate());
+        if (!diary_opt.is_initialized()) {
+            return {0, 0};
+        }
+
+        const auto &diary = diary_opt.get();
+        const auto begin_time_duration = (diary.begin_date_time() - StartHorizon());
+        const auto end_time_duration = (diary.end_date_time() - StartHorizon());
+
+        CHECK(!begin_time_duration.is_negative()) << carer.sap_number();
+        CHECK(!end_time_duration.is_negative()) << carer.sap_number();
+
+        const auto begin_time = GetAdjustedWorkdayStart(begin_time_duration);
+        const auto end_time = GetAdjustedWorkdayFinish(end_time_duration);
+
+        CHECK_GE(begin_time, 0) << carer.sap_number();
+        CHECK_LE(begin_time, end_time) << carer.sap_number();
+
+        return {begin_time, end_time};
+    }
+
     operations_research::IntervalVar *SolverWrapper::CreateBreakInterval(operations_research::Solver *solver,
                                                                          const rows::Event &event,
                                                                          std::string label) const {
@@ -894,57 +963,64 @@ namespace rows {
     }
 
     void SolverWrapper::AddSkillHandling(operations_research::RoutingModel &model) {
+        // visits with the same tasks share the domain of allowed vehicles
+        std::unordered_map<SkillSet, std::vector<int64> > allowed_vehicles_by_tasks;
         for (operations_research::RoutingIndexManager::NodeIndex visit_node{1}; visit_node < problem_data_.nodes(); ++visit_node) {
-            const auto &visit = problem_data_.NodeToVisit(visit_node);
-
-            std::vector<int64> visit_indices;
-            for (const auto local_visit_node : problem_data_.GetNodes(visit)) {
-                visit_indices.push_back(index_manager_.NodeToIndex(local_visit_node));
-            }
-
-            std::vector<int64> allowed_vehicles{index_manager_.kUnassigned};
-            for (auto vehicle = 0; vehicle < model.vehicles(); ++vehicle) {
-                const auto &carer = Carer(vehicle);
-                if (carer.has_skills(visit.tasks())) {
-                    allowed_vehicles.push_back(vehicle);
+            const auto &tasks = node_tasks_[visit_node.value()];
+
+            auto allowed_vehicles_it = allowed_vehicles_by_tasks.find(tasks);
+            if (allowed_vehicles_it == std::end(allowed_vehicles_by_tasks)) {
+                std::vector<int64> allowed_vehicles{index_manager_.kUnassigned};
+                for (auto vehicle = 0; vehicle < model.vehicles(); ++vehicle) {
+                    if (vehicle_skills_[vehicle].Includes(tasks)) {
+                        allowed_vehicles.push_back(vehicle);
+                    }
                 }
-            }
 
-            for (auto visit_index : visit_indices) {
-                model.solver()->AddConstraint(model.solver()->MakeMemberCt(model.VehicleVar(visit_index), allowed_vehicles));
+                allowed_vehicles_it = allowed_vehicles_by_tasks.emplace(tasks, std::move(allowed_vehicles)).first;
             }
+
+            model.VehicleVar(index_manager_.NodeToIndex(visit_node))->SetValues(allowed_vehicles_it->second);
         }
     }
 
     void SolverWrapper::AddContinuityOfCare(operations_research::RoutingModel &model) {
+        // the limit was not enforced before, because vehicles of visits were never tied to the vehicles of the service user,
+        // so it is posted only on request to keep results of existing configurations
+        if (!neighbourhood_options_.ContinuityOfCare) {
+            return;
+        }
+
+        std::vector<std::vector<int64> > filter_user_indices;
+        std::vector<int64> filter_max_carers;
         for (const auto &service_user : service_users_) {
             std::vector<int64> user_visit_indices;
             bool is_multiple_carer_service_user = false;
 
-            std::vector<int64> visit_indices;
             for (operations_research::RoutingIndexManager::NodeIndex visit_node{1}; visit_node < problem_data_.nodes(); ++visit_node) {
                 const auto &visit = problem_data_.NodeToVisit(visit_node);
-                const auto &visit_nodes = problem_data_.GetNodes(visit);
-
                 if (visit.service_user() != service_user.first) {
                     continue;
                 }
 
-                for (const auto local_visit_node : visit_nodes) {
-                    const auto visit_index = index_manager_.NodeToIndex(local_visit_node);
-                    user_visit_indices.push_back(visit_index);
-                }
-
-                if (visit_nodes.size() > 1) {
+                user_visit_indices.push_back(index_manager_.NodeToIndex(visit_node));
+                if (problem_data_.GetNodes(visit).size() > 1) {
                     is_multiple_carer_service_user = true;
                 }
             }
 
+            if (user_visit_indices.empty()) {
+                continue;
+            }
+
             std::vector<operations_research::IntVar *> is_visited_by_vehicle;
             model.solver()->MakeBoolVarArray(vehicles(), &is_visited_by_vehicle);
 
-            for (auto visit_index : visit_indices) {
-                model.solver()->MakeElementEquality(is_visited_by_vehicle, model.VehicleVar(visit_index), 1);
+            // a dropped visit has the vehicle -1, so it does not count against the limit
+            for (const auto visit_index : user_visit_indices) {
+                const auto vehicle = model.solver()->MakeMax(model.VehicleVar(visit_index), 0)->Var();
+                model.solver()->AddConstraint(model.solver()->MakeGreaterOrEqual(
+                        model.solver()->MakeElement(is_visited_by_vehicle, vehicle), model.ActiveVar(visit_index)));
             }
 
             auto continuity_care_cardinality = MAX_CARERS_SINGLE_VISITS;
@@ -954,6 +1030,14 @@ namespace rows {
 
             model.solver()->AddConstraint(
                     model.solver()->MakeLessOrEqual(model.solver()->MakeSum(is_visited_by_vehicle), continuity_care_cardinality));
+
+            filter_user_indices.emplace_back(std::move(user_visit_indices));
+            filter_max_carers.push_back(continuity_care_cardinality);
+        }
+
+        if (neighbourhood_options_.LocalSearchFilters && !filter_user_indices.empty()) {
+            model.AddLocalSearchFilter(model.solver()->RevAlloc(
+                    new ContinuityOfCareFilter(model, std::move(filter_user_indices), std::move(filter_max_carers))));
         }
     }
 
@@ -961,11 +1045,13 @@ namespace rows {
         static const auto START_FROM_ZERO_TIME = false;
 
         const auto transit_callback_handle = model.RegisterTransitCallback([this](int64 from_index, int64 to_index) -> int64 {
+            ROWS_PERF_COUNT(PerfCounter::TransitCallback);
             return this->problem_data_.Distance(this->index_manager_.IndexToNode(from_index), this->index_manager_.IndexToNode(to_index));
         });
         model.SetArcCostEvaluatorOfAllVehicles(transit_callback_handle);
 
         const auto service_time_callback_handle = model.RegisterTransitCallback([this](int64 from_index, int64 to_index) -> int64 {
+            ROWS_PERF_COUNT(PerfCounter::TransitCallback);
             return this->problem_data_.ServicePlusTravelTime(this->index_manager_.IndexToNode(from_index),
                                                              this->index_manager_.IndexToNode(to_index));
         });
@@ -982,6 +1068,7 @@ namespace rows {
         // visit that needs multiple carers is referenced by multiple nodes
         // all such nodes must be either performed or unperformed
         auto total_multiple_carer_visits = 0;
+        std::vector<std::pair<int64, int64> > sibling_indices;
         for (operations_research::RoutingIndexManager::NodeIndex visit_node{1}; visit_node < problem_data_.nodes(); ++visit_node) {
             const auto &visit = problem_data_.NodeToVisit(visit_node);
 
@@ -1044,9 +1131,85 @@ namespace rows {
                                                                                model.solver()->MakeIntConst(0));
                 model.solver()->AddConstraint(model.solver()->MakeLess(model.VehicleVar(first_visit_to_use), second_vehicle_var_to_use));
 
+                sibling_indices.emplace_back(first_visit_to_use, second_visit_to_use);
                 ++total_multiple_carer_visits;
             }
         }
+
+        if (neighbourhood_options_.LocalSearchFilters && !sibling_indices.empty()) {
+            model.AddLocalSearchFilter(model.solver()->RevAlloc(new SiblingFilter(model, std::move(sibling_indices))));
+        }
+
+        RestrictSuccessors(model);
+    }
+
+    void SolverWrapper::RestrictSuccessors(operations_research::RoutingModel &model) {
+        if (!neighbourhood_options_.PruneInfeasibleArcs && neighbourhood_options_.CandidateNeighbours == 0) {
+            return;
+        }
+
+        TraceSpan restrict_successors_span{"RestrictSuccessors", "model"};
+
+        const auto time_dimension = model.GetMutableDimension(rows::SolverWrapper::TIME_DIMENSION);
+
+        std::vector<int64> visit_indices;
+        for (operations_research::RoutingIndexManager::NodeIndex visit_node{1}; visit_node < problem_data_.nodes(); ++visit_node) {
+            visit_indices.push_back(index_manager_.NodeToIndex(visit_node));
+        }
+
+        // a successor is infeasible if the visit cannot start before its window closes,
+        // even if the predecessor starts as early as possible, the slack of the dimension is non-negative
+        std::size_t total_arcs = 0;
+        std::size_t pruned_arcs = 0;
+        std::vector<std::vector<int64> > candidates(static_cast<std::size_t>(model.Size()));
+        std::vector<std::pair<int64, int64> > feasible_successors;
+        std::vector<int64> infeasible_successors;
+        for (const auto from_index : visit_indices) {
+            const auto earliest_departure = time_dimension->CumulVar(from_index)->Min();
+
+            feasible_successors.clear();
+            infeasible_successors.clear();
+            for (const auto to_index : visit_indices) {
+                if (from_index == to_index) {
+                    continue;
+                }
+
+                ++total_arcs;
+                const auto transit = time_dimension->GetTransitValue(from_index, to_index, 0);
+                if (earliest_departure + transit > time_dimension->CumulVar(to_index)->Max()) {
+                    infeasible_successors.push_back(to_index);
+                } else {
+                    feasible_successors.emplace_back(transit, to_index);
+                }
+            }
+
+            if (neighbourhood_options_.PruneInfeasibleArcs && !infeasible_successors.empty()) {
+                model.NextVar(from_index)->RemoveValues(infeasible_successors);
+                pruned_arcs += infeasible_successors.size();
+            }
+
+            if (neighbourhood_options_.CandidateNeighbours > 0) {
+                const auto neighbours = std::min(neighbourhood_options_.CandidateNeighbours, feasible_successors.size());
+                std::partial_sort(std::begin(feasible_successors),
+                                  std::begin(feasible_successors) + neighbours,
+                                  std::end(feasible_successors));
+
+                auto &from_candidates = candidates[from_index];
+                for (std::size_t position = 0; position < neighbours; ++position) {
+                    from_candidates.push_back(feasible_successors[position].second);
+                }
+                std::sort(std::begin(from_candidates), std::end(from_candidates));
+            }
+        }
+
+        LOG(INFO) << boost::format("Pruned %1% out of %2% arcs between visits (%3$.1f%%)")
+                     % pruned_arcs
+                     % total_arcs
+                     % (total_arcs > 0 ? 100.0 * pruned_arcs / total_arcs : 0.0);
+
+        if (neighbourhood_options_.CandidateNeighbours > 0) {
+            model.AddLocalSearchFilter(model.solver()->RevAlloc(new CandidateNeighbourFilter(model, std::move(candidates))));
+        }
     }
 
     void SolverWrapper::AddCarerHandling(operations_research::RoutingModel &model) {
@@ -1071,21 +1234,10 @@ namespace rows {
 
             int64 begin_time = 0;
             int64 end_time = 0;
+            std::tie(begin_time, end_time) = GetWorkingHours(vehicle);
             if (diary_opt.is_initialized()) {
                 const auto &diary = diary_opt.get();
 
-                const auto begin_time_duration = (diary.begin_date_time() - StartHorizon());
-                const auto end_time_duration = (diary.end_date_time() - StartHorizon());
-
-                CHECK(!begin_time_duration.is_negative()) << carer.sap_number();
-                CHECK(!end_time_duration.is_negative()) << carer.sap_number();
-
-                begin_time = GetAdjustedWorkdayStart(begin_time_duration);
-                end_time = GetAdjustedWorkdayFinish(end_time_duration);
-
-                CHECK_GE(begin_time, 0) << carer.sap_number();
-                CHECK_LE(begin_time, end_time) << carer.sap_number();
-
                 const auto breaks = CreateBreakIntervals(solver_ptr, carer, diary);
                 if (!breaks.empty()) {
                     for (const auto &break_item : breaks) {
@@ -1139,6 +1291,12 @@ namespace rows {
         model.solver()->AddConstraint(model.solver()->MakeGreaterOrEqual(model.solver()->MakeSum(weighted_sum), max_dropped_visits_threshold));
     }
 
+    DroppedVisitTracker *SolverWrapper::AddDroppedVisitTracker(operations_research::RoutingModel &model) {
+        auto tracker = model.solver()->RevAlloc(new DroppedVisitTracker(model, index_manager_, problem_data_));
+        model.AddSearchMonitor(tracker);
+        return tracker;
+    }
+
     const std::vector<operations_research::RoutingNodeIndex> &SolverWrapper::GetNodes(const ScheduledVisit &visit) const {
         return GetNodes(visit.calendar_visit().get());
     }
@@ -30,13 +30,46 @@
 #include "printer.h"
 #include "failed_index_repository.h"
 #include "real_problem_data.h"
+#include "dropped_visit_tracker.h"
+#include "skill_set.h"
+#include "scenario_reduction.h"
+#include "delay_histogram.h"
 
 namespace rows {
 
+    class VisitDurationSample;
+
     class ScheduledVisit;
 
     class Solution;
 
+    // restrictions of successors in the routing model
+    struct NeighbourhoodOptions {
+        NeighbourhoodOptions();
+
+        NeighbourhoodOptions(bool prune_infeasible_arcs, std::size_t candidate_neighbours);
+
+        NeighbourhoodOptions(bool prune_infeasible_arcs, std::size_t candidate_neighbours, bool local_search_filters);
+
+        NeighbourhoodOptions(bool prune_infeasible_arcs,
+                             std::size_t candidate_neighbours,
+                             bool local_search_filters,
+                             bool continuity_of_care);
+
+        // remove successors which cannot be reached within the time window of the visit
+        bool PruneInfeasibleArcs;
+
+        // number of the nearest feasible successors considered by local search operators, unlimited if zero
+        std::size_t CandidateNeighbours;
+
+        // reject moves which break visits of multiple carers or continuity of care before the constraints propagate
+        bool LocalSearchFilters;
+
+        // limit the number of carers who visit a service user, the filter of the continuity of care
+        // is registered only if the limit is posted
+        bool ContinuityOfCare;
+    };
+
     class SolverWrapper {
     public:
 
@@ -109,6 +142,9 @@ namespace rows {
 
         int Vehicle(const rows::Carer &carer) const;
 
+        // true if the carer of the vehicle has all skills required by the visit of the node
+        bool HasSkills(int vehicle, operations_research::RoutingNodeIndex node) const;
+
         const boost::posix_time::ptime EndHorizon() const;
 
         const boost::posix_time::ptime StartHorizon() const;
@@ -141,6 +177,10 @@ namespace rows {
 
         std::vector<rows::Event> GetEffectiveBreaks(const rows::Diary &diary) const;
 
+        // adjusted begin and end of the workday of the vehicle in seconds from the start of the horizon,
+        // both are zero if the carer does not work on the scheduling day
+        std::pair<int64, int64> GetWorkingHours(int vehicle) const;
+
         boost::gregorian::date GetScheduleDate() const;
 
         boost::posix_time::time_duration GetAdjustment() const;
@@ -167,11 +207,33 @@ namespace rows {
 
         std::unordered_set<int64> FailedIndices() const { return failed_index_repository_->Indices(); }
 
+        // must be called before the model is configured
+        void SetNeighbourhoodOptions(NeighbourhoodOptions options) { neighbourhood_options_ = options; }
+
+        const NeighbourhoodOptions &neighbourhood_options() const { return neighbourhood_options_; }
+
+        // must be called before the duration sample is built
+        void SetScenarioReductionOptions(ScenarioReductionOptions options) { scenario_reduction_options_ = options; }
+
+        const ScenarioReductionOptions &scenario_reduction_options() const { return scenario_reduction_options_; }
+
+        // must be called before the delay tracker is created
+        void SetDelaySketchOptions(DelaySketchOptions options) { delay_sketch_options_ = options; }
+
+        const DelaySketchOptions &delay_sketch_options() const { return delay_sketch_options_; }
+
+        // delay trackers use the shared sample instead of querying the history, it must be built for the same problem
+        void SetDurationSample(std::shared_ptr<const VisitDurationSample> duration_sample) { duration_sample_ = std::move(duration_sample); }
+
+        const std::shared_ptr<const VisitDurationSample> &duration_sample() const { return duration_sample_; }
+
     protected:
         void AddTravelTime(operations_research::RoutingModel &model);
 
         void AddVisitsHandling(operations_research::RoutingModel &model);
 
+        void RestrictSuccessors(operations_research::RoutingModel &model);
+
         void AddCarerHandling(operations_research::RoutingModel &model);
 
         void AddDroppedVisitsHandling(operations_research::RoutingModel &model);
@@ -180,6 +242,8 @@ namespace rows {
 
         void LimitDroppedVisits(operations_research::RoutingModel &model, int64 max_dropped_visits_threshold);
 
+        DroppedVisitTracker *AddDroppedVisitTracker(operations_research::RoutingModel &model);
+
         void AddSkillHandling(operations_research::RoutingModel &model);
 
         void AddContinuityOfCare(operations_research::RoutingModel &model);
@@ -242,6 +306,15 @@ namespace rows {
         operations_research::RoutingIndexManager index_manager_;
 
         std::shared_ptr<FailedIndexRepository> failed_index_repository_;
+
+        NeighbourhoodOptions neighbourhood_options_;
+        ScenarioReductionOptions scenario_reduction_options_;
+        DelaySketchOptions delay_sketch_options_;
+        std::shared_ptr<const VisitDurationSample> duration_sample_;
+
+        // skills and tasks are interned when the solver is created, so the compatibility tests do not search vectors
+        std::vector<SkillSet> vehicle_skills_;
+        std::vector<SkillSet> node_tasks_;
     };
 }
 
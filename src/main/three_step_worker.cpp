@@ -3,6 +3,11 @@
 #include <absl/time/time.h>
 #include <ortools/base/protoutil.h>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
 #include <utility>
 
 #include "util/input.h"
@@ -15,6 +20,13 @@
 #include "delay_tracker.h"
 #include "second_step_solver_no_expected_delay.h"
 #include "declined_visit_evaluator.h"
+#include "perf_counters.h"
+#include "trace_writer.h"
+#include "memory_stats.h"
+#include "improvement_rate_search_limit.h"
+#include "solution_dumper.h"
+#include "construction_heuristic.h"
+#include "reoptimization.h"
 
 void FailureInterceptor() {
     LOG(INFO) << "Failure";
@@ -104,42 +116,56 @@ int64 GetMaxDistance(rows::SolverWrapper &solver, const std::vector<std::vector<
     return max_distance;
 }
 
+bool HasMultipleCarerVisits(const rows::Problem &problem) {
+    for (const auto &visit : problem.visits()) {
+        if (visit.carer_count() > 1) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// the construction heuristic routes all visits, other strategies route only visits of multiple carers
+bool HasFirstStage(rows::FirstStageStrategy strategy, const rows::Problem &problem) {
+    if (strategy == rows::FirstStageStrategy::CONSTRUCTION) {
+        return true;
+    }
+    return strategy != rows::FirstStageStrategy::NONE && HasMultipleCarerVisits(problem);
+}
+
+// a share of the time limit, a limit which is not set remains unlimited
+boost::posix_time::time_duration GetTimeShare(const boost::posix_time::time_duration &time_limit, double share) {
+    if (time_limit.is_special()) {
+        return time_limit;
+    }
+    return boost::posix_time::milliseconds(static_cast<int64>(static_cast<double>(time_limit.total_milliseconds()) * share));
+}
+
 void rows::ThreeStepSchedulingWorker::Run() {
-    bool has_multiple_carer_visits = false;
     for (const auto &visit : problem_data_->problem().visits()) {
         CHECK_GT(visit.duration().total_seconds(), 0);
-        if (visit.carer_count() > 1) {
-            has_multiple_carer_visits = true;
-        }
     }
+    const auto has_first_stage_strategy = HasFirstStage(first_stage_strategy_, problem_data_->problem());
 
     printer_->operator<<(TracingEvent(TracingEventType::Started, "All"));
+    TraceSpan all_stages_span{"All", "stage"};
+    const auto all_stages_counters = PerfCounters::Snapshot();
+    const auto all_stages_allocations = AllocationStats::Snapshot();
+    printer_->operator<<(MemorySummary("Start", MemoryUsage::Current(), AllocationStats{}));
+
+    // the high water mark of the resident set is reset at the start of each stage,
+    // so the peak of all stages is the maximum of the peaks observed before the resets
+    std::size_t all_stages_peak_rss = 0;
+    const auto reset_peak_rss = [&all_stages_peak_rss]() -> void {
+        all_stages_peak_rss = std::max(all_stages_peak_rss, MemoryUsage::Current().PeakRss);
+        if (!MemoryUsage::ResetPeak()) {
+            LOG_FIRST_N(WARNING, 1) << "Failed to reset the peak resident set size, stages report the process peak";
+        }
+    };
+    reset_peak_rss();
+    all_stages_peak_rss = 0;
 
-    auto second_stage_search_params = operations_research::DefaultRoutingSearchParameters();
-    second_stage_search_params.set_first_solution_strategy(operations_research::FirstSolutionStrategy_Value_PARALLEL_CHEAPEST_INSERTION);
-    second_stage_search_params.mutable_local_search_operators()->set_use_full_path_lns(operations_research::OptionalBoolean::BOOL_TRUE);
-    second_stage_search_params.mutable_local_search_operators()->set_use_path_lns(operations_research::OptionalBoolean::BOOL_TRUE);
-    CHECK_OK(util_time::EncodeGoogleApiProto(absl::Seconds(30), second_stage_search_params.mutable_lns_time_limit()));
-    second_stage_search_params.mutable_local_search_operators()->set_use_exchange_subtrip(operations_research::OptionalBoolean::BOOL_TRUE);
-    second_stage_search_params.mutable_local_search_operators()->set_use_relocate_expensive_chain(operations_research::OptionalBoolean::BOOL_TRUE);
-    second_stage_search_params.mutable_local_search_operators()->set_use_light_relocate_pair(operations_research::OptionalBoolean::BOOL_TRUE);
-    second_stage_search_params.mutable_local_search_operators()->set_use_relocate(operations_research::OptionalBoolean::BOOL_TRUE);
-    second_stage_search_params.mutable_local_search_operators()->set_use_exchange(operations_research::OptionalBoolean::BOOL_TRUE);
-    second_stage_search_params.mutable_local_search_operators()->set_use_exchange_pair(operations_research::OptionalBoolean::BOOL_TRUE);
-    second_stage_search_params.mutable_local_search_operators()->set_use_extended_swap_active(operations_research::OptionalBoolean::BOOL_TRUE);
-    second_stage_search_params.mutable_local_search_operators()->set_use_swap_active(operations_research::OptionalBoolean::BOOL_TRUE);
-    second_stage_search_params.mutable_local_search_operators()->set_use_node_pair_swap_active(operations_research::OptionalBoolean::BOOL_TRUE);
-    second_stage_search_params.mutable_local_search_operators()->set_use_local_cheapest_insertion_path_lns(
-            operations_research::OptionalBoolean::BOOL_TRUE);
-    second_stage_search_params.mutable_local_search_operators()->set_use_local_cheapest_insertion_expensive_chain_lns(
-            operations_research::OptionalBoolean::BOOL_TRUE);
-    second_stage_search_params.mutable_local_search_operators()->set_use_global_cheapest_insertion_expensive_chain_lns(
-            operations_research::OptionalBoolean::BOOL_TRUE);
-    second_stage_search_params.mutable_local_search_operators()->set_use_global_cheapest_insertion_path_lns(
-            operations_research::OptionalBoolean::BOOL_TRUE);
-    second_stage_search_params.set_use_full_propagation(true);
-//    second_stage_search_params.set_use_cp_sat(operations_research::OptionalBoolean::BOOL_TRUE);
-
+    const auto second_stage_search_params = CreateSecondStageRoutingSearchParameters();
 
     rows::SecondStepSolver second_stage_wrapper{*problem_data_,
                                                 second_stage_search_params,
@@ -155,11 +181,76 @@ void rows::ThreeStepSchedulingWorker::Run() {
         return;
     }
 
+    static const std::size_t OUTPUT_QUEUE_CAPACITY = 4;
+    output_writer_ = std::make_shared<AsyncSolutionWriter>(
+            [this](const std::string &file, const SolutionSnapshot &snapshot) -> void { WriteSnapshot(file, snapshot); },
+            OUTPUT_QUEUE_CAPACITY);
+
+    const auto has_first_stage = !reoptimization_
+                                 && (decomposition_options_.Clusters > 1
+                                     || has_first_stage_strategy);
+    std::unique_ptr<TimeBudget> time_budget;
+    if (time_budget_options_) {
+        std::vector<std::string> budget_stages;
+        if (has_first_stage) {
+            budget_stages.emplace_back("Stage1");
+        }
+        budget_stages.emplace_back("Stage2");
+        if (third_stage_strategy_ != ThirdStageStrategy::NONE) {
+            budget_stages.emplace_back("Stage3");
+        }
+        time_budget = std::make_unique<TimeBudget>(*time_budget_options_, std::move(budget_stages));
+    }
+
+    const auto begin_budget_stage = [this, &time_budget](const std::string &stage) -> void {
+        if (time_budget) {
+            stage_allocation_ = time_budget->BeginStage(stage);
+        }
+    };
+
+    const auto end_budget_stage = [this, &time_budget](const std::string &stage) -> void {
+        if (time_budget) {
+            time_budget->EndStage(stage);
+            stage_allocation_ = boost::none;
+        }
+    };
+
     std::vector<std::vector<int64>> second_step_initial_routes{static_cast<std::size_t>(second_stage_wrapper.vehicles())};
-    if (first_stage_strategy_ != FirstStageStrategy::NONE && has_multiple_carer_visits) {
+    auto second_stage_time_limit = opt_time_limit_;
+    if (reoptimization_) {
+        LOG(INFO) << "Reoptimizing the previous solution from " << reoptimization_->CurrentTime;
+
+        TraceSpan reoptimization_span{"Reoptimization", "model"};
+        second_step_initial_routes = GetPreviousRoutes(second_stage_wrapper);
+    } else if (decomposition_options_.Clusters > 1) {
+        LOG(INFO) << "Solving the first stage by decomposition into " << decomposition_options_.Clusters << " clusters";
+
+        const auto decomposition_counters = PerfCounters::Snapshot();
+        const auto decomposition_allocations = AllocationStats::Snapshot();
+        reset_peak_rss();
+        begin_budget_stage("Stage1");
+        {
+            TraceSpan decomposition_span{"Decomposition", "stage"};
+            second_step_initial_routes = SolveClusters(second_stage_wrapper);
+        }
+        end_budget_stage("Stage1");
+
+        // clusters used their share of the time limit, so the second stage is left with the remaining time
+        second_stage_time_limit = GetTimeShare(opt_time_limit_, 1.0 - decomposition_options_.TimeShare);
+        PrintStageSummary("Decomposition", decomposition_counters, decomposition_allocations);
+    } else if (has_first_stage_strategy) {
         LOG(INFO) << "Solving the first stage using " << GetAlias(first_stage_strategy_) << " strategy";
 
-        second_step_initial_routes = SolveFirstStage(second_stage_wrapper);
+        const auto first_stage_counters = PerfCounters::Snapshot();
+        const auto first_stage_allocations = AllocationStats::Snapshot();
+        reset_peak_rss();
+        begin_budget_stage("Stage1");
+        {
+            TraceSpan first_stage_span{"Stage1", "stage"};
+            second_step_initial_routes = SolveFirstStage(second_stage_wrapper);
+        }
+        end_budget_stage("Stage1");
+        PrintStageSummary("Stage1", first_stage_counters, first_stage_allocations);
 
         auto all_routes_empty = true;
         for (const auto &route: second_step_initial_routes) {
@@ -172,13 +263,71 @@ void rows::ThreeStepSchedulingWorker::Run() {
         LOG_IF(WARNING, all_routes_empty) << "First stage did not produce any routes";
     }
 
+    if ((third_stage_strategy_ == ThirdStageStrategy::DELAY_RISKINESS_REDUCTION
+         || third_stage_strategy_ == ThirdStageStrategy::DELAY_PROBABILITY_REDUCTION)
+        && history_ && !history_->empty()) {
+        const auto sample_counters = PerfCounters::Snapshot();
+        const auto sample_allocations = AllocationStats::Snapshot();
+        reset_peak_rss();
+        const auto sample_start = std::chrono::steady_clock::now();
+        {
+            TraceSpan duration_sample_span{"DurationSample", "model"};
+            duration_sample_ = std::make_shared<const VisitDurationSample>(problem_data_->problem(),
+                                                                           *history_,
+                                                                           scenario_reduction_options_);
+        }
+        const auto sample_time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - sample_start);
+        LOG(INFO) << boost::format("Built the sample of %1% visits in %2% scenarios in %3% ms, it takes %4% KB")
+                     % duration_sample_->num_visits()
+                     % duration_sample_->size()
+                     % sample_time.count()
+                     % (duration_sample_->memory_usage() / 1024);
+        PrintStageSummary("DurationSample", sample_counters, sample_allocations);
+    }
+
 //    second_stage_model->solver()->set_fail_intercept(&FailureInterceptor);
-    const auto routes = SolveSecondStage(second_step_initial_routes, second_stage_wrapper.index_manager(), second_stage_search_params);
+    const auto second_stage_counters = PerfCounters::Snapshot();
+    const auto second_stage_allocations = AllocationStats::Snapshot();
+    reset_peak_rss();
+    std::vector<std::vector<int64> > routes;
+    begin_budget_stage("Stage2");
+    {
+        TraceSpan second_stage_span{"Stage2", "stage"};
+        routes = SolveSecondStage(second_step_initial_routes,
+                                  second_stage_wrapper.index_manager(),
+                                  second_stage_search_params,
+                                  second_stage_time_limit);
+    }
+    end_budget_stage("Stage2");
+    PrintStageSummary("Stage2", second_stage_counters, second_stage_allocations);
+
     if (third_stage_strategy_ != ThirdStageStrategy::NONE) {
         LOG(INFO) << "Solving the third stage using " << GetAlias(third_stage_strategy_) << " strategy";
-        SolveThirdStage(routes, second_stage_wrapper.index_manager());
+        const auto third_stage_counters = PerfCounters::Snapshot();
+        const auto third_stage_allocations = AllocationStats::Snapshot();
+        reset_peak_rss();
+        begin_budget_stage("Stage3");
+        {
+            TraceSpan third_stage_span{"Stage3", "stage"};
+            SolveThirdStage(routes, second_stage_wrapper.index_manager());
+        }
+        end_budget_stage("Stage3");
+        PrintStageSummary("Stage3", third_stage_counters, third_stage_allocations);
     }
 
+    {
+        TraceSpan flush_span{"FlushOutput", "output"};
+        output_writer_->Flush();
+    }
+    LOG(INFO) << boost::format("Output writer saved %1% of %2% solutions, %3% were replaced by later solutions before they were saved")
+                 % output_writer_->written()
+                 % output_writer_->submitted()
+                 % output_writer_->coalesced();
+    output_writer_.reset();
+
+    auto all_stages_memory_usage = MemoryUsage::Current();
+    all_stages_memory_usage.PeakRss = std::max(all_stages_memory_usage.PeakRss, all_stages_peak_rss);
+    PrintStageSummary("All", all_stages_counters, all_stages_allocations, all_stages_memory_usage);
     printer_->operator<<(TracingEvent(TracingEventType::Finished, "All"));
     SetReturnCode(0);
 }
@@ -197,7 +346,8 @@ rows::ThreeStepSchedulingWorker::ThreeStepSchedulingWorker(std::shared_ptr<rows:
           opt_time_limit_{boost::posix_time::not_a_date_time},
           post_opt_time_limit_{boost::posix_time::not_a_date_time},
           cost_normalization_factor_{1.0},
-          data_factory_{std::move(data_factory)} {}
+          data_factory_{std::move(data_factory)},
+          intermediate_solutions_{false} {}
 
 std::vector<rows::ThreeStepSchedulingWorker::CarerTeam> rows::ThreeStepSchedulingWorker::GetCarerTeams(const rows::Problem &problem) {
     std::vector<std::pair<rows::Carer, rows::Diary>> carer_diaries;
@@ -286,6 +436,81 @@ bool rows::ThreeStepSchedulingWorker::Init(std::shared_ptr<const ProblemData> pr
     return true;
 }
 
+void rows::ThreeStepSchedulingWorker::EnableDeterministicSearch(DeterministicSearchOptions options) {
+    pre_opt_time_limit_ = boost::posix_time::not_a_date_time;
+    opt_time_limit_ = boost::posix_time::not_a_date_time;
+    post_opt_time_limit_ = boost::posix_time::not_a_date_time;
+    time_limit_ = boost::none;
+    deterministic_search_ = std::move(options);
+}
+
+void rows::ThreeStepSchedulingWorker::SetNeighbourhoodOptions(NeighbourhoodOptions options) {
+    neighbourhood_options_ = options;
+}
+
+void rows::ThreeStepSchedulingWorker::SetDecompositionOptions(DecompositionOptions options) {
+    CHECK_GT(options.TimeShare, 0.0);
+    CHECK_LT(options.TimeShare, 1.0);
+    decomposition_options_ = options;
+}
+
+void rows::ThreeStepSchedulingWorker::SetScenarioReductionOptions(ScenarioReductionOptions options) {
+    scenario_reduction_options_ = options;
+}
+
+void rows::ThreeStepSchedulingWorker::SetDelaySketchOptions(DelaySketchOptions options) {
+    delay_sketch_options_ = options;
+}
+
+void rows::ThreeStepSchedulingWorker::EnableReoptimization(ReoptimizationOptions options) {
+    if (third_stage_strategy_ != ThirdStageStrategy::NONE) {
+        throw util::ApplicationError((boost::format("The third stage is not used in the reoptimization, but the %1% strategy is set")
+                                      % third_stage_strategy_).str(),
+                                     util::ErrorCode::ERROR);
+    }
+    reoptimization_ = std::move(options);
+}
+
+void rows::ThreeStepSchedulingWorker::EnableTimeBudget(TimeBudgetOptions options) {
+    time_budget_options_ = std::move(options);
+}
+
+void rows::ThreeStepSchedulingWorker::EnableIntermediateSolutions() {
+    intermediate_solutions_ = true;
+}
+
+void rows::ThreeStepSchedulingWorker::ConfigureSolver(SolverWrapper &solver) const {
+    solver.SetNeighbourhoodOptions(neighbourhood_options_);
+    solver.SetScenarioReductionOptions(scenario_reduction_options_);
+    solver.SetDelaySketchOptions(delay_sketch_options_);
+    if (duration_sample_ && &solver.problem_data() == problem_data_.get()) {
+        solver.SetDurationSample(duration_sample_);
+    }
+}
+
+void rows::ThreeStepSchedulingWorker::ConfigureSearch(operations_research::RoutingModel &model) const {
+    if (deterministic_search_) {
+        ConfigureDeterministicSearch(model, *deterministic_search_);
+    }
+
+    if (stage_allocation_) {
+        DCHECK(time_budget_options_);
+
+        auto solver = model.solver();
+        model.AddSearchMonitor(solver->RevAlloc(new ImprovementRateSearchLimit(*stage_allocation_,
+                                                                               time_budget_options_->Window.total_milliseconds(),
+                                                                               time_budget_options_->MinImprovement,
+                                                                               &model,
+                                                                               solver)));
+    }
+}
+
+void rows::ThreeStepSchedulingWorker::ConfigureSearch(operations_research::RoutingSearchParameters &parameters) const {
+    if (deterministic_search_) {
+        ClearTimeLimits(parameters);
+    }
+}
+
 std::unique_ptr<rows::MetaheuristicSolver> rows::ThreeStepSchedulingWorker::CreateThirdStageSolver(
         const operations_research::RoutingSearchParameters &search_params,
         int64 max_dropped_visit_threshold) {
@@ -329,6 +554,35 @@ std::unique_ptr<rows::MetaheuristicSolver> rows::ThreeStepSchedulingWorker::Crea
     }
 }
 
+operations_research::RoutingSearchParameters rows::ThreeStepSchedulingWorker::CreateSecondStageRoutingSearchParameters() const {
+    auto second_stage_search_params = operations_research::DefaultRoutingSearchParameters();
+    second_stage_search_params.set_first_solution_strategy(operations_research::FirstSolutionStrategy_Value_PARALLEL_CHEAPEST_INSERTION);
+    second_stage_search_params.mutable_local_search_operators()->set_use_full_path_lns(operations_research::OptionalBoolean::BOOL_TRUE);
+    second_stage_search_params.mutable_local_search_operators()->set_use_path_lns(operations_research::OptionalBoolean::BOOL_TRUE);
+    CHECK_OK(util_time::EncodeGoogleApiProto(absl::Seconds(30), second_stage_search_params.mutable_lns_time_limit()));
+    second_stage_search_params.mutable_local_search_operators()->set_use_exchange_subtrip(operations_research::OptionalBoolean::BOOL_TRUE);
+    second_stage_search_params.mutable_local_search_operators()->set_use_relocate_expensive_chain(operations_research::OptionalBoolean::BOOL_TRUE);
+    second_stage_search_params.mutable_local_search_operators()->set_use_light_relocate_pair(operations_research::OptionalBoolean::BOOL_TRUE);
+    second_stage_search_params.mutable_local_search_operators()->set_use_relocate(operations_research::OptionalBoolean::BOOL_TRUE);
+    second_stage_search_params.mutable_local_search_operators()->set_use_exchange(operations_research::OptionalBoolean::BOOL_TRUE);
+    second_stage_search_params.mutable_local_search_operators()->set_use_exchange_pair(operations_research::OptionalBoolean::BOOL_TRUE);
+    second_stage_search_params.mutable_local_search_operators()->set_use_extended_swap_active(operations_research::OptionalBoolean::BOOL_TRUE);
+    second_stage_search_params.mutable_local_search_operators()->set_use_swap_active(operations_research::OptionalBoolean::BOOL_TRUE);
+    second_stage_search_params.mutable_local_search_operators()->set_use_node_pair_swap_active(operations_research::OptionalBoolean::BOOL_TRUE);
+    second_stage_search_params.mutable_local_search_operators()->set_use_local_cheapest_insertion_path_lns(
+            operations_research::OptionalBoolean::BOOL_TRUE);
+    second_stage_search_params.mutable_local_search_operators()->set_use_local_cheapest_insertion_expensive_chain_lns(
+            operations_research::OptionalBoolean::BOOL_TRUE);
+    second_stage_search_params.mutable_local_search_operators()->set_use_global_cheapest_insertion_expensive_chain_lns(
+            operations_research::OptionalBoolean::BOOL_TRUE);
+    second_stage_search_params.mutable_local_search_operators()->set_use_global_cheapest_insertion_path_lns(
+            operations_research::OptionalBoolean::BOOL_TRUE);
+    second_stage_search_params.set_use_full_propagation(true);
+//    second_stage_search_params.set_use_cp_sat(operations_research::OptionalBoolean::BOOL_TRUE);
+    ConfigureSearch(second_stage_search_params);
+    return second_stage_search_params;
+}
+
 operations_research::RoutingSearchParameters rows::ThreeStepSchedulingWorker::CreateThirdStageRoutingSearchParameters() {
     operations_research::RoutingSearchParameters parameters = operations_research::DefaultRoutingSearchParameters();
     parameters.set_first_solution_strategy(operations_research::FirstSolutionStrategy::PARALLEL_CHEAPEST_INSERTION);
@@ -372,6 +626,7 @@ operations_research::RoutingSearchParameters rows::ThreeStepSchedulingWorker::Cr
     if (time_limit_) {
         CHECK_OK(util_time::EncodeGoogleApiProto(absl::Seconds(time_limit_->total_seconds()), parameters.mutable_time_limit()));
     }
+    ConfigureSearch(parameters);
 
     return parameters;
 }
@@ -410,6 +665,7 @@ std::vector<std::vector<int64>> rows::ThreeStepSchedulingWorker::SolveFirstStage
         auto search_params = operations_research::DefaultRoutingSearchParameters();
         search_params.set_first_solution_strategy(operations_research::FirstSolutionStrategy_Value_PARALLEL_CHEAPEST_INSERTION);
         search_params.use_cp();
+        ConfigureSearch(search_params);
 
         rows::Problem sub_problem{team_visits, team_carers, problem_data_->problem().service_users()};
         const auto sub_problem_data = data_factory_->makeProblem(sub_problem);
@@ -421,11 +677,16 @@ std::vector<std::vector<int64>> rows::ThreeStepSchedulingWorker::SolveFirstStage
                                                    boost::posix_time::not_a_date_time,
                                                    pre_opt_time_limit_};
         operations_research::RoutingModel first_step_model{first_stage_wrapper.index_manager()};
+        ConfigureSolver(first_stage_wrapper);
         first_stage_wrapper.ConfigureModel(first_step_model, printer_, CancelToken(), cost_normalization_factor_);
+        ConfigureSearch(first_step_model);
 
         printer_->operator<<(TracingEvent(TracingEventType::Started, "Stage1"));
 //        first_step_model->solver()->set_fail_intercept(&FailureInterceptor);
-        first_step_assignment = first_step_model.SolveWithParameters(search_params);
+        {
+            TraceSpan search_span{"Search", "search"};
+            first_step_assignment = first_step_model.SolveWithParameters(search_params);
+        }
         printer_->operator<<(TracingEvent(TracingEventType::Finished, "Stage1"));
 
         if (first_step_assignment == nullptr) {
@@ -498,6 +759,7 @@ std::vector<std::vector<int64>> rows::ThreeStepSchedulingWorker::SolveFirstStage
         internal_search_params.mutable_local_search_operators()->set_use_cross_exchange(operations_research::BOOL_TRUE);
         internal_search_params.mutable_local_search_operators()->set_use_relocate_neighbors(operations_research::BOOL_TRUE);
         internal_search_params.set_local_search_metaheuristic(operations_research::LocalSearchMetaheuristic_Value_TABU_SEARCH);
+        ConfigureSearch(internal_search_params);
 
         std::vector<rows::CalendarVisit> team_visits;
         for (const auto &visit: problem_data_->problem().visits()) {
@@ -516,8 +778,14 @@ std::vector<std::vector<int64>> rows::ThreeStepSchedulingWorker::SolveFirstStage
                                                    begin_end_shift_time_extension_,
                                                    pre_opt_time_limit_};
         operations_research::RoutingModel multi_carer_model{multi_carer_wrapper.index_manager()};
+        ConfigureSolver(multi_carer_wrapper);
         multi_carer_wrapper.ConfigureModel(multi_carer_model, printer_, CancelToken(), cost_normalization_factor_);
-        auto result = multi_carer_model.SolveWithParameters(internal_search_params);
+        ConfigureSearch(multi_carer_model);
+        const operations_research::Assignment *result = nullptr;
+        {
+            TraceSpan search_span{"Search", "search"};
+            result = multi_carer_model.SolveWithParameters(internal_search_params);
+        }
         operations_research::Assignment const *multi_carer_assignment = multi_carer_wrapper.GetBestSolution();
         if (multi_carer_assignment == nullptr) {
             multi_carer_assignment = result;
@@ -564,11 +832,196 @@ std::vector<std::vector<int64>> rows::ThreeStepSchedulingWorker::SolveFirstStage
 
             ++route_number;
         }
+    } else if (first_stage_strategy_ == FirstStageStrategy::CONSTRUCTION) {
+        rows::ConstructionHeuristic heuristic{second_step_wrapper};
+
+        const auto construction_start = std::chrono::steady_clock::now();
+        {
+            TraceSpan construction_span{"Construction", "search"};
+            second_step_routes = heuristic.Solve();
+        }
+        const auto construction_time = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - construction_start);
+
+        LOG(INFO) << boost::format("Construction heuristic inserted %1% visits and declined %2% visits in %3% ms, travel time: %4%")
+                     % heuristic.inserted_visits()
+                     % heuristic.declined_visits()
+                     % construction_time.count()
+                     % boost::posix_time::seconds(heuristic.travel_time());
     }
 
     return second_step_routes;
 }
 
+std::vector<std::vector<int64> > rows::ThreeStepSchedulingWorker::GetPreviousRoutes(const rows::SolverWrapper &second_stage_wrapper) {
+    auto previous_routes = rows::GetPreviousRoutes(*reoptimization_, second_stage_wrapper);
+    frozen_routes_ = std::move(previous_routes.ExecutedRoutes);
+
+    LOG(INFO) << boost::format("Previous solution restored: %1% visits started before %2% are fixed, %3% visits are no longer scheduled")
+                 % previous_routes.ExecutedVisits
+                 % reoptimization_->CurrentTime
+                 % previous_routes.RemovedVisits;
+    return previous_routes.Routes;
+}
+
+std::vector<std::vector<int64> > rows::ThreeStepSchedulingWorker::FreezeExecutedRoutes(operations_research::RoutingModel &model,
+                                                                                       const std::vector<std::vector<int64> > &routes) const {
+    if (!reoptimization_) {
+        return routes;
+    }
+
+    return rows::FreezeExecutedRoutes(model, *problem_data_, frozen_routes_, reoptimization_->CurrentTime, routes);
+}
+
+std::vector<std::vector<int64> > rows::ThreeStepSchedulingWorker::SolveClusters(const rows::SolverWrapper &second_stage_wrapper) {
+    printer_->operator<<(TracingEvent(TracingEventType::Started, "Decomposition"));
+
+    const GeographicDecomposition decomposition{decomposition_options_};
+    std::vector<rows::Problem> sub_problems;
+    {
+        TraceSpan decompose_span{"Decompose", "model"};
+        sub_problems = decomposition.Decompose(*problem_data_);
+    }
+
+    // problem data is created sequentially, because the factory may load the map
+    std::vector<std::shared_ptr<const ProblemData> > cluster_problem_data;
+    for (auto &sub_problem : sub_problems) {
+        if (sub_problem.visits().empty()) {
+            continue;
+        }
+
+        if (sub_problem.carers().empty()) {
+            LOG(WARNING) << boost::format("No carers assigned to the cluster of %1% visits, the visits are left to the second stage")
+                            % sub_problem.visits().size();
+            continue;
+        }
+
+        cluster_problem_data.emplace_back(data_factory_->makeProblem(std::move(sub_problem)));
+    }
+
+    const auto cluster_data_factory = std::make_shared<rows::SynchronizedProblemDataFactory>(data_factory_);
+    std::vector<std::vector<CarerRoute> > cluster_routes(cluster_problem_data.size());
+    std::atomic<std::size_t> next_cluster{0};
+    const auto solve_clusters = [this, &cluster_problem_data, &cluster_data_factory, &cluster_routes, &next_cluster]() -> void {
+        for (auto cluster = next_cluster++; cluster < cluster_problem_data.size(); cluster = next_cluster++) {
+            try {
+                cluster_routes[cluster] = SolveCluster(cluster_problem_data[cluster], cluster_data_factory);
+            } catch (const util::ApplicationError &ex) {
+                LOG(WARNING) << boost::format("Failed to solve the cluster %1%: %2%") % cluster % ex.what();
+            }
+        }
+    };
+
+    const auto num_threads = std::max(std::min(decomposition_options_.Threads, cluster_problem_data.size()), static_cast<std::size_t>(1));
+    LOG(INFO) << boost::format("Solving %1% clusters using %2% threads") % cluster_problem_data.size() % num_threads;
+    {
+        std::vector<std::thread> threads;
+        for (std::size_t thread_index = 1; thread_index < num_threads; ++thread_index) {
+            threads.emplace_back(solve_clusters);
+        }
+        solve_clusters();
+        for (auto &thread : threads) {
+            thread.join();
+        }
+    }
+
+    const auto routes = RepairRoutes(MergeClusterRoutes(cluster_routes, second_stage_wrapper), second_stage_wrapper);
+    printer_->operator<<(TracingEvent(TracingEventType::Finished, "Decomposition"));
+    return routes;
+}
+
+std::vector<rows::ThreeStepSchedulingWorker::CarerRoute>
+rows::ThreeStepSchedulingWorker::SolveCluster(std::shared_ptr<const ProblemData> cluster_problem_data,
+                                              std::shared_ptr<ProblemDataFactory> cluster_data_factory) const {
+    TraceSpan cluster_span{"Cluster", "search"};
+
+    // printers are not thread safe, so clusters solved at the same time report their progress to the log
+    const auto cluster_time_limit = GetTimeShare(opt_time_limit_, decomposition_options_.TimeShare);
+    ThreeStepSchedulingWorker cluster_worker{std::make_shared<rows::LogPrinter>(),
+                                             first_stage_strategy_,
+                                             ThirdStageStrategy::NONE,
+                                             std::move(cluster_data_factory)};
+    cluster_worker.Init(std::move(cluster_problem_data),
+                        history_,
+                        output_file_,
+                        visit_time_window_,
+                        break_time_window_,
+                        begin_end_shift_time_extension_,
+                        pre_opt_time_limit_,
+                        cluster_time_limit,
+                        post_opt_time_limit_,
+                        time_limit_,
+                        cost_normalization_factor_);
+    cluster_worker.deterministic_search_ = deterministic_search_;
+    cluster_worker.neighbourhood_options_ = neighbourhood_options_;
+    cluster_worker.scenario_reduction_options_ = scenario_reduction_options_;
+    cluster_worker.delay_sketch_options_ = delay_sketch_options_;
+    cluster_worker.time_budget_options_ = time_budget_options_;
+    cluster_worker.stage_allocation_ = stage_allocation_;
+
+    const auto search_params = cluster_worker.CreateSecondStageRoutingSearchParameters();
+    rows::SecondStepSolver cluster_wrapper{*cluster_worker.problem_data_,
+                                           search_params,
+                                           visit_time_window_,
+                                           break_time_window_,
+                                           begin_end_shift_time_extension_,
+                                           cluster_time_limit};
+
+    std::vector<std::vector<int64> > initial_routes{static_cast<std::size_t>(cluster_wrapper.vehicles())};
+    if (HasFirstStage(first_stage_strategy_, cluster_worker.problem_data_->problem())) {
+        initial_routes = cluster_worker.SolveFirstStage(cluster_wrapper);
+    }
+
+    operations_research::RoutingModel cluster_model{cluster_wrapper.index_manager()};
+    cluster_worker.ConfigureSolver(cluster_wrapper);
+    cluster_wrapper.ConfigureModel(cluster_model, cluster_worker.printer_, CancelToken(), cost_normalization_factor_);
+    cluster_worker.ConfigureSearch(cluster_model);
+
+    const auto initial_assignment = cluster_model.ReadAssignmentFromRoutes(initial_routes, true);
+    const auto cluster_assignment = cluster_model.SolveFromAssignmentWithParameters(initial_assignment, search_params);
+    if (cluster_assignment == nullptr) {
+        throw util::ApplicationError("No cluster solution found.", util::ErrorCode::ERROR);
+    }
+
+    std::vector<std::vector<int64> > routes;
+    cluster_model.AssignmentToRoutes(*cluster_assignment, &routes);
+
+    std::vector<CarerRoute> carer_routes;
+    for (int vehicle = 0; vehicle < static_cast<int>(routes.size()); ++vehicle) {
+        CarerRoute carer_route{cluster_wrapper.Carer(vehicle), {}};
+        for (const auto index : routes[vehicle]) {
+            carer_route.second.push_back(cluster_wrapper.NodeToVisit(cluster_wrapper.index_manager().IndexToNode(index)));
+        }
+        carer_routes.emplace_back(std::move(carer_route));
+    }
+    return carer_routes;
+}
+
+std::vector<std::vector<int64> > rows::ThreeStepSchedulingWorker::RepairRoutes(const std::vector<std::vector<int64> > &routes,
+                                                                               const rows::SolverWrapper &second_stage_wrapper) {
+    TraceSpan repair_span{"Repair", "model"};
+
+    rows::SecondStepSolver repair_wrapper{*problem_data_,
+                                          operations_research::DefaultRoutingSearchParameters(),
+                                          visit_time_window_,
+                                          break_time_window_,
+                                          begin_end_shift_time_extension_,
+                                          boost::date_time::not_a_date_time};
+    operations_research::RoutingModel repair_model{second_stage_wrapper.index_manager()};
+    ConfigureSolver(repair_wrapper);
+    repair_wrapper.ConfigureModel(repair_model, printer_, CancelToken(), cost_normalization_factor_);
+
+    const auto repaired_routes = RepairClusterRoutes(routes, repair_model, repair_wrapper);
+    const auto assignment = repair_model.ReadAssignmentFromRoutes(repaired_routes, true);
+    CHECK(assignment != nullptr);
+
+    printer_->operator<<(SolutionSummary("Decomposition",
+                                         static_cast<double>(assignment->ObjectiveValue()),
+                                         util::GetDroppedVisitCount(repair_model, *assignment),
+                                         0));
+    return repaired_routes;
+}
+
 int64 GetEssentialRiskiness(std::vector<int64> delays) {
     std::sort(std::begin(delays), std::end(delays));
 
@@ -791,7 +1244,8 @@ private:
 std::vector<std::vector<int64> > rows::ThreeStepSchedulingWorker::SolveSecondStage(
         const std::vector<std::vector<int64>> &second_stage_initial_routes,
         const operations_research::RoutingIndexManager &index_manager,
-        const operations_research::RoutingSearchParameters &search_params) {
+        const operations_research::RoutingSearchParameters &search_params,
+        const boost::posix_time::time_duration &no_progress_time_limit) {
     static const auto LOAD_DEBUG_FILES = false;
     static const auto SOLUTION_EXTENSION = ".bin";
 
@@ -802,7 +1256,7 @@ std::vector<std::vector<int64> > rows::ThreeStepSchedulingWorker::SolveSecondSta
                                                 visit_time_window_,
                                                 break_time_window_,
                                                 begin_end_shift_time_extension_,
-                                                opt_time_limit_};
+                                                no_progress_time_limit};
     const auto scheduling_day = second_stage_wrapper.GetScheduleDate();
 
     std::stringstream second_stage_solution_name;
@@ -816,7 +1270,16 @@ std::vector<std::vector<int64> > rows::ThreeStepSchedulingWorker::SolveSecondSta
 
     std::unique_ptr<operations_research::RoutingModel> second_stage_model = std::make_unique<operations_research::RoutingModel>(index_manager);
 //    second_stage_model->solver()->set_fail_intercept(&FailureInterceptor);
+    ConfigureSolver(second_stage_wrapper);
     second_stage_wrapper.ConfigureModel(*second_stage_model, printer_, CancelToken(), cost_normalization_factor_);
+    const auto initial_routes = FreezeExecutedRoutes(*second_stage_model, second_stage_initial_routes);
+    ConfigureSearch(*second_stage_model);
+    if (intermediate_solutions_) {
+        const boost::filesystem::path output_path{output_file_};
+        const auto file_name_pattern = (boost::format("intermediate_%%1%%_%1%") % output_path.filename().string()).str();
+        second_stage_model->AddSearchMonitor(second_stage_model->solver()->RevAlloc(
+                new SolutionDumper(output_path.parent_path(), file_name_pattern, *second_stage_model, output_writer_)));
+    }
 
 //    for (auto index = 0; index < second_stage_solver.index_manager().num_indices(); ++index) {
 //        const auto routing_node = second_stage_solver.index_manager().IndexToNode(index);
@@ -838,8 +1301,10 @@ std::vector<std::vector<int64> > rows::ThreeStepSchedulingWorker::SolveSecondSta
                                                                         visit_time_window_,
                                                                         break_time_window_,
                                                                         begin_end_shift_time_extension_,
-                                                                        opt_time_limit_};
+                                                                        no_progress_time_limit};
+    ConfigureSolver(filtered_second_stage_wrapper);
     filtered_second_stage_wrapper.ConfigureModel(filtered_second_stage_model, printer_, CancelToken(), cost_normalization_factor_);
+    ConfigureSearch(filtered_second_stage_model);
 
     if (LOAD_DEBUG_FILES && boost::filesystem::is_regular_file(final_assignment_save_copy)) {
         filtered_assignment = filtered_second_stage_model.ReadAssignment(final_assignment_save_copy);
@@ -862,9 +1327,13 @@ std::vector<std::vector<int64> > rows::ThreeStepSchedulingWorker::SolveSecondSta
         penalty_msg << "MissedVisitPenalty: " << second_stage_wrapper.GetDroppedVisitPenalty();
         printer_->operator<<(TracingEvent(TracingEventType::Unknown, penalty_msg.str()));
 
-        const auto second_stage_initial_assignment = second_stage_model->ReadAssignmentFromRoutes(second_stage_initial_routes, true);
+        const auto second_stage_initial_assignment = second_stage_model->ReadAssignmentFromRoutes(initial_routes, true);
+        LOG_IF(WARNING, second_stage_initial_assignment == nullptr) << "Initial routes of the second stage are not feasible";
         printer_->operator<<(TracingEvent(TracingEventType::Started, "Stage2"));
-        second_stage_assignment = second_stage_model->SolveFromAssignmentWithParameters(second_stage_initial_assignment, search_params);
+        {
+            TraceSpan search_span{"Search", "search"};
+            second_stage_assignment = second_stage_model->SolveFromAssignmentWithParameters(second_stage_initial_assignment, search_params);
+        }
         printer_->operator<<(TracingEvent(TracingEventType::Finished, "Stage2"));
 
         if (second_stage_assignment == nullptr) {
@@ -877,23 +1346,28 @@ std::vector<std::vector<int64> > rows::ThreeStepSchedulingWorker::SolveSecondSta
             LOG(INFO) << "Second stage assignment written to file: " << assignment_save_copy;
         }
 
+        std::size_t invalid_routes = 0;
         for (int vehicle = 0; vehicle < second_stage_model->vehicles(); ++vehicle) {
             const auto validation_result = solution_validator_.ValidateFull(vehicle,
                                                                             *second_stage_assignment,
                                                                             *second_stage_model,
                                                                             second_stage_wrapper);
-            CHECK(validation_result.error() == nullptr);
+            if (validation_result.error() != nullptr) {
+                ++invalid_routes;
+            }
         }
+        printer_->operator<<(SolutionSummary("Stage2",
+                                             static_cast<double>(second_stage_assignment->ObjectiveValue()),
+                                             util::GetDroppedVisitCount(*second_stage_model, *second_stage_assignment),
+                                             invalid_routes));
+        CHECK_EQ(invalid_routes, 0);
 
         boost::filesystem::path output_path{output_file_};
         std::string second_stage_output_file{"second_stage_"};
         second_stage_output_file += output_path.filename().string();
         boost::filesystem::path second_stage_output = boost::filesystem::absolute(second_stage_output_file, output_path.parent_path());
 
-        solution_writer_.Write(second_stage_output,
-                               second_stage_wrapper,
-                               *second_stage_model,
-                               *second_stage_assignment);
+        output_writer_->Submit(second_stage_output.string(), TakeSolutionSnapshot(*second_stage_model, *second_stage_assignment));
     }
 
     if (third_stage_strategy_ != ThirdStageStrategy::DELAY_RISKINESS_REDUCTION
@@ -932,8 +1406,11 @@ std::vector<std::vector<int64> > rows::ThreeStepSchedulingWorker::SolveSecondSta
     }
 
     printer_->operator<<(TracingEvent(TracingEventType::Started, "Stage2-Patch"));
-    auto valid_second_stage_assignment
-            = filtered_second_stage_model.SolveFromAssignmentWithParameters(filtered_assignment, search_params);
+    const operations_research::Assignment *valid_second_stage_assignment = nullptr;
+    {
+        TraceSpan search_span{"Stage2-Patch", "search"};
+        valid_second_stage_assignment = filtered_second_stage_model.SolveFromAssignmentWithParameters(filtered_assignment, search_params);
+    }
     if (valid_second_stage_assignment == nullptr) {
         throw util::ApplicationError("No second stage patched solution found.", util::ErrorCode::ERROR);
     }
@@ -950,21 +1427,81 @@ std::vector<std::vector<int64> > rows::ThreeStepSchedulingWorker::SolveSecondSta
     return routes;
 }
 
-void rows::ThreeStepSchedulingWorker::WriteSolution(const operations_research::Assignment *assignment,
+void rows::ThreeStepSchedulingWorker::PrintStageSummary(const std::string &stage,
+                                                        const PerfCounterValues &counters_at_start,
+                                                        const AllocationStats &allocations_at_start) const {
+    PrintStageSummary(stage, counters_at_start, allocations_at_start, MemoryUsage::Current());
+}
+
+void rows::ThreeStepSchedulingWorker::PrintStageSummary(const std::string &stage,
+                                                        const PerfCounterValues &counters_at_start,
+                                                        const AllocationStats &allocations_at_start,
+                                                        const MemoryUsage &memory_usage) const {
+    printer_->operator<<(PerformanceSummary(stage, PerfCounters::Snapshot() - counters_at_start));
+    printer_->operator<<(MemorySummary(stage, memory_usage, AllocationStats::Snapshot() - allocations_at_start));
+}
+
+void rows::ThreeStepSchedulingWorker::WriteSolution(const std::string &stage,
+                                                    const operations_research::Assignment *assignment,
                                                     const operations_research::RoutingModel &model,
                                                     const SolverWrapper &solver) const {
+    TraceSpan write_solution_span{"WriteSolution", "output"};
+
     operations_research::Assignment *assignment_copy = model.solver()->MakeAssignment(assignment);
     const auto is_third_solution_correct = model.solver()->CheckAssignment(assignment_copy);
     DCHECK(is_third_solution_correct);
 
+    std::size_t invalid_routes = 0;
     for (int vehicle = 0; vehicle < model.vehicles(); ++vehicle) {
         const auto validation_result = solution_validator_.ValidateFull(vehicle, *assignment, model, solver);
-        CHECK(validation_result.error() == nullptr);
+        if (validation_result.error() != nullptr) {
+            ++invalid_routes;
+        }
     }
+    printer_->operator<<(SolutionSummary(stage,
+                                         static_cast<double>(assignment->ObjectiveValue()),
+                                         util::GetDroppedVisitCount(model, *assignment),
+                                         invalid_routes));
+    CHECK_EQ(invalid_routes, 0);
 
     solution_writer_.Write(output_file_, solver, model, *assignment);
 }
 
+void rows::ThreeStepSchedulingWorker::WriteSnapshot(const std::string &file, const SolutionSnapshot &snapshot) const {
+    TraceSpan write_snapshot_span{"WriteSnapshot", "output"};
+
+    if (!output_model_) {
+        output_solver_ = std::make_unique<SecondStepSolver>(*problem_data_,
+                                                            CreateSecondStageRoutingSearchParameters(),
+                                                            visit_time_window_,
+                                                            break_time_window_,
+                                                            begin_end_shift_time_extension_,
+                                                            opt_time_limit_);
+        ConfigureSolver(*output_solver_);
+        output_model_ = std::make_unique<operations_research::RoutingModel>(output_solver_->index_manager());
+
+        // the printer of the worker is used by the search thread, so the progress of restoring solutions is only logged
+        output_solver_->ConfigureModel(*output_model_, std::make_shared<LogPrinter>(), CancelToken(), cost_normalization_factor_);
+    }
+
+    // the routes only select the model, start times and breaks are written as they were found by the search
+    const auto solution = RestoreSolutionSnapshot(*output_model_, snapshot);
+
+    std::size_t invalid_routes = 0;
+    for (int vehicle = 0; vehicle < output_model_->vehicles(); ++vehicle) {
+        const auto validation_result = solution_validator_.ValidateFull(vehicle, *solution, *output_model_, *output_solver_);
+        if (validation_result.error() != nullptr) {
+            ++invalid_routes;
+        }
+    }
+    if (invalid_routes > 0) {
+        throw util::ApplicationError((boost::format("Solution written to %1% contains %2% invalid routes") % file % invalid_routes).str(),
+                                     util::ErrorCode::ERROR);
+    }
+
+    solution_writer_.Write(file, *output_solver_, *output_model_, *solution);
+}
+
 int64 GetEssentialRiskiness(int64 num_indices, rows::DelayTracker &tracker, const operations_research::Assignment *assignment) {
     if (num_indices <= 0) { return 0; }
 
@@ -1002,7 +1539,9 @@ void rows::ThreeStepSchedulingWorker::SolveThirdStage(const std::vector<std::vec
                                                                              begin_end_shift_time_extension_,
                                                                              post_opt_time_limit_,
                                                                              1);
+        ConfigureSolver(pre_assignment_third_step_solver);
         pre_assignment_third_step_solver.ConfigureModel(pre_assignment_third_stage_model, printer_, CancelToken(), cost_normalization_factor_);
+        ConfigureSearch(pre_assignment_third_stage_model);
 
         NodeMeanDelayRemover delayed_node_remover{pre_assignment_third_step_solver, pre_assignment_third_stage_model, *history_};
         const auto filtered_routes = delayed_node_remover.RemoveDelayedNodes(second_stage_routes);
@@ -1019,7 +1558,9 @@ void rows::ThreeStepSchedulingWorker::SolveThirdStage(const std::vector<std::vec
                                                               begin_end_shift_time_extension_,
                                                               post_opt_time_limit_,
                                                               max_dropped_visit_threshold);
+        ConfigureSolver(third_step_solver);
         third_step_solver.ConfigureModel(third_stage_model, printer_, CancelToken(), cost_normalization_factor_);
+        ConfigureSearch(third_stage_model);
         operations_research::Assignment *third_stage_pre_assignment = third_stage_model.ReadAssignmentFromRoutes(filtered_routes, false);
         DCHECK(third_stage_pre_assignment != nullptr);
 
@@ -1029,11 +1570,14 @@ void rows::ThreeStepSchedulingWorker::SolveThirdStage(const std::vector<std::vec
         const auto max_pre_riskiness = GetEssentialRiskiness(third_step_solver.index_manager().num_indices(),
                                                              local_tracker,
                                                              third_stage_pre_assignment);
-        WriteSolution(third_stage_pre_assignment, third_stage_model, third_step_solver);
+        WriteSolution("Stage3-Initial", third_stage_pre_assignment, third_stage_model, third_step_solver);
 
         printer_->operator<<(TracingEvent(TracingEventType::Started, "Stage3"));
-        const operations_research::Assignment *third_stage_assignment
-                = third_stage_model.SolveFromAssignmentWithParameters(third_stage_pre_assignment, third_search_params);
+        const operations_research::Assignment *third_stage_assignment = nullptr;
+        {
+            TraceSpan search_span{"Search", "search"};
+            third_stage_assignment = third_stage_model.SolveFromAssignmentWithParameters(third_stage_pre_assignment, third_search_params);
+        }
         if (third_stage_assignment == nullptr) {
             throw util::ApplicationError("No third stage solution found.", util::ErrorCode::ERROR);
         }
@@ -1044,26 +1588,31 @@ void rows::ThreeStepSchedulingWorker::SolveThirdStage(const std::vector<std::vec
         printer_->operator<<(TracingEvent(TracingEventType::Finished, "Stage3"));
 
         if (max_pre_riskiness > max_post_riskiness) {
-            WriteSolution(third_stage_assignment, third_stage_model, third_step_solver);
+            WriteSolution("Stage3", third_stage_assignment, third_stage_model, third_step_solver);
         }
     } else {
         const auto max_dropped_visit_threshold = declined_evaluator.GetThreshold(second_stage_routes);
 
         operations_research::RoutingModel third_stage_model{index_manager};
         std::unique_ptr<MetaheuristicSolver> third_step_solver = CreateThirdStageSolver(third_search_params, max_dropped_visit_threshold);
+        ConfigureSolver(*third_step_solver);
         third_step_solver->ConfigureModel(third_stage_model, printer_, CancelToken(), cost_normalization_factor_);
+        ConfigureSearch(third_stage_model);
         operations_research::Assignment *third_stage_pre_assignment = third_stage_model.ReadAssignmentFromRoutes(second_stage_routes, true);
         DCHECK(third_stage_pre_assignment != nullptr);
 
         printer_->operator<<(TracingEvent(TracingEventType::Started, "Stage3"));
-        const operations_research::Assignment *third_stage_assignment = third_stage_model.SolveFromAssignmentWithParameters(
-                third_stage_pre_assignment, third_search_params);
+        const operations_research::Assignment *third_stage_assignment = nullptr;
+        {
+            TraceSpan search_span{"Search", "search"};
+            third_stage_assignment = third_stage_model.SolveFromAssignmentWithParameters(third_stage_pre_assignment, third_search_params);
+        }
         if (third_stage_assignment == nullptr) {
             throw util::ApplicationError("No third stage solution found.", util::ErrorCode::ERROR);
         }
 
         printer_->operator<<(TracingEvent(TracingEventType::Finished, "Stage3"));
-        WriteSolution(third_stage_assignment, third_stage_model, *third_step_solver);
+        WriteSolution("Stage3", third_stage_assignment, third_stage_model, *third_step_solver);
     }
 }
 
@@ -1076,6 +1625,7 @@ std::vector<rows::RouteValidatorBase::Metrics> rows::ThreeStepSchedulingWorker::
                                                 begin_end_shift_time_extension_,
                                                 boost::date_time::not_a_date_time};
     operations_research::RoutingModel intermediate_model{second_stage_wrapper.index_manager()};
+    ConfigureSolver(intermediate_wrapper);
     intermediate_wrapper.ConfigureModel(intermediate_model, printer_, CancelToken(), cost_normalization_factor_);
 
 // useful for debugging
@@ -1116,6 +1666,10 @@ boost::optional<rows::FirstStageStrategy> rows::ParseFirstStageStrategy(const st
         return boost::make_optional(FirstStageStrategy::SOFT_TIME_WINDOWS);
     }
 
+    if (value == "construction") {
+        return boost::make_optional(FirstStageStrategy::CONSTRUCTION);
+    }
+
     return boost::none;
 }
 
@@ -1137,6 +1691,9 @@ std::ostream &rows::operator<<(std::ostream &out, rows::FirstStageStrategy value
         case FirstStageStrategy::SOFT_TIME_WINDOWS:
             out << "SOFT_TIME_WINDOWS";
             break;
+        case FirstStageStrategy::CONSTRUCTION:
+            out << "CONSTRUCTION";
+            break;
         case FirstStageStrategy::NONE:
             out << "NONE";
             break;
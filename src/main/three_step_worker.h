@@ -24,6 +24,13 @@
 #include "gexf_writer.h"
 #include "second_step_solver_no_expected_delay.h"
 #include "metaheuristic_solver.h"
+#include "deterministic_search.h"
+#include "geographic_decomposition.h"
+#include "schedule_delta.h"
+#include "time_budget.h"
+#include "async_solution_writer.h"
+#include "scenario_reduction.h"
+#include "duration_sample.h"
 
 namespace rows {
 
@@ -31,7 +38,8 @@ namespace rows {
         DEFAULT,
         NONE,
         TEAMS,
-        SOFT_TIME_WINDOWS
+        SOFT_TIME_WINDOWS,
+        CONSTRUCTION
     };
 
     boost::optional<FirstStageStrategy> ParseFirstStageStrategy(const std::string &value);
@@ -104,24 +112,86 @@ namespace rows {
                   boost::optional<boost::posix_time::time_duration> time_limit,
                   double cost_normalization_factor);
 
+        // replaces the wall-clock limits set by Init with solution and branch count limits
+        void EnableDeterministicSearch(DeterministicSearchOptions options);
+
+        void SetNeighbourhoodOptions(NeighbourhoodOptions options);
+
+        // clusters are solved instead of the first stage and their routes are merged into the initial solution of the second stage
+        void SetDecompositionOptions(DecompositionOptions options);
+
+        // the third stage evaluates delays in a reduced set of weighted scenarios instead of all historical dates
+        void SetScenarioReductionOptions(ScenarioReductionOptions options);
+
+        // the riskiness of visits is checked against histograms of delays before the exact computation
+        void SetDelaySketchOptions(DelaySketchOptions options);
+
+        // the previous solution is used instead of the first stage, visits which started before the current time are fixed
+        // and the remaining part of routes is solved by the second stage only, the worker must not use the third stage
+        void EnableReoptimization(ReoptimizationOptions options);
+
+        // stages share the time budget and stop when their objective no longer improves, time which a stage
+        // does not use is given to later stages
+        void EnableTimeBudget(TimeBudgetOptions options);
+
+        // the best solution of the second stage is saved every time it improves by a background thread
+        void EnableIntermediateSolutions();
+
     private:
+        using CarerRoute = rows::ClusterRoute;
 
         std::unique_ptr<rows::MetaheuristicSolver> CreateThirdStageSolver(const operations_research::RoutingSearchParameters &search_params,
                                                                           int64 max_dropped_visits_threshold);
 
         std::vector<std::vector<int64>> SolveFirstStage(const rows::SolverWrapper &second_step_wrapper);
 
+        std::vector<std::vector<int64> > GetPreviousRoutes(const rows::SolverWrapper &second_stage_wrapper);
+
+        // fixes visits of routes which started before the current time, returns routes without visits which can no longer start
+        std::vector<std::vector<int64> > FreezeExecutedRoutes(operations_research::RoutingModel &model,
+                                                              const std::vector<std::vector<int64> > &routes) const;
+
+        std::vector<std::vector<int64> > SolveClusters(const rows::SolverWrapper &second_stage_wrapper);
+
+        std::vector<CarerRoute> SolveCluster(std::shared_ptr<const ProblemData> cluster_problem_data,
+                                             std::shared_ptr<ProblemDataFactory> cluster_data_factory) const;
+
+        std::vector<std::vector<int64> > RepairRoutes(const std::vector<std::vector<int64> > &routes,
+                                                      const rows::SolverWrapper &second_stage_wrapper);
+
         std::vector<std::vector<int64> > SolveSecondStage(const std::vector<std::vector<int64> > &second_stage_initial_routes,
                                                                           const operations_research::RoutingIndexManager &index_manager,
-                                                                          const operations_research::RoutingSearchParameters &search_params);
+                                                                          const operations_research::RoutingSearchParameters &search_params,
+                                                                          const boost::posix_time::time_duration &no_progress_time_limit);
 
         void SolveThirdStage(const std::vector<std::vector<int64> > &second_stage_routes,
                              const operations_research::RoutingIndexManager &index_manager);
 
-        void WriteSolution(const operations_research::Assignment *assignment,
+        void PrintStageSummary(const std::string &stage,
+                               const PerfCounterValues &counters_at_start,
+                               const AllocationStats &allocations_at_start) const;
+
+        void PrintStageSummary(const std::string &stage,
+                               const PerfCounterValues &counters_at_start,
+                               const AllocationStats &allocations_at_start,
+                               const MemoryUsage &memory_usage) const;
+
+        void ConfigureSolver(SolverWrapper &solver) const;
+
+        void ConfigureSearch(operations_research::RoutingModel &model) const;
+
+        void ConfigureSearch(operations_research::RoutingSearchParameters &parameters) const;
+
+        void WriteSolution(const std::string &stage,
+                           const operations_research::Assignment *assignment,
                            const operations_research::RoutingModel &model,
                            const SolverWrapper &solver) const;
 
+        // called by the background thread of the output writer
+        void WriteSnapshot(const std::string &file, const SolutionSnapshot &snapshot) const;
+
+        operations_research::RoutingSearchParameters CreateSecondStageRoutingSearchParameters() const;
+
         operations_research::RoutingSearchParameters CreateThirdStageRoutingSearchParameters();
 
         std::vector<CarerTeam> GetCarerTeams(const rows::Problem &problem);
@@ -138,6 +208,18 @@ namespace rows {
         boost::posix_time::time_duration opt_time_limit_;
         boost::posix_time::time_duration post_opt_time_limit_;
         boost::optional<boost::posix_time::time_duration> time_limit_;
+        boost::optional<DeterministicSearchOptions> deterministic_search_;
+        NeighbourhoodOptions neighbourhood_options_;
+        DecompositionOptions decomposition_options_;
+        ScenarioReductionOptions scenario_reduction_options_;
+        DelaySketchOptions delay_sketch_options_;
+
+        // built once if delays are evaluated and shared by solvers of the problem
+        std::shared_ptr<const VisitDurationSample> duration_sample_;
+        boost::optional<ReoptimizationOptions> reoptimization_;
+        std::vector<std::vector<int64> > frozen_routes_;
+        boost::optional<TimeBudgetOptions> time_budget_options_;
+        boost::optional<TimeAllocation> stage_allocation_;
         double cost_normalization_factor_;
 
         std::string output_file_;
@@ -151,6 +233,14 @@ namespace rows {
 
         SolutionValidator solution_validator_;
         GexfWriter solution_writer_;
+
+        // the model of the second stage which restores snapshots of routes, it is used only by the output writer
+        mutable std::unique_ptr<SecondStepSolver> output_solver_;
+        mutable std::unique_ptr<operations_research::RoutingModel> output_model_;
+
+        // declared last to stop the background thread before members which it uses are destroyed
+        bool intermediate_solutions_;
+        std::shared_ptr<AsyncSolutionWriter> output_writer_;
     };
 };
 
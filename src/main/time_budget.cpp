@@ -0,0 +1,152 @@
+#include "time_budget.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+#include <boost/format.hpp>
+
+#include <glog/logging.h>
+
+namespace rows {
+
+    TimeBudgetOptions::TimeBudgetOptions()
+            : TimeBudgetOptions(boost::posix_time::minutes(10)) {}
+
+    TimeBudgetOptions::TimeBudgetOptions(boost::posix_time::time_duration budget)
+            : Budget{std::move(budget)},
+              StageWeights{{"Stage1", 1.0},
+                           {"Stage2", 3.0},
+                           {"Stage3", 1.0}},
+              Window{boost::posix_time::seconds(30)},
+              MinImprovement{0.001},
+              MaxExtension{0.5} {}
+
+    ImprovementRate::ImprovementRate(int64 window_ms, std::size_t capacity)
+            : window_ms_{window_ms},
+              samples_{capacity} {}
+
+    void ImprovementRate::Add(int64 time_ms, double objective) {
+        if (!samples_.empty() && samples_.back().second <= objective) {
+            return;
+        }
+
+        samples_.push_back(std::make_pair(time_ms, objective));
+    }
+
+    boost::optional<double> ImprovementRate::RelativeImprovement(int64 time_ms) const {
+        if (samples_.empty()) {
+            return boost::none;
+        }
+
+        // the reference is the best objective at the beginning of the window
+        const auto window_begin = time_ms - window_ms_;
+        const auto reference_it = std::upper_bound(std::begin(samples_), std::end(samples_), window_begin,
+                                                   [](int64 value, const std::pair<int64, double> &sample) -> bool {
+                                                       return value < sample.first;
+                                                   });
+
+        const auto current_objective = samples_.back().second;
+        if (reference_it != std::begin(samples_)) {
+            const auto reference_sample = *std::prev(reference_it);
+            return (reference_sample.second - current_objective) / std::max(std::abs(reference_sample.second), 1.0);
+        }
+
+        // old samples were overwritten, so the improvement since the oldest sample is scaled to the length of the window
+        if (samples_.full()) {
+            const auto &oldest_sample = samples_.front();
+            const auto span_ms = std::max(time_ms - oldest_sample.first, static_cast<int64>(1));
+            const auto improvement = (oldest_sample.second - current_objective) / std::max(std::abs(oldest_sample.second), 1.0);
+            return improvement * static_cast<double>(window_ms_) / static_cast<double>(span_ms);
+        }
+
+        return boost::none;
+    }
+
+    bool ImprovementRate::empty() const {
+        return samples_.empty();
+    }
+
+    TimeBudget::TimeBudget(TimeBudgetOptions options, std::vector<std::string> stages)
+            : options_{std::move(options)},
+              pending_stages_{std::move(stages)},
+              start_{std::chrono::steady_clock::now()},
+              current_stage_{},
+              current_stage_begin_{},
+              current_stage_allocation_{} {}
+
+    TimeAllocation TimeBudget::BeginStage(const std::string &stage) {
+        const auto stage_it = std::find(std::begin(pending_stages_), std::end(pending_stages_), stage);
+        CHECK(stage_it != std::end(pending_stages_)) << "Stage " << stage << " is not expected to run";
+        pending_stages_.erase(stage_it);
+
+        auto total_weight = Weight(stage);
+        for (const auto &pending_stage : pending_stages_) {
+            total_weight += Weight(pending_stage);
+        }
+
+        const auto remaining = Remaining();
+        const auto remaining_ms = remaining.total_milliseconds();
+        const auto allocation_ms = total_weight > 0.0
+                                   ? static_cast<int64>(static_cast<double>(remaining_ms) * Weight(stage) / total_weight)
+                                   : remaining_ms;
+        const auto extension_ms = static_cast<int64>(static_cast<double>(remaining_ms - allocation_ms) * options_.MaxExtension);
+
+        current_stage_ = stage;
+        current_stage_begin_ = Elapsed();
+        current_stage_allocation_ = boost::posix_time::milliseconds(allocation_ms);
+
+        LOG(INFO) << boost::format("Time budget: %1% receives %2% of the remaining %3%, it can continue up to %4% while the objective improves")
+                     % stage
+                     % current_stage_allocation_
+                     % remaining
+                     % boost::posix_time::milliseconds(allocation_ms + extension_ms);
+
+        const auto now = std::chrono::steady_clock::now();
+        return {stage,
+                now + std::chrono::milliseconds(allocation_ms),
+                now + std::chrono::milliseconds(allocation_ms + extension_ms)};
+    }
+
+    void TimeBudget::EndStage(const std::string &stage) {
+        CHECK_EQ(stage, current_stage_);
+
+        const auto used = Elapsed() - current_stage_begin_;
+        const auto difference = current_stage_allocation_ - used;
+        if (difference.is_negative()) {
+            LOG(INFO) << boost::format("Time budget: %1% used %2% of %3%, it borrowed %4% from later stages")
+                         % stage
+                         % used
+                         % current_stage_allocation_
+                         % difference.invert_sign();
+        } else {
+            LOG(INFO) << boost::format("Time budget: %1% used %2% of %3%, %4% is carried forward")
+                         % stage
+                         % used
+                         % current_stage_allocation_
+                         % difference;
+        }
+        current_stage_.clear();
+    }
+
+    boost::posix_time::time_duration TimeBudget::Elapsed() const {
+        const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start_);
+        return boost::posix_time::milliseconds(elapsed.count());
+    }
+
+    boost::posix_time::time_duration TimeBudget::Remaining() const {
+        const auto remaining = options_.Budget - Elapsed();
+        if (remaining.is_negative()) {
+            return boost::posix_time::seconds(0);
+        }
+        return remaining;
+    }
+
+    double TimeBudget::Weight(const std::string &stage) const {
+        const auto weight_it = options_.StageWeights.find(stage);
+        if (weight_it == std::end(options_.StageWeights)) {
+            return 1.0;
+        }
+        return weight_it->second;
+    }
+}
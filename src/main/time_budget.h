@@ -0,0 +1,92 @@
+#ifndef ROWS_TIME_BUDGET_H
+#define ROWS_TIME_BUDGET_H
+
+#include <chrono>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <boost/circular_buffer.hpp>
+#include <boost/date_time.hpp>
+#include <boost/optional.hpp>
+
+#include <ortools/base/integral_types.h>
+
+namespace rows {
+
+    // overall wall time of the computation shared by the stages instead of fixed limits of every stage
+    struct TimeBudgetOptions {
+        TimeBudgetOptions();
+
+        explicit TimeBudgetOptions(boost::posix_time::time_duration budget);
+
+        boost::posix_time::time_duration Budget;
+
+        // share of a stage in the time which remains when the stage begins relative to other stages which did not run yet
+        std::unordered_map<std::string, double> StageWeights;
+
+        // length of the sliding window over which the improvement of the objective is measured
+        boost::posix_time::time_duration Window;
+
+        // a stage stops when the objective improves by a smaller fraction over the window
+        double MinImprovement;
+
+        // fraction of the time of later stages which a stage that still improves can use after its allocation expires
+        double MaxExtension;
+    };
+
+    // relative improvement of the best objective over a sliding window of wall time
+    class ImprovementRate {
+    public:
+        ImprovementRate(int64 window_ms, std::size_t capacity);
+
+        void Add(int64 time_ms, double objective);
+
+        // returns none until the solutions cover the whole window
+        boost::optional<double> RelativeImprovement(int64 time_ms) const;
+
+        bool empty() const;
+
+    private:
+        int64 window_ms_;
+        boost::circular_buffer<std::pair<int64, double> > samples_;
+    };
+
+    struct TimeAllocation {
+        std::string Stage;
+
+        // the stage stops when the allocation expires unless the objective still improves
+        std::chrono::steady_clock::time_point Allocated;
+
+        // the stage stops unconditionally
+        std::chrono::steady_clock::time_point Latest;
+    };
+
+    // divides the time which remains among stages which did not run yet, so time not used by a stage is carried forward
+    class TimeBudget {
+    public:
+        TimeBudget(TimeBudgetOptions options, std::vector<std::string> stages);
+
+        TimeAllocation BeginStage(const std::string &stage);
+
+        void EndStage(const std::string &stage);
+
+        boost::posix_time::time_duration Elapsed() const;
+
+        boost::posix_time::time_duration Remaining() const;
+
+    private:
+        double Weight(const std::string &stage) const;
+
+        TimeBudgetOptions options_;
+        std::vector<std::string> pending_stages_;
+        std::chrono::steady_clock::time_point start_;
+
+        std::string current_stage_;
+        boost::posix_time::time_duration current_stage_begin_;
+        boost::posix_time::time_duration current_stage_allocation_;
+    };
+}
+
+
+#endif //ROWS_TIME_BUDGET_H
@@ -0,0 +1,132 @@
+#include "trace_writer.h"
+
+#include <unistd.h>
+
+#include <boost/format.hpp>
+#include <nlohmann/json.hpp>
+
+#include "util/aplication_error.h"
+
+namespace rows {
+
+    TraceWriter &TraceWriter::Instance() {
+        static TraceWriter instance;
+        return instance;
+    }
+
+    TraceWriter::TraceWriter()
+            : is_open_{false},
+              first_event_{true},
+              start_time_{std::chrono::steady_clock::now()} {}
+
+    TraceWriter::~TraceWriter() {
+        Close();
+    }
+
+    void TraceWriter::Open(const std::string &file_path) {
+        std::lock_guard<std::mutex> lock{mutex_};
+
+        stream_.open(file_path, std::ios::out | std::ios::trunc);
+        if (!stream_.is_open()) {
+            throw util::ApplicationError((boost::format("Failed to open the file: %1%") % file_path).str(), util::ErrorCode::ERROR);
+        }
+
+        stream_ << "[";
+        first_event_ = true;
+        thread_ids_.clear();
+        GetThreadId();
+        is_open_.store(true);
+    }
+
+    void TraceWriter::Close() {
+        std::lock_guard<std::mutex> lock{mutex_};
+
+        if (!is_open_.load()) {
+            return;
+        }
+
+        is_open_.store(false);
+        stream_ << "\n]\n";
+        stream_.close();
+    }
+
+    void TraceWriter::Begin(const std::string &name, const std::string &category) {
+        WriteEvent(name, category, 'B');
+    }
+
+    void TraceWriter::End(const std::string &name, const std::string &category) {
+        WriteEvent(name, category, 'E');
+    }
+
+    void TraceWriter::WriteEvent(const std::string &name, const std::string &category, char phase) {
+        if (!IsOpen()) {
+            return;
+        }
+
+        const auto timestamp = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start_time_).count();
+
+        std::lock_guard<std::mutex> lock{mutex_};
+        if (!is_open_.load()) {
+            return;
+        }
+
+        const nlohmann::json event{
+                {"name", name},
+                {"cat",  category},
+                {"ph",   std::string(1, phase)},
+                {"ts",   timestamp},
+                {"pid",  static_cast<int>(getpid())},
+                {"tid",  GetThreadId()}
+        };
+
+        if (!first_event_) {
+            stream_ << ",";
+        }
+        first_event_ = false;
+        stream_ << "\n" << event.dump();
+        stream_.flush();
+    }
+
+    int TraceWriter::GetThreadId() {
+        const auto thread_id = std::this_thread::get_id();
+        const auto find_it = thread_ids_.find(thread_id);
+        if (find_it != std::end(thread_ids_)) {
+            return find_it->second;
+        }
+
+        const auto local_thread_id = static_cast<int>(thread_ids_.size());
+        thread_ids_.emplace(thread_id, local_thread_id);
+
+        // metadata event, so the viewer shows a readable name of the track
+        const nlohmann::json thread_name_event{
+                {"name", "thread_name"},
+                {"ph",   "M"},
+                {"pid",  static_cast<int>(getpid())},
+                {"tid",  local_thread_id},
+                {"args", {{"name", local_thread_id == 0 ? std::string("main") : "worker-" + std::to_string(local_thread_id)}}}
+        };
+
+        if (!first_event_) {
+            stream_ << ",";
+        }
+        first_event_ = false;
+        stream_ << "\n" << thread_name_event.dump();
+        return local_thread_id;
+    }
+
+    TraceSpan::TraceSpan(const char *name, const char *category)
+            : name_{name},
+              category_{category},
+              enabled_{TraceWriter::Instance().IsOpen()} {
+        if (enabled_) {
+            TraceWriter::Instance().Begin(name_, category_);
+        }
+    }
+
+    TraceSpan::~TraceSpan() {
+        if (enabled_) {
+            TraceWriter::Instance().End(name_, category_);
+        }
+    }
+}
@@ -0,0 +1,66 @@
+#ifndef ROWS_TRACE_WRITER_H
+#define ROWS_TRACE_WRITER_H
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+namespace rows {
+
+    // writes spans in the Chrome trace event format, the output can be opened in chrome://tracing or Perfetto
+    class TraceWriter {
+    public:
+        static TraceWriter &Instance();
+
+        ~TraceWriter();
+
+        void Open(const std::string &file_path);
+
+        void Close();
+
+        inline bool IsOpen() const { return is_open_.load(std::memory_order_relaxed); }
+
+        void Begin(const std::string &name, const std::string &category);
+
+        void End(const std::string &name, const std::string &category);
+
+    private:
+        TraceWriter();
+
+        void WriteEvent(const std::string &name, const std::string &category, char phase);
+
+        int GetThreadId();
+
+        std::atomic<bool> is_open_;
+        std::mutex mutex_;
+        std::ofstream stream_;
+        bool first_event_;
+        std::chrono::steady_clock::time_point start_time_;
+        std::unordered_map<std::thread::id, int> thread_ids_;
+    };
+
+    // names are not copied, so they must outlive the span, string literals are expected; nothing is allocated
+    // unless the writer is open
+    class TraceSpan {
+    public:
+        TraceSpan(const char *name, const char *category);
+
+        TraceSpan(const TraceSpan &other) = delete;
+
+        TraceSpan &operator=(const TraceSpan &other) = delete;
+
+        ~TraceSpan();
+
+    private:
+        const char *name_;
+        const char *category_;
+        const bool enabled_;
+    };
+}
+
+
+#endif //ROWS_TRACE_WRITER_H
@@ -0,0 +1,134 @@
+#include "travel_speed_model.h"
+
+#include <map>
+#include <utility>
+
+#include <glog/logging.h>
+
+#include "location_container.h"
+
+namespace rows {
+
+    TravelSpeedModel::TravelSpeedModel()
+            : TravelSpeedModel(8.0, 1.3, 60) {}
+
+    TravelSpeedModel::TravelSpeedModel(double speed, double road_factor, int64 fixed_duration)
+            : Speed{speed},
+              RoadFactor{road_factor},
+              FixedDuration{fixed_duration},
+              RegionSize{0.0},
+              Regions{} {}
+
+    void to_json(nlohmann::json &json, const TravelSpeedModel::Region &region) {
+        json = nlohmann::json{
+                {"row",    region.Row},
+                {"column", region.Column},
+                {"factor", region.Factor}
+        };
+    }
+
+    void from_json(const nlohmann::json &json, TravelSpeedModel::Region &region) {
+        region.Row = json.at("row").get<int>();
+        region.Column = json.at("column").get<int>();
+        region.Factor = json.at("factor").get<double>();
+    }
+
+    void to_json(nlohmann::json &json, const TravelSpeedModel &model) {
+        json = nlohmann::json{
+                {"speed",          model.Speed},
+                {"road_factor",    model.RoadFactor},
+                {"fixed_duration", model.FixedDuration},
+                {"region_size",    model.RegionSize},
+                {"regions",        model.Regions}
+        };
+    }
+
+    void from_json(const nlohmann::json &json, TravelSpeedModel &model) {
+        model.Speed = json.at("speed").get<double>();
+        model.RoadFactor = json.at("road_factor").get<double>();
+        model.FixedDuration = json.at("fixed_duration").get<int64>();
+
+        const auto region_size_it = json.find("region_size");
+        if (region_size_it != std::end(json)) {
+            model.RegionSize = region_size_it->get<double>();
+        }
+
+        const auto regions_it = json.find("regions");
+        if (regions_it != std::end(json)) {
+            model.Regions = regions_it->get<std::vector<TravelSpeedModel::Region> >();
+        }
+
+        // the region of a journey is found by dividing coordinates by the region size
+        CHECK(model.Regions.empty() || model.RegionSize > 0.0) << "The region_size must be positive if regions are given";
+    }
+
+    class RoadFactorEstimate {
+    public:
+        RoadFactorEstimate()
+                : cross_product_{0.0},
+                  square_{0.0},
+                  samples_{0} {}
+
+        void Add(double travel_time, double duration) {
+            cross_product_ += travel_time * duration;
+            square_ += travel_time * travel_time;
+            ++samples_;
+        }
+
+        double Value() const {
+            CHECK_GT(square_, 0.0);
+            return cross_product_ / square_;
+        }
+
+        std::size_t Samples() const { return samples_; }
+
+    private:
+        double cross_product_;
+        double square_;
+        std::size_t samples_;
+    };
+
+    TravelSpeedModel FitTravelSpeedModel(const std::vector<TravelSample> &samples,
+                                         double speed,
+                                         int64 fixed_duration,
+                                         double region_size,
+                                         std::size_t min_region_samples) {
+        CHECK_GT(speed, 0.0);
+
+        RoadFactorEstimate global_estimate;
+        std::map<std::pair<int, int>, RoadFactorEstimate> region_estimates;
+        for (const auto &sample : samples) {
+            if (sample.From == sample.To) {
+                continue;
+            }
+
+            // duration of the journey along the great circle without the fixed overhead, journeys shorter than
+            // the overhead are kept with a negative duration, because dropping them would bias the road factor upwards
+            const auto travel_time = HaversineLocationContainer::GreatCircleDistance(sample.From, sample.To) / speed;
+            const auto duration = static_cast<double>(sample.Duration - fixed_duration);
+            global_estimate.Add(travel_time, duration);
+
+            if (region_size > 0.0) {
+                region_estimates[HaversineLocationContainer::GetRegion(sample.From, sample.To, region_size)].Add(travel_time, duration);
+            }
+        }
+
+        CHECK_GT(global_estimate.Samples(), 0) << "At least one sample of a journey between distinct locations is required";
+
+        TravelSpeedModel model{speed, global_estimate.Value(), fixed_duration};
+        if (region_size > 0.0) {
+            model.RegionSize = region_size;
+            for (const auto &region_estimate : region_estimates) {
+                if (region_estimate.second.Samples() < min_region_samples) {
+                    continue;
+                }
+
+                model.Regions.push_back({region_estimate.first.first,
+                                         region_estimate.first.second,
+                                         region_estimate.second.Value() / model.RoadFactor});
+            }
+        }
+
+        return model;
+    }
+}
@@ -0,0 +1,58 @@
+#ifndef ROWS_TRAVEL_SPEED_MODEL_H
+#define ROWS_TRAVEL_SPEED_MODEL_H
+
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include <ortools/constraint_solver/routing.h>
+
+#include "location.h"
+
+namespace rows {
+
+    // estimates travel durations from the great-circle distance without a map
+    struct TravelSpeedModel {
+        // correction of the road factor in a cell of the latitude-longitude grid
+        struct Region {
+            int Row;
+            int Column;
+            double Factor;
+        };
+
+        TravelSpeedModel();
+
+        TravelSpeedModel(double speed, double road_factor, int64 fixed_duration);
+
+        double Speed; // meters per second
+        double RoadFactor; // ratio of the road distance to the great-circle distance
+        int64 FixedDuration; // seconds added to every journey, i.e. parking
+        double RegionSize; // side of a grid cell in degrees, regional corrections are disabled if zero
+        std::vector<Region> Regions;
+    };
+
+    void to_json(nlohmann::json &json, const TravelSpeedModel::Region &region);
+
+    void from_json(const nlohmann::json &json, TravelSpeedModel::Region &region);
+
+    void to_json(nlohmann::json &json, const TravelSpeedModel &model);
+
+    void from_json(const nlohmann::json &json, TravelSpeedModel &model);
+
+    struct TravelSample {
+        Location From;
+        Location To;
+        int64 Duration;
+    };
+
+    // least squares fit of the road factor, the speed and the fixed duration are not fitted,
+    // regions with fewer samples than the minimum use the global road factor
+    TravelSpeedModel FitTravelSpeedModel(const std::vector<TravelSample> &samples,
+                                         double speed,
+                                         int64 fixed_duration,
+                                         double region_size,
+                                         std::size_t min_region_samples);
+}
+
+
+#endif //ROWS_TRAVEL_SPEED_MODEL_H
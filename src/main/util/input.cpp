@@ -1,5 +1,7 @@
 #include "input.h"
 
+#include <chrono>
+#include <fstream>
 #include <unordered_set>
 
 #include <boost/config.hpp>
@@ -11,8 +13,14 @@
 #include "util/error_code.h"
 #include "util/validation.h"
 #include "calendar_visit.h"
+#include "trace_writer.h"
+#include "past_visit.h"
+#include "real_problem_data.h"
+#include "travel_speed_model.h"
 
 rows::Problem util::LoadProblem(const std::string &problem_path, std::shared_ptr<rows::Printer> printer) {
+    rows::TraceSpan load_problem_span{"LoadProblem", "data"};
+
     boost::filesystem::path problem_file(boost::filesystem::canonical(problem_path));
     std::ifstream problem_stream;
     problem_stream.open(problem_file.c_str());
@@ -31,21 +39,7 @@ rows::Problem util::LoadProblem(const std::string &problem_path, std::shared_ptr
     }
 
     try {
-        rows::Problem::JsonLoader json_loader;
-        const auto initial_problem = json_loader.Load(problem_json);
-
-        std::vector<rows::CalendarVisit> visits_to_use;
-        for (const auto &visit : initial_problem.visits()) {
-            if (visit.duration().total_seconds() > 0) {
-                visits_to_use.push_back(visit);
-            }
-        }
-
-        LOG_IF(WARNING, visits_to_use.size() != initial_problem.visits().size()) << "Removed "
-                                                                                 << initial_problem.visits().size() -
-                                                                                    visits_to_use.size() << " visits ";
-
-        return rows::Problem(std::move(visits_to_use), initial_problem.carers(), initial_problem.service_users());
+        return ParseProblem(problem_json);
     } catch (const std::domain_error &ex) {
         throw util::ApplicationError(
                 (boost::format("Failed to parse the file %1% due to error: '%2%'") % problem_file %
@@ -54,11 +48,33 @@ rows::Problem util::LoadProblem(const std::string &problem_path, std::shared_ptr
     }
 }
 
+rows::Problem util::ParseProblem(const nlohmann::json &problem_json) {
+    rows::Problem::JsonLoader json_loader;
+    const auto initial_problem = json_loader.Load(problem_json);
+
+    std::vector<rows::CalendarVisit> visits_to_use;
+    for (const auto &visit : initial_problem.visits()) {
+        if (visit.duration().total_seconds() > 0) {
+            visits_to_use.push_back(visit);
+        }
+    }
+
+    LOG_IF(WARNING, visits_to_use.size() != initial_problem.visits().size()) << "Removed "
+                                                                             << initial_problem.visits().size() -
+                                                                                visits_to_use.size() << " visits ";
+
+    return rows::Problem(std::move(visits_to_use), initial_problem.carers(), initial_problem.service_users());
+}
+
 rows::Problem util::LoadReducedProblem(const std::string &problem_path,
                                        const std::string &scheduling_date_string,
                                        std::shared_ptr<rows::Printer> printer) {
-    const auto problem = LoadProblem(problem_path, printer);
+    return ReduceProblem(LoadProblem(problem_path, printer), scheduling_date_string, std::move(printer));
+}
 
+rows::Problem util::ReduceProblem(const rows::Problem &problem,
+                                  const std::string &scheduling_date_string,
+                                  std::shared_ptr<rows::Printer> printer) {
     const std::pair<boost::posix_time::ptime, boost::posix_time::ptime> timespan_pair = problem.Timespan();
     const auto begin_date = timespan_pair.first.date();
     const auto end_date = timespan_pair.second.date();
@@ -185,6 +201,115 @@ boost::posix_time::time_duration util::GetTimeDurationOrDefault(const std::strin
     return boost::posix_time::duration_from_string(text);
 }
 
+std::shared_ptr<const rows::History> util::LoadHistory(const std::string &history_path) {
+    rows::TraceSpan load_history_span{"LoadHistory", "data"};
+    const auto loading_history_start = std::chrono::high_resolution_clock::now();
+
+    std::ifstream past_visit_stream;
+    past_visit_stream.open(history_path);
+    if (!past_visit_stream.is_open()) {
+        throw util::ApplicationError((boost::format("Failed to open the file: %1%") % history_path).str(), util::ErrorCode::ERROR);
+    }
+
+    nlohmann::json past_visits_json;
+    try {
+        past_visit_stream >> past_visits_json;
+    } catch (...) {
+        throw util::ApplicationError((boost::format("Failed to open the file: %1%") % history_path).str(),
+                                     boost::current_exception_diagnostic_information(),
+                                     util::ErrorCode::ERROR);
+    }
+
+    std::shared_ptr<const rows::History> history;
+    try {
+        std::vector<rows::PastVisit> past_visits = past_visits_json.get<std::vector<rows::PastVisit>>();
+        history = std::make_shared<const rows::History>(std::move(past_visits));
+    } catch (...) {
+        throw util::ApplicationError((boost::format("Failed to parse the file: %1%") % history_path).str(),
+                                     boost::current_exception_diagnostic_information(),
+                                     util::ErrorCode::ERROR);
+    }
+
+    past_visit_stream.close();
+    const auto loading_history_end = std::chrono::high_resolution_clock::now();
+
+    LOG(INFO) << "Loaded past visits in "
+              << std::chrono::duration_cast<std::chrono::seconds>(loading_history_end - loading_history_start).count()
+              << " seconds";
+    return history;
+}
+
+std::shared_ptr<rows::ProblemDataFactory> util::CreateProblemDataFactory(const std::string &travel_model,
+                                                                         const std::string &travel_speed_model_path,
+                                                                         const std::string &maps_path) {
+    if (travel_model == "haversine" || travel_model == "euclidean" || travel_model == "manhattan") {
+        rows::TravelSpeedModel travel_speed_model;
+        if (!travel_speed_model_path.empty()) {
+            std::ifstream travel_speed_model_stream;
+            travel_speed_model_stream.open(travel_speed_model_path);
+            if (!travel_speed_model_stream.is_open()) {
+                throw util::ApplicationError((boost::format("Failed to open the file: %1%") % travel_speed_model_path).str(),
+                                             util::ErrorCode::ERROR);
+            }
+
+            try {
+                nlohmann::json travel_speed_model_json;
+                travel_speed_model_stream >> travel_speed_model_json;
+                travel_speed_model = travel_speed_model_json.get<rows::TravelSpeedModel>();
+            } catch (...) {
+                throw util::ApplicationError((boost::format("Failed to parse the file: %1%") % travel_speed_model_path).str(),
+                                             boost::current_exception_diagnostic_information(),
+                                             util::ErrorCode::ERROR);
+            }
+        }
+
+        if (travel_model == "euclidean") {
+            return std::make_shared<rows::GeometricProblemDataFactory>(rows::GeometricProblemDataFactory::Metric::Euclidean,
+                                                                       travel_speed_model.Speed);
+        }
+
+        if (travel_model == "manhattan") {
+            return std::make_shared<rows::GeometricProblemDataFactory>(rows::GeometricProblemDataFactory::Metric::Manhattan,
+                                                                       travel_speed_model.Speed);
+        }
+
+        return std::make_shared<rows::HaversineProblemDataFactory>(std::move(travel_speed_model));
+    }
+
+    if (!util::file::Exists("maps", maps_path)) {
+        throw util::ApplicationError((boost::format("The map is required by the %1% travel model") % travel_model).str(),
+                                     util::ErrorCode::ERROR);
+    }
+    return std::make_shared<rows::RealProblemDataFactory>(util::CreateEngineConfig(maps_path));
+}
+
+rows::ScheduleDelta util::LoadScheduleDelta(const std::string &delta_path) {
+    std::ifstream delta_stream;
+    delta_stream.open(delta_path);
+    if (!delta_stream.is_open()) {
+        throw util::ApplicationError((boost::format("Failed to open the file: %1%") % delta_path).str(),
+                                     util::ErrorCode::ERROR);
+    }
+
+    nlohmann::json delta_json;
+    try {
+        delta_stream >> delta_json;
+    } catch (...) {
+        throw util::ApplicationError((boost::format("Failed to open the file: %1%") % delta_path).str(),
+                                     boost::current_exception_diagnostic_information(),
+                                     util::ErrorCode::ERROR);
+    }
+
+    try {
+        rows::ScheduleDelta::JsonLoader json_loader;
+        return json_loader.Load(delta_json);
+    } catch (const std::domain_error &ex) {
+        throw util::ApplicationError(
+                (boost::format("Failed to parse the file '%1%' due to error: '%2%'") % delta_path % ex.what()).str(),
+                util::ErrorCode::ERROR);
+    }
+}
+
 rows::HumanPlannerSchedule util::LoadHumanPlannerSchedule(const std::string &schedule_path) {
     std::ifstream stream;
     stream.open(schedule_path);
@@ -8,6 +8,9 @@
 #include "problem.h"
 #include "printer.h"
 #include "solution.h"
+#include "schedule_delta.h"
+#include "history.h"
+#include "problem_data.h"
 #include "human_planner_schedule.h"
 
 #include <osrm/engine/engine_config.hpp>
@@ -35,14 +38,35 @@ namespace util {
 
     rows::Problem LoadProblem(const std::string &problem_path, std::shared_ptr<rows::Printer> printer);
 
+    /*!
+     * Loads the problem without visits of zero duration
+     * @throws std::domain_error
+     */
+    rows::Problem ParseProblem(const nlohmann::json &problem_json);
+
     rows::Problem LoadReducedProblem(const std::string &problem_path,
                                      const std::string &scheduling_date,
                                      std::shared_ptr<rows::Printer> printer);
 
+    // restricts the problem to the scheduling date, or to the first day if the date is empty
+    rows::Problem ReduceProblem(const rows::Problem &problem,
+                                const std::string &scheduling_date,
+                                std::shared_ptr<rows::Printer> printer);
+
+    std::shared_ptr<const rows::History> LoadHistory(const std::string &history_path);
+
+    // travel_model is 'osrm', 'haversine', 'euclidean' or 'manhattan', the travel speed model is optional,
+    // the geometric models use only the speed of the travel speed model
+    std::shared_ptr<rows::ProblemDataFactory> CreateProblemDataFactory(const std::string &travel_model,
+                                                                       const std::string &travel_speed_model_path,
+                                                                       const std::string &maps_path);
+
     rows::Solution LoadSolution(const std::string &solution_path,
                                 const rows::Problem &problem,
                                 const boost::posix_time::time_duration &visit_time_window);
 
+    rows::ScheduleDelta LoadScheduleDelta(const std::string &delta_path);
+
     rows::HumanPlannerSchedule LoadHumanPlannerSchedule(const std::string &schedule_path);
 
     std::shared_ptr<rows::Printer> CreatePrinter(const std::string &format);
@@ -41,6 +41,20 @@ std::size_t util::GetDroppedVisitCount(const operations_research::RoutingModel &
     return dropped_visits;
 }
 
+std::size_t util::GetDroppedVisitCount(const operations_research::RoutingModel &model, const operations_research::Assignment &assignment) {
+    std::size_t dropped_visits = 0;
+    for (int64 index = 0; index < model.Size(); ++index) {
+        if (model.IsStart(index)) {
+            continue;
+        }
+
+        if (assignment.Value(model.NextVar(index)) == index) {
+            ++dropped_visits;
+        }
+    }
+    return dropped_visits;
+}
+
 double util::Cost(const operations_research::RoutingModel &model) {
     return static_cast<double>(model.CostVar()->Value());
 }
@@ -13,6 +13,8 @@ namespace util {
 
     std::size_t GetDroppedVisitCount(const operations_research::RoutingModel &model);
 
+    std::size_t GetDroppedVisitCount(const operations_research::RoutingModel &model, const operations_research::Assignment &assignment);
+
     double Cost(const operations_research::RoutingModel &model);
 
     boost::posix_time::time_duration WallTime(operations_research::Solver const *solver);
@@ -0,0 +1,150 @@
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include "util/logging.h"
+#include "async_printer.h"
+
+// keeps the order of events received from the decorator
+class RecordingTestPrinter : public rows::Printer {
+public:
+    Printer &operator<<(const std::string &text) override {
+        return Record("text:" + text);
+    }
+
+    Printer &operator<<(const rows::ProblemDefinition &problem_definition) override {
+        return Record("problem");
+    }
+
+    Printer &operator<<(const rows::TracingEvent &trace_event) override {
+        return Record("trace:" + trace_event.Comment);
+    }
+
+    Printer &operator<<(const rows::ProgressStep &progress_step) override {
+        std::lock_guard<std::mutex> lock{mutex_};
+        steps_.push_back(progress_step.Solutions);
+        events_.push_back("step:" + std::to_string(progress_step.Solutions));
+        return *this;
+    }
+
+    Printer &operator<<(const rows::PerformanceSummary &performance_summary) override {
+        return Record("performance:" + performance_summary.Stage);
+    }
+
+    Printer &operator<<(const rows::MemorySummary &memory_summary) override {
+        return Record("memory:" + memory_summary.Stage);
+    }
+
+    Printer &operator<<(const rows::SolutionSummary &solution_summary) override {
+        return Record("solution:" + solution_summary.Stage);
+    }
+
+    std::vector<std::string> events() {
+        std::lock_guard<std::mutex> lock{mutex_};
+        return events_;
+    }
+
+    std::vector<std::size_t> steps() {
+        std::lock_guard<std::mutex> lock{mutex_};
+        return steps_;
+    }
+
+private:
+    Printer &Record(std::string event) {
+        std::lock_guard<std::mutex> lock{mutex_};
+        events_.push_back(std::move(event));
+        return *this;
+    }
+
+    std::mutex mutex_;
+    std::vector<std::string> events_;
+    std::vector<std::size_t> steps_;
+};
+
+rows::ProgressStep CreateProgressStep(std::size_t solutions) {
+    return {1000.0 - solutions, 3, boost::posix_time::milliseconds(solutions), 10 * solutions, solutions, 1024};
+}
+
+TEST(TestAsyncPrinter, PrintsProgressStepsBeforeLaterEvents) {
+    // given
+    const auto recording_printer = std::make_shared<RecordingTestPrinter>();
+    rows::AsyncPrinter printer{recording_printer, 16};
+
+    // when
+    printer << rows::TracingEvent(rows::TracingEventType::Started, "Stage2");
+    printer << CreateProgressStep(1);
+    printer << CreateProgressStep(2);
+    printer << rows::TracingEvent(rows::TracingEventType::Finished, "Stage2");
+    printer << CreateProgressStep(3);
+    printer.Flush();
+
+    // then
+    EXPECT_EQ(recording_printer->events(), (std::vector<std::string>{"trace:Stage2",
+                                                                       "step:1",
+                                                                       "step:2",
+                                                                       "trace:Stage2",
+                                                                       "step:3"}));
+}
+
+TEST(TestAsyncPrinter, KeepsContentOfProgressSteps) {
+    // given
+    class StepPrinter : public RecordingTestPrinter {
+    public:
+        Printer &operator<<(const rows::ProgressStep &progress_step) override {
+            Cost = progress_step.Cost;
+            DroppedVisits = progress_step.DroppedVisits;
+            WallTime = progress_step.WallTime;
+            Branches = progress_step.Branches;
+            MemoryUsage = progress_step.MemoryUsage;
+            return *this;
+        }
+
+        double Cost{0};
+        std::size_t DroppedVisits{0};
+        boost::posix_time::time_duration WallTime;
+        std::size_t Branches{0};
+        std::size_t MemoryUsage{0};
+    };
+    const auto step_printer = std::make_shared<StepPrinter>();
+
+    // when
+    {
+        rows::AsyncPrinter printer{step_printer, 4};
+        printer << CreateProgressStep(7);
+    }
+
+    // then
+    EXPECT_EQ(step_printer->Cost, 993.0);
+    EXPECT_EQ(step_printer->DroppedVisits, 3);
+    EXPECT_EQ(step_printer->WallTime, boost::posix_time::milliseconds(7));
+    EXPECT_EQ(step_printer->Branches, 70);
+    EXPECT_EQ(step_printer->MemoryUsage, 1024);
+}
+
+TEST(TestAsyncPrinter, DropsProgressStepsWhichDoNotFit) {
+    // given
+    const auto recording_printer = std::make_shared<RecordingTestPrinter>();
+    rows::AsyncPrinter printer{recording_printer, 4};
+    static const std::size_t STEPS = 100000;
+
+    // when
+    for (std::size_t step = 0; step < STEPS; ++step) {
+        printer << CreateProgressStep(step);
+    }
+    printer.Flush();
+
+    // then
+    const auto steps = recording_printer->steps();
+    EXPECT_EQ(printer.capacity(), 4);
+    EXPECT_EQ(steps.size() + printer.dropped(), STEPS);
+    EXPECT_TRUE(std::is_sorted(std::begin(steps), std::end(steps)));
+}
+
+int main(int argc, char **argv) {
+    util::SetupLogging(argv[0]);
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,130 @@
+#include <condition_variable>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include "util/logging.h"
+#include "async_solution_writer.h"
+
+using Routes = std::vector<std::vector<int64> >;
+
+rows::SolutionSnapshot Snapshot(Routes routes) {
+    rows::SolutionSnapshot snapshot;
+    snapshot.Routes = std::move(routes);
+    return snapshot;
+}
+
+// records routes of written snapshots and keeps the background thread busy until it is released
+class BlockingWrite {
+public:
+    void operator()(const std::string &file, const rows::SolutionSnapshot &snapshot) {
+        std::unique_lock<std::mutex> lock{mutex_};
+        started_ = true;
+        changed_.notify_all();
+        changed_.wait(lock, [this]() -> bool { return released_; });
+        snapshots_.emplace_back(file, snapshot.Routes);
+    }
+
+    void WaitStarted() {
+        std::unique_lock<std::mutex> lock{mutex_};
+        changed_.wait(lock, [this]() -> bool { return started_; });
+    }
+
+    void Release() {
+        std::lock_guard<std::mutex> lock{mutex_};
+        released_ = true;
+        changed_.notify_all();
+    }
+
+    std::vector<std::pair<std::string, Routes> > snapshots() {
+        std::lock_guard<std::mutex> lock{mutex_};
+        return snapshots_;
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable changed_;
+    bool started_{false};
+    bool released_{false};
+    std::vector<std::pair<std::string, Routes> > snapshots_;
+};
+
+TEST(TestAsyncSolutionWriter, WritesOnlyLatestPendingSnapshotOfFile) {
+    // given
+    BlockingWrite write;
+    rows::AsyncSolutionWriter writer{[&write](const std::string &file, const rows::SolutionSnapshot &snapshot) -> void {
+        write(file, snapshot);
+    }, 4};
+
+    // when
+    writer.Submit("first.gexf", Snapshot({{1, 2}}));
+    write.WaitStarted();
+    writer.Submit("second.gexf", Snapshot({{3}}));
+    writer.Submit("second.gexf", Snapshot({{3, 4}}));
+    writer.Submit("second.gexf", Snapshot({{3, 4, 5}}));
+    write.Release();
+    writer.Flush();
+
+    // then
+    const auto snapshots = write.snapshots();
+    ASSERT_EQ(snapshots.size(), 2);
+    EXPECT_EQ(snapshots[0].first, "first.gexf");
+    EXPECT_EQ(snapshots[0].second, (Routes{{1, 2}}));
+    EXPECT_EQ(snapshots[1].first, "second.gexf");
+    EXPECT_EQ(snapshots[1].second, (Routes{{3, 4, 5}}));
+    EXPECT_EQ(writer.submitted(), 4);
+    EXPECT_EQ(writer.coalesced(), 2);
+    EXPECT_EQ(writer.written(), 2);
+}
+
+TEST(TestAsyncSolutionWriter, WritesPendingSnapshotsWhenDestroyed) {
+    // given
+    std::vector<std::string> files;
+    {
+        rows::AsyncSolutionWriter writer{[&files](const std::string &file, const rows::SolutionSnapshot &snapshot) -> void {
+            files.push_back(file);
+        }, 1};
+
+        // when
+        writer.Submit("first.gexf", {});
+        writer.Submit("second.gexf", {});
+        writer.Submit("third.gexf", {});
+    }
+
+    // then
+    EXPECT_EQ(files, (std::vector<std::string>{"first.gexf", "second.gexf", "third.gexf"}));
+}
+
+TEST(TestAsyncSolutionWriter, ContinuesAfterFailedWriteAndReportsItOnFlush) {
+    // given
+    std::vector<std::string> files;
+    rows::AsyncSolutionWriter writer{[&files](const std::string &file, const rows::SolutionSnapshot &snapshot) -> void {
+        if (file == "failed.gexf") {
+            throw std::runtime_error("disk is full");
+        }
+        files.push_back(file);
+    }, 2};
+
+    // when
+    writer.Submit("failed.gexf", {});
+    writer.Submit("saved.gexf", {});
+
+    // then
+    EXPECT_THROW(writer.Flush(), std::runtime_error);
+    EXPECT_EQ(files, (std::vector<std::string>{"saved.gexf"}));
+    EXPECT_EQ(writer.written(), 2);
+
+    // the failure is reported once
+    EXPECT_NO_THROW(writer.Flush());
+}
+
+int main(int argc, char **argv) {
+    util::SetupLogging(argv[0]);
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,233 @@
+#include <functional>
+#include <random>
+#include <vector>
+
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include <ortools/constraint_solver/constraint_solver.h>
+
+#include "util/logging.h"
+#include "break_constraint.h"
+
+using Activity = rows::BreakConstraint::Activity;
+
+using Restriction = std::function<void(operations_research::Solver &,
+                                       const std::vector<operations_research::IntervalVar *> &)>;
+
+// formulation of breaks with interval variables and the disjunctive constraint used before the break constraint
+// was replaced by a propagator that does not allocate solver objects, intervals of activities precede intervals of breaks
+bool IsFeasibleWithIntervals(const std::vector<Activity> &activities,
+                             const std::vector<Activity> &breaks,
+                             const Restriction &restriction) {
+    operations_research::Solver solver{"break constraint reference"};
+
+    const auto create_chain = [&solver](const std::vector<Activity> &chain_activities,
+                                        std::vector<operations_research::IntervalVar *> &intervals) -> void {
+        operations_research::IntervalVar *last_interval = nullptr;
+        for (const auto &activity : chain_activities) {
+            auto interval = solver.MakeFixedDurationIntervalVar(activity.StartMin,
+                                                                activity.StartMax,
+                                                                activity.Duration,
+                                                                activity.Optional,
+                                                                "activity");
+            if (last_interval != nullptr) {
+                solver.AddConstraint(solver.MakeIntervalVarRelation(interval,
+                                                                    operations_research::Solver::STARTS_AFTER_END,
+                                                                    last_interval));
+            }
+            intervals.push_back(interval);
+            last_interval = interval;
+        }
+    };
+
+    std::vector<operations_research::IntervalVar *> all_intervals;
+    create_chain(activities, all_intervals);
+    create_chain(breaks, all_intervals);
+    restriction(solver, all_intervals);
+
+    const auto disjunctive_constraint = solver.MakeDisjunctiveConstraint(all_intervals, "breaks");
+    solver.AddConstraint(disjunctive_constraint);
+
+    std::vector<operations_research::IntVar *> performed_vars;
+    for (const auto interval : all_intervals) {
+        performed_vars.push_back(interval->PerformedExpr()->Var());
+    }
+
+    std::vector<operations_research::SequenceVar *> sequences{disjunctive_constraint->MakeSequenceVar()};
+    const auto decision_builder = solver.Compose(
+            solver.MakePhase(performed_vars,
+                             operations_research::Solver::CHOOSE_FIRST_UNBOUND,
+                             operations_research::Solver::ASSIGN_MAX_VALUE),
+            solver.MakePhase(sequences, operations_research::Solver::SEQUENCE_DEFAULT),
+            solver.MakePhase(all_intervals, operations_research::Solver::INTERVAL_DEFAULT));
+    return solver.Solve(decision_builder);
+}
+
+bool IsFeasibleWithIntervals(const std::vector<Activity> &activities, const std::vector<Activity> &breaks) {
+    return IsFeasibleWithIntervals(activities, breaks,
+                                   [](operations_research::Solver &,
+                                      const std::vector<operations_research::IntervalVar *> &) -> void {});
+}
+
+// the interval at the position is performed and starts in the range
+bool IsFeasibleWithIntervals(const std::vector<Activity> &activities,
+                             const std::vector<Activity> &breaks,
+                             std::size_t position,
+                             int64 start_min,
+                             int64 start_max) {
+    return IsFeasibleWithIntervals(
+            activities, breaks,
+            [position, start_min, start_max](operations_research::Solver &solver,
+                                             const std::vector<operations_research::IntervalVar *> &intervals) -> void {
+                const auto interval = intervals.at(position);
+                solver.AddConstraint(solver.MakeEquality(interval->PerformedExpr(), 1));
+                solver.AddConstraint(solver.MakeIntervalVarRelation(interval,
+                                                                    operations_research::Solver::STARTS_AFTER,
+                                                                    start_min));
+                solver.AddConstraint(solver.MakeIntervalVarRelation(interval,
+                                                                    operations_research::Solver::STARTS_BEFORE,
+                                                                    start_max));
+            });
+}
+
+TEST(TestBreakConstraint, AcceptsBreakBetweenVisits) {
+    // given
+    std::vector<Activity> activities{{0,   100, 60, false},
+                                     {100, 120, 60, false}};
+    std::vector<Activity> breaks{{60, 90, 30, false}};
+    std::vector<int64> earliest_ready;
+    std::vector<int64> latest_ready;
+
+    // when
+    const auto is_feasible = rows::BreakConstraint::Propagate(activities, breaks, earliest_ready, latest_ready);
+
+    // then
+    EXPECT_TRUE(is_feasible);
+    EXPECT_EQ(activities[0].StartMin, 0);
+    EXPECT_EQ(activities[0].StartMax, 30);
+    EXPECT_EQ(activities[1].StartMin, 100);
+    EXPECT_EQ(activities[1].StartMax, 120);
+    EXPECT_EQ(breaks[0].StartMin, 60);
+    EXPECT_EQ(breaks[0].StartMax, 90);
+}
+
+TEST(TestBreakConstraint, RejectsBreakOverlappingVisit) {
+    // given
+    std::vector<Activity> activities{{0, 0, 120, false}};
+    std::vector<Activity> breaks{{30, 60, 30, false}};
+    std::vector<int64> earliest_ready;
+    std::vector<int64> latest_ready;
+
+    // then
+    EXPECT_FALSE(rows::BreakConstraint::Propagate(activities, breaks, earliest_ready, latest_ready));
+}
+
+TEST(TestBreakConstraint, SkipsOptionalBreak) {
+    // given
+    std::vector<Activity> activities{{0, 0, 120, false}};
+    std::vector<Activity> breaks{{30, 60, 30, true}};
+    std::vector<int64> earliest_ready;
+    std::vector<int64> latest_ready;
+
+    // when
+    const auto is_feasible = rows::BreakConstraint::Propagate(activities, breaks, earliest_ready, latest_ready);
+
+    // then
+    EXPECT_TRUE(is_feasible);
+    EXPECT_GT(breaks[0].StartMin, breaks[0].StartMax);
+}
+
+TEST(TestBreakConstraint, MakesSameDecisionsAsIntervalFormulation) {
+    static const auto NUM_INSTANCES = 500;
+
+    std::mt19937 random_engine{13};
+    std::uniform_int_distribution<int> activity_count_distribution{1, 4};
+    std::uniform_int_distribution<int> break_count_distribution{0, 3};
+    std::uniform_int_distribution<int64> start_distribution{0, 40};
+    std::uniform_int_distribution<int64> window_distribution{0, 10};
+    std::uniform_int_distribution<int64> duration_distribution{1, 8};
+    std::bernoulli_distribution optional_distribution{0.5};
+
+    std::vector<int64> earliest_ready;
+    std::vector<int64> latest_ready;
+    auto feasible_instances = 0;
+    for (auto instance = 0; instance < NUM_INSTANCES; ++instance) {
+        // given
+        std::vector<Activity> activities;
+        const auto activity_count = activity_count_distribution(random_engine);
+        for (auto activity_index = 0; activity_index < activity_count; ++activity_index) {
+            const auto start_min = start_distribution(random_engine);
+            activities.emplace_back(start_min,
+                                    start_min + window_distribution(random_engine),
+                                    duration_distribution(random_engine),
+                                    false);
+        }
+
+        std::vector<Activity> breaks;
+        const auto break_count = break_count_distribution(random_engine);
+        for (auto break_index = 0; break_index < break_count; ++break_index) {
+            const auto start_min = start_distribution(random_engine);
+            breaks.emplace_back(start_min,
+                                start_min + window_distribution(random_engine),
+                                duration_distribution(random_engine),
+                                optional_distribution(random_engine));
+        }
+
+        // when
+        auto narrowed_activities = activities;
+        auto narrowed_breaks = breaks;
+        const auto is_feasible = rows::BreakConstraint::Propagate(narrowed_activities,
+                                                                  narrowed_breaks,
+                                                                  earliest_ready,
+                                                                  latest_ready);
+
+        // then
+        ASSERT_EQ(IsFeasibleWithIntervals(activities, breaks), is_feasible) << "Instance " << instance;
+        if (!is_feasible) {
+            continue;
+        }
+        ++feasible_instances;
+
+        // bounds of every start window are attained by some schedule and no schedule starts outside them
+        std::vector<Activity> narrowed_windows{narrowed_activities};
+        narrowed_windows.insert(std::end(narrowed_windows), std::begin(narrowed_breaks), std::end(narrowed_breaks));
+        std::vector<Activity> initial_windows{activities};
+        initial_windows.insert(std::end(initial_windows), std::begin(breaks), std::end(breaks));
+        for (std::size_t position = 0; position < narrowed_windows.size(); ++position) {
+            const auto &window = narrowed_windows[position];
+            const auto &initial_window = initial_windows[position];
+            if (window.StartMin > window.StartMax) {
+                EXPECT_TRUE(initial_window.Optional) << "Instance " << instance << " position " << position;
+                EXPECT_FALSE(IsFeasibleWithIntervals(activities, breaks, position,
+                                                     initial_window.StartMin,
+                                                     initial_window.StartMax))
+                                    << "Instance " << instance << " position " << position;
+                continue;
+            }
+
+            EXPECT_TRUE(IsFeasibleWithIntervals(activities, breaks, position, window.StartMin, window.StartMin))
+                                << "Instance " << instance << " position " << position;
+            EXPECT_TRUE(IsFeasibleWithIntervals(activities, breaks, position, window.StartMax, window.StartMax))
+                                << "Instance " << instance << " position " << position;
+            EXPECT_FALSE(IsFeasibleWithIntervals(activities, breaks, position,
+                                                 initial_window.StartMin,
+                                                 window.StartMin - 1))
+                                << "Instance " << instance << " position " << position;
+            EXPECT_FALSE(IsFeasibleWithIntervals(activities, breaks, position,
+                                                 window.StartMax + 1,
+                                                 initial_window.StartMax))
+                                << "Instance " << instance << " position " << position;
+        }
+    }
+
+    // both outcomes should be exercised
+    EXPECT_GT(feasible_instances, 0);
+    EXPECT_LT(feasible_instances, NUM_INSTANCES);
+}
+
+int main(int argc, char **argv) {
+    util::SetupLogging(argv[0]);
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
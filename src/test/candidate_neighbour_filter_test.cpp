@@ -0,0 +1,71 @@
+#include <vector>
+
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include <ortools/constraint_solver/routing.h>
+
+#include "util/logging.h"
+#include "candidate_neighbour_filter.h"
+
+class TestCandidateNeighbourFilter : public ::testing::Test {
+protected:
+    TestCandidateNeighbourFilter()
+            : index_manager_{5, 1, operations_research::RoutingIndexManager::NodeIndex{0}},
+              model_{index_manager_} {}
+
+    // the route visits nodes 1, 2, 3 and 4 in order
+    void Synchronize(operations_research::IntVarLocalSearchFilter &filter) {
+        auto assignment = model_.solver()->MakeAssignment();
+        for (int64 index = 0; index < model_.Size(); ++index) {
+            const auto next = model_.IsStart(index) ? 1 : (index == 4 ? model_.End(0) : index + 1);
+            assignment->Add(model_.NextVar(index))->SetValue(next);
+        }
+        filter.Synchronize(assignment, nullptr);
+    }
+
+    // moves node 2 after node 4, node 1 is reconnected to node 3
+    operations_research::Assignment *RelocateDelta() {
+        auto delta = model_.solver()->MakeAssignment();
+        delta->Add(model_.NextVar(1))->SetValue(3);
+        delta->Add(model_.NextVar(4))->SetValue(2);
+        delta->Add(model_.NextVar(2))->SetValue(model_.End(0));
+        return delta;
+    }
+
+    std::vector<std::vector<int64> > Candidates(std::vector<int64> candidates_of_4) const {
+        std::vector<std::vector<int64> > candidates(static_cast<std::size_t>(model_.Size()));
+        candidates[1] = {2};
+        candidates[2] = {3};
+        candidates[3] = {4};
+        candidates[4] = std::move(candidates_of_4);
+        return candidates;
+    }
+
+    operations_research::RoutingIndexManager index_manager_;
+    operations_research::RoutingModel model_;
+};
+
+TEST_F(TestCandidateNeighbourFilter, ReconnectingArcIsNotRestricted) {
+    // given
+    rows::CandidateNeighbourFilter filter{model_, Candidates({2})};
+    Synchronize(filter);
+
+    // then
+    EXPECT_TRUE(filter.Accept(RelocateDelta(), nullptr));
+}
+
+TEST_F(TestCandidateNeighbourFilter, ArcIntoMovedNodeIsRestricted) {
+    // given
+    rows::CandidateNeighbourFilter filter{model_, Candidates({})};
+    Synchronize(filter);
+
+    // then
+    EXPECT_FALSE(filter.Accept(RelocateDelta(), nullptr));
+}
+
+int main(int argc, char **argv) {
+    util::SetupLogging(argv[0]);
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
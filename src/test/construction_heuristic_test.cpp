@@ -0,0 +1,222 @@
+#include <atomic>
+#include <memory>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include <nlohmann/json.hpp>
+
+#include <ortools/constraint_solver/routing.h>
+#include <ortools/constraint_solver/routing_parameters.h>
+
+#include "util/logging.h"
+#include "util/input.h"
+#include "construction_heuristic.h"
+#include "instance_generator.h"
+#include "printer.h"
+#include "real_problem_data.h"
+#include "second_step_solver.h"
+
+class TestConstructionHeuristic : public ::testing::Test {
+protected:
+    void SetUp() override {
+        rows::InstanceGeneratorOptions options;
+        options.Seed = 11;
+        options.Carers = 8;
+        options.ServiceUsers = 20;
+        options.VisitsPerDay = 60;
+        options.Days = 1;
+        options.SiblingFraction = 0.2;
+        options.SplitShiftFraction = 0.5;
+        Generate(options);
+    }
+
+    void Generate(const rows::InstanceGeneratorOptions &options) {
+        rows::InstanceGenerator generator{options};
+        const auto problem_json = generator.GenerateProblem();
+
+        printer_ = std::make_shared<rows::LogPrinter>();
+        cancel_token_ = std::make_shared<std::atomic<bool> >(false);
+        problem_data_ = rows::HaversineProblemDataFactory{rows::TravelSpeedModel{}}.makeProblem(
+                util::ReduceProblem(util::ParseProblem(problem_json), "", printer_));
+    }
+
+    std::unique_ptr<rows::SecondStepSolver> CreateSolver() const {
+        return std::make_unique<rows::SecondStepSolver>(*problem_data_,
+                                                        operations_research::DefaultRoutingSearchParameters(),
+                                                        boost::posix_time::minutes(120),
+                                                        boost::posix_time::minutes(15),
+                                                        boost::posix_time::minutes(15),
+                                                        boost::date_time::not_a_date_time);
+    }
+
+    std::shared_ptr<rows::Printer> printer_;
+    std::shared_ptr<std::atomic<bool> > cancel_token_;
+    std::shared_ptr<rows::ProblemData> problem_data_;
+};
+
+TEST_F(TestConstructionHeuristic, RoutesAreFeasibleInRoutingModel) {
+    // given
+    auto search_params = operations_research::DefaultRoutingSearchParameters();
+    rows::SecondStepSolver solver{*problem_data_,
+                                  search_params,
+                                  boost::posix_time::minutes(120),
+                                  boost::posix_time::minutes(15),
+                                  boost::posix_time::minutes(15),
+                                  boost::date_time::not_a_date_time};
+    operations_research::RoutingModel model{solver.index_manager()};
+    solver.ConfigureModel(model, printer_, cancel_token_, 1.0);
+
+    rows::ConstructionHeuristic heuristic{solver};
+
+    // when
+    const auto routes = heuristic.Solve();
+
+    // then
+    ASSERT_EQ(routes.size(), model.vehicles());
+    EXPECT_EQ(heuristic.inserted_visits() + heuristic.declined_visits(), problem_data_->problem().visits().size());
+    EXPECT_GT(heuristic.inserted_visits(), 0);
+
+    std::vector<int> vehicle_of(static_cast<std::size_t>(model.Size()), -1);
+    for (auto vehicle = 0; vehicle < model.vehicles(); ++vehicle) {
+        for (const auto index : routes[vehicle]) {
+            EXPECT_EQ(vehicle_of[index], -1);
+            vehicle_of[index] = vehicle;
+        }
+    }
+
+    // both nodes of a visit of two carers are routed by different vehicles or dropped together
+    for (operations_research::RoutingNodeIndex node{1}; node < solver.nodes(); ++node) {
+        const auto &nodes = solver.GetNodes(solver.NodeToVisit(node));
+        if (nodes.size() > 1) {
+            const auto first_index = solver.index_manager().NodeToIndex(nodes[0]);
+            const auto second_index = solver.index_manager().NodeToIndex(nodes[1]);
+            EXPECT_EQ(vehicle_of[first_index] == -1, vehicle_of[second_index] == -1);
+            if (vehicle_of[first_index] != -1) {
+                EXPECT_NE(vehicle_of[first_index], vehicle_of[second_index]);
+            }
+        }
+    }
+
+    EXPECT_NE(model.ReadAssignmentFromRoutes(routes, true), nullptr);
+}
+
+TEST_F(TestConstructionHeuristic, PlacesBreaksOfSplitShiftsBetweenVisits) {
+    // given
+    rows::InstanceGeneratorOptions options;
+    options.Seed = 23;
+    options.Carers = 6;
+    options.ServiceUsers = 15;
+    options.VisitsPerDay = 50;
+    options.Days = 1;
+    options.SiblingFraction = 0.0;
+    options.SplitShiftFraction = 1.0;
+    Generate(options);
+
+    auto solver = CreateSolver();
+    operations_research::RoutingModel model{solver->index_manager()};
+    solver->ConfigureModel(model, printer_, cancel_token_, 1.0);
+
+    rows::ConstructionHeuristic heuristic{*solver};
+
+    // when
+    const auto routes = heuristic.Solve();
+    const auto assignment = model.ReadAssignmentFromRoutes(routes, true);
+
+    // then
+    ASSERT_NE(assignment, nullptr);
+
+    // the schedule restored by the model keeps visits out of breaks and some routes continue after the break
+    // which splits the shift of the carer
+    const auto time_dimension = model.GetMutableDimension(rows::SolverWrapper::TIME_DIMENSION);
+    std::size_t spanned_breaks = 0;
+    for (auto vehicle = 0; vehicle < model.vehicles(); ++vehicle) {
+        for (const auto break_interval : time_dimension->GetBreakIntervalsOfVehicle(vehicle)) {
+            if (assignment->PerformedMin(break_interval) == 0 || assignment->DurationMin(break_interval) == 0) {
+                continue;
+            }
+
+            const auto break_start = assignment->StartMin(break_interval);
+            const auto break_end = break_start + assignment->DurationMin(break_interval);
+            auto visits_before = 0;
+            auto visits_after = 0;
+            for (const auto index : routes[vehicle]) {
+                const auto visit_start = assignment->Min(time_dimension->CumulVar(index));
+                const auto visit_end = visit_start + problem_data_->ServiceTime(solver->index_manager().IndexToNode(index));
+                EXPECT_TRUE(visit_end <= break_start || visit_start >= break_end)
+                                    << "Visit " << index << " of vehicle " << vehicle << " overlaps a break";
+                if (visit_end <= break_start) {
+                    ++visits_before;
+                } else if (visit_start >= break_end) {
+                    ++visits_after;
+                }
+            }
+
+            if (visits_before > 0 && visits_after > 0) {
+                ++spanned_breaks;
+            }
+        }
+    }
+    EXPECT_GT(spanned_breaks, 0);
+}
+
+TEST_F(TestConstructionHeuristic, KeepsContinuityOfCareWithSiblings) {
+    // given
+    rows::InstanceGeneratorOptions options;
+    options.Seed = 29;
+    options.Carers = 10;
+    options.ServiceUsers = 8;
+    options.VisitsPerDay = 48;
+    options.Days = 1;
+    options.SiblingFraction = 0.4;
+    options.SplitShiftFraction = 0.0;
+    Generate(options);
+
+    auto solver = CreateSolver();
+    solver->SetNeighbourhoodOptions(rows::NeighbourhoodOptions(true, 0, true, true));
+    operations_research::RoutingModel model{solver->index_manager()};
+    solver->ConfigureModel(model, printer_, cancel_token_, 1.0);
+
+    rows::ConstructionHeuristic heuristic{*solver};
+
+    // when
+    const auto routes = heuristic.Solve();
+
+    // then
+    EXPECT_NE(model.ReadAssignmentFromRoutes(routes, true), nullptr);
+
+    std::unordered_map<rows::ServiceUser, bool> has_siblings;
+    for (operations_research::RoutingNodeIndex node{1}; node < solver->nodes(); ++node) {
+        const auto &visit = solver->NodeToVisit(node);
+        auto &user_has_siblings = has_siblings[visit.service_user()];
+        user_has_siblings = user_has_siblings || solver->GetNodes(visit).size() > 1;
+    }
+
+    std::unordered_map<rows::ServiceUser, std::set<int> > user_vehicles;
+    std::size_t routed_sibling_nodes = 0;
+    for (auto vehicle = 0; vehicle < model.vehicles(); ++vehicle) {
+        for (const auto index : routes[vehicle]) {
+            const auto &visit = solver->NodeToVisit(solver->index_manager().IndexToNode(index));
+            user_vehicles[visit.service_user()].insert(vehicle);
+            if (solver->GetNodes(visit).size() > 1) {
+                ++routed_sibling_nodes;
+            }
+        }
+    }
+    EXPECT_GT(routed_sibling_nodes, 0);
+
+    for (const auto &user_vehicles_pair : user_vehicles) {
+        const auto max_vehicles = has_siblings.at(user_vehicles_pair.first) ? rows::SolverWrapper::MAX_CARERS_MULTIPLE_VISITS
+                                                                            : rows::SolverWrapper::MAX_CARERS_SINGLE_VISITS;
+        EXPECT_LE(static_cast<int64>(user_vehicles_pair.second.size()), max_vehicles);
+    }
+}
+
+int main(int argc, char **argv) {
+    util::SetupLogging(argv[0]);
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
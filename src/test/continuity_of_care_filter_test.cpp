@@ -0,0 +1,97 @@
+#include <vector>
+
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include <ortools/constraint_solver/routing.h>
+
+#include "util/logging.h"
+#include "continuity_of_care_filter.h"
+
+class TestContinuityOfCareFilter : public ::testing::Test {
+protected:
+    TestContinuityOfCareFilter()
+            : index_manager_{7, 3, operations_research::RoutingIndexManager::NodeIndex{0}},
+              model_{index_manager_} {}
+
+    int64 Index(int node) const {
+        return index_manager_.NodeToIndex(operations_research::RoutingIndexManager::NodeIndex{node});
+    }
+
+    // vehicles visit nodes 1 and 2, nodes 3 and 4, nodes 5 and 6
+    void Synchronize(operations_research::IntVarLocalSearchFilter &filter) {
+        const std::vector<std::vector<int> > routes{{1, 2},
+                                                    {3, 4},
+                                                    {5, 6}};
+
+        auto assignment = model_.solver()->MakeAssignment();
+        for (int vehicle = 0; vehicle < model_.vehicles(); ++vehicle) {
+            auto previous_index = model_.Start(vehicle);
+            for (const auto node : routes[vehicle]) {
+                assignment->Add(model_.NextVar(previous_index))->SetValue(Index(node));
+                previous_index = Index(node);
+            }
+            assignment->Add(model_.NextVar(previous_index))->SetValue(model_.End(vehicle));
+        }
+        filter.Synchronize(assignment, nullptr);
+    }
+
+    // moves the last node of the route of the vehicle to the end of the route of the other vehicle
+    operations_research::Assignment *MoveLastNode(int vehicle, int node, int previous_node, int other_vehicle, int other_last_node) {
+        auto delta = model_.solver()->MakeAssignment();
+        delta->Add(model_.NextVar(Index(previous_node)))->SetValue(model_.End(vehicle));
+        delta->Add(model_.NextVar(Index(other_last_node)))->SetValue(Index(node));
+        delta->Add(model_.NextVar(Index(node)))->SetValue(model_.End(other_vehicle));
+        return delta;
+    }
+
+    operations_research::RoutingIndexManager index_manager_;
+    operations_research::RoutingModel model_;
+};
+
+TEST_F(TestContinuityOfCareFilter, RejectsCarerAboveLimit) {
+    // given
+    rows::ContinuityOfCareFilter filter{model_, {{Index(1), Index(2), Index(3)}}, {2}};
+    Synchronize(filter);
+
+    // then
+    EXPECT_FALSE(filter.Accept(MoveLastNode(0, 2, 1, 2, 6), nullptr));
+}
+
+TEST_F(TestContinuityOfCareFilter, AcceptsMoveToExistingCarer) {
+    // given
+    rows::ContinuityOfCareFilter filter{model_, {{Index(1), Index(2), Index(3)}}, {2}};
+    Synchronize(filter);
+
+    // then
+    EXPECT_TRUE(filter.Accept(MoveLastNode(0, 2, 1, 1, 4), nullptr));
+}
+
+TEST_F(TestContinuityOfCareFilter, AcceptsDroppedVisit) {
+    // given
+    rows::ContinuityOfCareFilter filter{model_, {{Index(1), Index(2), Index(3)}}, {1}};
+    Synchronize(filter);
+
+    auto delta = model_.solver()->MakeAssignment();
+    delta->Add(model_.NextVar(model_.Start(1)))->SetValue(Index(4));
+    delta->Add(model_.NextVar(Index(3)))->SetValue(Index(3));
+
+    // then
+    EXPECT_TRUE(filter.Accept(delta, nullptr));
+}
+
+TEST_F(TestContinuityOfCareFilter, AcceptsUserAboveLimitWhileCarersDoNotGrow) {
+    // given
+    rows::ContinuityOfCareFilter filter{model_, {{Index(2), Index(3), Index(4)}}, {1}};
+    Synchronize(filter);
+
+    // then
+    EXPECT_TRUE(filter.Accept(MoveLastNode(0, 2, 1, 1, 4), nullptr));
+    EXPECT_FALSE(filter.Accept(MoveLastNode(1, 4, 3, 2, 6), nullptr));
+}
+
+int main(int argc, char **argv) {
+    util::SetupLogging(argv[0]);
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
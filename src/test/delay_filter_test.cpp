@@ -0,0 +1,143 @@
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include <nlohmann/json.hpp>
+
+#include <ortools/constraint_solver/routing.h>
+#include <ortools/constraint_solver/routing_parameters.h>
+
+#include "util/logging.h"
+#include "util/input.h"
+#include "delay_probability_reduction_solver.h"
+#include "delay_riskiness_reduction_solver.h"
+#include "history.h"
+#include "instance_generator.h"
+#include "past_visit.h"
+#include "perf_counters.h"
+#include "printer.h"
+#include "real_problem_data.h"
+#include "second_step_solver.h"
+
+// the delay filters are conservative if local search visits the same solutions with and without them and they are
+// useful if they reject some moves; the continuity of care is not enforced, so its filter is not registered,
+// and no visit needs two carers
+class TestDelayFilter : public ::testing::Test {
+protected:
+    struct SearchResult {
+        int64 Objective;
+        std::vector<std::vector<int64> > Routes;
+        uint64_t Rejects;
+    };
+
+    void SetUp() override {
+        rows::InstanceGeneratorOptions options;
+        options.Seed = 5;
+        options.Carers = 2;
+        options.ServiceUsers = 5;
+        options.VisitsPerDay = 10;
+        options.Days = 1;
+        options.HistoryDays = 10;
+        options.SiblingFraction = 0.0;
+        options.SplitShiftFraction = 0.0;
+
+        rows::InstanceGenerator generator{options};
+        const auto problem_json = generator.GenerateProblem();
+        const auto history_json = generator.GenerateHistory(problem_json);
+
+        printer_ = std::make_shared<rows::LogPrinter>();
+        cancel_token_ = std::make_shared<std::atomic<bool> >(false);
+        history_ = std::make_unique<rows::History>(history_json.get<std::vector<rows::PastVisit> >());
+        problem_data_ = rows::HaversineProblemDataFactory{rows::TravelSpeedModel{}}.makeProblem(
+                util::ReduceProblem(util::ParseProblem(problem_json), "", printer_));
+
+        auto search_params = operations_research::DefaultRoutingSearchParameters();
+        search_params.set_solution_limit(16);
+        rows::SecondStepSolver second_step_solver{*problem_data_,
+                                                  search_params,
+                                                  VISIT_TIME_WINDOW,
+                                                  boost::posix_time::minutes(15),
+                                                  boost::posix_time::minutes(15),
+                                                  boost::date_time::not_a_date_time};
+        operations_research::RoutingModel second_step_model{second_step_solver.index_manager()};
+        second_step_solver.ConfigureModel(second_step_model, printer_, cancel_token_, 1.0);
+        const auto assignment = second_step_model.SolveWithParameters(search_params);
+        ASSERT_NE(assignment, nullptr);
+        second_step_model.AssignmentToRoutes(*assignment, &routes_);
+    }
+
+    template<typename SolverType>
+    SearchResult Search(bool local_search_filters) const {
+        auto search_params = operations_research::DefaultRoutingSearchParameters();
+        search_params.set_local_search_metaheuristic(operations_research::LocalSearchMetaheuristic_Value_GREEDY_DESCENT);
+        search_params.set_solution_limit(32);
+
+        SolverType solver{*problem_data_,
+                          *history_,
+                          search_params,
+                          VISIT_TIME_WINDOW,
+                          boost::posix_time::minutes(15),
+                          boost::posix_time::minutes(15),
+                          boost::date_time::not_a_date_time,
+                          static_cast<int64>(problem_data_->nodes())};
+        solver.SetNeighbourhoodOptions(rows::NeighbourhoodOptions(true, 0, local_search_filters));
+        operations_research::RoutingModel model{solver.index_manager()};
+        solver.ConfigureModel(model, printer_, cancel_token_, 1.0);
+
+        const auto initial_assignment = model.ReadAssignmentFromRoutes(routes_, true);
+        CHECK(initial_assignment != nullptr);
+        const auto perf_counters_before = rows::PerfCounters::Snapshot();
+        const auto assignment = model.SolveFromAssignmentWithParameters(initial_assignment, search_params);
+        const auto perf_counters = rows::PerfCounters::Snapshot() - perf_counters_before;
+        CHECK(assignment != nullptr);
+
+        SearchResult result;
+        result.Objective = assignment->ObjectiveValue();
+        model.AssignmentToRoutes(*assignment, &result.Routes);
+        result.Rejects = perf_counters[rows::PerfCounter::DelayFilterReject];
+        return result;
+    }
+
+    static const boost::posix_time::time_duration VISIT_TIME_WINDOW;
+
+    std::shared_ptr<rows::Printer> printer_;
+    std::shared_ptr<std::atomic<bool> > cancel_token_;
+    std::unique_ptr<rows::History> history_;
+    std::shared_ptr<rows::ProblemData> problem_data_;
+    std::vector<std::vector<int64> > routes_;
+};
+
+const boost::posix_time::time_duration TestDelayFilter::VISIT_TIME_WINDOW = boost::posix_time::minutes(30);
+
+TEST_F(TestDelayFilter, ProbabilityFilterKeepsSearchTrajectory) {
+    // when
+    const auto filtered_result = Search<rows::DelayProbabilityReductionSolver>(true);
+    const auto unfiltered_result = Search<rows::DelayProbabilityReductionSolver>(false);
+
+    // then
+    EXPECT_EQ(filtered_result.Objective, unfiltered_result.Objective);
+    EXPECT_EQ(filtered_result.Routes, unfiltered_result.Routes);
+    EXPECT_GT(filtered_result.Rejects, 0u);
+    EXPECT_EQ(unfiltered_result.Rejects, 0u);
+}
+
+TEST_F(TestDelayFilter, RiskinessFilterKeepsSearchTrajectory) {
+    // when
+    const auto filtered_result = Search<rows::DelayRiskinessReductionSolver>(true);
+    const auto unfiltered_result = Search<rows::DelayRiskinessReductionSolver>(false);
+
+    // then
+    EXPECT_EQ(filtered_result.Objective, unfiltered_result.Objective);
+    EXPECT_EQ(filtered_result.Routes, unfiltered_result.Routes);
+    EXPECT_GT(filtered_result.Rejects, 0u);
+    EXPECT_EQ(unfiltered_result.Rejects, 0u);
+}
+
+int main(int argc, char **argv) {
+    util::SetupLogging(argv[0]);
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,116 @@
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include "util/logging.h"
+#include "delay_histogram.h"
+#include "delay_tracker.h"
+
+// decisions of histograms are compared with the essential riskiness computed by the delay tracker
+class TestDelayHistogram : public ::testing::Test {
+protected:
+    static bool IsRiskinessAtMost(const std::vector<int64> &delays, const std::vector<int64> &weights, int64 riskiness) {
+        return rows::DelayTracker::GetEssentialRiskiness(delays, weights) <= riskiness;
+    }
+
+    static rows::DelayHistogram Build(int64 resolution,
+                                      int64 max_delay,
+                                      const std::vector<int64> &delays,
+                                      const std::vector<int64> &weights) {
+        rows::DelayHistogram histogram{resolution, max_delay};
+        for (std::size_t scenario = 0; scenario < delays.size(); ++scenario) {
+            histogram.Add(delays[scenario], weights[scenario]);
+        }
+        return histogram;
+    }
+};
+
+TEST_F(TestDelayHistogram, CountsDelayedArrivalsExactly) {
+    // given
+    const std::vector<int64> delays{-600, -1, 0, 1, 59, 60, 61, 7200, 10000};
+    const std::vector<int64> weights{1, 2, 3, 4, 5, 6, 7, 8, 9};
+
+    // when
+    const auto histogram = Build(60, 3600, delays, weights);
+
+    // then
+    EXPECT_EQ(histogram.total_weight(), 45);
+    EXPECT_EQ(histogram.WeightAbove(0), 4 + 5 + 6 + 7 + 8 + 9);
+    EXPECT_EQ(histogram.WeightAbove(60), 7 + 8 + 9);
+    EXPECT_EQ(histogram.WeightAbove(-60), 2 + 3 + 4 + 5 + 6 + 7 + 8 + 9);
+
+    // the threshold is rounded up to the resolution
+    EXPECT_EQ(histogram.WeightAbove(30), 7 + 8 + 9);
+}
+
+TEST_F(TestDelayHistogram, MovesWeightBetweenBuckets) {
+    // given
+    auto histogram = Build(60, 3600, {0, 0, 0}, {1, 1, 1});
+
+    // when
+    histogram.Move(0, 120, 1);
+    histogram.Move(0, 30, 1);
+    histogram.Move(30, -90, 1);
+
+    // then
+    EXPECT_EQ(histogram.total_weight(), 3);
+    EXPECT_EQ(histogram.WeightAbove(0), 1);
+    EXPECT_EQ(histogram.WeightAbove(-120), 3);
+    EXPECT_EQ(histogram.WeightAbove(-60), 2);
+}
+
+TEST_F(TestDelayHistogram, RiskinessDecisionsAgreeWithExactComputation) {
+    // given
+    std::mt19937 random_engine{17};
+    std::uniform_int_distribution<int64> delay_distribution{-3600, 1800};
+    std::uniform_int_distribution<int64> weight_distribution{1, 4};
+    std::uniform_int_distribution<int64> riskiness_distribution{0, 3600};
+
+    auto confirmed_decisions = 0;
+    auto exact_confirmed_decisions = 0;
+    for (auto sample = 0; sample < 1000; ++sample) {
+        std::vector<int64> delays(16);
+        std::vector<int64> weights(16);
+        for (std::size_t scenario = 0; scenario < delays.size(); ++scenario) {
+            delays[scenario] = delay_distribution(random_engine);
+            weights[scenario] = weight_distribution(random_engine);
+        }
+        const auto riskiness = riskiness_distribution(random_engine);
+
+        // when
+        const auto coarse_histogram = Build(300, 7200, delays, weights);
+        const auto fine_histogram = Build(1, 7200, delays, weights);
+        const auto exact = IsRiskinessAtMost(delays, weights, riskiness);
+
+        // then
+        if (coarse_histogram.IsRiskinessAtMost(riskiness)) {
+            EXPECT_TRUE(exact);
+            ++confirmed_decisions;
+        }
+        EXPECT_EQ(fine_histogram.IsRiskinessAtMost(riskiness), exact);
+
+        if (exact) {
+            ++exact_confirmed_decisions;
+        }
+    }
+
+    EXPECT_GT(confirmed_decisions, exact_confirmed_decisions / 2);
+}
+
+TEST_F(TestDelayHistogram, DoesNotConfirmRiskinessOfDelaysAboveRange) {
+    // given
+    const auto histogram = Build(60, 600, {-100000, 601}, {1, 1});
+
+    // then
+    EXPECT_TRUE(IsRiskinessAtMost({-100000, 601}, {1, 1}, 1000));
+    EXPECT_FALSE(histogram.IsRiskinessAtMost(1000));
+}
+
+int main(int argc, char **argv) {
+    util::SetupLogging(argv[0]);
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
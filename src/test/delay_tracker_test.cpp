@@ -0,0 +1,357 @@
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include <nlohmann/json.hpp>
+
+#include <ortools/constraint_solver/routing.h>
+#include <ortools/constraint_solver/routing_parameters.h>
+
+#include "util/logging.h"
+#include "util/input.h"
+#include "delay_tracker.h"
+#include "history.h"
+#include "instance_generator.h"
+#include "invariant_checks.h"
+#include "past_visit.h"
+#include "printer.h"
+#include "real_problem_data.h"
+#include "second_step_solver.h"
+
+// debug builds enable ROWS_EXPENSIVE_CHECKS by default, so the propagation verifies its invariants in every call
+class TestDelayTracker : public ::testing::Test {
+protected:
+    void SetUp() override {
+        rows::InstanceGeneratorOptions options;
+        options.Seed = 7;
+        options.Carers = 4;
+        options.ServiceUsers = 6;
+        options.VisitsPerDay = 12;
+        options.Days = 1;
+        options.HistoryDays = 10;
+        options.SiblingFraction = 0.3;
+        options.SplitShiftFraction = 0.0;
+
+        rows::InstanceGenerator generator{options};
+        const auto problem_json = generator.GenerateProblem();
+        const auto history_json = generator.GenerateHistory(problem_json);
+
+        printer_ = std::make_shared<rows::LogPrinter>();
+        cancel_token_ = std::make_shared<std::atomic<bool> >(false);
+        history_ = std::make_unique<rows::History>(history_json.get<std::vector<rows::PastVisit> >());
+        problem_data_ = rows::HaversineProblemDataFactory{rows::TravelSpeedModel{}}.makeProblem(
+                util::ReduceProblem(util::ParseProblem(problem_json), "", printer_));
+    }
+
+    std::shared_ptr<rows::Printer> printer_;
+    std::shared_ptr<std::atomic<bool> > cancel_token_;
+    std::unique_ptr<rows::History> history_;
+    std::shared_ptr<rows::ProblemData> problem_data_;
+};
+
+TEST_F(TestDelayTracker, SiblingsStartAtSameTimeInAllScenarios) {
+    // given
+    auto search_params = operations_research::DefaultRoutingSearchParameters();
+    search_params.set_solution_limit(16);
+    rows::SecondStepSolver solver{*problem_data_,
+                                  search_params,
+                                  boost::posix_time::minutes(30),
+                                  boost::posix_time::minutes(15),
+                                  boost::posix_time::minutes(15),
+                                  boost::date_time::not_a_date_time};
+    operations_research::RoutingModel model{solver.index_manager()};
+    solver.ConfigureModel(model, printer_, cancel_token_, 1.0);
+    const auto assignment = model.SolveWithParameters(search_params);
+    ASSERT_NE(assignment, nullptr);
+
+    rows::DelayTracker tracker{solver, *history_, &model.GetDimensionOrDie(rows::SolverWrapper::TIME_DIMENSION)};
+
+    // when
+    tracker.UpdateAllPaths(assignment);
+
+    // then
+    auto visited_siblings = 0;
+    for (int64 index = 0; index < solver.index_manager().num_indices(); ++index) {
+        if (!tracker.IsVisited(index) || !tracker.has_sibling(index)) {
+            continue;
+        }
+
+        ++visited_siblings;
+        EXPECT_EQ(tracker.Start(index), tracker.Start(tracker.sibling(index)));
+    }
+    EXPECT_GT(visited_siblings, 0);
+}
+
+// the path builder of the delay tracker before partial paths were compacted into reusable buffers,
+// kept to verify that the records of the tracker do not depend on the representation of partial paths
+namespace reference {
+
+    struct PartialPath {
+        explicit PartialPath(std::size_t size)
+                : current_time{0},
+                  travel_time{0},
+                  node_next_pos{0},
+                  break_next_pos{1},
+                  path(size, 0) {}
+
+        bool IsComplete() const { return path[path.size() - 1] < 0; }
+
+        std::size_t CurrentPosition() const { return break_next_pos + node_next_pos - 1; }
+
+        int64 current_time;
+        int64 travel_time;
+        std::size_t node_next_pos;
+        std::size_t break_next_pos;
+        std::vector<int64> path;
+        std::vector<int64> slack;
+    };
+
+    const PartialPath *SelectBestPath(const PartialPath &left, const PartialPath &right) {
+        int64 capped_budget = 0;
+        int64 total_budget = 0;
+        for (std::size_t pos = 0; pos < left.slack.size(); ++pos) {
+            capped_budget += std::min(left.slack[pos], static_cast<int64>(3600)) - std::min(right.slack[pos], static_cast<int64>(3600));
+            total_budget += left.slack[pos] - right.slack[pos];
+        }
+
+        if (capped_budget != 0) {
+            return capped_budget > 0 ? &left : &right;
+        }
+        return total_budget >= 0 ? &left : &right;
+    }
+
+    std::vector<int64> BuildPath(rows::DelayTracker &tracker,
+                                 const rows::SolverWrapper &solver,
+                                 const operations_research::RoutingDimension *dimension,
+                                 int vehicle,
+                                 const operations_research::Assignment *assignment) {
+        const auto model = dimension->model();
+        const auto &breaks = dimension->GetBreakIntervalsOfVehicle(vehicle);
+
+        std::vector<int64> nodes;
+        for (auto node = model->Start(vehicle); !model->IsEnd(node); node = assignment->Value(model->NextVar(node))) {
+            nodes.push_back(node);
+        }
+        nodes.push_back(model->End(vehicle));
+
+        if (nodes.size() == 2) {
+            return {};
+        }
+
+        if (breaks.size() == 2) {
+            nodes.push_back(-1);
+            return nodes;
+        }
+
+        const auto path_size = breaks.size() + nodes.size() - 1;
+        std::vector<PartialPath> partial_paths{PartialPath{path_size}};
+        partial_paths[0].current_time = assignment->StartMin(breaks[0]) + assignment->DurationMin(breaks[0]);
+
+        for (std::size_t current_path_pos = 0; current_path_pos < partial_paths.size(); ++current_path_pos) {
+            for (auto pos = partial_paths[current_path_pos].CurrentPosition(); pos < path_size; ++pos) {
+                auto &path = partial_paths[current_path_pos];
+                const auto has_visit = path.node_next_pos < nodes.size();
+                const auto has_break = path.break_next_pos < breaks.size();
+
+                int64 next_travel_time = 0;
+                int64 time_after_visit = kint64max;
+                int64 visit_slack_time = 0;
+                if (has_visit) {
+                    const auto current_node = nodes[path.node_next_pos];
+                    const auto cumul = dimension->CumulVar(current_node);
+                    if (path.current_time + path.travel_time > assignment->Max(cumul)) {
+                        break;
+                    }
+
+                    if (path.node_next_pos + 1 < nodes.size()) {
+                        next_travel_time = solver.Distance(solver.index_manager().IndexToNode(current_node),
+                                                           solver.index_manager().IndexToNode(nodes[path.node_next_pos + 1]));
+                    }
+                    time_after_visit = std::max(path.current_time + path.travel_time, assignment->Min(cumul))
+                                       + tracker.Record(current_node).duration;
+                    visit_slack_time = assignment->Max(cumul) - path.current_time - path.travel_time;
+                }
+
+                int64 time_after_break = kint64max;
+                int64 waiting_time_for_break = 0;
+                if (has_break) {
+                    const auto interval = breaks[path.break_next_pos];
+                    if (path.current_time > assignment->StartMax(interval)) {
+                        break;
+                    }
+
+                    time_after_break = std::max(path.current_time, assignment->StartMin(interval)) + assignment->DurationMin(interval);
+                    waiting_time_for_break = std::max(static_cast<int64>(0), assignment->StartMin(interval) - path.current_time);
+                }
+
+                auto visit_preferred = has_visit && !has_break;
+                auto break_preferred = has_break && !has_visit;
+                if (has_visit && has_break) {
+                    const auto interval = breaks[path.break_next_pos];
+                    const auto cumul = dimension->CumulVar(nodes[path.node_next_pos]);
+                    visit_preferred = assignment->Max(cumul) < assignment->StartMin(interval)
+                                      || time_after_visit < assignment->StartMin(interval)
+                                      || assignment->Max(cumul) < time_after_break
+                                      || path.break_next_pos == breaks.size() - 1;
+                    break_preferred = assignment->StartMax(interval) < assignment->Min(cumul)
+                                      || time_after_break < assignment->Min(cumul)
+                                      || assignment->StartMax(interval) < time_after_visit;
+                    if (visit_preferred && break_preferred) {
+                        break;
+                    }
+                } else if (!has_visit && !has_break) {
+                    break;
+                }
+
+                const auto perform_break = [&](PartialPath &target) -> void {
+                    target.path[target.CurrentPosition()] = -static_cast<int64>(target.break_next_pos);
+                    target.travel_time = std::max(static_cast<int64>(0), target.travel_time - waiting_time_for_break);
+                    target.current_time = time_after_break;
+                    ++target.break_next_pos;
+                };
+                const auto perform_visit = [&](PartialPath &target) -> void {
+                    target.path[target.CurrentPosition()] = nodes[target.node_next_pos];
+                    target.current_time = time_after_visit;
+                    target.travel_time = next_travel_time;
+                    ++target.node_next_pos;
+                    target.slack.push_back(visit_slack_time);
+                };
+
+                if (break_preferred) {
+                    perform_break(path);
+                } else if (visit_preferred) {
+                    perform_visit(path);
+                } else {
+                    auto path_copy = path;
+                    perform_visit(path);
+                    perform_break(path_copy);
+                    partial_paths.push_back(std::move(path_copy));
+                }
+            }
+        }
+
+        const PartialPath *best_path = nullptr;
+        for (const auto &path : partial_paths) {
+            if (path.IsComplete()) {
+                best_path = best_path == nullptr ? &path : SelectBestPath(*best_path, path);
+            }
+        }
+        CHECK(best_path != nullptr);
+        return best_path->path;
+    }
+}
+
+TEST(TestDelayTrackerPaths, RecordsMatchReferenceBuilderOnRandomRoutesWithBreaks) {
+    for (auto seed = 1u; seed <= 8u; ++seed) {
+        // given
+        rows::InstanceGeneratorOptions options;
+        options.Seed = seed;
+        options.Carers = 5;
+        options.ServiceUsers = 10;
+        options.VisitsPerDay = 25;
+        options.HistoryDays = 5;
+        options.SiblingFraction = 0.2;
+        options.SplitShiftFraction = 0.8;
+
+        rows::InstanceGenerator generator{options};
+        const auto problem_json = generator.GenerateProblem();
+        const auto history_json = generator.GenerateHistory(problem_json);
+
+        const auto printer = std::make_shared<rows::LogPrinter>();
+        const auto cancel_token = std::make_shared<std::atomic<bool> >(false);
+        const rows::History history{history_json.get<std::vector<rows::PastVisit> >()};
+        const auto problem_data = rows::HaversineProblemDataFactory{rows::TravelSpeedModel{}}.makeProblem(
+                util::ReduceProblem(util::ParseProblem(problem_json), "", printer));
+
+        // the solution limit varies the routes between seeds
+        auto search_params = operations_research::DefaultRoutingSearchParameters();
+        search_params.set_solution_limit(1 + seed % 4 * 8);
+        rows::SecondStepSolver solver{*problem_data,
+                                      search_params,
+                                      boost::posix_time::minutes(90),
+                                      boost::posix_time::minutes(30),
+                                      boost::posix_time::minutes(15),
+                                      boost::date_time::not_a_date_time};
+        operations_research::RoutingModel model{solver.index_manager()};
+        solver.ConfigureModel(model, printer, cancel_token, 1.0);
+        const auto assignment = model.SolveWithParameters(search_params);
+        ASSERT_NE(assignment, nullptr);
+
+        const auto dimension = &model.GetDimensionOrDie(rows::SolverWrapper::TIME_DIMENSION);
+        rows::DelayTracker tracker{solver, history, dimension};
+
+        // when
+        tracker.UpdateAllPaths(assignment);
+
+        // then
+        for (auto vehicle = 0; vehicle < model.vehicles(); ++vehicle) {
+            const auto expected_path = reference::BuildPath(tracker, solver, dimension, vehicle, assignment);
+            EXPECT_EQ(tracker.BuildPath(vehicle, assignment), expected_path) << "seed " << seed << ", vehicle " << vehicle;
+
+            if (expected_path.empty()) {
+                EXPECT_EQ(tracker.Record(model.Start(vehicle)).next, model.End(vehicle));
+                continue;
+            }
+
+            const auto &breaks = dimension->GetBreakIntervalsOfVehicle(vehicle);
+            int64 current_node = -1;
+            int64 last_break_min = 0;
+            int64 last_break_duration = 0;
+            int64 total_break_duration = 0;
+            for (const auto element : expected_path) {
+                if (element < 0) {
+                    last_break_min = assignment->StartMin(breaks[-element]);
+                    last_break_duration = assignment->DurationMin(breaks[-element]);
+                    total_break_duration += last_break_duration;
+                    continue;
+                }
+
+                EXPECT_TRUE(tracker.IsVisited(element));
+                if (current_node != -1) {
+                    const auto &record = tracker.Record(current_node);
+                    EXPECT_EQ(record.next, element);
+                    EXPECT_EQ(record.travel_time, model.GetArcCostForVehicle(current_node, element, vehicle));
+                    EXPECT_EQ(record.break_min, last_break_min + last_break_duration - total_break_duration);
+                    EXPECT_EQ(record.break_duration, total_break_duration);
+                }
+
+                current_node = element;
+                last_break_min = 0;
+                last_break_duration = 0;
+                total_break_duration = 0;
+            }
+        }
+    }
+}
+
+TEST(TestInvariantChecks, RunsExpensiveChecksAccordingToPolicy) {
+    // given
+    static const auto CALLS = 4 * rows::EXPENSIVE_CHECKS_SAMPLING;
+
+    // when
+    auto checked_calls = 0u;
+    for (auto call = 0u; call < CALLS; ++call) {
+        if (ROWS_EXPENSIVE_CHECKS_ENABLED()) {
+            ++checked_calls;
+        }
+    }
+
+    // then
+#if defined(ROWS_EXPENSIVE_CHECKS)
+    EXPECT_EQ(checked_calls, CALLS);
+#elif !defined(NDEBUG)
+    EXPECT_EQ(checked_calls, CALLS / rows::EXPENSIVE_CHECKS_SAMPLING);
+#else
+    EXPECT_EQ(checked_calls, 0);
+#endif
+}
+
+int main(int argc, char **argv) {
+    util::SetupLogging(argv[0]);
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,165 @@
+#include <atomic>
+#include <memory>
+
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include <nlohmann/json.hpp>
+
+#include <ortools/constraint_solver/routing.h>
+#include <ortools/constraint_solver/routing_parameters.h>
+
+#include "util/logging.h"
+#include "util/input.h"
+#include "dropped_visit_tracker.h"
+#include "instance_generator.h"
+#include "printer.h"
+#include "real_problem_data.h"
+#include "second_step_solver.h"
+
+namespace {
+
+    // compares the count of the tracker with a full scan of the next variables at every solution,
+    // the monitor must be added to the model after the tracker
+    class DroppedNodesCheck : public operations_research::SearchMonitor {
+    public:
+        DroppedNodesCheck(const operations_research::RoutingModel &model, const rows::DroppedVisitTracker &tracker)
+                : SearchMonitor(model.solver()),
+                  model_{model},
+                  tracker_{tracker},
+                  deactivated_delta_{false},
+                  deactivated_neighbour_{false},
+                  solutions_{0},
+                  deactivated_solutions_{0},
+                  mismatches_{0} {}
+
+        bool AcceptDelta(operations_research::Assignment *delta, operations_research::Assignment *deltadelta) override {
+            deactivated_delta_ = false;
+            const auto &container = delta->IntVarContainer();
+            for (int position = 0; position < container.Size(); ++position) {
+                if (!container.Element(position).Activated()) {
+                    deactivated_delta_ = true;
+                    break;
+                }
+            }
+            return true;
+        }
+
+        void AcceptNeighbor() override {
+            deactivated_neighbour_ = deactivated_delta_;
+        }
+
+        bool AtSolution() override {
+            int64 dropped_nodes = 0;
+            for (int64 index = 1; index < model_.nodes(); ++index) {
+                const auto next_var = model_.NextVar(index);
+                if (next_var->Bound() && next_var->Value() == index) {
+                    ++dropped_nodes;
+                }
+            }
+
+            ++solutions_;
+            if (deactivated_neighbour_) {
+                ++deactivated_solutions_;
+            }
+            if (dropped_nodes != tracker_.DroppedNodes()) {
+                ++mismatches_;
+            }
+            deactivated_neighbour_ = false;
+            return true;
+        }
+
+        std::string DebugString() const override { return "DroppedNodesCheck"; }
+
+        int solutions() const { return solutions_; }
+
+        int deactivated_solutions() const { return deactivated_solutions_; }
+
+        int mismatches() const { return mismatches_; }
+
+    private:
+        const operations_research::RoutingModel &model_;
+        const rows::DroppedVisitTracker &tracker_;
+
+        bool deactivated_delta_;
+        bool deactivated_neighbour_;
+        int solutions_;
+        int deactivated_solutions_;
+        int mismatches_;
+    };
+}
+
+class TestDroppedVisitTracker : public ::testing::Test {
+protected:
+    void SetUp() override {
+        rows::InstanceGeneratorOptions options;
+        options.Seed = 17;
+        options.Carers = 6;
+        options.ServiceUsers = 15;
+        options.VisitsPerDay = 50;
+        options.Days = 1;
+        options.SiblingFraction = 0.2;
+        options.SplitShiftFraction = 0.0;
+
+        rows::InstanceGenerator generator{options};
+        const auto problem_json = generator.GenerateProblem();
+
+        printer_ = std::make_shared<rows::LogPrinter>();
+        cancel_token_ = std::make_shared<std::atomic<bool> >(false);
+        problem_data_ = rows::HaversineProblemDataFactory{rows::TravelSpeedModel{}}.makeProblem(
+                util::ReduceProblem(util::ParseProblem(problem_json), "", printer_));
+    }
+
+    std::shared_ptr<rows::Printer> printer_;
+    std::shared_ptr<std::atomic<bool> > cancel_token_;
+    std::shared_ptr<rows::ProblemData> problem_data_;
+};
+
+TEST_F(TestDroppedVisitTracker, CountMatchesSolutionsOfLargeNeighbourhoodSearch) {
+    // given
+    auto search_params = operations_research::DefaultRoutingSearchParameters();
+    search_params.set_local_search_metaheuristic(operations_research::LocalSearchMetaheuristic_Value_GREEDY_DESCENT);
+    search_params.set_solution_limit(16);
+
+    // only large neighbourhood search operators, their deltas leave the relaxed next variables deactivated
+    const auto operators = search_params.mutable_local_search_operators();
+    const auto descriptor = operators->GetDescriptor();
+    const auto reflection = operators->GetReflection();
+    for (auto field_index = 0; field_index < descriptor->field_count(); ++field_index) {
+        reflection->SetEnumValue(operators,
+                                 descriptor->field(field_index),
+                                 operations_research::OptionalBoolean::BOOL_FALSE);
+    }
+    operators->set_use_path_lns(operations_research::OptionalBoolean::BOOL_TRUE);
+    operators->set_use_inactive_lns(operations_research::OptionalBoolean::BOOL_TRUE);
+
+    rows::SecondStepSolver solver{*problem_data_,
+                                  search_params,
+                                  boost::posix_time::minutes(120),
+                                  boost::posix_time::minutes(15),
+                                  boost::posix_time::minutes(15),
+                                  boost::date_time::not_a_date_time};
+    operations_research::RoutingModel model{solver.index_manager()};
+    solver.ConfigureModel(model, printer_, cancel_token_, 1.0);
+
+    const auto tracker = model.solver()->RevAlloc(
+            new rows::DroppedVisitTracker(model, solver.index_manager(), *problem_data_));
+    model.AddSearchMonitor(tracker);
+    const auto check = model.solver()->RevAlloc(new DroppedNodesCheck(model, *tracker));
+    model.AddSearchMonitor(check);
+
+    // when
+    const auto assignment = model.SolveWithParameters(search_params);
+
+    // then
+    ASSERT_NE(assignment, nullptr);
+    EXPECT_GT(check->solutions(), 1);
+    EXPECT_GT(check->deactivated_solutions(), 0);
+    EXPECT_EQ(check->mismatches(), 0);
+}
+
+int main(int argc, char **argv) {
+    util::SetupLogging(argv[0]);
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,287 @@
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <random>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include <ortools/constraint_solver/routing.h>
+#include <ortools/constraint_solver/routing_parameters.h>
+
+#include "util/logging.h"
+#include "util/input.h"
+#include "construction_heuristic.h"
+#include "geographic_decomposition.h"
+#include "instance_generator.h"
+#include "printer.h"
+#include "real_problem_data.h"
+#include "second_step_solver.h"
+
+TEST(TestGeographicDecomposition, KMedoidsSeparatesDistantGroups) {
+    // given
+    static const std::size_t NUM_GROUPS = 3;
+    static const std::size_t GROUP_SIZE = 5;
+
+    const auto num_points = NUM_GROUPS * GROUP_SIZE;
+    std::vector<std::vector<int64> > distances(num_points, std::vector<int64>(num_points, 0));
+    for (std::size_t left = 0; left < num_points; ++left) {
+        for (std::size_t right = 0; right < num_points; ++right) {
+            if (left == right) {
+                continue;
+            }
+
+            distances[left][right] = left / GROUP_SIZE == right / GROUP_SIZE ? 60 + left % GROUP_SIZE : 3600;
+        }
+    }
+    const std::vector<int64> weights(num_points, 1800);
+    std::mt19937 random_engine{7};
+
+    // when
+    const auto clusters = rows::KMedoids(distances, weights, NUM_GROUPS, 100, random_engine);
+
+    // then
+    ASSERT_EQ(clusters.size(), num_points);
+    for (std::size_t point = 0; point < num_points; ++point) {
+        const auto group_begin = point - point % GROUP_SIZE;
+        EXPECT_EQ(clusters[point], clusters[group_begin]);
+        for (std::size_t other_point = 0; other_point < group_begin; other_point += GROUP_SIZE) {
+            EXPECT_NE(clusters[point], clusters[other_point]);
+        }
+    }
+}
+
+TEST(TestGeographicDecomposition, KMedoidsAssignsSinglePointsToOwnClusters) {
+    // given
+    const std::vector<std::vector<int64> > distances{{0,   100},
+                                                     {100, 0}};
+    const std::vector<int64> weights{1, 1};
+    std::mt19937 random_engine{7};
+
+    // when
+    const auto clusters = rows::KMedoids(distances, weights, 5, 100, random_engine);
+
+    // then
+    ASSERT_EQ(clusters.size(), 2);
+    EXPECT_NE(clusters[0], clusters[1]);
+}
+
+TEST(TestGeographicDecomposition, AssignsMinimumNumberOfCarersBeforeDemand) {
+    // given
+    const std::vector<std::vector<int64> > cluster_demand{{10, 10, 10, 10},
+                                                          {0,  0,  0,  1}};
+    const std::vector<std::vector<int64> > carer_availability{{1, 1, 1, 1},
+                                                              {1, 1, 1, 1},
+                                                              {1, 1, 0, 0}};
+    const std::vector<std::size_t> min_carers{1, 2};
+
+    // when
+    const auto carer_clusters = rows::AssignCarersToClusters(cluster_demand, carer_availability, min_carers);
+
+    // then
+    ASSERT_EQ(carer_clusters.size(), carer_availability.size());
+    std::vector<std::size_t> carers_in_cluster(cluster_demand.size(), 0);
+    for (const auto cluster : carer_clusters) {
+        ASSERT_LT(cluster, cluster_demand.size());
+        ++carers_in_cluster[cluster];
+    }
+    EXPECT_GE(carers_in_cluster[0], min_carers[0]);
+    EXPECT_GE(carers_in_cluster[1], min_carers[1]);
+}
+
+TEST(TestGeographicDecomposition, AssignsCarerToClusterWithOverlappingDemand) {
+    // given
+    const std::vector<std::vector<int64> > cluster_demand{{5, 5, 0, 0},
+                                                          {0, 0, 5, 5}};
+    const std::vector<std::vector<int64> > carer_availability{{0, 0, 1, 1},
+                                                              {1, 1, 0, 0}};
+    const std::vector<std::size_t> min_carers{0, 0};
+
+    // when
+    const auto carer_clusters = rows::AssignCarersToClusters(cluster_demand, carer_availability, min_carers);
+
+    // then
+    ASSERT_EQ(carer_clusters.size(), 2);
+    EXPECT_EQ(carer_clusters[0], 1);
+    EXPECT_EQ(carer_clusters[1], 0);
+}
+
+class TestClusterRoutes : public ::testing::Test {
+protected:
+    void SetUp() override {
+        rows::InstanceGeneratorOptions options;
+        options.Seed = 11;
+        options.Carers = 8;
+        options.ServiceUsers = 20;
+        options.VisitsPerDay = 60;
+        options.Days = 1;
+        options.Clusters = 3;
+        options.SiblingFraction = 0.2;
+        options.SplitShiftFraction = 0.5;
+
+        rows::InstanceGenerator generator{options};
+        const auto problem_json = generator.GenerateProblem();
+
+        printer_ = std::make_shared<rows::LogPrinter>();
+        cancel_token_ = std::make_shared<std::atomic<bool> >(false);
+        problem_data_ = rows::HaversineProblemDataFactory{rows::TravelSpeedModel{}}.makeProblem(
+                util::ReduceProblem(util::ParseProblem(problem_json), "", printer_));
+        solver_ = std::make_unique<rows::SecondStepSolver>(*problem_data_,
+                                                           operations_research::DefaultRoutingSearchParameters(),
+                                                           boost::posix_time::minutes(120),
+                                                           boost::posix_time::minutes(15),
+                                                           boost::posix_time::minutes(15),
+                                                           boost::date_time::not_a_date_time);
+        model_ = std::make_unique<operations_research::RoutingModel>(solver_->index_manager());
+        solver_->ConfigureModel(*model_, printer_, cancel_token_, 1.0);
+
+        // routes of the construction heuristic are feasible, so they are used as solutions of clusters
+        routes_ = rows::ConstructionHeuristic{*solver_}.Solve();
+        ASSERT_NE(model_->ReadAssignmentFromRoutes(routes_, true), nullptr);
+    }
+
+    std::pair<int64, int64> FindRoutedSiblings() const {
+        for (const auto &route : routes_) {
+            for (const auto index : route) {
+                const auto &visit_nodes = problem_data_->GetNodes(solver_->index_manager().IndexToNode(index));
+                if (visit_nodes.size() > 1) {
+                    const auto visit_indices = solver_->index_manager().NodesToIndices(visit_nodes);
+                    return {std::min(visit_indices[0], visit_indices[1]), std::max(visit_indices[0], visit_indices[1])};
+                }
+            }
+        }
+        return {-1, -1};
+    }
+
+    std::vector<int> GetVehicles(const std::vector<std::vector<int64> > &routes) const {
+        std::vector<int> vehicle_of(static_cast<std::size_t>(model_->Size()), -1);
+        for (std::size_t vehicle = 0; vehicle < routes.size(); ++vehicle) {
+            for (const auto index : routes[vehicle]) {
+                vehicle_of[index] = static_cast<int>(vehicle);
+            }
+        }
+        return vehicle_of;
+    }
+
+    std::shared_ptr<rows::Printer> printer_;
+    std::shared_ptr<std::atomic<bool> > cancel_token_;
+    std::shared_ptr<rows::ProblemData> problem_data_;
+    std::unique_ptr<rows::SecondStepSolver> solver_;
+    std::unique_ptr<operations_research::RoutingModel> model_;
+    std::vector<std::vector<int64> > routes_;
+};
+
+TEST_F(TestClusterRoutes, DecomposeAssignsEveryVisitAndCarerToOneCluster) {
+    // given
+    const rows::GeographicDecomposition decomposition{rows::DecompositionOptions{3, 1}};
+
+    // when
+    const auto sub_problems = decomposition.Decompose(*problem_data_);
+
+    // then
+    ASSERT_EQ(sub_problems.size(), 3);
+
+    std::unordered_set<std::size_t> visits;
+    std::unordered_set<std::string> carers;
+    for (const auto &sub_problem : sub_problems) {
+        for (const auto &visit : sub_problem.visits()) {
+            EXPECT_TRUE(visits.insert(visit.id()).second);
+
+            const auto &service_users = sub_problem.service_users();
+            const auto service_user_it = std::find_if(std::cbegin(service_users),
+                                                      std::cend(service_users),
+                                                      [&visit](const rows::ExtendedServiceUser &service_user) -> bool {
+                                                          return service_user.id() == visit.service_user().id();
+                                                      });
+            EXPECT_NE(service_user_it, std::cend(service_users));
+        }
+
+        for (const auto &carer : sub_problem.carers()) {
+            EXPECT_TRUE(carers.insert(carer.first.sap_number()).second);
+        }
+    }
+    EXPECT_EQ(visits.size(), problem_data_->problem().visits().size());
+    EXPECT_LE(carers.size(), problem_data_->problem().carers().size());
+    EXPECT_GT(carers.size(), 0);
+}
+
+TEST_F(TestClusterRoutes, MergeAssignsLowerSiblingIndexToLowerVehicle) {
+    // given
+    const auto siblings = FindRoutedSiblings();
+    ASSERT_NE(siblings.first, -1);
+
+    // carers are split between two clusters and listed in the reverse order of vehicles
+    std::vector<std::vector<rows::ClusterRoute> > cluster_routes(2);
+    for (auto vehicle = static_cast<int>(routes_.size()) - 1; vehicle >= 0; --vehicle) {
+        rows::ClusterRoute carer_route{solver_->Carer(vehicle), {}};
+        for (const auto index : routes_[vehicle]) {
+            carer_route.second.push_back(solver_->NodeToVisit(solver_->index_manager().IndexToNode(index)));
+        }
+        cluster_routes[vehicle % 2].emplace_back(std::move(carer_route));
+    }
+
+    // when
+    const auto routes = rows::MergeClusterRoutes(cluster_routes, *solver_);
+
+    // then
+    EXPECT_EQ(routes, routes_);
+
+    const auto vehicle_of = GetVehicles(routes);
+    ASSERT_NE(vehicle_of[siblings.first], -1);
+    EXPECT_LT(vehicle_of[siblings.first], vehicle_of[siblings.second]);
+    EXPECT_NE(model_->ReadAssignmentFromRoutes(routes, true), nullptr);
+}
+
+TEST_F(TestClusterRoutes, RepairRemovesConflictingSiblings) {
+    // given
+    const auto siblings = FindRoutedSiblings();
+    ASSERT_NE(siblings.first, -1);
+
+    // the model requires the lower index of a visit of two carers to be routed by the vehicle with the lower number
+    auto routes = routes_;
+    for (auto &route : routes) {
+        for (auto &index : route) {
+            if (index == siblings.first) {
+                index = siblings.second;
+            } else if (index == siblings.second) {
+                index = siblings.first;
+            }
+        }
+    }
+    ASSERT_EQ(model_->ReadAssignmentFromRoutes(routes, true), nullptr);
+
+    // when
+    const auto repaired_routes = rows::RepairClusterRoutes(routes, *model_, *solver_);
+
+    // then
+    ASSERT_EQ(repaired_routes.size(), routes.size());
+    EXPECT_NE(model_->ReadAssignmentFromRoutes(repaired_routes, true), nullptr);
+
+    const auto vehicle_of = GetVehicles(repaired_routes);
+    EXPECT_EQ(vehicle_of[siblings.first], -1);
+    EXPECT_EQ(vehicle_of[siblings.second], -1);
+    for (const auto &route : routes) {
+        for (const auto index : route) {
+            if (index != siblings.first && index != siblings.second) {
+                EXPECT_NE(vehicle_of[index], -1);
+            }
+        }
+    }
+}
+
+TEST_F(TestClusterRoutes, RepairKeepsFeasibleRoutes) {
+    // when
+    const auto repaired_routes = rows::RepairClusterRoutes(routes_, *model_, *solver_);
+
+    // then
+    EXPECT_EQ(repaired_routes, routes_);
+}
+
+int main(int argc, char **argv) {
+    util::SetupLogging(argv[0]);
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,169 @@
+#include <cmath>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include <nlohmann/json.hpp>
+
+#include "util/logging.h"
+#include "history.h"
+#include "instance_generator.h"
+#include "location_container.h"
+#include "past_visit.h"
+#include "problem.h"
+#include "real_problem_data.h"
+
+class TestInstanceGenerator : public ::testing::Test {
+protected:
+    void SetUp() override {
+        options_.Seed = 7;
+        options_.Carers = 6;
+        options_.ServiceUsers = 12;
+        options_.VisitsPerDay = 40;
+        options_.Days = 2;
+        options_.SiblingFraction = 0.25;
+    }
+
+    rows::InstanceGeneratorOptions options_;
+};
+
+TEST_F(TestInstanceGenerator, SameSeedGeneratesSameInstance) {
+    // given
+    rows::InstanceGenerator first_generator{options_};
+    rows::InstanceGenerator second_generator{options_};
+    auto other_seed_options = options_;
+    other_seed_options.Seed = options_.Seed + 1;
+    rows::InstanceGenerator other_seed_generator{other_seed_options};
+
+    // when
+    const auto first_problem = first_generator.GenerateProblem();
+    const auto second_problem = second_generator.GenerateProblem();
+    const auto other_seed_problem = other_seed_generator.GenerateProblem();
+
+    // then
+    EXPECT_EQ(first_problem, second_problem);
+    EXPECT_EQ(first_generator.GenerateHistory(first_problem), second_generator.GenerateHistory(second_problem));
+    EXPECT_NE(first_problem, other_seed_problem);
+}
+
+TEST_F(TestInstanceGenerator, ProblemIsLoadedBySolverLoader) {
+    // given
+    rows::InstanceGenerator generator{options_};
+
+    // when
+    const auto problem = rows::Problem::JsonLoader{}.Load(generator.GenerateProblem());
+
+    // then
+    ASSERT_EQ(problem.carers().size(), static_cast<std::size_t>(options_.Carers));
+    for (const auto &carer_diaries : problem.carers()) {
+        EXPECT_EQ(carer_diaries.second.size(), static_cast<std::size_t>(options_.Days));
+    }
+
+    ASSERT_EQ(problem.visits().size(), static_cast<std::size_t>(options_.VisitsPerDay * options_.Days));
+    std::size_t sibling_visits = 0;
+    for (const auto &visit : problem.visits()) {
+        EXPECT_TRUE(visit.carer_count() == 1 || visit.carer_count() == 2);
+        ASSERT_TRUE(visit.location());
+        if (visit.carer_count() == 2) {
+            ++sibling_visits;
+        }
+    }
+    EXPECT_GT(sibling_visits, 0);
+    EXPECT_LT(sibling_visits, problem.visits().size());
+}
+
+TEST_F(TestInstanceGenerator, VisitsAreInsideArea) {
+    // given
+    options_.AreaSize = 4000.0;
+    rows::InstanceGenerator generator{options_};
+    const auto problem = rows::Problem::JsonLoader{}.Load(generator.GenerateProblem());
+    const rows::Location center{"55.8642", "-4.2518"};
+
+    // then
+    for (const auto &visit : problem.visits()) {
+        // the farthest point of the square is at the corner
+        EXPECT_LE(rows::HaversineLocationContainer::GreatCircleDistance(center, visit.location().get()),
+                  options_.AreaSize / std::sqrt(2.0) + 1.0);
+    }
+}
+
+TEST_F(TestInstanceGenerator, HistoryCoversEveryRecurringVisit) {
+    // given
+    rows::InstanceGenerator generator{options_};
+    const auto problem_json = generator.GenerateProblem();
+
+    std::set<std::pair<std::string, std::string> > recurring_visits;
+    for (const auto &service_user_visits : problem_json.at("visits")) {
+        for (const auto &visit : service_user_visits.at("visits")) {
+            recurring_visits.emplace(service_user_visits.at("service_user").get<std::string>(),
+                                     visit.at("time").get<std::string>());
+        }
+    }
+
+    // when
+    const auto history_json = generator.GenerateHistory(problem_json);
+    const rows::History history{history_json.get<std::vector<rows::PastVisit> >()};
+
+    // then
+    EXPECT_EQ(history_json.size(), recurring_visits.size() * static_cast<std::size_t>(options_.HistoryDays));
+    EXPECT_FALSE(history.empty());
+}
+
+TEST_F(TestInstanceGenerator, SplitShiftsHaveTwoWorkingPeriods) {
+    for (const auto split_shift_fraction : {0.0, 1.0}) {
+        // given
+        options_.SplitShiftFraction = split_shift_fraction;
+        rows::InstanceGenerator generator{options_};
+
+        // when
+        const auto problem = rows::Problem::JsonLoader{}.Load(generator.GenerateProblem());
+
+        // then
+        const std::size_t expected_events = split_shift_fraction == 0.0 ? 1 : 2;
+        for (const auto &carer_diaries : problem.carers()) {
+            for (const auto &diary : carer_diaries.second) {
+                EXPECT_EQ(diary.events().size(), expected_events);
+            }
+        }
+    }
+}
+
+TEST_F(TestInstanceGenerator, GeometricTravelModelsComputeTravelTimes) {
+    // given
+    static const auto SPEED = 1.4;
+    options_.Days = 1;
+    rows::InstanceGenerator generator{options_};
+    const auto problem = rows::Problem::JsonLoader{}.Load(generator.GenerateProblem());
+
+    // when
+    const auto euclidean_data = rows::GeometricProblemDataFactory{rows::GeometricProblemDataFactory::Metric::Euclidean,
+                                                                  SPEED}.makeProblem(problem);
+    const auto manhattan_data = rows::GeometricProblemDataFactory{rows::GeometricProblemDataFactory::Metric::Manhattan,
+                                                                  SPEED}.makeProblem(problem);
+
+    // then
+    ASSERT_EQ(euclidean_data->nodes(), manhattan_data->nodes());
+    int64 total_distance = 0;
+    for (operations_research::RoutingNodeIndex from{1}; from < euclidean_data->nodes(); ++from) {
+        for (operations_research::RoutingNodeIndex to{1}; to < euclidean_data->nodes(); ++to) {
+            const auto euclidean_distance = euclidean_data->Distance(from, to);
+            const auto manhattan_distance = manhattan_data->Distance(from, to);
+
+            // the street grid path is not shorter than the straight line and not longer than its diagonal bound
+            EXPECT_GE(manhattan_distance, euclidean_distance);
+            EXPECT_LE(manhattan_distance, std::ceil(euclidean_distance * std::sqrt(2.0)) + 1);
+            total_distance += euclidean_distance;
+        }
+    }
+    EXPECT_GT(total_distance, 0);
+}
+
+int main(int argc, char **argv) {
+    util::SetupLogging(argv[0]);
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -107,6 +107,23 @@ TEST(TestLocationContainer, CanCalculateTravelTimes) {
     EXPECT_GT(max, 0);
     EXPECT_GT(min, 0);
     LOG(INFO) << "Max: " << max << " Min: " << min;
+
+    // containers sharing the routing service find the same travel times without loading the map again
+    const auto routing_service = std::make_shared<const osrm::OSRM>(config);
+    rows::RealLocationContainer first_shared_container{routing_service};
+    rows::RealLocationContainer second_shared_container{routing_service};
+    for (const auto &source_pair : location_index) {
+        for (const auto &destination_pair : location_index) {
+            if (source_pair.second == destination_pair.second) {
+                continue;
+            }
+
+            const auto expected_distance = distance_matrix[source_pair.second][destination_pair.second];
+            EXPECT_EQ(first_shared_container.Distance(source_pair.first, destination_pair.first), expected_distance);
+            EXPECT_EQ(second_shared_container.Distance(destination_pair.first, source_pair.first),
+                      distance_matrix[destination_pair.second][source_pair.second]);
+        }
+    }
 }
 
 int main(int argc, char **argv) {
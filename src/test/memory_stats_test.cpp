@@ -0,0 +1,60 @@
+#include <cstdlib>
+#include <cstring>
+
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include "util/logging.h"
+#include "memory_stats.h"
+
+namespace {
+
+    // allocates a block which is returned to the system when freed, touches all its pages and frees it
+    void TouchMemory(std::size_t size) {
+        char *volatile block = static_cast<char *>(std::malloc(size));
+        ASSERT_NE(block, nullptr);
+        std::memset(block, 1, size);
+        std::free(block);
+    }
+}
+
+TEST(TestMemoryStats, PeakIncludesFreedMemory) {
+    // given
+    static const std::size_t BLOCK_SIZE = 128 * 1024 * 1024;
+    const auto usage_at_start = rows::MemoryUsage::Current();
+
+    // when
+    TouchMemory(BLOCK_SIZE);
+
+    // then
+    const auto usage = rows::MemoryUsage::Current();
+    EXPECT_GE(usage.PeakRss, usage_at_start.Rss + BLOCK_SIZE / 2);
+    EXPECT_LT(usage.Rss, usage.PeakRss);
+    EXPECT_GE(usage.ProcessPeakRss, usage.PeakRss);
+}
+
+TEST(TestMemoryStats, ResetPeakStartsNewHighWaterMark) {
+    // given
+    static const std::size_t BLOCK_SIZE = 128 * 1024 * 1024;
+    TouchMemory(BLOCK_SIZE);
+    const auto usage_before_reset = rows::MemoryUsage::Current();
+
+    // when
+    const auto is_reset = rows::MemoryUsage::ResetPeak();
+
+    // then
+    const auto usage = rows::MemoryUsage::Current();
+    EXPECT_GE(usage.ProcessPeakRss, usage_before_reset.PeakRss);
+    if (is_reset) {
+        EXPECT_LT(usage.PeakRss, usage_before_reset.PeakRss);
+        EXPECT_GE(usage.PeakRss, usage.Rss);
+    } else {
+        EXPECT_GE(usage.PeakRss, usage_before_reset.PeakRss);
+    }
+}
+
+int main(int argc, char **argv) {
+    util::SetupLogging(argv[0]);
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
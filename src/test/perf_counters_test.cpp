@@ -0,0 +1,66 @@
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include "util/logging.h"
+#include "perf_counters.h"
+
+TEST(TestPerfCounters, SnapshotIncludesFinishedThreads) {
+    // given
+    const auto counters_at_start = rows::PerfCounters::Snapshot();
+
+    // when
+    std::thread worker{[]() -> void {
+        for (auto call = 0; call < 100; ++call) {
+            rows::PerfCounters::Increment(rows::PerfCounter::SiblingFilterCall);
+        }
+    }};
+    worker.join();
+    rows::PerfCounters::Increment(rows::PerfCounter::SiblingFilterCall);
+
+    // then
+    const auto counters = rows::PerfCounters::Snapshot() - counters_at_start;
+    EXPECT_EQ(counters[rows::PerfCounter::SiblingFilterCall], 101u);
+    EXPECT_EQ(counters[rows::PerfCounter::SiblingFilterReject], 0u);
+}
+
+TEST(TestPerfCounters, SnapshotIncludesRunningThreads) {
+    // given
+    const auto counters_at_start = rows::PerfCounters::Snapshot();
+    std::mutex mutex;
+    std::condition_variable condition;
+    auto counted = false;
+    auto finish = false;
+
+    // when
+    std::thread worker{[&]() -> void {
+        for (auto call = 0; call < 10; ++call) {
+            rows::PerfCounters::Increment(rows::PerfCounter::ContinuityFilterReject);
+        }
+
+        std::unique_lock<std::mutex> lock{mutex};
+        counted = true;
+        condition.notify_all();
+        condition.wait(lock, [&finish]() -> bool { return finish; });
+    }};
+
+    std::unique_lock<std::mutex> lock{mutex};
+    condition.wait(lock, [&counted]() -> bool { return counted; });
+    const auto counters = rows::PerfCounters::Snapshot() - counters_at_start;
+    finish = true;
+    lock.unlock();
+    condition.notify_all();
+    worker.join();
+
+    // then
+    EXPECT_EQ(counters[rows::PerfCounter::ContinuityFilterReject], 10u);
+}
+
+int main(int argc, char **argv) {
+    util::SetupLogging(argv[0]);
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
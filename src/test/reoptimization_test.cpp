@@ -0,0 +1,221 @@
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include <nlohmann/json.hpp>
+
+#include <ortools/constraint_solver/routing.h>
+#include <ortools/constraint_solver/routing_parameters.h>
+
+#include "util/aplication_error.h"
+#include "util/logging.h"
+#include "util/input.h"
+#include "construction_heuristic.h"
+#include "instance_generator.h"
+#include "printer.h"
+#include "real_problem_data.h"
+#include "reoptimization.h"
+#include "second_step_solver.h"
+#include "three_step_worker.h"
+
+// the previous solution is built from routes of the construction heuristic, visits start at the earliest time
+// allowed by the model and the current time is the median of start times, so some visits were executed
+class TestReoptimization : public ::testing::Test {
+protected:
+    void SetUp() override {
+        rows::InstanceGeneratorOptions options;
+        options.Seed = 11;
+        options.Carers = 8;
+        options.ServiceUsers = 20;
+        options.VisitsPerDay = 60;
+        options.Days = 1;
+        options.SiblingFraction = 0.2;
+        options.SplitShiftFraction = 0.5;
+
+        rows::InstanceGenerator generator{options};
+        const auto problem_json = generator.GenerateProblem();
+
+        printer_ = std::make_shared<rows::LogPrinter>();
+        cancel_token_ = std::make_shared<std::atomic<bool> >(false);
+        problem_data_ = rows::HaversineProblemDataFactory{rows::TravelSpeedModel{}}.makeProblem(
+                util::ReduceProblem(util::ParseProblem(problem_json), "", printer_));
+        solver_ = CreateSolver();
+
+        operations_research::RoutingModel model{solver_->index_manager()};
+        solver_->ConfigureModel(model, printer_, cancel_token_, 1.0);
+        routes_ = rows::ConstructionHeuristic{*solver_}.Solve();
+
+        const auto assignment = model.ReadAssignmentFromRoutes(routes_, true);
+        ASSERT_NE(assignment, nullptr);
+        const auto solution = model.RestoreAssignment(*assignment);
+        ASSERT_NE(solution, nullptr);
+
+        const auto &time_dimension = model.GetDimensionOrDie(rows::SolverWrapper::TIME_DIMENSION);
+        std::vector<rows::ScheduledVisit> visits;
+        std::vector<int64> start_times;
+        for (int vehicle = 0; vehicle < model.vehicles(); ++vehicle) {
+            for (const auto index : routes_[vehicle]) {
+                const auto start_time = solution->Min(time_dimension.CumulVar(index));
+                const auto &calendar_visit = solver_->NodeToVisit(solver_->index_manager().IndexToNode(index));
+                visits.emplace_back(rows::ScheduledVisit::VisitType::OK,
+                                    solver_->Carer(vehicle),
+                                    problem_data_->StartHorizon() + boost::posix_time::seconds(start_time),
+                                    calendar_visit.duration(),
+                                    boost::none,
+                                    boost::none,
+                                    calendar_visit);
+                start_times.push_back(start_time);
+            }
+        }
+        ASSERT_FALSE(start_times.empty());
+
+        std::nth_element(std::begin(start_times), std::begin(start_times) + start_times.size() / 2, std::end(start_times));
+        current_time_ = problem_data_->StartHorizon() + boost::posix_time::seconds(start_times[start_times.size() / 2]);
+        previous_solution_ = rows::Solution{std::move(visits), {}};
+    }
+
+    std::unique_ptr<rows::SecondStepSolver> CreateSolver() const {
+        return std::make_unique<rows::SecondStepSolver>(*problem_data_,
+                                                        operations_research::DefaultRoutingSearchParameters(),
+                                                        boost::posix_time::minutes(120),
+                                                        boost::posix_time::minutes(15),
+                                                        boost::posix_time::minutes(15),
+                                                        boost::date_time::not_a_date_time);
+    }
+
+    std::shared_ptr<rows::Printer> printer_;
+    std::shared_ptr<std::atomic<bool> > cancel_token_;
+    std::shared_ptr<rows::ProblemData> problem_data_;
+    std::unique_ptr<rows::SecondStepSolver> solver_;
+    std::vector<std::vector<int64> > routes_;
+    rows::Solution previous_solution_;
+    boost::posix_time::ptime current_time_;
+};
+
+TEST_F(TestReoptimization, MapsPreviousRoutesOntoModel) {
+    // given
+    auto visits = previous_solution_.visits();
+    const auto carer = visits.front().carer().get();
+    const auto removed_visit = visits.front().calendar_visit().get();
+    visits.emplace_back(rows::ScheduledVisit::VisitType::OK,
+                        carer,
+                        removed_visit.datetime(),
+                        removed_visit.duration(),
+                        boost::none,
+                        boost::none,
+                        rows::CalendarVisit{std::numeric_limits<std::size_t>::max(),
+                                            removed_visit.service_user(),
+                                            removed_visit.address(),
+                                            removed_visit.location(),
+                                            removed_visit.datetime(),
+                                            removed_visit.duration(),
+                                            1,
+                                            {}});
+    const rows::ReoptimizationOptions options{rows::Solution{std::move(visits), {}}, current_time_};
+
+    // when
+    const auto previous_routes = rows::GetPreviousRoutes(options, *solver_);
+
+    // then
+    EXPECT_EQ(previous_routes.Routes, routes_);
+    EXPECT_EQ(previous_routes.RemovedVisits, 1u);
+    EXPECT_GT(previous_routes.ExecutedVisits, 0u);
+
+    operations_research::RoutingModel model{solver_->index_manager()};
+    solver_->ConfigureModel(model, printer_, cancel_token_, 1.0);
+    EXPECT_NE(model.ReadAssignmentFromRoutes(previous_routes.Routes, true), nullptr);
+}
+
+TEST_F(TestReoptimization, ExecutedVisitsArePrefixesOfRoutes) {
+    // given
+    const rows::ReoptimizationOptions options{previous_solution_, current_time_};
+
+    // when
+    const auto previous_routes = rows::GetPreviousRoutes(options, *solver_);
+
+    // then
+    ASSERT_EQ(previous_routes.ExecutedRoutes.size(), previous_routes.Routes.size());
+    std::size_t executed_visits = 0;
+    for (std::size_t vehicle = 0; vehicle < previous_routes.Routes.size(); ++vehicle) {
+        const auto &route = previous_routes.Routes[vehicle];
+        const auto &executed_route = previous_routes.ExecutedRoutes[vehicle];
+        ASSERT_LE(executed_route.size(), route.size());
+        EXPECT_TRUE(std::equal(std::cbegin(executed_route), std::cend(executed_route), std::cbegin(route)));
+
+        const auto carer_visits = previous_solution_.GetRoute(solver_->Carer(static_cast<int>(vehicle))).visits();
+        for (const auto &visit : carer_visits) {
+            const auto &visit_nodes = solver_->GetNodes(visit.calendar_visit().get());
+            const auto visit_indices = solver_->index_manager().NodesToIndices(visit_nodes);
+            const auto is_executed = std::any_of(std::cbegin(visit_indices), std::cend(visit_indices), [&executed_route](int64 index) -> bool {
+                return std::find(std::cbegin(executed_route), std::cend(executed_route), index) != std::cend(executed_route);
+            });
+            EXPECT_EQ(is_executed, visit.datetime() < current_time_);
+        }
+        executed_visits += executed_route.size();
+    }
+    EXPECT_EQ(executed_visits, previous_routes.ExecutedVisits);
+}
+
+TEST_F(TestReoptimization, FreezesExecutedVisits) {
+    // given
+    const rows::ReoptimizationOptions options{previous_solution_, current_time_};
+    const auto previous_routes = rows::GetPreviousRoutes(options, *solver_);
+
+    const auto executed_route_it = std::find_if(std::cbegin(previous_routes.ExecutedRoutes),
+                                                std::cend(previous_routes.ExecutedRoutes),
+                                                [](const std::vector<int64> &route) -> bool { return !route.empty(); });
+    ASSERT_NE(executed_route_it, std::cend(previous_routes.ExecutedRoutes));
+    const auto vehicle = executed_route_it - std::cbegin(previous_routes.ExecutedRoutes);
+
+    operations_research::RoutingModel model{solver_->index_manager()};
+    solver_->ConfigureModel(model, printer_, cancel_token_, 1.0);
+
+    // when
+    const auto routes = rows::FreezeExecutedRoutes(model,
+                                                   *problem_data_,
+                                                   previous_routes.ExecutedRoutes,
+                                                   current_time_,
+                                                   previous_routes.Routes);
+
+    // then
+    EXPECT_EQ(routes, previous_routes.Routes);
+    EXPECT_NE(model.ReadAssignmentFromRoutes(routes, true), nullptr);
+
+    // an executed visit cannot be moved
+    auto changed_routes = routes;
+    changed_routes[vehicle].erase(std::begin(changed_routes[vehicle]));
+    EXPECT_EQ(model.ReadAssignmentFromRoutes(changed_routes, true), nullptr);
+
+    // the remaining visits cannot start in the past
+    const auto &time_dimension = model.GetDimensionOrDie(rows::SolverWrapper::TIME_DIMENSION);
+    const auto current_time = (current_time_ - problem_data_->StartHorizon()).total_seconds();
+    for (std::size_t route_vehicle = 0; route_vehicle < routes.size(); ++route_vehicle) {
+        const auto &executed_route = previous_routes.ExecutedRoutes[route_vehicle];
+        for (auto position = executed_route.size(); position < routes[route_vehicle].size(); ++position) {
+            EXPECT_GE(time_dimension.CumulVar(routes[route_vehicle][position])->Min(), current_time);
+        }
+    }
+}
+
+TEST_F(TestReoptimization, WorkerRejectsThirdStage) {
+    // given
+    rows::ThreeStepSchedulingWorker worker{printer_,
+                                           rows::FirstStageStrategy::NONE,
+                                           rows::ThirdStageStrategy::DEFAULT,
+                                           nullptr};
+
+    // then
+    EXPECT_THROW(worker.EnableReoptimization(rows::ReoptimizationOptions{previous_solution_, current_time_}),
+                 util::ApplicationError);
+}
+
+int main(int argc, char **argv) {
+    util::SetupLogging(argv[0]);
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,145 @@
+#include <algorithm>
+#include <vector>
+
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include <ortools/constraint_solver/routing.h>
+
+#include "util/logging.h"
+#include "route_change_filter.h"
+
+// exposes the view of routes after the move which is seen by derived filters
+class RecordingFilter : public rows::RouteChangeFilter {
+public:
+    explicit RecordingFilter(const operations_research::RoutingModel &model)
+            : RouteChangeFilter(model),
+              calls{0},
+              new_vehicles{},
+              affected_indices{} {}
+
+    std::string DebugString() const override {
+        return "RecordingFilter";
+    }
+
+    std::size_t calls;
+    std::vector<int64> new_vehicles;
+    std::vector<int64> affected_indices;
+
+private:
+    bool AcceptRoutes() override {
+        ++calls;
+        new_vehicles.clear();
+        for (int64 index = 0; index < model_.Size(); ++index) {
+            new_vehicles.push_back(NewVehicle(index));
+        }
+        affected_indices = AffectedIndices();
+        return true;
+    }
+};
+
+class TestRouteChangeFilter : public ::testing::Test {
+protected:
+    TestRouteChangeFilter()
+            : index_manager_{7, 2, operations_research::RoutingIndexManager::NodeIndex{0}},
+              model_{index_manager_} {}
+
+    int64 Index(int node) const {
+        return index_manager_.NodeToIndex(operations_research::RoutingIndexManager::NodeIndex{node});
+    }
+
+    // the first vehicle visits nodes 1, 2 and 3, the second vehicle visits nodes 4, 5 and 6
+    void Synchronize(operations_research::IntVarLocalSearchFilter &filter) {
+        const std::vector<std::vector<int> > routes{{1, 2, 3},
+                                                    {4, 5, 6}};
+
+        auto assignment = model_.solver()->MakeAssignment();
+        for (int vehicle = 0; vehicle < model_.vehicles(); ++vehicle) {
+            auto previous_index = model_.Start(vehicle);
+            for (const auto node : routes[vehicle]) {
+                assignment->Add(model_.NextVar(previous_index))->SetValue(Index(node));
+                previous_index = Index(node);
+            }
+            assignment->Add(model_.NextVar(previous_index))->SetValue(model_.End(vehicle));
+        }
+        filter.Synchronize(assignment, nullptr);
+    }
+
+    operations_research::RoutingIndexManager index_manager_;
+    operations_research::RoutingModel model_;
+};
+
+TEST_F(TestRouteChangeFilter, AcceptsMovesBeforeSynchronization) {
+    // given
+    RecordingFilter filter{model_};
+    auto delta = model_.solver()->MakeAssignment();
+    delta->Add(model_.NextVar(Index(1)))->SetValue(Index(3));
+
+    // then
+    EXPECT_TRUE(filter.Accept(delta, nullptr));
+    EXPECT_EQ(filter.calls, 0u);
+}
+
+TEST_F(TestRouteChangeFilter, FollowsNodeMovedToAnotherRoute) {
+    // given
+    RecordingFilter filter{model_};
+    Synchronize(filter);
+
+    // node 2 is moved after node 4
+    auto delta = model_.solver()->MakeAssignment();
+    delta->Add(model_.NextVar(Index(1)))->SetValue(Index(3));
+    delta->Add(model_.NextVar(Index(4)))->SetValue(Index(2));
+    delta->Add(model_.NextVar(Index(2)))->SetValue(Index(5));
+
+    // when
+    EXPECT_TRUE(filter.Accept(delta, nullptr));
+
+    // then
+    ASSERT_EQ(filter.calls, 1u);
+    EXPECT_EQ(filter.new_vehicles[Index(1)], 0);
+    EXPECT_EQ(filter.new_vehicles[Index(2)], 1);
+    EXPECT_EQ(filter.new_vehicles[Index(3)], 0);
+    EXPECT_EQ(filter.new_vehicles[Index(5)], 1);
+    for (auto node = 1; node <= 6; ++node) {
+        EXPECT_NE(std::find(std::cbegin(filter.affected_indices), std::cend(filter.affected_indices), Index(node)),
+                  std::cend(filter.affected_indices));
+    }
+}
+
+TEST_F(TestRouteChangeFilter, UnperformedNodeHasNoVehicle) {
+    // given
+    RecordingFilter filter{model_};
+    Synchronize(filter);
+
+    // node 3 is removed from the route
+    auto delta = model_.solver()->MakeAssignment();
+    delta->Add(model_.NextVar(Index(2)))->SetValue(model_.End(0));
+    delta->Add(model_.NextVar(Index(3)))->SetValue(Index(3));
+
+    // when
+    EXPECT_TRUE(filter.Accept(delta, nullptr));
+
+    // then
+    ASSERT_EQ(filter.calls, 1u);
+    EXPECT_EQ(filter.new_vehicles[Index(3)], -1);
+    EXPECT_EQ(filter.new_vehicles[Index(4)], 1);
+}
+
+TEST_F(TestRouteChangeFilter, RejectsCycle) {
+    // given
+    RecordingFilter filter{model_};
+    Synchronize(filter);
+
+    auto delta = model_.solver()->MakeAssignment();
+    delta->Add(model_.NextVar(Index(3)))->SetValue(Index(1));
+
+    // then
+    EXPECT_FALSE(filter.Accept(delta, nullptr));
+    EXPECT_EQ(filter.calls, 0u);
+}
+
+int main(int argc, char **argv) {
+    util::SetupLogging(argv[0]);
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,250 @@
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include <boost/date_time.hpp>
+
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include "util/logging.h"
+#include "delay_tracker.h"
+#include "scenario_reduction.h"
+
+class TestScenarioReduction : public ::testing::Test {
+protected:
+    // dates of the whole year, so every weekday and season is represented
+    static std::vector<boost::gregorian::date> Dates() {
+        std::vector<boost::gregorian::date> dates;
+        for (boost::gregorian::day_iterator date_it{boost::gregorian::date{2017, 1, 1}};
+             *date_it < boost::gregorian::date{2018, 1, 1};
+             ++date_it) {
+            dates.push_back(*date_it);
+        }
+        return dates;
+    }
+
+    // visits take longer at weekends and in winter
+    static std::vector<std::vector<int64> > Samples(const std::vector<boost::gregorian::date> &dates) {
+        static const std::size_t NUM_VISITS = 8;
+
+        std::vector<std::vector<int64> > samples(NUM_VISITS);
+        for (std::size_t visit = 0; visit < NUM_VISITS; ++visit) {
+            for (const auto &date : dates) {
+                const auto weekday = date.day_of_week().as_number();
+                const auto is_weekend = weekday == 0 || weekday == 6;
+                const auto is_winter = date.month() <= 2 || date.month() == 12;
+                samples[visit].push_back(1800 + 60 * visit + (is_weekend ? 600 : 0) + (is_winter ? 300 : 0) + date.day() % 7);
+            }
+        }
+        return samples;
+    }
+
+    static int64 TotalWeight(const rows::ScenarioReduction &reduction) {
+        return std::accumulate(std::cbegin(reduction.Weights), std::cend(reduction.Weights), static_cast<int64>(0));
+    }
+
+    static bool IsSorted(const rows::ScenarioReduction &reduction) {
+        return std::is_sorted(std::cbegin(reduction.Scenarios), std::cend(reduction.Scenarios));
+    }
+};
+
+TEST_F(TestScenarioReduction, KeepsAllDatesWithoutReduction) {
+    // given
+    const auto dates = Dates();
+    const auto samples = Samples(dates);
+
+    // when
+    const auto reduction = rows::ReduceScenarios(rows::ScenarioReductionOptions{}, dates, samples);
+    const auto error = rows::EstimateReductionError(reduction, samples);
+
+    // then
+    ASSERT_EQ(reduction.Scenarios.size(), dates.size());
+    EXPECT_EQ(TotalWeight(reduction), dates.size());
+    EXPECT_DOUBLE_EQ(error.MaxMeanError, 0.0);
+    EXPECT_DOUBLE_EQ(error.MaxQuantileError, 0.0);
+}
+
+TEST_F(TestScenarioReduction, UniformSampleRepresentsAllDates) {
+    // given
+    const auto dates = Dates();
+    const auto samples = Samples(dates);
+
+    // when
+    const auto reduction = rows::ReduceScenarios(rows::ScenarioReductionOptions{rows::ScenarioReductionStrategy::UNIFORM, 50},
+                                                 dates,
+                                                 samples);
+
+    // then
+    EXPECT_EQ(reduction.Scenarios.size(), 50);
+    EXPECT_EQ(TotalWeight(reduction), dates.size());
+    EXPECT_TRUE(IsSorted(reduction));
+}
+
+TEST_F(TestScenarioReduction, StratifiedSampleCoversWeekdaysAndSeasons) {
+    // given
+    const auto dates = Dates();
+    const auto samples = Samples(dates);
+
+    // when
+    const auto reduction = rows::ReduceScenarios(rows::ScenarioReductionOptions{rows::ScenarioReductionStrategy::STRATIFIED, 56},
+                                                 dates,
+                                                 samples);
+    const auto error = rows::EstimateReductionError(reduction, samples);
+
+    // then
+    EXPECT_EQ(reduction.Scenarios.size(), 56);
+    EXPECT_EQ(TotalWeight(reduction), dates.size());
+    EXPECT_TRUE(IsSorted(reduction));
+
+    std::vector<std::vector<bool> > covered(7, std::vector<bool>(4, false));
+    for (const auto position : reduction.Scenarios) {
+        const auto &date = dates[position];
+        covered[date.day_of_week().as_number()][(date.month().as_number() % 12) / 3] = true;
+    }
+    for (const auto &weekday_covered : covered) {
+        for (const auto season_covered : weekday_covered) {
+            EXPECT_TRUE(season_covered);
+        }
+    }
+
+    // weekends and winters are represented by the right share of dates
+    EXPECT_LT(error.MaxMeanError, 10.0);
+}
+
+TEST_F(TestScenarioReduction, MedoidsRepresentSimilarDates) {
+    // given
+    const std::vector<boost::gregorian::date> dates{boost::gregorian::date{2017, 3, 6},
+                                                    boost::gregorian::date{2017, 3, 7},
+                                                    boost::gregorian::date{2017, 3, 8},
+                                                    boost::gregorian::date{2017, 3, 9},
+                                                    boost::gregorian::date{2017, 3, 10},
+                                                    boost::gregorian::date{2017, 3, 11}};
+    const std::vector<std::vector<int64> > samples{{1800, 1800, 1800, 3600, 3600, 1800},
+                                                   {900,  900,  900,  1800, 1800, 900}};
+
+    // when
+    const auto reduction = rows::ReduceScenarios(rows::ScenarioReductionOptions{rows::ScenarioReductionStrategy::KMEDOIDS, 2},
+                                                 dates,
+                                                 samples);
+    const auto error = rows::EstimateReductionError(reduction, samples);
+
+    // then
+    ASSERT_EQ(reduction.Scenarios.size(), 2);
+    EXPECT_EQ(reduction.Weights, (std::vector<int64>{4, 2}));
+    EXPECT_EQ(samples[0][reduction.Scenarios[0]], 1800);
+    EXPECT_EQ(samples[0][reduction.Scenarios[1]], 3600);
+    EXPECT_DOUBLE_EQ(error.MaxMeanError, 0.0);
+    EXPECT_DOUBLE_EQ(error.MaxQuantileError, 0.0);
+}
+
+TEST_F(TestScenarioReduction, ReportsNoDelayErrorForEquivalentScenarios) {
+    // given
+    const std::vector<boost::gregorian::date> dates{boost::gregorian::date{2017, 3, 6},
+                                                    boost::gregorian::date{2017, 3, 7},
+                                                    boost::gregorian::date{2017, 3, 8},
+                                                    boost::gregorian::date{2017, 3, 9}};
+    const std::vector<std::vector<int64> > delays{{-600, -600, 300, 300},
+                                                  {-60,  -60,  900, 900}};
+
+    // when
+    const auto reduction = rows::ReduceScenarios(rows::ScenarioReductionOptions{rows::ScenarioReductionStrategy::KMEDOIDS, 2},
+                                                 dates,
+                                                 delays);
+    const auto error = rows::EstimateDelayError(reduction, delays);
+
+    // then
+    EXPECT_DOUBLE_EQ(error.MaxMeanDelayError, 0.0);
+    EXPECT_DOUBLE_EQ(error.MaxDelayProbabilityError, 0.0);
+    EXPECT_DOUBLE_EQ(error.MaxRiskinessError, 0.0);
+    EXPECT_EQ(error.RiskinessMismatches, 0);
+}
+
+TEST_F(TestScenarioReduction, ReportsDelayErrorOfMissingScenarios) {
+    // given
+    const std::vector<std::vector<int64> > delays{{-900, -600, 300, 600}};
+    rows::ScenarioReduction reduction;
+    reduction.Scenarios = {2, 3};
+    reduction.Weights = {2, 2};
+
+    // when
+    const auto error = rows::EstimateDelayError(reduction, delays);
+
+    // then
+    EXPECT_DOUBLE_EQ(error.MaxMeanDelayError, 450.0 + 150.0);
+    EXPECT_DOUBLE_EQ(error.MaxDelayProbabilityError, 50.0);
+    EXPECT_EQ(error.RiskinessMismatches, 1);
+}
+
+// a scenario of weight w must have the same riskiness as w copies of the scenario, the riskiness of the expanded
+// scenarios is the minimum index r >= 0 such that the sum of max(delay, -r) is not positive
+TEST(TestEssentialRiskiness, WeightedRiskinessMatchesExpandedScenarios) {
+    static const int NUM_ITERATIONS = 10000;
+
+    std::mt19937 generator{17};
+    std::uniform_int_distribution<std::size_t> size_distribution{1, 12};
+    std::uniform_int_distribution<int64> delay_distribution{-25, 15};
+    std::uniform_int_distribution<int64> scale_distribution{0, 2};
+    std::uniform_int_distribution<int64> weight_distribution{1, 4};
+
+    for (auto iteration = 0; iteration < NUM_ITERATIONS; ++iteration) {
+        // given
+        std::vector<int64> delay;
+        std::vector<int64> weights;
+        std::vector<int64> expanded_delay;
+        const auto num_scenarios = size_distribution(generator);
+        for (std::size_t scenario = 0; scenario < num_scenarios; ++scenario) {
+            // a few long delays and many equal ones, so ties and an exact balance of delays are common
+            const auto scenario_delay = delay_distribution(generator) * (scale_distribution(generator) == 0 ? 37 : 1);
+            const auto weight = weight_distribution(generator);
+            delay.push_back(scenario_delay);
+            weights.push_back(weight);
+            expanded_delay.insert(std::end(expanded_delay), static_cast<std::size_t>(weight), scenario_delay);
+        }
+
+        int64 expected_riskiness = 0;
+        if (*std::max_element(std::cbegin(expanded_delay), std::cend(expanded_delay)) > 0) {
+            expected_riskiness = rows::DelayTracker::MAX_RISKINESS;
+            const auto min_delay = *std::min_element(std::cbegin(expanded_delay), std::cend(expanded_delay));
+            for (int64 riskiness = 0; riskiness <= -min_delay; ++riskiness) {
+                int64 balance = 0;
+                for (const auto scenario_delay : expanded_delay) {
+                    balance += std::max(scenario_delay, -riskiness);
+                }
+
+                if (balance <= 0) {
+                    expected_riskiness = riskiness;
+                    break;
+                }
+            }
+        }
+
+        // when
+        const auto weighted_riskiness = rows::DelayTracker::GetEssentialRiskiness(delay, weights);
+        const auto expanded_riskiness = rows::DelayTracker::GetEssentialRiskiness(expanded_delay,
+                                                                                  std::vector<int64>(expanded_delay.size(), 1));
+
+        // then
+        ASSERT_EQ(weighted_riskiness, expected_riskiness) << "iteration " << iteration;
+        ASSERT_EQ(expanded_riskiness, expected_riskiness) << "iteration " << iteration;
+        ASSERT_EQ(rows::DelayTracker::GetMeanDelay(delay, weights),
+                  rows::DelayTracker::GetMeanDelay(expanded_delay, std::vector<int64>(expanded_delay.size(), 1)));
+        ASSERT_EQ(rows::DelayTracker::GetDelayProbability(delay, weights),
+                  rows::DelayTracker::GetDelayProbability(expanded_delay, std::vector<int64>(expanded_delay.size(), 1)));
+    }
+}
+
+TEST_F(TestScenarioReduction, ParsesStrategies) {
+    EXPECT_EQ(rows::ParseScenarioReductionStrategy("none").get(), rows::ScenarioReductionStrategy::NONE);
+    EXPECT_EQ(rows::ParseScenarioReductionStrategy("Uniform").get(), rows::ScenarioReductionStrategy::UNIFORM);
+    EXPECT_EQ(rows::ParseScenarioReductionStrategy("stratified").get(), rows::ScenarioReductionStrategy::STRATIFIED);
+    EXPECT_EQ(rows::ParseScenarioReductionStrategy("kmedoids").get(), rows::ScenarioReductionStrategy::KMEDOIDS);
+    EXPECT_FALSE(rows::ParseScenarioReductionStrategy("random"));
+}
+
+int main(int argc, char **argv) {
+    util::SetupLogging(argv[0]);
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,117 @@
+#include <string>
+#include <vector>
+
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include <nlohmann/json.hpp>
+
+#include "util/logging.h"
+#include "schedule_delta.h"
+
+rows::Problem CreateProblem() {
+    const rows::ExtendedServiceUser service_user{1,
+                                                 rows::Address{"1", "High Street", "Glasgow", "G1 1AA"},
+                                                 rows::Location{"55.8886039", "-4.3429593"}};
+    const boost::posix_time::ptime morning{boost::gregorian::date(2017, 2, 1), boost::posix_time::hours(9)};
+
+    std::vector<rows::CalendarVisit> visits;
+    for (std::size_t visit_id = 1; visit_id <= 3; ++visit_id) {
+        visits.emplace_back(visit_id,
+                            service_user,
+                            service_user.address(),
+                            boost::make_optional(service_user.location()),
+                            morning + boost::posix_time::hours(visit_id),
+                            boost::posix_time::minutes(30),
+                            1,
+                            std::vector<int>{});
+    }
+
+    std::vector<std::pair<rows::Carer, std::vector<rows::Diary> > > carers{{rows::Carer{"100"}, {}},
+                                                                           {rows::Carer{"200"}, {}}};
+    return {std::move(visits), std::move(carers), {service_user}};
+}
+
+TEST(TestScheduleDelta, LoadsChangesFromJson) {
+    // given
+    const auto delta_json = nlohmann::json::parse(R"({
+        "current_time": {"date": "2017-02-01", "time": "12:30:00"},
+        "removed_visits": [2],
+        "removed_carers": ["200"],
+        "added_visits": [{"key": 4, "service_user": "1", "date": "2017-02-01", "time": "15:00:00", "duration": "1800"}]
+    })");
+
+    // when
+    const auto delta = rows::ScheduleDelta::JsonLoader{}.Load(delta_json);
+
+    // then
+    EXPECT_EQ(delta.current_time(),
+              boost::posix_time::ptime(boost::gregorian::date(2017, 2, 1), boost::posix_time::time_duration(12, 30, 0)));
+    EXPECT_EQ(delta.removed_visits(), std::vector<std::size_t>{2});
+    ASSERT_EQ(delta.removed_carers().size(), 1u);
+    EXPECT_EQ(delta.removed_carers().front().sap_number(), "200");
+    ASSERT_EQ(delta.added_visits().size(), 1u);
+    EXPECT_EQ(delta.added_visits().front().id(), 4u);
+    EXPECT_EQ(delta.added_visits().front().carer_count(), 1);
+    EXPECT_EQ(delta.added_visits().front().duration(), boost::posix_time::minutes(30));
+}
+
+TEST(TestScheduleDelta, AppliesChangesToProblem) {
+    // given
+    const auto problem = CreateProblem();
+    const boost::posix_time::ptime afternoon{boost::gregorian::date(2017, 2, 1), boost::posix_time::hours(15)};
+    const rows::ScheduleDelta delta{afternoon - boost::posix_time::hours(2),
+                                    {2},
+                                    {rows::Carer{"200"}},
+                                    {rows::CalendarVisit{4,
+                                                         rows::ServiceUser{1},
+                                                         rows::Address{},
+                                                         boost::none,
+                                                         afternoon,
+                                                         boost::posix_time::minutes(30),
+                                                         1,
+                                                         {}}}};
+
+    // when
+    const auto updated_problem = delta.Apply(problem);
+
+    // then
+    std::vector<std::size_t> visit_ids;
+    for (const auto &visit : updated_problem.visits()) {
+        visit_ids.push_back(visit.id());
+    }
+    EXPECT_EQ(visit_ids, (std::vector<std::size_t>{1, 3, 4}));
+
+    ASSERT_EQ(updated_problem.carers().size(), 1u);
+    EXPECT_EQ(updated_problem.carers().front().first.sap_number(), "100");
+
+    const auto &added_visit = updated_problem.visits().back();
+    ASSERT_TRUE(added_visit.location());
+    EXPECT_EQ(added_visit.location().get(), problem.service_users().front().location());
+    EXPECT_EQ(added_visit.address(), problem.service_users().front().address());
+}
+
+TEST(TestScheduleDelta, RejectsVisitOfUnknownServiceUser) {
+    // given
+    const auto problem = CreateProblem();
+    const rows::ScheduleDelta delta{boost::posix_time::ptime(boost::gregorian::date(2017, 2, 1)),
+                                    {},
+                                    {},
+                                    {rows::CalendarVisit{4,
+                                                         rows::ServiceUser{2},
+                                                         rows::Address{},
+                                                         boost::none,
+                                                         boost::posix_time::ptime(boost::gregorian::date(2017, 2, 1)),
+                                                         boost::posix_time::minutes(30),
+                                                         1,
+                                                         {}}}};
+
+    // then
+    EXPECT_THROW(delta.Apply(problem), util::ApplicationError);
+}
+
+int main(int argc, char **argv) {
+    util::SetupLogging(argv[0]);
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
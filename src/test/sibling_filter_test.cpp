@@ -0,0 +1,152 @@
+#include <utility>
+#include <vector>
+
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include <ortools/constraint_solver/routing.h>
+
+#include "util/logging.h"
+#include "sibling_filter.h"
+#include "solver_wrapper.h"
+
+// nodes 1 and 3 are a visit of two carers, every arc takes a minute including the service time
+class TestSiblingFilter : public ::testing::Test {
+protected:
+    TestSiblingFilter()
+            : index_manager_{7, 3, operations_research::RoutingIndexManager::NodeIndex{0}},
+              model_{index_manager_} {
+        const auto transit_callback = model_.RegisterTransitCallback([](int64 from_index, int64 to_index) -> int64 { return 60; });
+        model_.AddDimension(transit_callback, HORIZON, HORIZON, false, rows::SolverWrapper::TIME_DIMENSION);
+    }
+
+    int64 Index(int node) const {
+        return index_manager_.NodeToIndex(operations_research::RoutingIndexManager::NodeIndex{node});
+    }
+
+    std::vector<std::pair<int64, int64> > Siblings() const {
+        return {{Index(1), Index(3)}};
+    }
+
+    operations_research::RoutingDimension &time_dimension() {
+        return *model_.GetMutableDimension(rows::SolverWrapper::TIME_DIMENSION);
+    }
+
+    // vehicles visit nodes 1 and 2, nodes 3 and 4, nodes 5 and 6
+    void Synchronize(operations_research::IntVarLocalSearchFilter &filter) {
+        const std::vector<std::vector<int> > routes{{1, 2},
+                                                    {3, 4},
+                                                    {5, 6}};
+
+        auto assignment = model_.solver()->MakeAssignment();
+        for (int vehicle = 0; vehicle < model_.vehicles(); ++vehicle) {
+            auto previous_index = model_.Start(vehicle);
+            for (const auto node : routes[vehicle]) {
+                assignment->Add(model_.NextVar(previous_index))->SetValue(Index(node));
+                previous_index = Index(node);
+            }
+            assignment->Add(model_.NextVar(previous_index))->SetValue(model_.End(vehicle));
+        }
+        filter.Synchronize(assignment, nullptr);
+    }
+
+    // moves node 1 from the start of the first route to the end of the route of the vehicle
+    operations_research::Assignment *MoveFirstSibling(int vehicle, int last_node) {
+        auto delta = model_.solver()->MakeAssignment();
+        delta->Add(model_.NextVar(model_.Start(0)))->SetValue(Index(2));
+        delta->Add(model_.NextVar(Index(last_node)))->SetValue(Index(1));
+        delta->Add(model_.NextVar(Index(1)))->SetValue(model_.End(vehicle));
+        return delta;
+    }
+
+    static const int64 HORIZON;
+
+    operations_research::RoutingIndexManager index_manager_;
+    operations_research::RoutingModel model_;
+};
+
+const int64 TestSiblingFilter::HORIZON = 1000;
+
+TEST_F(TestSiblingFilter, RejectsSiblingsOnSameVehicle) {
+    // given
+    rows::SiblingFilter filter{model_, Siblings()};
+    Synchronize(filter);
+
+    // then
+    EXPECT_FALSE(filter.Accept(MoveFirstSibling(1, 4), nullptr));
+}
+
+TEST_F(TestSiblingFilter, RejectsReversedOrderOfVehicles) {
+    // given
+    rows::SiblingFilter filter{model_, Siblings()};
+    Synchronize(filter);
+
+    // then
+    EXPECT_FALSE(filter.Accept(MoveFirstSibling(2, 6), nullptr));
+}
+
+TEST_F(TestSiblingFilter, RejectsSingleDroppedSibling) {
+    // given
+    rows::SiblingFilter filter{model_, Siblings()};
+    Synchronize(filter);
+
+    auto delta = model_.solver()->MakeAssignment();
+    delta->Add(model_.NextVar(model_.Start(0)))->SetValue(Index(2));
+    delta->Add(model_.NextVar(Index(1)))->SetValue(Index(1));
+
+    // then
+    EXPECT_FALSE(filter.Accept(delta, nullptr));
+}
+
+TEST_F(TestSiblingFilter, AcceptsBothDroppedSiblings) {
+    // given
+    rows::SiblingFilter filter{model_, Siblings()};
+    Synchronize(filter);
+
+    auto delta = model_.solver()->MakeAssignment();
+    delta->Add(model_.NextVar(model_.Start(0)))->SetValue(Index(2));
+    delta->Add(model_.NextVar(Index(1)))->SetValue(Index(1));
+    delta->Add(model_.NextVar(model_.Start(1)))->SetValue(Index(4));
+    delta->Add(model_.NextVar(Index(3)))->SetValue(Index(3));
+
+    // then
+    EXPECT_TRUE(filter.Accept(delta, nullptr));
+}
+
+TEST_F(TestSiblingFilter, RejectsSiblingsWhichCannotStartTogether) {
+    // given
+    time_dimension().CumulVar(Index(3))->SetRange(0, 100);
+    rows::SiblingFilter filter{model_, Siblings()};
+    Synchronize(filter);
+
+    // node 2 is moved before node 1, so node 1 cannot start before two minutes
+    auto delta = model_.solver()->MakeAssignment();
+    delta->Add(model_.NextVar(model_.Start(0)))->SetValue(Index(2));
+    delta->Add(model_.NextVar(Index(2)))->SetValue(Index(1));
+    delta->Add(model_.NextVar(Index(1)))->SetValue(model_.End(0));
+
+    // then
+    EXPECT_FALSE(filter.Accept(delta, nullptr));
+}
+
+TEST_F(TestSiblingFilter, AcceptsSiblingsWhichStartTogether) {
+    // given
+    time_dimension().CumulVar(Index(3))->SetRange(0, 100);
+    rows::SiblingFilter filter{model_, Siblings()};
+    Synchronize(filter);
+
+    // node 2 is moved to the last route, node 1 still starts after a minute
+    auto delta = model_.solver()->MakeAssignment();
+    delta->Add(model_.NextVar(Index(1)))->SetValue(model_.End(0));
+    delta->Add(model_.NextVar(Index(6)))->SetValue(Index(2));
+    delta->Add(model_.NextVar(Index(2)))->SetValue(model_.End(2));
+
+    // then
+    EXPECT_TRUE(filter.Accept(delta, nullptr));
+}
+
+int main(int argc, char **argv) {
+    util::SetupLogging(argv[0]);
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,183 @@
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include <nlohmann/json.hpp>
+
+#include <ortools/constraint_solver/routing.h>
+#include <ortools/constraint_solver/routing_parameters.h>
+
+#include "util/aplication_error.h"
+#include "util/logging.h"
+#include "util/input.h"
+#include "async_solution_writer.h"
+#include "construction_heuristic.h"
+#include "deterministic_search.h"
+#include "history.h"
+#include "instance_generator.h"
+#include "printer.h"
+#include "real_problem_data.h"
+#include "second_step_solver.h"
+#include "solution_snapshot.h"
+#include "three_step_worker.h"
+
+// a snapshot is restored by another model of the same problem, as the output writer of the worker does,
+// there are enough carers to keep dropped visits below the limit of intermediate solutions
+class TestSolutionSnapshot : public ::testing::Test {
+protected:
+    void SetUp() override {
+        rows::InstanceGeneratorOptions options;
+        options.Seed = 13;
+        options.Carers = 8;
+        options.ServiceUsers = 8;
+        options.VisitsPerDay = 20;
+        options.Days = 1;
+        options.SiblingFraction = 0.2;
+        options.SplitShiftFraction = 0.5;
+
+        rows::InstanceGenerator generator{options};
+        const auto problem_json = generator.GenerateProblem();
+
+        printer_ = std::make_shared<rows::LogPrinter>();
+        cancel_token_ = std::make_shared<std::atomic<bool> >(false);
+        problem_data_ = rows::HaversineProblemDataFactory{rows::TravelSpeedModel{}}.makeProblem(
+                util::ReduceProblem(util::ParseProblem(problem_json), "", printer_));
+    }
+
+    std::unique_ptr<rows::SecondStepSolver> CreateSolver() const {
+        auto search_params = operations_research::DefaultRoutingSearchParameters();
+        search_params.set_solution_limit(8);
+        return std::make_unique<rows::SecondStepSolver>(*problem_data_,
+                                                        search_params,
+                                                        boost::posix_time::minutes(120),
+                                                        boost::posix_time::minutes(15),
+                                                        boost::posix_time::minutes(15),
+                                                        boost::date_time::not_a_date_time);
+    }
+
+    std::unique_ptr<operations_research::RoutingModel> CreateModel(rows::SecondStepSolver &solver) const {
+        auto model = std::make_unique<operations_research::RoutingModel>(solver.index_manager());
+        solver.ConfigureModel(*model, printer_, cancel_token_, 1.0);
+        return model;
+    }
+
+    std::shared_ptr<rows::Printer> printer_;
+    std::shared_ptr<std::atomic<bool> > cancel_token_;
+    std::shared_ptr<rows::ProblemData> problem_data_;
+};
+
+TEST_F(TestSolutionSnapshot, RestoresValuesFoundBySearch) {
+    // given
+    auto search_solver = CreateSolver();
+    auto search_model = CreateModel(*search_solver);
+    const auto initial_routes = rows::ConstructionHeuristic{*search_solver}.Solve();
+    const auto initial_assignment = search_model->ReadAssignmentFromRoutes(initial_routes, true);
+    ASSERT_NE(initial_assignment, nullptr);
+    auto search_params = operations_research::DefaultRoutingSearchParameters();
+    search_params.set_solution_limit(8);
+    const auto search_assignment = search_model->SolveFromAssignmentWithParameters(initial_assignment, search_params);
+    ASSERT_NE(search_assignment, nullptr);
+
+    auto output_solver = CreateSolver();
+    auto output_model = CreateModel(*output_solver);
+
+    // when
+    const auto snapshot = rows::TakeSolutionSnapshot(*search_model, *search_assignment);
+    const auto solution = rows::RestoreSolutionSnapshot(*output_model, snapshot);
+
+    // then
+    ASSERT_NE(solution, nullptr);
+    std::vector<std::vector<int64> > restored_routes;
+    output_model->AssignmentToRoutes(*solution, &restored_routes);
+    EXPECT_EQ(restored_routes, snapshot.Routes);
+
+    const auto search_dimension = search_model->GetMutableDimension(rows::SolverWrapper::TIME_DIMENSION);
+    const auto output_dimension = output_model->GetMutableDimension(rows::SolverWrapper::TIME_DIMENSION);
+    for (int64 index = 0; index < search_model->Size() + search_model->vehicles(); ++index) {
+        EXPECT_EQ(solution->Min(output_dimension->CumulVar(index)), search_assignment->Min(search_dimension->CumulVar(index)));
+    }
+
+    for (auto vehicle = 0; vehicle < search_model->vehicles(); ++vehicle) {
+        const auto &search_breaks = search_dimension->GetBreakIntervalsOfVehicle(vehicle);
+        const auto &output_breaks = output_dimension->GetBreakIntervalsOfVehicle(vehicle);
+        ASSERT_EQ(search_breaks.size(), output_breaks.size());
+        for (std::size_t break_pos = 0; break_pos < search_breaks.size(); ++break_pos) {
+            EXPECT_EQ(solution->StartMin(output_breaks[break_pos]), search_assignment->StartMin(search_breaks[break_pos]));
+            EXPECT_EQ(solution->DurationMin(output_breaks[break_pos]), search_assignment->DurationMin(search_breaks[break_pos]));
+        }
+    }
+}
+
+TEST_F(TestSolutionSnapshot, FailsToRestoreInvalidSnapshot) {
+    // given
+    auto solver = CreateSolver();
+    auto model = CreateModel(*solver);
+    const auto routes = rows::ConstructionHeuristic{*solver}.Solve();
+    const auto assignment = model->ReadAssignmentFromRoutes(routes, true);
+    ASSERT_NE(assignment, nullptr);
+    const auto snapshot = rows::TakeSolutionSnapshot(*model, *assignment);
+
+    auto truncated_snapshot = snapshot;
+    truncated_snapshot.Cumuls.pop_back();
+
+    auto repeated_visit_snapshot = snapshot;
+    const auto route_it = std::find_if(std::begin(repeated_visit_snapshot.Routes), std::end(repeated_visit_snapshot.Routes),
+                                       [](const std::vector<int64> &route) -> bool { return !route.empty(); });
+    ASSERT_NE(route_it, std::end(repeated_visit_snapshot.Routes));
+    route_it->push_back(route_it->front());
+
+    // then
+    EXPECT_THROW(rows::RestoreSolutionSnapshot(*model, truncated_snapshot), util::ApplicationError);
+    EXPECT_THROW(rows::RestoreSolutionSnapshot(*model, repeated_visit_snapshot), util::ApplicationError);
+}
+
+TEST_F(TestSolutionSnapshot, WorkerWritesSnapshotsInBackground) {
+    // given
+    const auto output_directory = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("rows-snapshot-%%%%-%%%%");
+    ASSERT_TRUE(boost::filesystem::create_directories(output_directory));
+    const auto output_file = output_directory / "solution.gexf";
+
+    rows::ThreeStepSchedulingWorker worker{printer_, rows::FirstStageStrategy::NONE, rows::ThirdStageStrategy::NONE, nullptr};
+    ASSERT_TRUE(worker.Init(problem_data_,
+                            std::make_shared<rows::History>(),
+                            output_file.string(),
+                            boost::posix_time::minutes(120),
+                            boost::posix_time::minutes(15),
+                            boost::posix_time::minutes(15),
+                            boost::posix_time::seconds(5),
+                            boost::posix_time::seconds(5),
+                            boost::posix_time::seconds(5),
+                            boost::none,
+                            1.0));
+    worker.EnableDeterministicSearch(rows::DeterministicSearchOptions{8, 100000, 1});
+    worker.EnableIntermediateSolutions();
+
+    // when
+    worker.Run();
+
+    // then
+    EXPECT_EQ(worker.ReturnCode(), 0);
+    EXPECT_TRUE(boost::filesystem::is_regular_file(output_directory / "second_stage_solution.gexf"));
+
+    std::size_t intermediate_files = 0;
+    for (boost::filesystem::directory_iterator file_it{output_directory}; file_it != boost::filesystem::directory_iterator{}; ++file_it) {
+        if (file_it->path().filename().string().find("intermediate_") == 0) {
+            ++intermediate_files;
+        }
+    }
+    EXPECT_GT(intermediate_files, 0);
+
+    boost::filesystem::remove_all(output_directory);
+}
+
+int main(int argc, char **argv) {
+    util::SetupLogging(argv[0]);
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
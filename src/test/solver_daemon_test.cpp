@@ -0,0 +1,272 @@
+#include <cstring>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <boost/format.hpp>
+
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include <nlohmann/json.hpp>
+
+#include "util/logging.h"
+#include "instance_generator.h"
+#include "real_problem_data.h"
+#include "solver_daemon.h"
+
+// client of the daemon, which sends requests and receives messages in the line-delimited JSON format
+class DaemonClient {
+public:
+    explicit DaemonClient(const std::string &socket_path)
+            : socket_{socket(AF_UNIX, SOCK_STREAM, 0)},
+              buffer_{} {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        std::strncpy(address.sun_path, socket_path.c_str(), sizeof(address.sun_path) - 1);
+        CHECK_EQ(connect(socket_, reinterpret_cast<sockaddr *>(&address), sizeof(address)), 0);
+    }
+
+    ~DaemonClient() {
+        close(socket_);
+    }
+
+    void Send(const nlohmann::json &request) {
+        const auto text = request.dump() + "\n";
+        CHECK_EQ(send(socket_, text.data(), text.size(), MSG_NOSIGNAL), static_cast<ssize_t>(text.size()));
+    }
+
+    void SendText(const std::string &text) {
+        CHECK_EQ(send(socket_, text.data(), text.size(), MSG_NOSIGNAL), static_cast<ssize_t>(text.size()));
+    }
+
+    nlohmann::json Receive() {
+        auto line_end = buffer_.find('\n');
+        while (line_end == std::string::npos) {
+            char chunk[4096];
+            const auto bytes_read = recv(socket_, chunk, sizeof(chunk), 0);
+            CHECK_GT(bytes_read, 0) << "Daemon closed the connection";
+            buffer_.append(chunk, static_cast<std::size_t>(bytes_read));
+            line_end = buffer_.find('\n');
+        }
+
+        const auto line = buffer_.substr(0, line_end);
+        buffer_.erase(0, line_end + 1);
+        return nlohmann::json::parse(line);
+    }
+
+    // skips progress events of running jobs
+    nlohmann::json Receive(const std::string &type, const std::string &id) {
+        while (true) {
+            auto message = Receive();
+            if (message.at("type") != type) {
+                continue;
+            }
+
+            const auto id_it = message.find("id");
+            if (id.empty() || (id_it != std::end(message) && *id_it == id)) {
+                return message;
+            }
+        }
+    }
+
+private:
+    const int socket_;
+    std::string buffer_;
+};
+
+class TestSolverDaemon : public ::testing::Test {
+protected:
+    void StartDaemon(rows::SolverDaemonOptions options) {
+        options.SocketPath = (boost::format("/tmp/rows-daemon-test-%1%.sock") % getpid()).str();
+        socket_path_ = options.SocketPath;
+
+        daemon_ = std::make_unique<rows::SolverDaemon>(
+                options,
+                std::make_shared<rows::HaversineProblemDataFactory>(rows::TravelSpeedModel{}),
+                std::make_shared<const rows::History>());
+        daemon_->Listen();
+        daemon_thread_ = std::thread([this]() -> void { daemon_->Run(); });
+    }
+
+    void TearDown() override {
+        if (daemon_) {
+            daemon_->Shutdown();
+            daemon_thread_.join();
+            daemon_.reset();
+        }
+    }
+
+    static nlohmann::json GenerateProblem() {
+        rows::InstanceGeneratorOptions options;
+        options.Seed = 11;
+        options.Carers = 3;
+        options.ServiceUsers = 4;
+        options.VisitsPerDay = 2;
+        options.Days = 1;
+        options.SiblingFraction = 0.0;
+        options.SplitShiftFraction = 0.0;
+
+        rows::InstanceGenerator generator{options};
+        return generator.GenerateProblem();
+    }
+
+    nlohmann::json SolveRequest(const std::string &id, const std::string &time_limit) const {
+        return {{"command",    "solve"},
+                {"id",         id},
+                {"problem",    GenerateProblem()},
+                {"parameters", {{"preopt_noprogress_time_limit",  time_limit},
+                                {"opt_noprogress_time_limit",     time_limit},
+                                {"postopt_noprogress_time_limit", time_limit},
+                                {"third_stage",                   "none"},
+                                {"output",                        (boost::format("/tmp/rows-daemon-test-%1%-%2%.gexf")
+                                                                   % getpid() % id).str()}}}};
+    }
+
+    std::string socket_path_;
+    std::unique_ptr<rows::SolverDaemon> daemon_;
+    std::thread daemon_thread_;
+};
+
+TEST_F(TestSolverDaemon, SolvesProblemAndStreamsProgress) {
+    // given
+    StartDaemon(rows::SolverDaemonOptions{});
+    DaemonClient client{socket_path_};
+
+    // when
+    client.Send({{"command", "status"}});
+    const auto initial_status = client.Receive();
+
+    client.Send(SolveRequest("job-1", "00:00:01"));
+    const auto accepted = client.Receive();
+
+    auto progress_events = 0;
+    auto message = client.Receive();
+    while (message.at("type") != "finished") {
+        EXPECT_EQ(message.at("id"), "job-1");
+        ++progress_events;
+        message = client.Receive();
+    }
+
+    client.Send({{"command", "status"}});
+    const auto final_status = client.Receive("status", "");
+
+    // then
+    EXPECT_EQ(initial_status.at("type"), "status");
+    EXPECT_TRUE(initial_status.at("jobs").empty());
+    EXPECT_EQ(accepted.at("type"), "accepted");
+    EXPECT_EQ(accepted.at("id"), "job-1");
+    EXPECT_GT(progress_events, 0);
+    EXPECT_EQ(message.at("id"), "job-1");
+    EXPECT_EQ(message.at("return_code"), 0);
+    EXPECT_TRUE(final_status.at("jobs").empty());
+    EXPECT_EQ(final_status.at("problem_cache"), 1);
+}
+
+TEST_F(TestSolverDaemon, RunsConcurrentJobsOfSameProblem) {
+    // given
+    rows::SolverDaemonOptions options;
+    options.MaxJobs = 2;
+    StartDaemon(options);
+    DaemonClient client{socket_path_};
+
+    // when
+    client.Send(SolveRequest("job-1", "00:00:01"));
+    client.Send(SolveRequest("job-2", "00:00:01"));
+
+    // jobs finish in any order
+    std::map<std::string, nlohmann::json> finished;
+    while (finished.size() < 2) {
+        const auto message = client.Receive("finished", "");
+        finished.emplace(message.at("id").get<std::string>(), message);
+    }
+
+    client.Send({{"command", "status"}});
+    const auto final_status = client.Receive("status", "");
+
+    // then
+    ASSERT_EQ(finished.count("job-1"), 1u);
+    ASSERT_EQ(finished.count("job-2"), 1u);
+    EXPECT_EQ(finished.at("job-1").at("return_code"), 0);
+    EXPECT_EQ(finished.at("job-2").at("return_code"), 0);
+    EXPECT_EQ(final_status.at("problem_cache"), 1);
+}
+
+TEST_F(TestSolverDaemon, RejectsJobsAboveLimitAndCancels) {
+    // given
+    rows::SolverDaemonOptions options;
+    options.MaxJobs = 1;
+    StartDaemon(options);
+    DaemonClient client{socket_path_};
+
+    // when
+    client.Send(SolveRequest("job-1", "00:05:00"));
+    const auto accepted = client.Receive("accepted", "job-1");
+
+    client.Send(SolveRequest("job-2", "00:00:01"));
+    const auto rejected = client.Receive("rejected", "job-2");
+
+    client.Send({{"command", "cancel"},
+                 {"id",      "job-1"}});
+    const auto cancelled = client.Receive("cancelled", "job-1");
+    const auto finished = client.Receive("finished", "job-1");
+
+    // then
+    EXPECT_EQ(accepted.at("id"), "job-1");
+    EXPECT_EQ(rejected.at("id"), "job-2");
+    EXPECT_EQ(cancelled.at("id"), "job-1");
+    EXPECT_EQ(finished.at("id"), "job-1");
+}
+
+TEST_F(TestSolverDaemon, RejectsJobsAboveMemoryLimit) {
+    // given
+    rows::SolverDaemonOptions options;
+    options.MemoryLimit = 1;
+    StartDaemon(options);
+    DaemonClient client{socket_path_};
+
+    // when
+    client.Send(SolveRequest("job-1", "00:00:01"));
+    const auto rejected = client.Receive();
+
+    // then
+    EXPECT_EQ(rejected.at("type"), "rejected");
+    EXPECT_EQ(rejected.at("id"), "job-1");
+}
+
+TEST_F(TestSolverDaemon, ReportsInvalidRequestsAndShutsDown) {
+    // given
+    StartDaemon(rows::SolverDaemonOptions{});
+    DaemonClient client{socket_path_};
+
+    // when
+    client.SendText("not a json\n");
+    const auto parse_error = client.Receive();
+
+    client.Send({{"command", "cancel"},
+                 {"id",      "missing"}});
+    const auto cancel_error = client.Receive();
+
+    client.Send({{"command", "shutdown"}});
+    const auto shutdown = client.Receive();
+    daemon_thread_.join();
+    daemon_.reset();
+
+    // then
+    EXPECT_EQ(parse_error.at("type"), "error");
+    EXPECT_EQ(cancel_error.at("type"), "error");
+    EXPECT_EQ(cancel_error.at("id"), "missing");
+    EXPECT_EQ(shutdown.at("type"), "shutdown");
+    EXPECT_NE(access(socket_path_.c_str(), F_OK), 0);
+}
+
+int main(int argc, char **argv) {
+    util::SetupLogging(argv[0]);
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,101 @@
+#include <string>
+#include <vector>
+
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include "util/logging.h"
+#include "time_budget.h"
+
+TEST(TestTimeBudget, ImprovementIsUnknownUntilWindowIsCovered) {
+    // given
+    rows::ImprovementRate improvement_rate{1000, 16};
+
+    // when
+    improvement_rate.Add(100, 1000.0);
+    improvement_rate.Add(500, 900.0);
+
+    // then
+    EXPECT_FALSE(improvement_rate.RelativeImprovement(900));
+    ASSERT_TRUE(improvement_rate.RelativeImprovement(1200));
+    EXPECT_DOUBLE_EQ(*improvement_rate.RelativeImprovement(1200), 0.1);
+}
+
+TEST(TestTimeBudget, ImprovementIsMeasuredFromBeginningOfWindow) {
+    // given
+    rows::ImprovementRate improvement_rate{1000, 16};
+
+    // when
+    improvement_rate.Add(0, 1000.0);
+    improvement_rate.Add(500, 800.0);
+    improvement_rate.Add(2000, 799.0);
+    improvement_rate.Add(2100, 900.0);
+
+    // then
+    ASSERT_TRUE(improvement_rate.RelativeImprovement(2500));
+    EXPECT_DOUBLE_EQ(*improvement_rate.RelativeImprovement(2500), 1.0 / 800.0);
+    ASSERT_TRUE(improvement_rate.RelativeImprovement(4000));
+    EXPECT_DOUBLE_EQ(*improvement_rate.RelativeImprovement(4000), 0.0);
+}
+
+TEST(TestTimeBudget, ImprovementIsScaledWhenSamplesAreOverwritten) {
+    // given
+    rows::ImprovementRate improvement_rate{1000, 2};
+
+    // when
+    improvement_rate.Add(0, 1000.0);
+    improvement_rate.Add(400, 900.0);
+    improvement_rate.Add(500, 810.0);
+
+    // then
+    ASSERT_TRUE(improvement_rate.RelativeImprovement(600));
+    EXPECT_DOUBLE_EQ(*improvement_rate.RelativeImprovement(600), 0.1 * 1000.0 / 200.0);
+}
+
+TEST(TestTimeBudget, AllocatesRemainingTimeByWeights) {
+    // given
+    rows::TimeBudgetOptions options{boost::posix_time::minutes(10)};
+    options.StageWeights = {{"Stage1", 1.0},
+                            {"Stage2", 3.0}};
+    options.MaxExtension = 0.5;
+    rows::TimeBudget time_budget{options, {"Stage1", "Stage2"}};
+
+    // when
+    const auto allocation = time_budget.BeginStage("Stage1");
+    const auto allocated = std::chrono::duration_cast<std::chrono::seconds>(allocation.Allocated - std::chrono::steady_clock::now());
+    const auto latest = std::chrono::duration_cast<std::chrono::seconds>(allocation.Latest - std::chrono::steady_clock::now());
+
+    // then
+    EXPECT_NEAR(allocated.count(), 150, 1);
+    EXPECT_NEAR(latest.count(), 150 + 225, 1);
+}
+
+TEST(TestTimeBudget, CarriesUnusedTimeForward) {
+    // given
+    rows::TimeBudgetOptions options{boost::posix_time::minutes(10)};
+    rows::TimeBudget time_budget{options, {"Stage1", "Stage2", "Stage3"}};
+
+    // when
+    time_budget.BeginStage("Stage1");
+    time_budget.EndStage("Stage1");
+    const auto second_stage_allocation = time_budget.BeginStage("Stage2");
+    time_budget.EndStage("Stage2");
+    const auto third_stage_allocation = time_budget.BeginStage("Stage3");
+    const auto second_stage_allocated = std::chrono::duration_cast<std::chrono::seconds>(
+            second_stage_allocation.Allocated - std::chrono::steady_clock::now());
+    const auto third_stage_allocated = std::chrono::duration_cast<std::chrono::seconds>(
+            third_stage_allocation.Allocated - std::chrono::steady_clock::now());
+    const auto third_stage_latest = std::chrono::duration_cast<std::chrono::seconds>(
+            third_stage_allocation.Latest - std::chrono::steady_clock::now());
+
+    // then
+    EXPECT_NEAR(second_stage_allocated.count(), 450, 1);
+    EXPECT_NEAR(third_stage_allocated.count(), 600, 1);
+    EXPECT_EQ(third_stage_allocated.count(), third_stage_latest.count());
+}
+
+int main(int argc, char **argv) {
+    util::SetupLogging(argv[0]);
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,131 @@
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include <boost/format.hpp>
+#include <nlohmann/json.hpp>
+
+#include "util/logging.h"
+#include "location.h"
+#include "location_container.h"
+#include "travel_speed_model.h"
+
+namespace {
+
+    // location at the given distance north of the center of Glasgow
+    rows::Location NorthOfCenter(double meters) {
+        static const double METERS_PER_DEGREE = 6371000.0 * M_PI / 180.0;
+
+        return {(boost::format("%.6f") % (55.8642 + meters / METERS_PER_DEGREE)).str(), "-4.251800"};
+    }
+}
+
+TEST(TestTravelSpeedModel, GreatCircleDistanceOfKnownPlaces) {
+    // given
+    const rows::Location glasgow{"55.864200", "-4.251800"};
+    const rows::Location edinburgh{"55.953300", "-3.188300"};
+    const rows::Location south{"55.000000", "-4.000000"};
+    const rows::Location north{"56.000000", "-4.000000"};
+
+    // then
+    EXPECT_DOUBLE_EQ(rows::HaversineLocationContainer::GreatCircleDistance(glasgow, glasgow), 0.0);
+    EXPECT_NEAR(rows::HaversineLocationContainer::GreatCircleDistance(glasgow, edinburgh), 67019.5, 1.0);
+    EXPECT_NEAR(rows::HaversineLocationContainer::GreatCircleDistance(edinburgh, glasgow), 67019.5, 1.0);
+    EXPECT_NEAR(rows::HaversineLocationContainer::GreatCircleDistance(south, north), 111194.9, 1.0);
+}
+
+TEST(TestTravelSpeedModel, FitRecoversRoadFactor) {
+    // given
+    static const double SPEED = 8.0;
+    static const int64 FIXED_DURATION = 60;
+    static const double ROAD_FACTOR = 1.3;
+
+    const auto origin = NorthOfCenter(0.0);
+    std::vector<rows::TravelSample> samples;
+    for (auto step = 1; step <= 20; ++step) {
+        const auto destination = NorthOfCenter(250.0 * step);
+        const auto travel_time = rows::HaversineLocationContainer::GreatCircleDistance(origin, destination) / SPEED;
+        samples.push_back({origin, destination, FIXED_DURATION + static_cast<int64>(std::round(ROAD_FACTOR * travel_time))});
+    }
+
+    // when
+    const auto model = rows::FitTravelSpeedModel(samples, SPEED, FIXED_DURATION, 0.0, 1);
+
+    // then
+    EXPECT_NEAR(model.RoadFactor, ROAD_FACTOR, 1E-3);
+    EXPECT_DOUBLE_EQ(model.Speed, SPEED);
+    EXPECT_EQ(model.FixedDuration, FIXED_DURATION);
+    EXPECT_TRUE(model.Regions.empty());
+}
+
+TEST(TestTravelSpeedModel, FitKeepsJourneysShorterThanFixedDuration) {
+    // given
+    static const double SPEED = 8.0;
+    static const int64 FIXED_DURATION = 60;
+    static const double ROAD_FACTOR = 1.3;
+    static const int64 NOISE = 60;
+
+    // short journeys measured with symmetric noise, some durations are below the fixed duration
+    const auto origin = NorthOfCenter(0.0);
+    std::vector<rows::TravelSample> samples;
+    for (auto step = 1; step <= 10; ++step) {
+        const auto destination = NorthOfCenter(50.0 * step);
+        const auto travel_time = rows::HaversineLocationContainer::GreatCircleDistance(origin, destination) / SPEED;
+        const auto duration = FIXED_DURATION + static_cast<int64>(std::round(ROAD_FACTOR * travel_time));
+        samples.push_back({origin, destination, duration + NOISE});
+        samples.push_back({origin, destination, duration - NOISE});
+    }
+
+    // when
+    const auto model = rows::FitTravelSpeedModel(samples, SPEED, FIXED_DURATION, 0.0, 1);
+
+    // then
+    EXPECT_NEAR(model.RoadFactor, ROAD_FACTOR, 0.02);
+}
+
+TEST(TestTravelSpeedModel, FitCorrectsRegions) {
+    // given
+    static const double SPEED = 8.0;
+    static const int64 FIXED_DURATION = 0;
+    static const double REGION_SIZE = 0.1;
+
+    // journeys in the first region are twice as slow as in the second one
+    const rows::Location first_origin{"55.010000", "-4.050000"};
+    const rows::Location second_origin{"55.210000", "-4.050000"};
+    std::vector<rows::TravelSample> samples;
+    for (auto step = 1; step <= 5; ++step) {
+        const auto offset = (boost::format("%.6f") % (-4.050000 + 0.01 * step)).str();
+        const rows::Location first_destination{"55.010000", offset};
+        const rows::Location second_destination{"55.210000", offset};
+        const auto first_travel_time = rows::HaversineLocationContainer::GreatCircleDistance(first_origin, first_destination) / SPEED;
+        const auto second_travel_time = rows::HaversineLocationContainer::GreatCircleDistance(second_origin, second_destination) / SPEED;
+        samples.push_back({first_origin, first_destination, static_cast<int64>(std::round(2.0 * first_travel_time))});
+        samples.push_back({second_origin, second_destination, static_cast<int64>(std::round(second_travel_time))});
+    }
+
+    // when
+    const auto model = rows::FitTravelSpeedModel(samples, SPEED, FIXED_DURATION, REGION_SIZE, 5);
+
+    // then
+    ASSERT_EQ(model.Regions.size(), 2u);
+    EXPECT_DOUBLE_EQ(model.RegionSize, REGION_SIZE);
+    EXPECT_NEAR(model.Regions[0].Factor / model.Regions[1].Factor, 2.0, 0.1);
+}
+
+TEST(TestTravelSpeedModel, RegionsWithoutRegionSizeAreRejected) {
+    // given
+    const auto model_json = nlohmann::json::parse(
+            R"({"speed": 8.0, "road_factor": 1.3, "fixed_duration": 60, "regions": [{"row": 1, "column": 2, "factor": 1.1}]})");
+
+    // then
+    EXPECT_DEATH(model_json.get<rows::TravelSpeedModel>(), "region_size");
+}
+
+int main(int argc, char **argv) {
+    util::SetupLogging(argv[0]);
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,62 @@
+#!/usr/bin/env bash
+
+# compares fixed no progress time limits of every stage with the adaptive time budget shared by the stages
+# on generated instances, results are read from manifests of the runs
+
+set -e
+
+SIZES=${SIZES:-"20:60:120 40:120:240 80:240:480"}
+# the fixed limits of the first, the second and the third stage sum up to the budget
+PRE_OPT_LIMIT=${PRE_OPT_LIMIT:-"00:01:00"}
+OPT_LIMIT=${OPT_LIMIT:-"00:03:00"}
+POST_OPT_LIMIT=${POST_OPT_LIMIT:-"00:01:00"}
+TIME_BUDGET=${TIME_BUDGET:-"00:05:00"}
+OUTPUT_DIR=${OUTPUT_DIR:-time_budget_benchmark}
+SOLVER_ARGS="--travel-model=haversine --scheduling-date=2017-02-01 --console-format=log \
+--visit-time-window=00:30:00 --break-time-window=00:30:00 --begin-end-shift-time-extension=00:15:00"
+
+mkdir -p ${OUTPUT_DIR}
+for size in ${SIZES}; do
+    IFS=':' read -r carers service_users visits <<< "${size}"
+    instance=${OUTPUT_DIR}/c${carers}_s${service_users}_v${visits}
+
+    if [ ! -f ${instance}_problem.json ]; then
+        ./build/rows-generate --carers=${carers} --service_users=${service_users} --visits_per_day=${visits} \
+        --problem_output=${instance}_problem.json --history_output=
+    fi
+
+    rm -f ${instance}_fixed.json ${instance}_budget.json
+    ./build/rows-main --problem=${instance}_problem.json ${SOLVER_ARGS} \
+    --preopt-noprogress-time-limit=${PRE_OPT_LIMIT} --opt-noprogress-time-limit=${OPT_LIMIT} \
+    --postopt-noprogress-time-limit=${POST_OPT_LIMIT} \
+    --output=${instance}_fixed.gexf --manifest=${instance}_fixed.json 2> ${instance}_fixed.err.log
+    ./build/rows-main --problem=${instance}_problem.json ${SOLVER_ARGS} --time-budget=${TIME_BUDGET} \
+    --output=${instance}_budget.gexf --manifest=${instance}_budget.json 2> ${instance}_budget.err.log
+    grep "Time budget:" ${instance}_budget.err.log || true
+done
+
+python3 - ${OUTPUT_DIR}/*_fixed.json <<'PYTHON'
+import json
+import sys
+
+
+def summarize(path):
+    with open(path) as input_stream:
+        manifest = json.load(input_stream)
+    solutions = manifest['solutions']
+    wall_time_ms = sum(stage['wall_time_ms'] for stage in manifest['stages'] if stage['name'] == 'All')
+    if not solutions:
+        return None, None, wall_time_ms
+    # the last solution is the output of the run
+    return solutions[-1]['cost'], solutions[-1]['dropped_visits'], wall_time_ms
+
+
+print('{0:<24} {1:>14} {2:>8} {3:>10} {4:>14} {5:>8} {6:>10}'.format(
+    'instance', 'cost', 'dropped', 'time [s]', 'cost (budget)', 'dropped', 'time [s]'))
+for fixed_path in sys.argv[1:]:
+    instance = fixed_path[:-len('_fixed.json')]
+    cost, dropped, wall_time_ms = summarize(fixed_path)
+    budget_cost, budget_dropped, budget_wall_time_ms = summarize(instance + '_budget.json')
+    print('{0:<24} {1:>14} {2:>8} {3:>10.1f} {4:>14} {5:>8} {6:>10.1f}'.format(
+        instance.split('/')[-1], cost, dropped, wall_time_ms / 1000.0, budget_cost, budget_dropped, budget_wall_time_ms / 1000.0))
+PYTHON